@@ -8,6 +8,9 @@ let package = Package(
         .library(
             name: "gttcan",
             targets: ["gttcan"]),
+        .executable(
+            name: "gttcan-sim",
+            targets: ["gttcan-sim"]),
     ],
     dependencies: [
     ],
@@ -30,6 +33,12 @@ let package = Package(
                     "-Wno-unknown-warning-option",
                     "-Wno-documentation-unknown-command"
                 ])]),
+        .executableTarget(
+            name: "gttcan-sim",
+            dependencies: ["gttcan"],
+            linkerSettings: [
+                .linkedLibrary("m", .when(platforms: [.linux]))
+            ]),
         .testTarget(
             name: "gttcanTests",
             dependencies: ["gttcan"]),
@@ -0,0 +1,652 @@
+/**
+ * @file main.c
+ * @brief Micro-benchmarks of the GTTCAN protocol hot paths.
+ *
+ * Every benchmark runs a fixed number of calls per repetition, after one
+ * warm-up repetition, and reports the median and minimum time per call
+ * (and TSC ticks per call on x86).  The output is a table, or JSON for
+ * tracking regressions across releases and compiler flags.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gttcan.h"
+#include "gttcan_whiteboard.h"
+#include "gttcan_fd.h"
+#include "gttcan_stats.h"
+#include "gttcan_trace.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define GTTCAN_BENCH_TSC 1
+#else
+#define GTTCAN_BENCH_TSC 0
+#endif
+
+#ifndef GTTCAN_BENCH_CPP
+#define GTTCAN_BENCH_CPP 0
+#endif
+
+#ifndef GTTCAN_BENCH_BUILD
+#define GTTCAN_BENCH_BUILD ""
+#endif
+
+#define MAX_REPETITIONS 101U
+#define SCHEDULE_LENGTH 64U
+#define BATCH_FRAMES 64U
+#define INSTANCES 1024U
+
+typedef uint64_t (*benchmark_fp)(uint64_t iterations);
+
+typedef struct benchmark_s {
+    const char *name;
+    benchmark_fp run;
+    uint64_t iterations; // calls per repetition
+} benchmark_t;
+
+typedef struct result_s {
+    double median_ns;
+    double min_ns;
+    double median_ticks;
+} result_t;
+
+static volatile uint64_t sink;
+static gttcan_t ttcan;
+static gttcan_whiteboard_t whiteboard;
+static gttcan_fd_t fd;
+static gttcan_stats_t stats;
+#if GTTCAN_TRACE
+static gttcan_trace_t trace;
+#endif
+static uint8_t schedule[GTTCAN_SCHEDULE_SIZE(SCHEDULE_LENGTH)];
+static gttcan_t instances[INSTANCES];
+static gttcan_node_schedule_t shared_schedule;
+static gttcan_node_schedule_t node_schedule; // of ttcan, also without GTTCAN_EMBEDDED_SCHEDULE
+static const uint8_t frame[8] = { 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0 };
+
+static void ignore_transmit(uint32_t id, uint64_t data, void *context) { sink += id ^ data; (void)context; }
+static void ignore_timer(uint32_t delay, void *context) { sink += delay; (void)context; }
+static uint64_t read_value(uint16_t id, void *context) { (void)context; return 0x0123456789ABCDEFULL ^ id; }
+static void ignore_write(uint16_t id, uint64_t value, void *context) { sink += id ^ value; (void)context; }
+static void ignore_fd_transmit(uint32_t id, const uint8_t *data, uint8_t length, void *context) { sink += id ^ data[0] ^ length; (void)context; }
+static uint8_t read_buffer(uint16_t id, uint8_t *data, void *context) { memcpy(data, frame, sizeof(frame)); data[0] ^= (uint8_t)id; (void)context; return sizeof(frame); }
+static void ignore_fd_write(uint16_t id, const uint8_t *data, uint8_t length, void *context) { sink += id ^ data[0] ^ length; (void)context; }
+
+/**
+ * @brief Set up a node that owns every fourth slot of a 64-slot schedule.
+ *
+ * Slot 0 is a reference frame of node 1, the local node is node 2.
+ */
+static uint32_t pack_schedule(void)
+{
+    uint32_t entries[SCHEDULE_LENGTH];
+    for (uint32_t g = 0U; g < SCHEDULE_LENGTH; g++)
+    {
+        entries[g] = (g == 0U) ? (1UL << 16U) : (((((g % 4U) == 1U) ? 2UL : 3UL) << 16U) | (g + 1U));
+    }
+    return GTTCAN_pack_schedule(schedule, sizeof(schedule), entries, SCHEDULE_LENGTH, 0U);
+}
+
+static void set_up(bool exact_offset)
+{
+    GTTCAN_init(&ttcan, 2U, 2000U, SCHEDULE_LENGTH, ignore_transmit, ignore_timer, read_value, ignore_write, NULL);
+    if (!GTTCAN_build_node_schedule(&node_schedule, schedule, pack_schedule(), 2U, false) ||
+        !GTTCAN_set_node_schedule(&ttcan, &node_schedule))
+    {
+        fprintf(stderr, "invalid benchmark schedule\n");
+        exit(2);
+    }
+    if (exact_offset)
+    {
+        GTTCAN_set_exact_slot_offset(&ttcan, 10U, 0U);
+    }
+    ttcan.isActive = true;
+    ttcan.transmitted = true;
+}
+
+static uint64_t bench_crc15(uint64_t iterations)
+{
+    uint64_t sum = 0U;
+    uint8_t data[8];
+    memcpy(data, frame, sizeof(data));
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        data[0] = (uint8_t)i;
+        sum += GTTCAN_crc15(data, sizeof(data));
+    }
+    return sum;
+}
+
+static uint64_t bench_crc15_bitwise(uint64_t iterations)
+{
+    uint64_t sum = 0U;
+    uint8_t data[8];
+    memcpy(data, frame, sizeof(data));
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        data[0] = (uint8_t)i;
+        sum += GTTCAN_crc15_bitwise(data, sizeof(data));
+    }
+    return sum;
+}
+
+static uint64_t bench_crc15_batch(uint64_t iterations)
+{
+    static uint8_t frames[BATCH_FRAMES * 8U];
+    static uint32_t lengths[BATCH_FRAMES];
+    static uint16_t crcs[BATCH_FRAMES];
+    for (uint32_t i = 0U; i < sizeof(frames); i++)
+    {
+        frames[i] = (uint8_t)(i * 37U);
+    }
+    for (uint32_t i = 0U; i < BATCH_FRAMES; i++)
+    {
+        lengths[i] = 8U;
+    }
+    uint64_t sum = 0U;
+    for (uint64_t i = 0U; i < iterations; i += BATCH_FRAMES)
+    {
+        frames[0] = (uint8_t)i;
+        GTTCAN_crc15_batch(frames, 8U, lengths, crcs, BATCH_FRAMES);
+        sum += crcs[0];
+    }
+    return sum;
+}
+
+static uint64_t bench_calculate_stuffing_bits(uint64_t iterations)
+{
+    uint64_t sum = 0U;
+    uint8_t data[8];
+    memcpy(data, frame, sizeof(data));
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        data[0] = (uint8_t)i;
+        sum += GTTCAN_calculate_stuffing_bits(data, sizeof(data));
+    }
+    return sum;
+}
+
+static uint64_t bench_count_bitstream_stuffing_bits(uint64_t iterations)
+{
+    gttcan_bitstream_t stream;
+    (void)GTTCAN_serialise_extended_frame(0x12345U, frame, sizeof(frame), &stream);
+    uint64_t sum = 0U;
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        stream.bits[1] ^= i << 20U;
+        sum += GTTCAN_count_bitstream_stuffing_bits(&stream);
+    }
+    return sum;
+}
+
+static uint64_t bench_calculate_can_frame_bits(uint64_t iterations)
+{
+    uint64_t sum = 0U;
+    uint8_t data[8];
+    memcpy(data, frame, sizeof(data));
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        data[0] = (uint8_t)i;
+        sum += GTTCAN_calculate_can_frame_bits(data, sizeof(data), true);
+    }
+    return sum;
+}
+
+static uint64_t bench_calculate_extended_frame_bits(uint64_t iterations)
+{
+    uint64_t sum = 0U;
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        sum += GTTCAN_calculate_extended_frame_bits((uint32_t)i & 0x1FFFFFFFU, frame, sizeof(frame));
+    }
+    return sum;
+}
+
+static uint64_t bench_calculate_fd_frame_bits(uint64_t iterations)
+{
+    uint8_t payload[GTTCAN_FD_MAX_PAYLOAD];
+    for (uint32_t i = 0U; i < GTTCAN_FD_MAX_PAYLOAD; i++)
+    {
+        payload[i] = frame[i % sizeof(frame)];
+    }
+    uint64_t sum = 0U;
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        gttcan_fd_frame_bits_t bits;
+        sum += GTTCAN_calculate_fd_frame_bits((uint32_t)i & 0x1FFFFFFFU, payload, GTTCAN_FD_MAX_PAYLOAD, true, &bits);
+    }
+    return sum;
+}
+
+static uint64_t bench_process_frame(uint64_t iterations)
+{
+    set_up(false);
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        const uint32_t index = ((uint32_t)i % (SCHEDULE_LENGTH - 1U)) + 1U;
+        GTTCAN_process_frame(&ttcan, (index * 2000U) + ((uint32_t)i & 7U), GTTCAN_CAN_ID(index, index + 1U), i);
+    }
+    return (uint64_t)ttcan.error_offset;
+}
+
+/**
+ * @brief Receive frames on INSTANCES nodes in turn.
+ *
+ * The nodes either embed their own copy of the node schedule or
+ * share one, see GTTCAN_set_node_schedule().
+ */
+static uint64_t bench_process_frame_instances(uint64_t iterations, bool shared)
+{
+    const uint32_t size = pack_schedule();
+    (void)GTTCAN_build_node_schedule(&shared_schedule, schedule, size, 2U, false);
+    for (uint32_t n = 0U; n < INSTANCES; n++)
+    {
+        GTTCAN_init(&instances[n], 2U, 2000U, SCHEDULE_LENGTH, ignore_transmit, ignore_timer, read_value, ignore_write, NULL);
+#if GTTCAN_EMBEDDED_SCHEDULE
+        (void)(shared ? GTTCAN_set_node_schedule(&instances[n], &shared_schedule) : GTTCAN_load_schedule(&instances[n], schedule, size));
+#else
+        (void)shared;
+        (void)GTTCAN_set_node_schedule(&instances[n], &shared_schedule);
+#endif
+        instances[n].isActive = true;
+        instances[n].transmitted = true;
+    }
+    int64_t sum = 0;
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        gttcan_t * const instance = &instances[i % INSTANCES];
+        const uint32_t index = ((uint32_t)(i / INSTANCES) % (SCHEDULE_LENGTH - 1U)) + 1U;
+        GTTCAN_process_frame(instance, (index * 2000U) + ((uint32_t)i & 7U), GTTCAN_CAN_ID(index, index + 1U), i);
+        sum += instance->error_offset;
+    }
+    return (uint64_t)sum;
+}
+
+#if GTTCAN_EMBEDDED_SCHEDULE
+static uint64_t bench_process_frame_1024_embedded(uint64_t iterations)
+{
+    return bench_process_frame_instances(iterations, false);
+}
+#endif
+
+static uint64_t bench_process_frame_1024_shared(uint64_t iterations)
+{
+    return bench_process_frame_instances(iterations, true);
+}
+
+/// One call is one frame, passed in batches of 8.
+static uint64_t bench_process_frames(uint64_t iterations)
+{
+    gttcan_rx_frame_t frames[8];
+    set_up(false);
+    for (uint64_t i = 0U; i < iterations; i += 8U)
+    {
+        for (uint32_t f = 0U; f < 8U; f++)
+        {
+            const uint32_t index = ((uint32_t)(i + f) % (SCHEDULE_LENGTH - 1U)) + 1U;
+            frames[f].timestamp = (index * 2000U) + (f & 7U);
+            frames[f].id = GTTCAN_CAN_ID(index, index + 1U);
+            frames[f].data = i;
+        }
+        GTTCAN_process_frames(&ttcan, frames, 8U);
+    }
+    return (uint64_t)ttcan.error_offset;
+}
+
+static uint64_t bench_process_frame_stats(uint64_t iterations)
+{
+    set_up(false);
+    GTTCAN_stats_init(&stats);
+    GTTCAN_set_stats(&ttcan, &stats);
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        const uint32_t index = ((uint32_t)i % (SCHEDULE_LENGTH - 1U)) + 1U;
+        GTTCAN_process_frame(&ttcan, (index * 2000U) + ((uint32_t)i & 7U), GTTCAN_CAN_ID(index, index + 1U), i);
+    }
+    return (uint64_t)ttcan.error_offset;
+}
+
+#if GTTCAN_TRACE
+static uint64_t bench_process_frame_trace(uint64_t iterations)
+{
+    set_up(false);
+    GTTCAN_trace_init(&trace);
+    GTTCAN_set_trace(&ttcan, &trace);
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        const uint32_t index = ((uint32_t)i % (SCHEDULE_LENGTH - 1U)) + 1U;
+        GTTCAN_process_frame(&ttcan, (index * 2000U) + ((uint32_t)i & 7U), GTTCAN_CAN_ID(index, index + 1U), i);
+    }
+    return (uint64_t)ttcan.error_offset + trace.written;
+}
+#endif
+
+static uint64_t bench_process_frame_whiteboard(uint64_t iterations)
+{
+    set_up(false);
+    GTTCAN_whiteboard_init(&whiteboard);
+    GTTCAN_set_whiteboard(&ttcan, &whiteboard);
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        const uint32_t index = ((uint32_t)i % (SCHEDULE_LENGTH - 1U)) + 1U;
+        GTTCAN_process_frame(&ttcan, (index * 2000U) + ((uint32_t)i & 7U), GTTCAN_CAN_ID(index, index), i);
+    }
+    return (uint64_t)ttcan.error_offset;
+}
+
+static uint64_t bench_whiteboard_read(uint64_t iterations)
+{
+    gttcan_whiteboard_value_t value;
+    uint64_t sum = 0U;
+    GTTCAN_whiteboard_init(&whiteboard);
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        (void)GTTCAN_whiteboard_read(&whiteboard, (uint16_t)(i % GTTCAN_WHITEBOARD_SIZE), &value);
+        sum += value.value + value.generation;
+    }
+    return sum;
+}
+
+static uint64_t bench_process_reference_frame(uint64_t iterations, bool exact_offset)
+{
+    set_up(exact_offset);
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        GTTCAN_process_frame(&ttcan, (uint32_t)i & 7U, GTTCAN_CAN_ID(0U, 0U), 0x8000000000000000ULL | (i * 1000U));
+    }
+    return (uint64_t)ttcan.error_offset;
+}
+
+static uint64_t bench_process_reference_frame_default(uint64_t iterations)
+{
+    return bench_process_reference_frame(iterations, false);
+}
+
+static uint64_t bench_process_reference_frame_exact(uint64_t iterations)
+{
+    return bench_process_reference_frame(iterations, true);
+}
+
+static uint64_t bench_process_reference_frame_exact_fd(uint64_t iterations)
+{
+    set_up(true);
+    GTTCAN_fd_init(&fd, ignore_fd_transmit, read_buffer, ignore_fd_write, 2U);
+    GTTCAN_set_fd(&ttcan, &fd);
+    uint8_t payload[8];
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        GTTCAN_fd_write_u64(payload, 0x8000000000000000ULL | (i * 1000U));
+        GTTCAN_process_fd_frame(&ttcan, (uint32_t)i & 7U, GTTCAN_CAN_ID(0U, 0U), payload, sizeof(payload));
+    }
+    return (uint64_t)ttcan.error_offset;
+}
+
+static uint64_t bench_transmit_next_frame(uint64_t iterations)
+{
+    set_up(false);
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        GTTCAN_transmit_next_frame(&ttcan);
+    }
+    return ttcan.localScheduleIndex;
+}
+
+static uint64_t bench_transmit_next_frame_whiteboard(uint64_t iterations)
+{
+    set_up(false);
+    GTTCAN_whiteboard_init(&whiteboard);
+    GTTCAN_set_whiteboard(&ttcan, &whiteboard);
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        GTTCAN_transmit_next_frame(&ttcan);
+    }
+    return ttcan.localScheduleIndex;
+}
+
+static uint64_t bench_accumulate_error(uint64_t iterations)
+{
+    set_up(false);
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        if (ttcan.slots_accumulated == UINT16_MAX)
+        {
+            (void)GTTCAN_fta(&ttcan);
+        }
+        GTTCAN_accumulate_error(&ttcan, (int32_t)(i & 15U) - 8);
+    }
+    return (uint64_t)ttcan.error_accumulator;
+}
+
+/// One call is a full round: 16 accumulated errors and the FTA.
+static uint64_t bench_fta_round(uint64_t iterations)
+{
+    int64_t sum = 0;
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        for (int32_t e = 0; e < 16; e++)
+        {
+            GTTCAN_accumulate_error(&ttcan, ((e * 7) & 15) - 8 + (int32_t)(i & 3U));
+        }
+        sum += GTTCAN_fta(&ttcan);
+    }
+    return (uint64_t)sum;
+}
+
+static uint64_t bench_fta(uint64_t iterations)
+{
+    set_up(false);
+    return bench_fta_round(iterations);
+}
+
+static uint64_t bench_fta_windowed(uint64_t iterations)
+{
+    set_up(false);
+    (void)GTTCAN_set_fta(&ttcan, (uint8_t)GTTCAN_FTA_MAX_OUTLIERS, (uint8_t)GTTCAN_FTA_MAX_WINDOW);
+    return bench_fta_round(iterations);
+}
+
+#if GTTCAN_BENCH_CPP
+// gttcan::Node with the same schedule and frames, see node.cpp.
+uint64_t bench_node_process_frame(uint64_t iterations);
+uint64_t bench_node_process_reference_frame(uint64_t iterations);
+uint64_t bench_node_transmit_next_frame(uint64_t iterations);
+uint64_t bench_node_transmit_whiteboard(uint64_t iterations);
+#endif
+
+static const benchmark_t benchmarks[] = {
+    { "crc15", bench_crc15, 2000000U },
+    { "crc15_bitwise", bench_crc15_bitwise, 500000U },
+    { "crc15_batch", bench_crc15_batch, 2000000U },
+    { "calculate_stuffing_bits", bench_calculate_stuffing_bits, 2000000U },
+    { "count_bitstream_stuffing_bits", bench_count_bitstream_stuffing_bits, 2000000U },
+    { "calculate_can_frame_bits", bench_calculate_can_frame_bits, 2000000U },
+    { "calculate_extended_frame_bits", bench_calculate_extended_frame_bits, 1000000U },
+    { "calculate_fd_frame_bits", bench_calculate_fd_frame_bits, 100000U },
+    { "process_frame", bench_process_frame, 2000000U },
+    { "process_frames", bench_process_frames, 2000000U },
+#if GTTCAN_EMBEDDED_SCHEDULE
+    { "process_frame_1024_embedded", bench_process_frame_1024_embedded, 2000000U },
+#endif
+    { "process_frame_1024_shared", bench_process_frame_1024_shared, 2000000U },
+    { "process_frame_stats", bench_process_frame_stats, 2000000U },
+#if GTTCAN_TRACE
+    { "process_frame_trace", bench_process_frame_trace, 2000000U },
+#endif
+    { "process_frame_whiteboard", bench_process_frame_whiteboard, 2000000U },
+    { "whiteboard_read", bench_whiteboard_read, 5000000U },
+    { "process_reference_frame", bench_process_reference_frame_default, 2000000U },
+    { "process_reference_frame_exact", bench_process_reference_frame_exact, 1000000U },
+    { "process_reference_frame_exact_fd", bench_process_reference_frame_exact_fd, 1000000U },
+    { "transmit_next_frame", bench_transmit_next_frame, 2000000U },
+    { "transmit_next_frame_whiteboard", bench_transmit_next_frame_whiteboard, 2000000U },
+#if GTTCAN_BENCH_CPP
+    { "node_process_frame", bench_node_process_frame, 2000000U },
+    { "node_process_reference_frame", bench_node_process_reference_frame, 2000000U },
+    { "node_transmit_next_frame", bench_node_transmit_next_frame, 2000000U },
+    { "node_transmit_whiteboard", bench_node_transmit_whiteboard, 2000000U },
+#endif
+    { "accumulate_error", bench_accumulate_error, 5000000U },
+    { "fta", bench_fta, 200000U },
+    { "fta_windowed", bench_fta_windowed, 200000U },
+};
+
+static double now_ns(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (1e9 * (double)now.tv_sec) + (double)now.tv_nsec;
+}
+
+static uint64_t ticks(void)
+{
+#if GTTCAN_BENCH_TSC
+    return __rdtsc();
+#else
+    return 0U;
+#endif
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static result_t measure(const benchmark_t *benchmark, uint64_t iterations, unsigned repetitions)
+{
+    double times[MAX_REPETITIONS];
+    double tick_counts[MAX_REPETITIONS];
+    sink += benchmark->run(iterations); // warm-up
+    for (unsigned r = 0U; r < repetitions; r++)
+    {
+        const uint64_t start_ticks = ticks();
+        const double start = now_ns();
+        sink += benchmark->run(iterations);
+        times[r] = (now_ns() - start) / (double)iterations;
+        tick_counts[r] = (double)(ticks() - start_ticks) / (double)iterations;
+    }
+    qsort(times, repetitions, sizeof(times[0]), compare_doubles);
+    qsort(tick_counts, repetitions, sizeof(tick_counts[0]), compare_doubles);
+    const result_t result = { times[repetitions / 2U], times[0], tick_counts[repetitions / 2U] };
+    return result;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] [BENCHMARK...]\n"
+            "  --json             print JSON instead of a table\n"
+            "  --quick            run 1/100 of the calls (smoke test)\n"
+            "  --repetitions N    timed repetitions per benchmark (default 7)\n"
+            "  --list             list the benchmarks\n",
+            name);
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t count = sizeof(benchmarks) / sizeof(benchmarks[0]);
+    bool selected[sizeof(benchmarks) / sizeof(benchmarks[0])] = { false };
+    bool any_selected = false;
+    bool json = false;
+    uint64_t divisor = 1U;
+    unsigned repetitions = 7U;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0)
+        {
+            json = true;
+        }
+        else if (strcmp(argv[i], "--quick") == 0)
+        {
+            divisor = 100U;
+        }
+        else if ((strcmp(argv[i], "--repetitions") == 0) && ((i + 1) < argc))
+        {
+            repetitions = (unsigned)strtoul(argv[++i], NULL, 0);
+            if ((repetitions == 0U) || (repetitions > MAX_REPETITIONS))
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--list") == 0)
+        {
+            for (size_t b = 0U; b < count; b++)
+            {
+                printf("%s\n", benchmarks[b].name);
+            }
+            return 0;
+        }
+        else if (argv[i][0] == '-')
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        else
+        {
+            size_t b = 0U;
+            while ((b < count) && (strcmp(benchmarks[b].name, argv[i]) != 0))
+            {
+                b++;
+            }
+            if (b == count)
+            {
+                fprintf(stderr, "%s: unknown benchmark %s\n", argv[0], argv[i]);
+                return 1;
+            }
+            selected[b] = true;
+            any_selected = true;
+        }
+    }
+
+    if (json)
+    {
+        printf("{\"compiler\":\"%s\",\"build\":\"%s\",\"crc15_slices\":%d,\"transmit_tables\":%d,"
+               "\"repetitions\":%u,\"benchmarks\":[",
+#ifdef __VERSION__
+               __VERSION__,
+#else
+               "",
+#endif
+               GTTCAN_BENCH_BUILD, (int)GTTCAN_CRC15_SLICES, (int)GTTCAN_TRANSMIT_TABLES, repetitions);
+    }
+    else
+    {
+        printf("%-32s %12s %12s %12s\n", "benchmark", "ns/call", "min ns/call", GTTCAN_BENCH_TSC ? "tsc/call" : "");
+    }
+    const char *separator = "";
+    for (size_t b = 0U; b < count; b++)
+    {
+        if (any_selected && !selected[b])
+        {
+            continue;
+        }
+        const uint64_t iterations = benchmarks[b].iterations / divisor;
+        const result_t result = measure(&benchmarks[b], iterations, repetitions);
+        if (json)
+        {
+            printf("%s{\"name\":\"%s\",\"iterations\":%llu,\"ns_per_call\":%.3f,\"min_ns_per_call\":%.3f",
+                   separator, benchmarks[b].name, (unsigned long long)iterations, result.median_ns, result.min_ns);
+            if (GTTCAN_BENCH_TSC)
+            {
+                printf(",\"tsc_per_call\":%.2f", result.median_ticks);
+            }
+            printf("}");
+            separator = ",";
+        }
+        else if (GTTCAN_BENCH_TSC)
+        {
+            printf("%-32s %12.2f %12.2f %12.1f\n", benchmarks[b].name, result.median_ns, result.min_ns, result.median_ticks);
+        }
+        else
+        {
+            printf("%-32s %12.2f %12.2f\n", benchmarks[b].name, result.median_ns, result.min_ns);
+        }
+    }
+    if (json)
+    {
+        printf("]}\n");
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file node.cpp
+ * @brief Micro-benchmarks of gttcan::Node (gttcan.hpp).
+ *
+ * The same 64-slot schedule and frames as the gttcan_t benchmarks in
+ * main.c, with the driver and store inlined into the node.
+ */
+#include "gttcan.hpp"
+
+extern "C" {
+uint64_t bench_node_process_frame(uint64_t iterations);
+uint64_t bench_node_process_reference_frame(uint64_t iterations);
+uint64_t bench_node_transmit_next_frame(uint64_t iterations);
+uint64_t bench_node_transmit_whiteboard(uint64_t iterations);
+}
+
+namespace {
+
+constexpr std::size_t schedule_length = 64U;
+
+/// Every fourth slot of node 2, slot 0 is a reference frame of node 1 (see set_up() in main.c).
+constexpr std::array<uint32_t, schedule_length> bench_entries()
+{
+    std::array<uint32_t, schedule_length> entries {};
+    for (uint32_t g = 0U; g < schedule_length; g++)
+    {
+        entries[g] = (g == 0U) ? (1UL << 16U) : (((((g % 4U) == 1U) ? 2UL : 3UL) << 16U) | (g + 1U));
+    }
+    return entries;
+}
+
+struct BenchSchedule {
+    static constexpr uint8_t node = 2U;
+    static constexpr uint32_t slotduration = 2000U;
+    static constexpr std::array<uint32_t, schedule_length> entries = bench_entries();
+};
+
+volatile uint64_t sink;
+
+/// Accumulates into a volatile sink like the callbacks in main.c, so that no call is optimised away.
+struct SinkDriver {
+    void transmit(uint32_t id, uint64_t data) { sink += id ^ data; }
+    void set_timer(uint32_t delay) { sink += delay; }
+    uint64_t read(uint16_t dataID) { return 0x0123456789ABCDEFULL ^ dataID; }
+    void write(uint16_t dataID, uint64_t value, uint32_t timestamp) { (void)timestamp; sink += dataID ^ value; }
+};
+
+using BenchNode = gttcan::Node<BenchSchedule, SinkDriver, SinkDriver>;
+
+/// Activate the node as if it had seen a start of schedule and transmitted (see set_up() in main.c).
+void set_up(BenchNode &node)
+{
+    node.process_frame(0U, GTTCAN_CAN_ID(0U, 0U), gttcan::start_of_schedule_flag);
+    node.transmit_next_frame();
+}
+
+} // namespace
+
+uint64_t bench_node_process_frame(uint64_t iterations)
+{
+    SinkDriver driver;
+    BenchNode node(driver, driver);
+    set_up(node);
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        const uint32_t index = ((uint32_t)i % (schedule_length - 1U)) + 1U;
+        node.process_frame((index * 2000U) + ((uint32_t)i & 7U), GTTCAN_CAN_ID(index, index + 1U), i);
+    }
+    return sink;
+}
+
+uint64_t bench_node_process_reference_frame(uint64_t iterations)
+{
+    SinkDriver driver;
+    BenchNode node(driver, driver);
+    set_up(node);
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        node.process_frame((uint32_t)i & 7U, GTTCAN_CAN_ID(0U, 0U), gttcan::start_of_schedule_flag | (i * 1000U));
+    }
+    return sink;
+}
+
+uint64_t bench_node_transmit_next_frame(uint64_t iterations)
+{
+    SinkDriver driver;
+    BenchNode node(driver, driver);
+    set_up(node);
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        node.transmit_next_frame();
+    }
+    return sink;
+}
+
+uint64_t bench_node_transmit_whiteboard(uint64_t iterations)
+{
+    static gttcan_whiteboard_t whiteboard;
+    GTTCAN_whiteboard_init(&whiteboard);
+    SinkDriver driver;
+    gttcan::WhiteboardStore store(whiteboard);
+    gttcan::Node<BenchSchedule, SinkDriver, gttcan::WhiteboardStore> node(driver, store);
+    node.process_frame(0U, GTTCAN_CAN_ID(0U, 0U), gttcan::start_of_schedule_flag);
+    for (uint64_t i = 0U; i < iterations; i++)
+    {
+        node.transmit_next_frame();
+    }
+    return sink;
+}
@@ -0,0 +1,309 @@
+/**
+ * @file gttcan.hpp
+ * @brief Header-only C++ front end with compile-time schedules.
+ *
+ * gttcan::Node implements the protocol of gttcan_t for a global
+ * schedule, node ID and slot duration that are known at compile time.
+ * The local schedule and the per-index transmit tables are computed by
+ * the compiler into constant arrays (flash on microcontrollers), and
+ * the driver and whiteboard are template parameters whose member
+ * functions are called directly, so the receive and transmit paths
+ * make no indirect calls and have no loops over the schedule.
+ *
+ * A node is wire compatible with gttcan_t nodes in their default
+ * configuration: for the same frames, it sends the same frames and
+ * arms the same timer delays as GTTCAN_process_frame() and
+ * GTTCAN_transmit_next_frame() without clock servo, fast join,
+ * sporadic messages, schedule staging or CAN FD.  The driver contract
+ * (`current_time`, timer delays) is that of gttcan.h.
+ *
+ * The schedule is a type with the members
+ *
+ *     static constexpr uint8_t node = 2;             // local node ID
+ *     static constexpr uint32_t slotduration = 2000; // in NTU
+ *     static constexpr std::array<uint32_t, N> entries = { ... }; // (node << 16) | data ID, see GTTCAN_pack_schedule()
+ *
+ * The driver provides `void transmit(uint32_t id, uint64_t data)` and
+ * `void set_timer(uint32_t delay)`, the store `uint64_t read(uint16_t dataID)`
+ * and `void write(uint16_t dataID, uint64_t value, uint32_t timestamp)`
+ * (see gttcan::WhiteboardStore).
+ */
+#ifndef GTTCAN_HPP
+#define GTTCAN_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "gttcan.h"
+#include "gttcan_whiteboard.h"
+
+namespace gttcan {
+
+/// Bit 63 of a reference frame: start of schedule.
+constexpr uint64_t start_of_schedule_flag = 0x8000000000000000ULL;
+/// The network time bits of a reference frame.
+constexpr uint64_t network_time_mask = 0x3FFFFFFFFFFFFFFFULL;
+
+/**
+ * @brief The local schedule and transmit tables of a schedule, computed at compile time.
+ *
+ * The tables match those of GTTCAN_load_schedule() with #GTTCAN_TRANSMIT_TABLES.
+ */
+template <typename Schedule>
+struct Tables {
+    /// Length of the global schedule.
+    static constexpr std::size_t length = Schedule::entries.size();
+
+    static_assert((length > 0U) && (length <= (std::size_t)GTTCAN_MAX_SLOTS), "the global schedule must have 1 - GTTCAN_MAX_SLOTS slots");
+    static_assert(Schedule::slotduration > 0U, "the slot duration must not be 0");
+
+    /// Return the node ID of a schedule entry.
+    static constexpr uint8_t node_of(uint32_t entry) { return (uint8_t)((entry >> 16U) & 0xFFU); }
+
+    /// Return the number of slots of the local node.
+    static constexpr std::size_t count_local()
+    {
+        std::size_t count = 0U;
+        for (std::size_t i = 0U; i < length; i++)
+        {
+            count += (node_of(Schedule::entries[i]) == Schedule::node) ? 1U : 0U;
+        }
+        return count;
+    }
+
+    /// Return true if all data IDs fit into the CAN identifier.
+    static constexpr bool valid_data_ids()
+    {
+        bool valid = true;
+        for (std::size_t i = 0U; i < length; i++)
+        {
+            valid = valid && ((Schedule::entries[i] & 0xFFFFU) <= GTTCAN_DATAID_MASK);
+        }
+        return valid;
+    }
+
+    /// Length of the local schedule.
+    static constexpr std::size_t local_length = count_local();
+
+    static_assert(valid_data_ids(), "data IDs must not exceed GTTCAN_DATAID_MASK");
+    static_assert(local_length <= 255U, "the local schedule must have at most 255 slots");
+
+    /// One local slot.
+    struct Slot {
+        uint32_t id;      // CAN identifier of the frame
+        uint16_t index;   // global schedule index
+        uint16_t dataID;  // data ID
+    };
+
+    /// Per global index: the next local slot and the timer delay to it.
+    struct Next {
+        uint32_t delay; // slots to the next local slot (strictly after the index) times the slot duration
+        uint8_t local;  // local schedule index of the next local slot
+    };
+
+    static constexpr std::array<Slot, (local_length > 0U) ? local_length : 1U> build_local()
+    {
+        std::array<Slot, (local_length > 0U) ? local_length : 1U> slots {};
+        std::size_t count = 0U;
+        for (std::size_t i = 0U; i < length; i++)
+        {
+            if (node_of(Schedule::entries[i]) == Schedule::node)
+            {
+                const uint16_t dataID = (uint16_t)(Schedule::entries[i] & 0xFFFFU);
+                slots[count] = Slot { GTTCAN_CAN_ID(i, dataID), (uint16_t)i, dataID };
+                count++;
+            }
+        }
+        return slots;
+    }
+
+    /// The local schedule, in the order of the global schedule.
+    static constexpr auto local = build_local();
+
+    static constexpr std::array<Next, length> build_next()
+    {
+        std::array<Next, length> next {};
+        for (std::size_t index = 0U; index < length; index++)
+        {
+            std::size_t following = 0U;
+            while ((following < local_length) && (local[following].index <= index))
+            {
+                following++;
+            }
+            uint32_t slots = 0U;
+            if (local_length == 0U) // never transmitting: wake up at the start of the next round
+            {
+                slots = (uint32_t)(length - index);
+            }
+            else
+            {
+                slots = (following < local_length) ? (uint32_t)(local[following].index - index) :
+                    (uint32_t)((local[0].index + length) - index); // first slot of the next round
+            }
+            next[index] = Next { slots * Schedule::slotduration, (uint8_t)((following < local_length) ? following : 0U) };
+        }
+        return next;
+    }
+
+    /// Per global index: the next local slot and the timer delay to it.
+    static constexpr auto next = build_next();
+};
+
+/**
+ * @brief A GTTCAN node with a compile-time schedule.
+ *
+ * @tparam Schedule The schedule, see gttcan.hpp.
+ * @tparam Driver Provides `transmit(id, data)` and `set_timer(delay)`.
+ * @tparam Store Provides `read(dataID)` and `write(dataID, value, timestamp)`.
+ * @tparam ReferenceOffset NTU added to received network times, see GTTCAN_reference_frame_offset().
+ */
+template <typename Schedule, typename Driver, typename Store, uint32_t ReferenceOffset = GTTCAN_DEFAULT_SLOT_OFFSET>
+class Node {
+public:
+    using tables = Tables<Schedule>;
+
+    /**
+     * @brief Create an inactive node.
+     *
+     * @param driver The driver, called from process_frame() and transmit_next_frame().
+     * @param store The whiteboard.
+     */
+    Node(Driver &driver, Store &store) : driver_(driver), store_(store) {}
+
+    /**
+     * @brief Process a received CAN frame, see GTTCAN_process_frame().
+     *
+     * @param current_time The local time since the last transmission.
+     * @param can_frame_id_field The ID field of the received CAN frame.
+     * @param received_data The data of the received CAN frame.
+     */
+    void process_frame(uint32_t current_time, uint32_t can_frame_id_field, uint64_t received_data)
+    {
+        const uint16_t index = GTTCAN_CAN_ID_INDEX(can_frame_id_field);
+        const uint16_t dataID = GTTCAN_CAN_ID_DATAID(can_frame_id_field);
+        if (index >= tables::length)
+        {
+            return; // not in the schedule
+        }
+        const typename tables::Next &next = tables::next[index];
+        local_index_ = next.local;
+        if (transmitted_)
+        {
+            slots_accumulated_++;
+        }
+        bool rearm = false;
+        if (dataID == (uint16_t)NETWORK_TIME_SLOT)
+        {
+            if ((received_data & start_of_schedule_flag) != 0U)
+            {
+                // A schedule switch cannot be followed by a compile-time schedule.
+                stale_ = stale_ || ((received_data & GTTCAN_SCHEDULE_SWITCH_FLAG) != 0U);
+                active_ = !stale_;
+            }
+            store_.write(dataID, (received_data & network_time_mask) + ReferenceOffset, current_time);
+            slots_accumulated_ = 0U;
+            rearm = true;
+        }
+        else
+        {
+            store_.write(dataID, received_data, current_time);
+            if (slots_accumulated_ >= tables::length) // a round without a reference frame
+            {
+                slots_accumulated_ = 0U;
+                rearm = true;
+            }
+        }
+        if (rearm)
+        {
+            driver_.set_timer(next.delay);
+        }
+    }
+
+    /**
+     * @brief Transmit the next frame of the local schedule, see GTTCAN_transmit_next_frame().
+     */
+    void transmit_next_frame()
+    {
+        if (!active_ || (tables::local_length == 0U))
+        {
+            return;
+        }
+        const typename tables::Slot &slot = tables::local[local_index_];
+        transmitted_ = true;
+        uint64_t data = store_.read(slot.dataID);
+        if (slot.dataID == (uint16_t)NETWORK_TIME_SLOT) // this is a reference frame
+        {
+            slots_accumulated_ = 0U;
+        }
+        if (slot.index == 0U) // start of schedule
+        {
+            data = (data | start_of_schedule_flag) & ~GTTCAN_SCHEDULE_SWITCH_FLAG;
+        }
+        local_index_ = (uint8_t)((local_index_ + 1U == tables::local_length) ? 0U : local_index_ + 1U);
+        driver_.set_timer(tables::next[slot.index].delay);
+        driver_.transmit(slot.id, data);
+    }
+
+    /**
+     * @brief Start the schedule on the time master, see GTTCAN_start().
+     */
+    void start()
+    {
+        local_index_ = 0U;
+        active_ = true;
+        transmit_next_frame();
+    }
+
+    /**
+     * @brief Deactivate the node until the next start-of-schedule frame,
+     *        like GTTCAN_load_schedule() does.
+     */
+    void reset()
+    {
+        local_index_ = 0U;
+        slots_accumulated_ = 0U;
+        active_ = false;
+        transmitted_ = false;
+        stale_ = false;
+    }
+
+    /// Whether the node transmits in its slots.
+    bool active() const { return active_; }
+
+    /// Whether the node has transmitted since it was reset.
+    bool transmitted() const { return transmitted_; }
+
+private:
+    Driver &driver_;
+    Store &store_;
+    uint16_t slots_accumulated_ = 0U; // frames received since the last reference frame, once transmitted
+    uint8_t local_index_ = 0U;        // local schedule index of the next transmission
+    bool active_ = false;
+    bool transmitted_ = false;
+    bool stale_ = false;              // missed a schedule switch, stays inactive until reset()
+};
+
+/**
+ * @brief A store backed by the built-in whiteboard (see gttcan_whiteboard.h).
+ */
+class WhiteboardStore {
+public:
+    /**
+     * @param whiteboard The whiteboard (initialised with GTTCAN_whiteboard_init()).
+     */
+    explicit WhiteboardStore(gttcan_whiteboard_t &whiteboard) : whiteboard_(whiteboard) {}
+
+    uint64_t read(uint16_t dataID) const { return GTTCAN_whiteboard_value(&whiteboard_, dataID); }
+
+    void write(uint16_t dataID, uint64_t value, uint32_t timestamp)
+    {
+        (void)GTTCAN_whiteboard_write(&whiteboard_, dataID, value, timestamp);
+    }
+
+private:
+    gttcan_whiteboard_t &whiteboard_;
+};
+
+} // namespace gttcan
+
+#endif // GTTCAN_HPP
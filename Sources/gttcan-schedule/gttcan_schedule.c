@@ -0,0 +1,481 @@
+/**
+ * @file gttcan_schedule.c
+ * @brief Offline compiler from a periodic message set to a global schedule.
+ *
+ * Each message is sent at a constant spacing that divides the global
+ * schedule length, so that it recurs at the same indices in every
+ * round.  For a candidate length N, a message with a period of p slots
+ * gets the largest divisor of N not above p as its spacing (N itself
+ * if it is sent once a round).  Starting from the shortest length that
+ * could hold every message, the compiler tries increasing lengths until
+ * the messages, taken in order of increasing spacing, can be placed
+ * first-fit.  For a power of two, the spacings are harmonic and
+ * first-fit succeeds whenever the slots suffice, so the search always
+ * ends if the message set fits at all.
+ *
+ * The slot duration is the longest frame duration, so CAN FD frames
+ * with a bit rate switch get shorter slots than their bits suggest.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gttcan_schedule.h"
+#include "slot_defs.h"
+
+/**
+ * @brief Largest number of divisors of a schedule length (at most 65535).
+ */
+#define GTTCAN_SCHEDULE_MAX_DIVISORS 256U
+
+/**
+ * @brief Working state of one compilation.
+ */
+typedef struct gttcan_schedule_packer_s {
+    const gttcan_schedule_message_t *messages;
+    uint32_t count;
+    uint32_t *periods;  // period of each message in slots
+    uint64_t *order;    // messages by increasing period, see GTTCAN_schedule_compare_keys()
+    uint32_t *spacings; // spacing of each message for the current length
+    uint8_t *occupied;  // slots taken for the current length
+    uint32_t divisors[GTTCAN_SCHEDULE_MAX_DIVISORS];
+    uint32_t divisor_count;
+} gttcan_schedule_packer_t;
+
+/**
+ * @brief Fill in the default compiler parameters.
+ *
+ * Classic CAN at 1 Mbit/s, 100 ns NTU, no guard time, derived slot
+ * duration, up to #GTTCAN_SCHEDULE_MAX_SLOTS slots, node 1 as the time master.
+ *
+ * @param config The configuration to initialise.
+ */
+void GTTCAN_schedule_default_config(gttcan_schedule_config_t *config)
+{
+    config->bitrate = 1000000U;
+    config->data_bitrate = 0U;
+    config->ntu = 100.0;
+    config->guard = 0U;
+    config->slotduration = 0U;
+    config->max_slots = GTTCAN_SCHEDULE_MAX_SLOTS;
+    config->master = 1U;
+    config->fd = false;
+}
+
+/**
+ * @brief Return the worst-case bits of a frame.
+ *
+ * Classic CAN frames (see GTTCAN_calculate_extended_frame_max_bits())
+ * are counted as nominal bits, CAN FD frames are split between the
+ * bit rates (see GTTCAN_calculate_fd_frame_max_bits()).
+ *
+ * @param config The compiler parameters.
+ * @param id The 29-bit identifier of the frame.
+ * @param length The number of payload bytes.
+ * @param bits Receives the bits at each bit rate.
+ * @return The number of bits, without interframe space.
+ */
+uint32_t GTTCAN_schedule_frame_max_bits(const gttcan_schedule_config_t *config, uint32_t id, uint8_t length,
+                                        gttcan_fd_frame_bits_t *bits)
+{
+    if (config->fd)
+    {
+        return GTTCAN_calculate_fd_frame_max_bits(id, length, config->data_bitrate != 0U, bits);
+    }
+    memset(bits, 0, sizeof(*bits));
+    bits->nominal_bits = GTTCAN_calculate_extended_frame_max_bits(id, length);
+    return bits->nominal_bits;
+}
+
+/**
+ * @brief Return the duration of a frame in us.
+ *
+ * @param config The compiler parameters.
+ * @param bits The bits of the frame at each bit rate.
+ * @return The duration, without interframe space.
+ */
+double GTTCAN_schedule_frame_us(const gttcan_schedule_config_t *config, const gttcan_fd_frame_bits_t *bits)
+{
+    const double nominal_us = ((double)bits->nominal_bits * 1e6) / (double)config->bitrate;
+    const double data_us = (bits->data_bits != 0U) ? (((double)bits->data_bits * 1e6) / (double)config->data_bitrate) : 0.0;
+    return nominal_us + data_us;
+}
+
+/**
+ * @brief Return the time a frame occupies on the bus in NTU, rounded up.
+ *
+ * @param config The compiler parameters.
+ * @param frame_us The frame duration in us, without interframe space
+ *                 (which is added at the nominal bit rate).
+ */
+uint32_t GTTCAN_schedule_us_to_ntu(const gttcan_schedule_config_t *config, double frame_us)
+{
+    const double interframe_us = ((double)GTTCAN_SCHEDULE_INTERFRAME_BITS * 1e6) / (double)config->bitrate;
+    const double ntu = ((frame_us + interframe_us) * 1e3) / config->ntu;
+    return (uint32_t)ceil(ntu - 1e-9);
+}
+
+/**
+ * @brief Order sort keys (period in the upper, message in the lower half).
+ */
+static int GTTCAN_schedule_compare_keys(const void *a, const void *b)
+{
+    const uint64_t left = *(const uint64_t *)a;
+    const uint64_t right = *(const uint64_t *)b;
+    return (left < right) ? -1 : ((left > right) ? 1 : 0);
+}
+
+/**
+ * @brief Enumerate the divisors of a schedule length in increasing order.
+ */
+static void GTTCAN_schedule_divisors(gttcan_schedule_packer_t *packer, uint32_t length)
+{
+    uint32_t small = 0U;
+    uint32_t large[GTTCAN_SCHEDULE_MAX_DIVISORS];
+    uint32_t large_count = 0U;
+    for (uint32_t d = 1U; (d * d) <= length; d++)
+    {
+        if ((length % d) == 0U)
+        {
+            packer->divisors[small++] = d;
+            if ((d * d) != length)
+            {
+                large[large_count++] = length / d;
+            }
+        }
+    }
+    for (uint32_t i = 0U; i < large_count; i++)
+    {
+        packer->divisors[small + i] = large[large_count - 1U - i];
+    }
+    packer->divisor_count = small + large_count;
+}
+
+/**
+ * @brief Return the largest divisor of the current length that is not above a period.
+ */
+static uint32_t GTTCAN_schedule_spacing(const gttcan_schedule_packer_t *packer, uint32_t period)
+{
+    uint32_t low = 0U;
+    uint32_t high = packer->divisor_count;
+    while ((high - low) > 1U)
+    {
+        const uint32_t middle = (low + high) / 2U;
+        if (packer->divisors[middle] <= period)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return packer->divisors[low];
+}
+
+/**
+ * @brief Try to place all messages into a global schedule of a given length.
+ *
+ * @return true if every message found a free offset.
+ */
+static bool GTTCAN_schedule_try(gttcan_schedule_packer_t *packer, uint32_t length, gttcan_schedule_placement_t *placements)
+{
+    GTTCAN_schedule_divisors(packer, length);
+    uint64_t demand = 1U; // the reference frame
+    for (uint32_t i = 0U; (i < packer->count) && (demand <= length); i++)
+    {
+        const uint32_t message = (uint32_t)packer->order[i];
+        packer->spacings[message] = GTTCAN_schedule_spacing(packer, packer->periods[message]);
+        demand += length / packer->spacings[message];
+    }
+    if (demand > length)
+    {
+        return false;
+    }
+
+    memset(packer->occupied, 0, length);
+    packer->occupied[0] = 1U;
+    for (uint32_t i = 0U; i < packer->count; i++)
+    {
+        const uint32_t message = (uint32_t)packer->order[i];
+        const uint32_t spacing = packer->spacings[message];
+        bool placed = false;
+        for (uint32_t offset = 1U; !placed && (offset < spacing); offset++)
+        {
+            uint32_t slot = offset;
+            while ((slot < length) && (packer->occupied[slot] == 0U))
+            {
+                slot += spacing;
+            }
+            placed = (slot >= length);
+            if (placed)
+            {
+                for (slot = offset; slot < length; slot += spacing)
+                {
+                    packer->occupied[slot] = 1U;
+                }
+                placements[message].offset = offset;
+                placements[message].spacing = spacing;
+                placements[message].count = length / spacing;
+            }
+        }
+        if (!placed)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Pack the messages into the shortest global schedule for the current periods.
+ *
+ * @return The global schedule length, or 0 if the messages do not fit.
+ */
+static uint32_t GTTCAN_schedule_pack(gttcan_schedule_packer_t *packer, uint32_t max_slots, gttcan_schedule_placement_t *placements, uint32_t *candidates)
+{
+    for (uint32_t i = 0U; i < packer->count; i++)
+    {
+        packer->order[i] = ((uint64_t)packer->periods[i] << 32U) | i;
+    }
+    qsort(packer->order, packer->count, sizeof(*packer->order), GTTCAN_schedule_compare_keys);
+    for (uint32_t length = packer->count + 1U; length <= max_slots; length++)
+    {
+        (*candidates)++;
+        if (GTTCAN_schedule_try(packer, length, placements))
+        {
+            return length;
+        }
+    }
+    return 0U;
+}
+
+/**
+ * @brief Set the worst-case bits and duration of the frames of a placed message.
+ */
+static void GTTCAN_schedule_frame_time(const gttcan_schedule_config_t *config, const gttcan_schedule_message_t *message,
+                                       gttcan_schedule_placement_t *placement)
+{
+    placement->frame_bits = 0U;
+    placement->frame_us = 0.0;
+    for (uint32_t i = 0U; i < placement->count; i++)
+    {
+        const uint32_t index = placement->offset + (i * placement->spacing);
+        gttcan_fd_frame_bits_t bits;
+        const uint32_t frame_bits = GTTCAN_schedule_frame_max_bits(config, GTTCAN_CAN_ID(index, message->dataID), message->length, &bits);
+        const double frame_us = GTTCAN_schedule_frame_us(config, &bits);
+        if (frame_us > placement->frame_us)
+        {
+            placement->frame_bits = frame_bits;
+            placement->frame_us = frame_us;
+        }
+    }
+}
+
+static bool GTTCAN_schedule_validate(const gttcan_schedule_message_t *messages, uint32_t count,
+                                     const gttcan_schedule_config_t *config, char *error, uint32_t error_size)
+{
+    if ((config->bitrate == 0U) || !(config->ntu > 0.0) || (config->master == 0U) || (config->master == (uint8_t)GTTCAN_ARBITRATION_NODE) || (!config->fd && (config->data_bitrate != 0U)) ||
+        (config->max_slots < 2U) || (config->max_slots > GTTCAN_SCHEDULE_MAX_SLOTS))
+    {
+        (void)snprintf(error, error_size, "invalid bit rates, NTU, time master or schedule length limit");
+        return false;
+    }
+    if (count == 0U)
+    {
+        (void)snprintf(error, error_size, "the message set is empty");
+        return false;
+    }
+    uint8_t * const seen = calloc((size_t)GTTCAN_DATAID_MASK + 1U, 1U);
+    bool valid = (seen != NULL);
+    if (!valid)
+    {
+        (void)snprintf(error, error_size, "out of memory");
+    }
+    const uint32_t max_length = config->fd ? GTTCAN_FD_MAX_PAYLOAD : 8U;
+    for (uint32_t i = 0U; valid && (i < count); i++)
+    {
+        const gttcan_schedule_message_t * const message = &messages[i];
+        if ((message->node == 0U) || (message->node == (uint8_t)GTTCAN_ARBITRATION_NODE) || (message->length > max_length) || !(message->period > 0.0) ||
+            (message->dataID <= (uint16_t)INTERRUPT_TIMER_VALUE_SLOT) || !GTTCAN_DATAID_FITS(message->dataID))
+        {
+            (void)snprintf(error, error_size, "message %u: invalid node, data ID (2 - %u), period or payload size",
+                           i + 1U, (unsigned)GTTCAN_DATAID_MASK);
+            valid = false;
+        }
+        else if (seen[message->dataID] != 0U)
+        {
+            (void)snprintf(error, error_size, "message %u: data ID %u is produced twice", i + 1U, message->dataID);
+            valid = false;
+        }
+        else
+        {
+            seen[message->dataID] = 1U;
+        }
+    }
+    free(seen);
+    return valid;
+}
+
+/**
+ * @brief Compile a message set into a global schedule.
+ *
+ * @param messages The message set.
+ * @param count The number of messages.
+ * @param config The compiler parameters.
+ * @param schedule Receives the schedule; release it with GTTCAN_schedule_free().
+ * @param error Receives a description of the problem if compilation fails.
+ * @param error_size The size of `error` in bytes.
+ * @return false if the message set is invalid or does not fit into
+ *         `config->max_slots` slots, true otherwise.
+ */
+bool GTTCAN_schedule_compile(const gttcan_schedule_message_t *messages, uint32_t count,
+                             const gttcan_schedule_config_t *config, gttcan_schedule_t *schedule,
+                             char *error, uint32_t error_size)
+{
+    memset(schedule, 0, sizeof(*schedule));
+    if (!GTTCAN_schedule_validate(messages, count, config, error, error_size))
+    {
+        return false;
+    }
+
+    gttcan_schedule_packer_t packer;
+    packer.messages = messages;
+    packer.count = count;
+    packer.periods = malloc((size_t)count * sizeof(*packer.periods));
+    packer.order = malloc((size_t)count * sizeof(*packer.order));
+    packer.spacings = malloc((size_t)count * sizeof(*packer.spacings));
+    packer.occupied = malloc(config->max_slots);
+    schedule->placements = calloc(count, sizeof(*schedule->placements));
+    bool valid = (packer.periods != NULL) && (packer.order != NULL) && (packer.spacings != NULL) &&
+        (packer.occupied != NULL) && (schedule->placements != NULL);
+    if (!valid)
+    {
+        (void)snprintf(error, error_size, "out of memory");
+    }
+
+    // Start from the frames at index 0 and lengthen the slots until
+    // the frames at the indices they were placed at fit as well.
+    gttcan_fd_frame_bits_t bits;
+    schedule->reference_frame_bits = GTTCAN_schedule_frame_max_bits(config, GTTCAN_CAN_ID(0U, NETWORK_TIME_SLOT), 8U, &bits);
+    schedule->reference_frame_us = GTTCAN_schedule_frame_us(config, &bits);
+    uint32_t max_frame_bits = schedule->reference_frame_bits;
+    double max_frame_us = schedule->reference_frame_us;
+    for (uint32_t i = 0U; valid && (i < count); i++)
+    {
+        const uint32_t frame_bits = GTTCAN_schedule_frame_max_bits(config, GTTCAN_CAN_ID(0U, messages[i].dataID), messages[i].length, &bits);
+        const double frame_us = GTTCAN_schedule_frame_us(config, &bits);
+        if (frame_us > max_frame_us)
+        {
+            max_frame_bits = frame_bits;
+            max_frame_us = frame_us;
+        }
+    }
+    uint32_t slotduration = (config->slotduration != 0U) ? config->slotduration :
+        (GTTCAN_schedule_us_to_ntu(config, max_frame_us) + config->guard);
+    while (valid)
+    {
+        const double slot_us = ((double)slotduration * config->ntu) / 1e3;
+        for (uint32_t i = 0U; valid && (i < count); i++)
+        {
+            const double period = floor((messages[i].period / slot_us) + 1e-9);
+            packer.periods[i] = (period > (double)config->max_slots) ? config->max_slots : (uint32_t)period;
+            if (packer.periods[i] < 2U) // slot 0 holds the reference frame
+            {
+                (void)snprintf(error, error_size, "message %u: the period of %g us is shorter than two slots of %g us",
+                               i + 1U, messages[i].period, slot_us);
+                valid = false;
+            }
+        }
+        if (valid)
+        {
+            schedule->length = GTTCAN_schedule_pack(&packer, config->max_slots, schedule->placements, &schedule->candidates);
+            valid = (schedule->length != 0U);
+            if (!valid)
+            {
+                double demand = 0.0;
+                for (uint32_t i = 0U; i < count; i++)
+                {
+                    demand += 1.0 / (double)packer.periods[i];
+                }
+                (void)snprintf(error, error_size, "the message set needs at least %.1f %% of the slots of %u NTU and does not fit into %u slots",
+                               100.0 * demand, slotduration, config->max_slots);
+            }
+        }
+        if (valid)
+        {
+            max_frame_bits = schedule->reference_frame_bits;
+            max_frame_us = schedule->reference_frame_us;
+            for (uint32_t i = 0U; i < count; i++)
+            {
+                GTTCAN_schedule_frame_time(config, &messages[i], &schedule->placements[i]);
+                if (schedule->placements[i].frame_us > max_frame_us)
+                {
+                    max_frame_bits = schedule->placements[i].frame_bits;
+                    max_frame_us = schedule->placements[i].frame_us;
+                }
+            }
+            const uint32_t needed = GTTCAN_schedule_us_to_ntu(config, max_frame_us) + config->guard;
+            if (needed <= slotduration)
+            {
+                break;
+            }
+            if (config->slotduration != 0U)
+            {
+                (void)snprintf(error, error_size, "a slot of %u NTU is shorter than the longest frame (%u bits, %u NTU with guard)",
+                               slotduration, max_frame_bits, needed);
+                valid = false;
+            }
+            slotduration = needed;
+        }
+    }
+
+    if (valid)
+    {
+        schedule->entries = calloc(schedule->length, sizeof(*schedule->entries));
+        valid = (schedule->entries != NULL);
+        if (!valid)
+        {
+            (void)snprintf(error, error_size, "out of memory");
+        }
+    }
+    if (valid)
+    {
+        schedule->entries[0] = (uint32_t)config->master << 16U;
+        schedule->used_slots = 1U;
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            const gttcan_schedule_placement_t * const placement = &schedule->placements[i];
+            for (uint32_t slot = placement->offset; slot < schedule->length; slot += placement->spacing)
+            {
+                schedule->entries[slot] = ((uint32_t)messages[i].node << 16U) | messages[i].dataID;
+            }
+            schedule->used_slots += placement->count;
+        }
+        schedule->slotduration = slotduration;
+        schedule->max_frame_bits = max_frame_bits;
+        schedule->max_frame_us = max_frame_us;
+    }
+    free(packer.periods);
+    free(packer.order);
+    free(packer.spacings);
+    free(packer.occupied);
+    if (!valid)
+    {
+        GTTCAN_schedule_free(schedule);
+    }
+    return valid;
+}
+
+/**
+ * @brief Release a compiled schedule.
+ *
+ * @param schedule The schedule.
+ */
+void GTTCAN_schedule_free(gttcan_schedule_t *schedule)
+{
+    free(schedule->entries);
+    free(schedule->placements);
+    schedule->entries = NULL;
+    schedule->placements = NULL;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file gttcan_schedule.h
+ * @brief Offline compiler from a periodic message set to a global schedule.
+ *
+ * A message set lists, for each data ID, the producing node, the
+ * longest allowed interval between two transmissions and the payload
+ * size.  The compiler derives the shortest slot duration that fits
+ * the longest frame on the bus (worst-case bit stuffing included) and
+ * packs the messages into the global schedule with the fewest slots
+ * in which each message is sent at a constant spacing no longer than
+ * its period.  Slot 0 holds the start-of-schedule reference frame.
+ *
+ * For CAN FD, slots are sized by time: the arbitration phase is sent
+ * at the nominal and the data phase at the data bit rate.
+ */
+#ifndef GTTCAN_SCHEDULE_H
+#define GTTCAN_SCHEDULE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gttcan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Bits between two frames (the interframe space).
+ */
+#define GTTCAN_SCHEDULE_INTERFRAME_BITS 3U
+
+/**
+ * @brief Longest global schedule the compiler accepts as `max_slots`.
+ *
+ * One slot per schedule index value, but at most 65535, the largest
+ * length of a schedule blob (see GTTCAN_load_schedule()).
+ */
+#define GTTCAN_SCHEDULE_MAX_SLOTS ((((uint32_t)GTTCAN_INDEX_MASK + 1U) > 0xFFFFU) ? 0xFFFFU : ((uint32_t)GTTCAN_INDEX_MASK + 1U))
+
+/**
+ * @brief A periodic message.
+ */
+typedef struct gttcan_schedule_message_s {
+    uint8_t node;    // producing node ID (1 - 254, 255 marks arbitration slots)
+    uint8_t length;  // payload bytes (0 - 8, 0 - 64 for CAN FD)
+    uint16_t dataID; // data ID (2 - GTTCAN_DATAID_MASK, 0 and 1 are reserved)
+    double period;   // longest interval between two transmissions in us
+} gttcan_schedule_message_t;
+
+/**
+ * @brief Parameters of the schedule compiler.
+ */
+typedef struct gttcan_schedule_config_s {
+    uint32_t bitrate;      // CAN bit rate in bit/s (the nominal bit rate for CAN FD)
+    uint32_t data_bitrate; // CAN FD data bit rate in bit/s, 0 to send without bit rate switch
+    double ntu;            // duration of one network time unit in ns
+    uint32_t guard;        // NTU added to the longest frame, e.g. for the sync error
+    uint32_t slotduration; // slot duration in NTU, 0 to derive the shortest
+    uint32_t max_slots;    // longest global schedule (2 - GTTCAN_SCHEDULE_MAX_SLOTS)
+    uint8_t master;        // node ID of the time master, which sends the reference frame
+    bool fd;               // send CAN FD frames
+} gttcan_schedule_config_t;
+
+/**
+ * @brief Where a message was placed.
+ *
+ * The message is sent in slots `offset`, `offset + spacing`, ...
+ * of every round.
+ */
+typedef struct gttcan_schedule_placement_s {
+    uint32_t offset;     // first global schedule index
+    uint32_t spacing;    // slots between two transmissions (the global schedule length if sent once a round)
+    uint32_t count;      // transmissions per round
+    uint32_t frame_bits; // worst-case frame length in bits, without interframe space
+    double frame_us;     // worst-case frame duration in us, without interframe space
+} gttcan_schedule_placement_t;
+
+/**
+ * @brief A compiled schedule.
+ */
+typedef struct gttcan_schedule_s {
+    uint32_t *entries;                       // global schedule, see GTTCAN_pack_schedule()
+    gttcan_schedule_placement_t *placements; // one per message, in the order of the message set
+    uint32_t length;                         // global schedule length
+    uint32_t slotduration;                   // slot duration in NTU
+    uint32_t max_frame_bits;                 // bits of the longest frame, without interframe space
+    uint32_t reference_frame_bits;           // worst-case length of the reference frame in bits
+    double max_frame_us;                     // duration of the longest frame in us, without interframe space
+    double reference_frame_us;               // worst-case duration of the reference frame in us
+    uint32_t used_slots;                     // slots with a frame (the reference slot included)
+    uint32_t candidates;                     // schedule lengths that were tried
+} gttcan_schedule_t;
+
+/**
+ * @brief Fill in the default compiler parameters.
+ *
+ * Classic CAN at 1 Mbit/s, 100 ns NTU, no guard time, derived slot
+ * duration, up to #GTTCAN_SCHEDULE_MAX_SLOTS slots, node 1 as the time master.
+ *
+ * @param config The configuration to initialise.
+ */
+void GTTCAN_schedule_default_config(gttcan_schedule_config_t *config);
+
+/**
+ * @brief Return the worst-case bits of a frame.
+ *
+ * Classic CAN frames (see GTTCAN_calculate_extended_frame_max_bits())
+ * are counted as nominal bits, CAN FD frames are split between the
+ * bit rates (see GTTCAN_calculate_fd_frame_max_bits()).
+ *
+ * @param config The compiler parameters.
+ * @param id The 29-bit identifier of the frame.
+ * @param length The number of payload bytes.
+ * @param bits Receives the bits at each bit rate.
+ * @return The number of bits, without interframe space.
+ */
+uint32_t GTTCAN_schedule_frame_max_bits(const gttcan_schedule_config_t *config, uint32_t id, uint8_t length,
+                                        gttcan_fd_frame_bits_t *bits);
+
+/**
+ * @brief Return the duration of a frame in us.
+ *
+ * @param config The compiler parameters.
+ * @param bits The bits of the frame at each bit rate.
+ * @return The duration, without interframe space.
+ */
+double GTTCAN_schedule_frame_us(const gttcan_schedule_config_t *config, const gttcan_fd_frame_bits_t *bits);
+
+/**
+ * @brief Return the time a frame occupies on the bus in NTU, rounded up.
+ *
+ * @param config The compiler parameters.
+ * @param frame_us The frame duration in us, without interframe space
+ *                 (which is added at the nominal bit rate).
+ */
+uint32_t GTTCAN_schedule_us_to_ntu(const gttcan_schedule_config_t *config, double frame_us);
+
+/**
+ * @brief Compile a message set into a global schedule.
+ *
+ * @param messages The message set.
+ * @param count The number of messages.
+ * @param config The compiler parameters.
+ * @param schedule Receives the schedule; release it with GTTCAN_schedule_free().
+ * @param error Receives a description of the problem if compilation fails.
+ * @param error_size The size of `error` in bytes.
+ * @return false if the message set is invalid or does not fit into
+ *         `config->max_slots` slots, true otherwise.
+ */
+bool GTTCAN_schedule_compile(const gttcan_schedule_message_t *messages, uint32_t count,
+                             const gttcan_schedule_config_t *config, gttcan_schedule_t *schedule,
+                             char *error, uint32_t error_size);
+
+/**
+ * @brief Release a compiled schedule.
+ *
+ * @param schedule The schedule.
+ */
+void GTTCAN_schedule_free(gttcan_schedule_t *schedule);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GTTCAN_SCHEDULE_H
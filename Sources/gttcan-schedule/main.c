@@ -0,0 +1,425 @@
+/**
+ * @file main.c
+ * @brief Command line front end of the GTTCAN schedule compiler.
+ *
+ * Reads a message set, one message per line:
+ * ```
+ * # node  data-id  period-us  [payload-bytes (default 8)]
+ *   2     17       1000       8
+ * ```
+ * compiles it into a global schedule and prints a utilisation and
+ * latency report.  The schedule can be written as a C source file or
+ * as a binary blob for GTTCAN_load_schedule().
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gttcan_schedule.h"
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] MESSAGES\n"
+            "  --bitrate BPS           CAN bit rate (default 1000000)\n"
+            "  --fd                    send CAN FD frames (payloads of up to 64 bytes)\n"
+            "  --data-bitrate BPS      CAN FD data bit rate (default 0: no bit rate switch)\n"
+            "  --ntu NS                duration of a network time unit (default 100)\n"
+            "  --guard NTU             time added to the longest frame (default 0)\n"
+            "  --slot-duration NTU     use this slot duration instead of the shortest\n"
+            "  --max-slots N           longest global schedule (default %u)\n"
+            "  --master NODE           node ID of the time master (default 1)\n"
+            "  --c FILE                write the schedule as a C source file\n"
+            "  --blob FILE             write the schedule as a binary blob (see GTTCAN_load_schedule())\n"
+            "  --name NAME             name of the C array (default gttcan_schedule)\n"
+            "  --summary               print only the totals\n"
+            "  --json                  print the report as JSON (one object per line)\n"
+            "MESSAGES has one message per line: node data-id period-us [payload-bytes]\n",
+            name, (unsigned)GTTCAN_SCHEDULE_MAX_SLOTS);
+}
+
+static double elapsed(const struct timespec *start)
+{
+    struct timespec now;
+    (void)timespec_get(&now, TIME_UTC);
+    return (double)(now.tv_sec - start->tv_sec) + (1e-9 * (double)(now.tv_nsec - start->tv_nsec));
+}
+
+static bool read_messages(const char *path, gttcan_schedule_message_t **messages, uint32_t *count)
+{
+    FILE * const file = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        return false;
+    }
+    gttcan_schedule_message_t *list = NULL;
+    uint32_t length = 0U;
+    uint32_t capacity = 0U;
+    uint32_t line_number = 0U;
+    bool valid = true;
+    char line[256];
+    while (valid && (fgets(line, sizeof(line), file) != NULL))
+    {
+        line_number++;
+        char * const comment = strchr(line, '#');
+        if (comment != NULL)
+        {
+            *comment = '\0';
+        }
+        unsigned node = 0U;
+        unsigned dataID = 0U;
+        double period = 0.0;
+        unsigned payload = 8U;
+        char extra = '\0';
+        const int fields = sscanf(line, "%u %u %lf %u %c", &node, &dataID, &period, &payload, &extra);
+        if (fields <= 0)
+        {
+            continue; // empty line
+        }
+        if ((fields < 3) || (fields > 4) || (node > 0xFFU) || (dataID > 0xFFFFU) || (payload > 0xFFU))
+        {
+            fprintf(stderr, "%s:%u: expected: node data-id period-us [payload-bytes]\n", path, line_number);
+            valid = false;
+        }
+        else
+        {
+            if (length == capacity)
+            {
+                capacity = (capacity == 0U) ? 256U : (2U * capacity);
+                gttcan_schedule_message_t * const grown = realloc(list, (size_t)capacity * sizeof(*list));
+                valid = (grown != NULL);
+                list = valid ? grown : list;
+            }
+            if (valid)
+            {
+                list[length].node = (uint8_t)node;
+                list[length].dataID = (uint16_t)dataID;
+                list[length].period = period;
+                list[length].length = (uint8_t)payload;
+                length++;
+            }
+        }
+    }
+    if (file != stdin)
+    {
+        (void)fclose(file);
+    }
+    if (!valid)
+    {
+        free(list);
+        return false;
+    }
+    *messages = list;
+    *count = length;
+    return true;
+}
+
+static bool write_blob(const char *path, const gttcan_schedule_t *schedule)
+{
+    const uint32_t size = GTTCAN_SCHEDULE_SIZE(schedule->length);
+    uint8_t * const blob = malloc(size);
+    FILE * const file = fopen(path, "wb");
+    bool valid = (blob != NULL) && (file != NULL) &&
+        (GTTCAN_pack_schedule(blob, size, schedule->entries, (uint16_t)schedule->length, schedule->slotduration) == size) &&
+        (fwrite(blob, 1U, size, file) == size);
+    if (file != NULL)
+    {
+        valid = (fclose(file) == 0) && valid;
+    }
+    free(blob);
+    return valid;
+}
+
+static bool write_c(const char *path, const char *name, const gttcan_schedule_t *schedule, const gttcan_schedule_config_t *config)
+{
+    const uint32_t size = GTTCAN_SCHEDULE_SIZE(schedule->length);
+    uint8_t * const blob = malloc(size);
+    FILE * const file = fopen(path, "w");
+    bool valid = (blob != NULL) && (file != NULL) &&
+        (GTTCAN_pack_schedule(blob, size, schedule->entries, (uint16_t)schedule->length, schedule->slotduration) == size);
+    if (valid)
+    {
+        fprintf(file,
+                "// Generated by gttcan-schedule: %u slots of %u NTU (%g us) at %u bit/s.\n"
+                "// GTTCAN_init(&gttcan, node, %s_slotduration, %s_length, ...);\n"
+                "// GTTCAN_load_schedule(&gttcan, %s, sizeof(%s));\n"
+                "#include <stdint.h>\n"
+                "#include \"gttcan.h\"\n\n"
+                "const uint32_t %s_slotduration = %uU;\n"
+                "const uint16_t %s_length = %uU;\n\n"
+                "const uint8_t %s[GTTCAN_SCHEDULE_SIZE(%uU)] = {\n   ",
+                schedule->length, schedule->slotduration, ((double)schedule->slotduration * config->ntu) / 1e3,
+                config->bitrate, name, name, name, name, name, schedule->slotduration, name, schedule->length,
+                name, schedule->length);
+        for (uint32_t i = 0U; i < GTTCAN_SCHEDULE_HEADER_SIZE; i++)
+        {
+            fprintf(file, " 0x%02X,", blob[i]);
+        }
+        fprintf(file, " // header\n");
+        for (uint32_t index = 0U; index < schedule->length; index++)
+        {
+            const uint8_t * const entry = &blob[GTTCAN_SCHEDULE_HEADER_SIZE + (index * GTTCAN_SCHEDULE_ENTRY_SIZE)];
+            const uint32_t node = schedule->entries[index] >> 16U;
+            const uint32_t dataID = schedule->entries[index] & 0xFFFFU;
+            fprintf(file, "    0x%02X, 0x%02X, 0x%02X, // %u: ", entry[0], entry[1], entry[2], index);
+            if (node == 0U)
+            {
+                fprintf(file, "free\n");
+            }
+            else if (index == 0U)
+            {
+                fprintf(file, "reference, node %u\n", node);
+            }
+            else
+            {
+                fprintf(file, "node %u, data %u\n", node, dataID);
+            }
+        }
+        fprintf(file, "};\n");
+    }
+    if (file != NULL)
+    {
+        valid = (fclose(file) == 0) && valid;
+    }
+    free(blob);
+    return valid;
+}
+
+static void print_report(const gttcan_schedule_message_t *messages, uint32_t count, const gttcan_schedule_t *schedule,
+                         const gttcan_schedule_config_t *config, bool summary, bool json, double wall)
+{
+    const double slot_us = ((double)schedule->slotduration * config->ntu) / 1e3;
+    const double interframe_us = ((double)GTTCAN_SCHEDULE_INTERFRAME_BITS * 1e6) / (double)config->bitrate;
+    const double round_us = slot_us * (double)schedule->length;
+    double bus_us = schedule->reference_frame_us + interframe_us;
+    double max_latency = 0.0;
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        const gttcan_schedule_placement_t * const placement = &schedule->placements[i];
+        bus_us += (double)placement->count * (placement->frame_us + interframe_us);
+        // From a value being written until its frame has been received.
+        const double latency = ((double)placement->spacing * slot_us) + placement->frame_us;
+        max_latency = (latency > max_latency) ? latency : max_latency;
+        if (!summary)
+        {
+            if (json)
+            {
+                printf("{\"node\":%u,\"data_id\":%u,\"period\":%g,\"payload\":%u,\"offset\":%u,\"spacing\":%u,"
+                       "\"per_round\":%u,\"interval\":%g,\"latency\":%g,\"frame_bits\":%u}\n",
+                       messages[i].node, messages[i].dataID, messages[i].period, messages[i].length, placement->offset,
+                       placement->spacing, placement->count, (double)placement->spacing * slot_us, latency, placement->frame_bits);
+            }
+            else
+            {
+                if (i == 0U)
+                {
+                    printf("  %5s %6s %10s %7s %7s %7s %10s %10s %5s\n", "node", "data", "period", "payload",
+                           "offset", "spacing", "interval", "latency", "bits");
+                }
+                printf("  %5u %6u %10.1f %7u %7u %7u %10.1f %10.1f %5u\n", messages[i].node, messages[i].dataID,
+                       messages[i].period, messages[i].length, placement->offset, placement->spacing,
+                       (double)placement->spacing * slot_us, latency, placement->frame_bits);
+            }
+        }
+    }
+    const double slot_utilisation = (double)schedule->used_slots / (double)schedule->length;
+    const double bus_utilisation = bus_us / round_us;
+    if (json)
+    {
+        printf("{\"messages\":%u,\"slots\":%u,\"used_slots\":%u,\"slotduration\":%u,\"slot_us\":%g,\"round_us\":%g,"
+               "\"bitrate\":%u,\"data_bitrate\":%u,\"fd\":%s,\"ntu\":%g,\"guard\":%u,\"max_frame_bits\":%u,\"max_frame_us\":%g,"
+               "\"reference_frame_bits\":%u,"
+               "\"slot_utilisation\":%g,\"bus_utilisation\":%g,\"max_latency\":%g,\"candidates\":%u,\"wall_time\":%g}\n",
+               count, schedule->length, schedule->used_slots, schedule->slotduration, slot_us, round_us,
+               config->bitrate, config->data_bitrate, config->fd ? "true" : "false", config->ntu, config->guard,
+               schedule->max_frame_bits, schedule->max_frame_us, schedule->reference_frame_bits,
+               slot_utilisation, bus_utilisation, max_latency, schedule->candidates, wall);
+    }
+    else
+    {
+        printf("%u messages in %u slots of %u NTU (%.1f us), round %.1f us at %u bit/s",
+               count, schedule->length, schedule->slotduration, slot_us, round_us, config->bitrate);
+        if (config->fd)
+        {
+            printf(" (CAN FD, data phase at %u bit/s)", (config->data_bitrate != 0U) ? config->data_bitrate : config->bitrate);
+        }
+        printf("\n  longest frame %u bits (%.1f us) + %u interframe bits, reference frame %u bits, guard %u NTU\n",
+               schedule->max_frame_bits, schedule->max_frame_us, GTTCAN_SCHEDULE_INTERFRAME_BITS,
+               schedule->reference_frame_bits, config->guard);
+        printf("  slot utilisation %.1f %% (%u used), bus utilisation %.1f %% (worst case), max latency %.1f us\n",
+               100.0 * slot_utilisation, schedule->used_slots, 100.0 * bus_utilisation, max_latency);
+        printf("  compiled in %.3f s (%u schedule lengths tried)\n", wall, schedule->candidates);
+        if (!summary)
+        {
+            printf("  (period, interval and latency in us; interval is the spacing in time)\n");
+        }
+    }
+}
+
+/**
+ * @brief Warn about limits of the library build that the schedule exceeds.
+ */
+static void check_limits(const gttcan_schedule_t *schedule)
+{
+    if (schedule->length > (uint32_t)GTTCAN_MAX_SCHEDULE_LENGTH)
+    {
+        fprintf(stderr, "warning: %u slots need GTTCAN_MAX_SLOTS >= %u on the nodes (default %u)"
+#if GTTCAN_TRANSMIT_TABLES
+                " or GTTCAN_TRANSMIT_TABLES=0"
+#endif
+                "\n",
+                schedule->length, schedule->length, (unsigned)GTTCAN_MAX_SLOTS);
+    }
+    uint32_t owned[256] = { 0U };
+    for (uint32_t i = 0U; i < schedule->length; i++)
+    {
+        owned[(schedule->entries[i] >> 16U) & 0xFFU]++;
+    }
+    for (uint32_t node = 1U; node < 256U; node++)
+    {
+        if (owned[node] > (uint32_t)GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH)
+        {
+            fprintf(stderr, "warning: node %u owns %u slots, more than GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH (%u)\n",
+                    node, owned[node], (unsigned)GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    gttcan_schedule_config_t config;
+    GTTCAN_schedule_default_config(&config);
+    const char *path = NULL;
+    const char *c_path = NULL;
+    const char *blob_path = NULL;
+    const char *name = "gttcan_schedule";
+    bool summary = false;
+    bool json = false;
+    for (int i = 1; i < argc; i++)
+    {
+        const char * const arg = argv[i];
+        const char * const value = ((i + 1) < argc) ? argv[i + 1] : NULL;
+        if ((strcmp(arg, "--help") == 0) || (strcmp(arg, "-h") == 0))
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        else if (strcmp(arg, "--summary") == 0)
+        {
+            summary = true;
+        }
+        else if (strcmp(arg, "--fd") == 0)
+        {
+            config.fd = true;
+        }
+        else if (strcmp(arg, "--json") == 0)
+        {
+            json = true;
+        }
+        else if ((arg[0] == '-') && (arg[1] != '\0') && (value == NULL))
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        else if (strcmp(arg, "--bitrate") == 0)
+        {
+            config.bitrate = (uint32_t)strtoul(value, NULL, 10);
+            i++;
+        }
+        else if (strcmp(arg, "--data-bitrate") == 0)
+        {
+            config.data_bitrate = (uint32_t)strtoul(value, NULL, 10);
+            i++;
+        }
+        else if (strcmp(arg, "--ntu") == 0)
+        {
+            config.ntu = strtod(value, NULL);
+            i++;
+        }
+        else if (strcmp(arg, "--guard") == 0)
+        {
+            config.guard = (uint32_t)strtoul(value, NULL, 10);
+            i++;
+        }
+        else if (strcmp(arg, "--slot-duration") == 0)
+        {
+            config.slotduration = (uint32_t)strtoul(value, NULL, 10);
+            i++;
+        }
+        else if (strcmp(arg, "--max-slots") == 0)
+        {
+            config.max_slots = (uint32_t)strtoul(value, NULL, 10);
+            i++;
+        }
+        else if (strcmp(arg, "--master") == 0)
+        {
+            config.master = (uint8_t)strtoul(value, NULL, 10);
+            i++;
+        }
+        else if (strcmp(arg, "--c") == 0)
+        {
+            c_path = value;
+            i++;
+        }
+        else if (strcmp(arg, "--blob") == 0)
+        {
+            blob_path = value;
+            i++;
+        }
+        else if (strcmp(arg, "--name") == 0)
+        {
+            name = value;
+            i++;
+        }
+        else if (((arg[0] == '-') && (arg[1] != '\0')) || (path != NULL))
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        else
+        {
+            path = arg;
+        }
+    }
+    if (path == NULL)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    gttcan_schedule_message_t *messages = NULL;
+    uint32_t count = 0U;
+    if (!read_messages(path, &messages, &count))
+    {
+        return 2;
+    }
+    struct timespec start;
+    (void)timespec_get(&start, TIME_UTC);
+    gttcan_schedule_t schedule;
+    char error[256];
+    if (!GTTCAN_schedule_compile(messages, count, &config, &schedule, error, sizeof(error)))
+    {
+        fprintf(stderr, "%s: %s\n", argv[0], error);
+        free(messages);
+        return 2;
+    }
+    const double wall = elapsed(&start);
+    check_limits(&schedule);
+    print_report(messages, count, &schedule, &config, summary, json, wall);
+
+    int status = 0;
+    if ((blob_path != NULL) && !write_blob(blob_path, &schedule))
+    {
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], blob_path);
+        status = 2;
+    }
+    if ((c_path != NULL) && !write_c(c_path, name, &schedule, &config))
+    {
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], c_path);
+        status = 2;
+    }
+    GTTCAN_schedule_free(&schedule);
+    free(messages);
+    return status;
+}
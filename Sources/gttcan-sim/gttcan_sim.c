@@ -0,0 +1,840 @@
+/**
+ * @file gttcan_sim.c
+ * @brief Discrete-event simulator for a GTTCAN network on a virtual CAN bus.
+ *
+ * Time on the bus ("true" time) is kept in ns as a double.  Each node
+ * converts true time into its local time with a constant rate error
+ * (drift) and offset, and counts network time units (NTU) of its local
+ * clock.  Following the driver contract of gttcan.c, `current_time` is
+ * the local time between the start of the last local transmission
+ * (or the received start of schedule) and the start of the received
+ * frame, and timer delays are relative to the instant of the event
+ * that set them (the timer interrupt or the start of the received frame).
+ *
+ * Frames of arbitration slots are sent single-shot: a frame that loses
+ * arbitration, or finds the bus busy because another node started
+ * first, is dropped and reported with GTTCAN_transmit_result(), so
+ * that the sporadic message is retried in the next arbitration slot.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gttcan_sim.h"
+#include "slot_defs.h"
+
+/// Interframe space in bits.
+#define GTTCAN_SIM_INTERFRAME_BITS 3U
+/// Number of schedule rounds before sync errors are sampled.
+#define GTTCAN_SIM_WARMUP_ROUNDS 2U
+
+enum gttcan_sim_event_type_e {
+    GTTCAN_SIM_TIMER,     // timer interrupt of a node
+    GTTCAN_SIM_BUS_START, // the bus becomes idle, arbitration starts
+    GTTCAN_SIM_BUS_END,   // end of the frame on the bus
+    GTTCAN_SIM_SPORADIC,  // a node queues a sporadic message
+    GTTCAN_SIM_SWITCH     // all nodes stage the new schedule, the time master switches to it
+};
+
+typedef struct gttcan_sim_event_s {
+    double time;         // true time in ns
+    uint64_t sequence;   // insertion order, breaks ties deterministically
+    uint64_t generation; // timer generation (timer events only)
+    uint32_t type;
+    uint32_t node;
+} gttcan_sim_event_t;
+
+struct gttcan_sim_s;
+
+typedef struct gttcan_sim_node_s {
+    gttcan_t gttcan;
+    gttcan_node_schedule_t node_schedule;      // built once, also without GTTCAN_EMBEDDED_SCHEDULE
+    gttcan_node_schedule_t next_node_schedule; // staged at the switch time
+    gttcan_sporadic_t sporadic;
+    gttcan_staging_t staging;
+    gttcan_clock_t global_clock;
+    gttcan_filter_t filters[GTTCAN_SIM_MAX_FILTERS];
+    uint32_t filter_count;
+    struct gttcan_sim_s *sim;
+    uint32_t index;           // index into the node array
+    double rate;              // local time per true time (1 + drift)
+    double offset;            // local time at true time 0 in ns
+    double event_time;        // true time of the event being processed
+    double power_up;          // true time in ns from which the node receives frames
+    int64_t reference_ticks;  // local NTU at the last transmission or start of schedule
+    uint64_t timer_generation;
+    bool joined;              // the node has transmitted
+    bool tx_pending;
+    bool tx_single_shot;      // the pending frame is dropped if it loses arbitration
+    uint32_t tx_id;
+    uint64_t tx_data;
+    double tx_request_time;
+} gttcan_sim_node_t;
+
+typedef struct gttcan_sim_s {
+    const gttcan_sim_config_t *config;
+    gttcan_sim_stats_t *stats;
+    gttcan_sim_node_t *nodes;
+    gttcan_sim_event_t *events;
+    gttcan_sim_event_t bus_event; // the pending BUS_START or BUS_END event, kept out of the queue
+    gttcan_frame_prefix_t *prefixes; // identifier and control field of the last frame of each slot
+    size_t event_count;
+    size_t event_capacity;
+    uint64_t sequence;
+    uint64_t random_state;
+    double now;
+    double bit_ns;
+    double warmup;
+    double master_slot;       // slot duration of the time master in true ns
+    double start_of_schedule; // true time of the last start of schedule
+    bool start_of_schedule_valid;
+    bool bus_busy;
+    bool bus_event_pending;
+    bool switch_failed;       // a node could not stage the new schedule
+    double bus_idle_time;
+    double busy_time;
+    uint32_t bus_node;        // sender of the frame on the bus
+    double bus_frame_start;
+    double sync_error_sum;
+    double sync_error_squares;
+    double time_error_sum;
+    double global_error_sum;
+} gttcan_sim_t;
+
+/**
+ * @brief Return the next value of the xorshift64* generator.
+ */
+static uint64_t GTTCAN_sim_random(gttcan_sim_t *sim)
+{
+    uint64_t x = sim->random_state;
+    x ^= x >> 12U;
+    x ^= x << 25U;
+    x ^= x >> 27U;
+    sim->random_state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * @brief Return a uniformly distributed random number in [0, 1).
+ */
+static double GTTCAN_sim_uniform(gttcan_sim_t *sim)
+{
+    return (double)(GTTCAN_sim_random(sim) >> 11U) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Return the local time of a node in ns at a given true time.
+ */
+static inline double GTTCAN_sim_local_time(const gttcan_sim_node_t *node, double time)
+{
+    return (time * node->rate) + node->offset;
+}
+
+/**
+ * @brief Return the local clock of a node in NTU at a given true time.
+ *
+ * Local times are never negative, so the conversion truncates towards
+ * the earlier tick without a call to floor().
+ */
+static inline int64_t GTTCAN_sim_local_ticks(const gttcan_sim_node_t *node, double time)
+{
+    return (int64_t)(GTTCAN_sim_local_time(node, time) / node->sim->config->ntu);
+}
+
+/**
+ * @brief Return the larger of two times, which are never NaN (unlike fmax(), which is a library call).
+ */
+static inline double GTTCAN_sim_max(double a, double b)
+{
+    return (a > b) ? a : b;
+}
+
+/**
+ * @brief Return the true time at which the local clock of a node reaches a given local time.
+ */
+static inline double GTTCAN_sim_true_time(const gttcan_sim_node_t *node, double local_time)
+{
+    return (local_time - node->offset) / node->rate;
+}
+
+/**
+ * @brief Whether an event comes before another one.
+ */
+static inline bool GTTCAN_sim_before(const gttcan_sim_event_t *a, const gttcan_sim_event_t *b)
+{
+    return (a->time < b->time) || ((a->time == b->time) && (a->sequence < b->sequence));
+}
+
+/**
+ * @brief Insert an event into the event queue (a binary min-heap).
+ */
+static bool GTTCAN_sim_push(gttcan_sim_t *sim, uint32_t type, uint32_t node, double time, uint64_t generation)
+{
+    if (sim->event_count == sim->event_capacity)
+    {
+        const size_t capacity = (sim->event_capacity == 0U) ? 64U : (2U * sim->event_capacity);
+        gttcan_sim_event_t * const events = realloc(sim->events, capacity * sizeof(*events));
+        if (events == NULL)
+        {
+            return false;
+        }
+        sim->events = events;
+        sim->event_capacity = capacity;
+    }
+    const gttcan_sim_event_t event = { time, sim->sequence++, generation, type, node };
+    size_t i = sim->event_count++;
+    while (i > 0U)
+    {
+        const size_t parent = (i - 1U) / 2U;
+        const gttcan_sim_event_t * const p = &sim->events[parent];
+        if (GTTCAN_sim_before(p, &event))
+        {
+            break;
+        }
+        sim->events[i] = *p;
+        i = parent;
+    }
+    sim->events[i] = event;
+    return true;
+}
+
+/**
+ * @brief Remove the earliest event from the event queue.
+ */
+static gttcan_sim_event_t GTTCAN_sim_pop(gttcan_sim_t *sim)
+{
+    const gttcan_sim_event_t first = sim->events[0];
+    const gttcan_sim_event_t last = sim->events[--sim->event_count];
+    size_t i = 0U;
+    for (;;)
+    {
+        size_t child = (2U * i) + 1U;
+        if (child >= sim->event_count)
+        {
+            break;
+        }
+        const gttcan_sim_event_t *c = &sim->events[child];
+        if ((child + 1U) < sim->event_count)
+        {
+            const gttcan_sim_event_t * const r = &sim->events[child + 1U];
+            if (GTTCAN_sim_before(r, c))
+            {
+                child++;
+                c = r;
+            }
+        }
+        if (GTTCAN_sim_before(&last, c))
+        {
+            break;
+        }
+        sim->events[i] = *c;
+        i = child;
+    }
+    sim->events[i] = last;
+    return first;
+}
+
+/**
+ * @brief Schedule the next bus event.
+ *
+ * There is at most one bus event pending (the start of arbitration or
+ * the end of the frame on the bus), so it is kept out of the queue,
+ * which then only holds the few timer events.
+ */
+static void GTTCAN_sim_set_bus_event(gttcan_sim_t *sim, uint32_t type, uint32_t node, double time)
+{
+    const gttcan_sim_event_t event = { time, sim->sequence++, 0U, type, node };
+    sim->bus_event = event;
+    sim->bus_event_pending = true;
+}
+
+/**
+ * @brief Remove the earliest event from the bus event and the event queue.
+ *
+ * @return false if no event is pending.
+ */
+static bool GTTCAN_sim_next_event(gttcan_sim_t *sim, gttcan_sim_event_t *event)
+{
+    if (sim->bus_event_pending && ((sim->event_count == 0U) || GTTCAN_sim_before(&sim->bus_event, &sim->events[0])))
+    {
+        *event = sim->bus_event;
+        sim->bus_event_pending = false;
+        return true;
+    }
+    if (sim->event_count == 0U)
+    {
+        return false;
+    }
+    *event = GTTCAN_sim_pop(sim);
+    return true;
+}
+
+/**
+ * @brief Schedule arbitration for when the bus becomes idle.
+ */
+static void GTTCAN_sim_request_bus(gttcan_sim_t *sim)
+{
+    if (sim->bus_busy || sim->bus_event_pending)
+    {
+        return;
+    }
+    GTTCAN_sim_set_bus_event(sim, GTTCAN_SIM_BUS_START, 0U, GTTCAN_sim_max(sim->now, sim->bus_idle_time));
+}
+
+/**
+ * @brief Transmit callback: queue a frame in the CAN controller of a node.
+ */
+static void GTTCAN_sim_transmit(uint32_t id, uint64_t data, void *context)
+{
+    gttcan_sim_node_t * const node = context;
+    gttcan_sim_t * const sim = node->sim;
+    if (node->tx_pending)
+    {
+        sim->stats->slot_overruns++; // the previous frame never made it onto the bus
+    }
+    const uint32_t owner = (GTTCAN_get_schedule_entry(&node->gttcan, GTTCAN_CAN_ID_INDEX(id)) >> 16U) & 0xFFU;
+    node->tx_pending = true;
+    node->tx_single_shot = (owner == (uint32_t)GTTCAN_ARBITRATION_NODE);
+    node->tx_id = id;
+    if (node->tx_single_shot && sim->bus_busy)
+    {
+        node->tx_pending = false; // another node won the arbitration slot
+        sim->stats->sporadic_lost++;
+        GTTCAN_transmit_result(&node->gttcan, id, false, (uint32_t)GTTCAN_sim_local_ticks(node, node->event_time));
+    }
+    node->tx_data = data;
+    node->tx_request_time = node->event_time;
+    node->reference_ticks = GTTCAN_sim_local_ticks(node, node->event_time);
+    GTTCAN_set_local_reference(&node->gttcan, (uint32_t)node->reference_ticks);
+    if (!node->joined)
+    {
+        node->joined = true;
+        if (node->power_up > 0.0)
+        {
+            sim->stats->join_latency = node->event_time - node->power_up;
+        }
+    }
+
+    const uint16_t index = GTTCAN_CAN_ID_INDEX(id);
+    if (node->index == 0U)
+    {
+        if (index == 0U)
+        {
+            sim->start_of_schedule = node->event_time;
+            sim->start_of_schedule_valid = true;
+        }
+    }
+    else if (sim->start_of_schedule_valid && (node->event_time >= sim->warmup))
+    {
+        const double error = node->event_time - (sim->start_of_schedule + ((double)index * sim->master_slot));
+        const double magnitude = fabs(error);
+        sim->stats->sync_samples++;
+        sim->sync_error_sum += magnitude;
+        sim->sync_error_squares += error * error;
+        sim->stats->sync_error_max = GTTCAN_sim_max(sim->stats->sync_error_max, magnitude);
+        const uint64_t global = GTTCAN_get_global_time(&node->gttcan, (uint32_t)node->reference_ticks);
+        const double global_error = fabs(((double)global * sim->config->ntu) - GTTCAN_sim_local_time(&sim->nodes[0], node->event_time));
+        sim->stats->global_samples++;
+        sim->global_error_sum += global_error;
+        sim->stats->global_error_max = GTTCAN_sim_max(sim->stats->global_error_max, global_error);
+    }
+    GTTCAN_sim_request_bus(sim);
+}
+
+/**
+ * @brief Timer callback: (re-)arm the timer interrupt of a node.
+ */
+static void GTTCAN_sim_set_timer(uint32_t delay, void *context)
+{
+    gttcan_sim_node_t * const node = context;
+    gttcan_sim_t * const sim = node->sim;
+    const double deadline = GTTCAN_sim_local_time(node, node->event_time) + ((double)delay * sim->config->ntu);
+    const double fire = GTTCAN_sim_true_time(node, deadline) + (sim->config->jitter * GTTCAN_sim_uniform(sim));
+    node->timer_generation++;
+    (void)GTTCAN_sim_push(sim, GTTCAN_SIM_TIMER, node->index, GTTCAN_sim_max(fire, sim->now), node->timer_generation);
+}
+
+/**
+ * @brief Read callback: the network time on the master, random payloads otherwise.
+ */
+static uint64_t GTTCAN_sim_read_value(uint16_t dataID, void *context)
+{
+    gttcan_sim_node_t * const node = context;
+    if (dataID == (uint16_t)NETWORK_TIME_SLOT)
+    {
+        return (uint64_t)GTTCAN_sim_local_ticks(node, node->event_time) & 0x3FFFFFFFFFFFFFFFULL;
+    }
+    return GTTCAN_sim_random(node->sim);
+}
+
+/**
+ * @brief Write callback: compare the received network time with the master clock.
+ */
+static void GTTCAN_sim_write_value(uint16_t dataID, uint64_t value, void *context)
+{
+    gttcan_sim_node_t * const node = context;
+    gttcan_sim_t * const sim = node->sim;
+    if ((dataID != (uint16_t)NETWORK_TIME_SLOT) || (sim->now < sim->warmup))
+    {
+        return;
+    }
+    const double error = fabs(((double)value * sim->config->ntu) - GTTCAN_sim_local_time(&sim->nodes[0], sim->now));
+    sim->stats->time_samples++;
+    sim->time_error_sum += error;
+    sim->stats->time_error_max = GTTCAN_sim_max(sim->stats->time_error_max, error);
+}
+
+/**
+ * @brief Arbitrate the bus among all pending frames and start the winner.
+ */
+static void GTTCAN_sim_bus_start(gttcan_sim_t *sim)
+{
+    gttcan_sim_node_t *winner = NULL;
+    for (uint32_t i = 0U; i < sim->config->nodes; i++)
+    {
+        gttcan_sim_node_t * const node = &sim->nodes[i];
+        if (node->tx_pending && ((winner == NULL) || (node->tx_id < winner->tx_id)))
+        {
+            winner = node;
+        }
+    }
+    if (winner == NULL)
+    {
+        return;
+    }
+    for (uint32_t i = 0U; i < sim->config->nodes; i++)
+    {
+        gttcan_sim_node_t * const node = &sim->nodes[i];
+        if ((node != winner) && node->tx_pending && node->tx_single_shot)
+        {
+            node->tx_pending = false;
+            sim->stats->sporadic_lost++;
+            GTTCAN_transmit_result(&node->gttcan, node->tx_id, false, (uint32_t)GTTCAN_sim_local_ticks(node, sim->now));
+        }
+    }
+    uint8_t payload[8];
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        payload[i] = (uint8_t)(winner->tx_data >> (56U - (8U * i)));
+    }
+    gttcan_frame_prefix_t * const prefix = &sim->prefixes[GTTCAN_CAN_ID_INDEX(winner->tx_id)];
+    if ((prefix->length != 8U) || (prefix->id != winner->tx_id))
+    {
+        GTTCAN_prepare_extended_frame_prefix(winner->tx_id, 8U, prefix);
+    }
+    const double duration = (double)GTTCAN_calculate_extended_frame_bits_from_prefix(prefix, payload) * sim->bit_ns;
+    if (sim->now > winner->tx_request_time)
+    {
+        sim->stats->arbitration_losses++;
+    }
+    const double slot_end = winner->tx_request_time + (((double)sim->config->slotduration * sim->config->ntu) / winner->rate);
+    if ((sim->now + duration) > slot_end)
+    {
+        sim->stats->slot_overruns++;
+    }
+    winner->tx_pending = false;
+    sim->bus_busy = true;
+    sim->bus_node = winner->index;
+    sim->bus_frame_start = sim->now;
+    sim->busy_time += duration;
+    GTTCAN_sim_set_bus_event(sim, GTTCAN_SIM_BUS_END, winner->index, sim->now + duration);
+}
+
+/**
+ * @brief Deliver the frame on the bus to all other nodes.
+ */
+static void GTTCAN_sim_bus_end(gttcan_sim_t *sim)
+{
+    const gttcan_sim_node_t * const sender = &sim->nodes[sim->bus_node];
+    const uint32_t id = sender->tx_id;
+    const uint64_t data = sender->tx_data;
+    const bool start_of_schedule = (GTTCAN_CAN_ID_INDEX(id) == 0U) && (GTTCAN_CAN_ID_DATAID(id) == (uint16_t)NETWORK_TIME_SLOT);
+    sim->stats->frames++;
+    sim->bus_busy = false;
+    GTTCAN_transmit_result(&sim->nodes[sim->bus_node].gttcan, id, true, (uint32_t)GTTCAN_sim_local_ticks(sender, sim->now));
+    sim->bus_idle_time = sim->now + ((double)GTTCAN_SIM_INTERFRAME_BITS * sim->bit_ns);
+    for (uint32_t i = 0U; i < sim->config->nodes; i++)
+    {
+        gttcan_sim_node_t * const node = &sim->nodes[i];
+        if ((i == sim->bus_node) || (sim->bus_frame_start < node->power_up))
+        {
+            continue; // the sender, or a node that was powered up during the frame
+        }
+        node->event_time = sim->bus_frame_start + (sim->config->jitter * GTTCAN_sim_uniform(sim));
+        if ((sim->config->filter_banks != 0U) && !GTTCAN_filters_accept(node->filters, node->filter_count, id))
+        {
+            sim->stats->filtered_frames++;
+            continue;
+        }
+        const int64_t ticks = GTTCAN_sim_local_ticks(node, node->event_time);
+        if (start_of_schedule && !node->gttcan.transmitted)
+        {
+            node->reference_ticks = ticks;
+            GTTCAN_set_local_reference(&node->gttcan, (uint32_t)ticks);
+        }
+        GTTCAN_process_frame(&node->gttcan, (uint32_t)(ticks - node->reference_ticks), id, data);
+    }
+    for (uint32_t i = 0U; i < sim->config->nodes; i++)
+    {
+        if (sim->nodes[i].tx_pending)
+        {
+            GTTCAN_sim_request_bus(sim);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Return an exponentially distributed interval in ns with the given rate per s.
+ */
+static double GTTCAN_sim_exponential(gttcan_sim_t *sim, double rate)
+{
+    return -log(1.0 - GTTCAN_sim_uniform(sim)) * (1e9 / rate);
+}
+
+/**
+ * @brief Queue a sporadic message of random priority on a node and schedule the next one.
+ *
+ * The data ID grows with the priority level, so that CAN arbitration
+ * between the nodes prefers the more urgent messages.
+ */
+static void GTTCAN_sim_sporadic(gttcan_sim_t *sim, gttcan_sim_node_t *node)
+{
+    const gttcan_sim_config_t * const config = sim->config;
+    if (sim->now >= node->power_up)
+    {
+        const uint32_t priority = (uint32_t)(GTTCAN_sim_random(sim) % (uint64_t)GTTCAN_SPORADIC_PRIORITIES);
+        const uint32_t dataID = (uint32_t)config->slots + 2U + (priority * config->nodes) + node->index;
+        (void)GTTCAN_sporadic_push(&node->sporadic, (uint16_t)dataID, GTTCAN_sim_random(sim), (uint8_t)priority,
+                                   (uint32_t)GTTCAN_sim_local_ticks(node, sim->now));
+    }
+    (void)GTTCAN_sim_push(sim, GTTCAN_SIM_SPORADIC, node->index, sim->now + GTTCAN_sim_exponential(sim, config->sporadic_rate), 0U);
+}
+
+/**
+ * @brief Stage the new schedule on every node and let the time master switch to it.
+ */
+static void GTTCAN_sim_switch(gttcan_sim_t *sim)
+{
+    for (uint32_t i = 0U; i < sim->config->nodes; i++)
+    {
+        if (!GTTCAN_stage_node_schedule(&sim->nodes[i].gttcan, &sim->nodes[i].next_node_schedule))
+        {
+            sim->switch_failed = true;
+        }
+    }
+    (void)GTTCAN_request_schedule_switch(&sim->nodes[0].gttcan);
+}
+
+/**
+ * @brief Build the global schedule blob for a configuration.
+ *
+ * @param config The configuration.
+ * @param rotation Data slots are assigned round-robin starting at this node.
+ * @param size Receives the size of the blob.
+ * @return The blob (to be freed by the caller), or NULL if the
+ *         configuration cannot be represented.
+ */
+static uint8_t *GTTCAN_sim_build_schedule(const gttcan_sim_config_t *config, uint32_t rotation, uint32_t *size)
+{
+    uint32_t * const entries = malloc((size_t)config->slots * sizeof(*entries));
+    uint32_t owned[GTTCAN_SIM_MAX_NODES] = { 0U };
+    uint32_t next = 0U;
+    uint32_t arbitration = 0U; // arbitration slots, which are in every local schedule
+    bool valid = (entries != NULL);
+    for (uint32_t g = 0U; valid && (g < config->slots); g++)
+    {
+        uint32_t node = 0U;
+        uint32_t dataID = (uint32_t)NETWORK_TIME_SLOT;
+        if ((g != 0U) && ((config->reference_interval == 0U) || ((g % config->reference_interval) != 0U)))
+        {
+            if ((config->arbitration_interval != 0U) && ((g % config->arbitration_interval) == 0U))
+            {
+                entries[g] = (uint32_t)GTTCAN_ARBITRATION_NODE << 16U;
+                arbitration++;
+                continue;
+            }
+            node = (next++ + rotation) % config->nodes;
+            dataID = g + 2U; // keep clear of the reserved data IDs
+        }
+        owned[node]++;
+        valid = (dataID <= GTTCAN_DATAID_MASK);
+        if (valid)
+        {
+            entries[g] = ((node + 1U) << 16U) | dataID;
+        }
+    }
+    for (uint32_t node = 0U; valid && (node < config->nodes); node++)
+    {
+        valid = ((owned[node] + arbitration) <= (uint32_t)GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH);
+    }
+    uint8_t *blob = NULL;
+    if (valid)
+    {
+        *size = GTTCAN_SCHEDULE_SIZE(config->slots);
+        blob = malloc(*size);
+        if (blob != NULL)
+        {
+            (void)GTTCAN_pack_schedule(blob, *size, entries, config->slots, config->slotduration);
+        }
+    }
+    free(entries);
+    return blob;
+}
+
+/**
+ * @brief Derive the acceptance filters of a node that consumes the data of the next node.
+ *
+ * @param config The configuration.
+ * @param node The node, with its schedule loaded.
+ * @return false if no filters could be derived.
+ */
+static bool GTTCAN_sim_build_filters(const gttcan_sim_config_t *config, gttcan_sim_node_t *node)
+{
+    static uint16_t consumed[GTTCAN_MAX_SLOTS + GTTCAN_SPORADIC_PRIORITIES];
+    static gttcan_filter_workspace_t filter_workspace;
+    const uint32_t next = ((node->index + 1U) % config->nodes) + 1U;
+    uint32_t count = 0U;
+    for (uint16_t g = 0U; g < config->slots; g++)
+    {
+        const uint32_t entry = GTTCAN_get_schedule_entry(&node->gttcan, g);
+        if ((entry >> 16U) == next)
+        {
+            consumed[count++] = (uint16_t)(entry & 0xFFFFU);
+        }
+    }
+    for (uint32_t priority = 0U; (config->arbitration_interval != 0U) && (priority < (uint32_t)GTTCAN_SPORADIC_PRIORITIES); priority++)
+    {
+        consumed[count++] = (uint16_t)((uint32_t)config->slots + 2U + (priority * config->nodes) + (next - 1U)); // see GTTCAN_sim_sporadic()
+    }
+    node->filter_count = GTTCAN_build_filters(&node->gttcan, consumed, count, 0U, node->filters, config->filter_banks,
+                                              &filter_workspace);
+    return node->filter_count > 0U;
+}
+
+/**
+ * @brief Fill in the default simulation parameters.
+ *
+ * Four nodes at 1 Mbit/s, 16 slots of 200 us, 50 ppm drift,
+ * 1 us jitter, 10 simulated seconds, all nodes powered up together.
+ *
+ * @param config The configuration to initialise.
+ */
+void GTTCAN_sim_default_config(gttcan_sim_config_t *config)
+{
+    config->nodes = 4U;
+    config->slots = 16U;
+    config->reference_interval = 0U;
+    config->slotduration = 2000U;
+    config->bitrate = 1000000U;
+    config->ntu = 100.0;
+    config->drift_ppm = 50.0;
+    config->jitter = 1000.0;
+    config->duration = 10.0;
+    config->exact_offset = false;
+    config->servo = false;
+    config->fta_outliers = 1U;
+    config->fta_window = 1U;
+    config->join_observations = 0U;
+    config->join_time = 0.0;
+    config->arbitration_interval = 0U;
+    config->sporadic_rate = 0.0;
+    config->switch_time = 0.0;
+    config->filter_banks = 0U;
+    config->trace = NULL;
+    config->seed = 1U;
+}
+
+/**
+ * @brief Run a simulation.
+ *
+ * @param config The simulation parameters.
+ * @param stats Receives the results.
+ * @return false if the configuration is invalid (e.g. a node would own
+ *         more than #GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH slots, or filters
+ *         with a schedule switch), a node could not build, attach or
+ *         stage its schedule or memory could not be allocated, true
+ *         otherwise.
+ */
+bool GTTCAN_sim_run(const gttcan_sim_config_t *config, gttcan_sim_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if ((config->nodes == 0U) || (config->nodes > GTTCAN_SIM_MAX_NODES) || (config->nodes > 255U) ||
+        (config->slots == 0U) || (config->slots > (uint16_t)GTTCAN_MAX_SLOTS) || (config->slotduration == 0U) ||
+        (config->bitrate == 0U) || !(config->ntu > 0.0) || !(config->duration > 0.0) ||
+        !(config->drift_ppm >= 0.0) || (config->drift_ppm >= 1e6) || !(config->jitter >= 0.0) ||
+        !(config->join_time >= 0.0) || (config->join_time >= config->duration) ||
+        ((config->join_time > 0.0) && (config->nodes < 2U)) || !(config->sporadic_rate >= 0.0) ||
+        !(config->switch_time >= 0.0) || (config->switch_time >= config->duration) ||
+        (config->filter_banks > GTTCAN_SIM_MAX_FILTERS) || ((config->filter_banks != 0U) && (config->switch_time > 0.0)) ||
+        (((uint32_t)config->slots + 2U + ((uint32_t)GTTCAN_SPORADIC_PRIORITIES * config->nodes)) > GTTCAN_DATAID_MASK))
+    {
+        return false;
+    }
+    uint32_t size = 0U;
+    uint32_t next_size = 0U;
+    uint8_t * const schedule = GTTCAN_sim_build_schedule(config, 0U, &size);
+    uint8_t * const next_schedule = GTTCAN_sim_build_schedule(config, 1U, &next_size);
+    gttcan_sim_t sim;
+    memset(&sim, 0, sizeof(sim));
+    sim.config = config;
+    sim.stats = stats;
+    sim.random_state = (config->seed != 0U) ? config->seed : 0x9E3779B97F4A7C15ULL;
+    sim.nodes = calloc(config->nodes, sizeof(*sim.nodes));
+    sim.prefixes = calloc(config->slots, sizeof(*sim.prefixes));
+    bool valid = (schedule != NULL) && (next_schedule != NULL) && (sim.nodes != NULL) && (sim.prefixes != NULL);
+    sim.bit_ns = 1e9 / (double)config->bitrate;
+    sim.warmup = (double)GTTCAN_SIM_WARMUP_ROUNDS * (double)config->slots * (double)config->slotduration * config->ntu;
+    const uint32_t bit_time = (uint32_t)fmax(1.0, round(sim.bit_ns / config->ntu));
+    const uint32_t latency = (uint32_t)round(config->jitter / config->ntu); // mean timestamp and timer jitter
+
+    for (uint32_t i = 0U; valid && (i < config->nodes); i++)
+    {
+        gttcan_sim_node_t * const node = &sim.nodes[i];
+        node->sim = &sim;
+        node->index = i;
+        node->rate = 1.0 + (config->drift_ppm * 1e-6 * ((2.0 * GTTCAN_sim_uniform(&sim)) - 1.0));
+        node->offset = 1e6 * GTTCAN_sim_uniform(&sim);
+        node->power_up = ((i + 1U) == config->nodes) ? (config->join_time * 1e9) : 0.0;
+        GTTCAN_init(&node->gttcan, (uint8_t)(i + 1U), config->slotduration, config->slots,
+                    GTTCAN_sim_transmit, GTTCAN_sim_set_timer, GTTCAN_sim_read_value, GTTCAN_sim_write_value, node);
+        // The queue is attached first, so that the node schedules include the arbitration slots.
+        const bool arbitration = (config->arbitration_interval != 0U);
+        GTTCAN_sporadic_init(&node->sporadic);
+        if (arbitration && !GTTCAN_set_sporadic(&node->gttcan, &node->sporadic))
+        {
+            valid = false;
+            break;
+        }
+        if (!GTTCAN_build_node_schedule(&node->node_schedule, schedule, size, (uint8_t)(i + 1U), arbitration) ||
+            !GTTCAN_build_node_schedule(&node->next_node_schedule, next_schedule, next_size, (uint8_t)(i + 1U), arbitration) ||
+            !GTTCAN_set_node_schedule(&node->gttcan, &node->node_schedule) ||
+            !GTTCAN_set_fta(&node->gttcan, config->fta_outliers, config->fta_window))
+        {
+            valid = false;
+            break;
+        }
+        GTTCAN_set_fast_join(&node->gttcan, config->join_observations);
+        GTTCAN_staging_init(&node->staging);
+        GTTCAN_set_staging(&node->gttcan, &node->staging);
+        GTTCAN_clock_init(&node->global_clock);
+        GTTCAN_set_global_clock(&node->gttcan, &node->global_clock);
+        if (arbitration && (config->sporadic_rate > 0.0))
+        {
+            (void)GTTCAN_sim_push(&sim, GTTCAN_SIM_SPORADIC, i, GTTCAN_sim_exponential(&sim, config->sporadic_rate), 0U);
+        }
+        if (config->exact_offset)
+        {
+            GTTCAN_set_exact_slot_offset(&node->gttcan, bit_time, 0U);
+        }
+#if GTTCAN_TRACE
+        if (i == 1U)
+        {
+            GTTCAN_set_trace(&node->gttcan, config->trace);
+        }
+#endif
+        if (config->servo && (i != 0U))
+        {
+            GTTCAN_set_clock_servo(&node->gttcan, true, (uint8_t)GTTCAN_SERVO_KP_SHIFT, (uint8_t)GTTCAN_SERVO_KI_SHIFT, latency);
+        }
+        valid = (config->filter_banks == 0U) || GTTCAN_sim_build_filters(config, node);
+    }
+    if (!valid)
+    {
+        free(sim.events);
+        free(sim.prefixes);
+        free(sim.nodes);
+        free(schedule);
+        free(next_schedule);
+        return false;
+    }
+    sim.master_slot = ((double)config->slotduration * config->ntu) / sim.nodes[0].rate;
+    stats->join_latency = (config->join_time > 0.0) ? -1.0 : 0.0;
+    if (config->switch_time > 0.0)
+    {
+        (void)GTTCAN_sim_push(&sim, GTTCAN_SIM_SWITCH, 0U, config->switch_time * 1e9, 0U);
+    }
+
+    GTTCAN_start(&sim.nodes[0].gttcan);
+    const double end = config->duration * 1e9;
+    gttcan_sim_event_t event;
+    while (GTTCAN_sim_next_event(&sim, &event))
+    {
+        if (event.time > end)
+        {
+            break;
+        }
+        sim.now = event.time;
+        stats->events++;
+        switch (event.type)
+        {
+            case GTTCAN_SIM_TIMER:
+            {
+                gttcan_sim_node_t * const node = &sim.nodes[event.node];
+                if (event.generation == node->timer_generation)
+                {
+                    node->event_time = sim.now;
+                    GTTCAN_transmit_next_frame(&node->gttcan);
+                }
+                break;
+            }
+            case GTTCAN_SIM_BUS_START:
+                GTTCAN_sim_bus_start(&sim);
+                break;
+            case GTTCAN_SIM_SPORADIC:
+                GTTCAN_sim_sporadic(&sim, &sim.nodes[event.node]);
+                break;
+            case GTTCAN_SIM_SWITCH:
+                GTTCAN_sim_switch(&sim);
+                break;
+            default:
+                GTTCAN_sim_bus_end(&sim);
+                break;
+        }
+    }
+
+    stats->simulated_time = config->duration;
+    stats->bus_utilisation = sim.busy_time / end;
+    if (stats->bus_utilisation > 1.0)
+    {
+        stats->bus_utilisation = 1.0; // the last frame may extend past the end
+    }
+    if (stats->sync_samples > 0U)
+    {
+        stats->sync_error_mean = sim.sync_error_sum / (double)stats->sync_samples;
+        stats->sync_error_rms = sqrt(sim.sync_error_squares / (double)stats->sync_samples);
+    }
+    if (stats->time_samples > 0U)
+    {
+        stats->time_error_mean = sim.time_error_sum / (double)stats->time_samples;
+    }
+    if (stats->global_samples > 0U)
+    {
+        stats->global_error_mean = sim.global_error_sum / (double)stats->global_samples;
+    }
+    for (uint32_t priority = 0U; priority < (uint32_t)GTTCAN_SPORADIC_PRIORITIES; priority++)
+    {
+        double latency_sum = 0.0;
+        uint64_t sent = 0U;
+        for (uint32_t i = 0U; i < config->nodes; i++)
+        {
+            const gttcan_sporadic_t * const sporadic = &sim.nodes[i].sporadic;
+            const double latency_max = (double)sporadic->stats[priority].latency_max * config->ntu;
+            latency_sum += (double)sporadic->stats[priority].latency_sum * config->ntu;
+            sent += sporadic->stats[priority].sent;
+            stats->sporadic_dropped += sporadic->queues[priority].dropped;
+            stats->sporadic_latency_max[priority] = fmax(stats->sporadic_latency_max[priority], latency_max);
+        }
+        stats->sporadic_sent += sent;
+        stats->sporadic_latency_mean[priority] = (sent > 0U) ? (latency_sum / (double)sent) : 0.0;
+    }
+    for (uint32_t i = 0U; i < config->nodes; i++)
+    {
+        stats->schedule_switches += sim.nodes[i].staging.switches;
+    }
+    free(sim.events);
+    free(sim.prefixes);
+    free(sim.nodes);
+    free(schedule);
+    free(next_schedule);
+    return !sim.switch_failed;
+}
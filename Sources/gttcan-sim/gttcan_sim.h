@@ -0,0 +1,136 @@
+/**
+ * @file gttcan_sim.h
+ * @brief Discrete-event simulator for a GTTCAN network on a virtual CAN bus.
+ *
+ * The simulator runs several gttcan_t instances against a shared,
+ * arbitrating CAN bus.  Every node has its own local clock with a
+ * constant drift and a random timer/timestamp jitter.  All events
+ * (timer interrupts, start and end of frames) are taken from a single
+ * event queue, so a run is fully deterministic for a given seed.
+ */
+#ifndef GTTCAN_SIM_H
+#define GTTCAN_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gttcan.h"
+#include "gttcan_sporadic.h"
+#include "gttcan_staging.h"
+#include "gttcan_clock.h"
+#include "gttcan_filter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef GTTCAN_SIM_MAX_NODES
+#define GTTCAN_SIM_MAX_NODES 64U
+#endif
+
+#ifndef GTTCAN_SIM_MAX_FILTERS
+#define GTTCAN_SIM_MAX_FILTERS 64U
+#endif
+
+/**
+ * @brief Parameters of a simulation run.
+ *
+ * Node 1 is the time master: it owns slot 0 (the start-of-schedule
+ * reference frame) and any further reference slots.  The remaining
+ * slots are arbitration slots (every `arbitration_interval`-th slot)
+ * or are assigned to the nodes round-robin.  With a `switch_time`,
+ * every node stages a schedule in which each of these slots belongs
+ * to the next node, and the time master switches to it.  With
+ * `filter_banks`, every node consumes the data of the next node and
+ * only receives the frames accepted by its filters (see gttcan_filter.h).
+ */
+typedef struct gttcan_sim_config_s {
+    uint32_t nodes;              // number of nodes (1 - GTTCAN_SIM_MAX_NODES)
+    uint16_t slots;              // global schedule length
+    uint16_t reference_interval; // a reference frame every n slots (0: start of schedule only)
+    uint16_t arbitration_interval; // an arbitration slot every n slots (0: none)
+    uint32_t slotduration;       // slot duration in NTU
+    uint32_t bitrate;            // CAN bit rate in bit/s
+    double ntu;                  // duration of one network time unit in ns
+    double drift_ppm;            // maximum clock drift, each node is drawn from [-drift, drift]
+    double jitter;               // maximum timer and timestamp jitter in ns
+    double duration;             // simulated time in s
+    bool exact_offset;           // use GTTCAN_set_exact_slot_offset() on all nodes
+    bool servo;                  // enable the clock servo on all nodes but the time master
+    uint8_t fta_outliers;        // outliers discarded at each end by the FTA, see GTTCAN_set_fta()
+    uint8_t fta_window;          // rounds averaged over by the FTA
+    uint8_t join_observations;   // fast join on all nodes, see GTTCAN_set_fast_join() (0: wait for a start of schedule)
+    double join_time;            // the last node is powered up this many s into the run (0: all nodes start together)
+    double sporadic_rate;        // sporadic messages per s and node, sent in the arbitration slots
+    double switch_time;          // switch all nodes to a new schedule this many s into the run (0: never)
+    uint32_t filter_banks;       // acceptance filters per node (0 - GTTCAN_SIM_MAX_FILTERS, 0: receive all frames)
+    struct gttcan_trace_s *trace; // records the events of the second node (with GTTCAN_TRACE), NULL for none
+    uint64_t seed;               // seed of the random number generator
+} gttcan_sim_config_t;
+
+/**
+ * @brief Results of a simulation run.
+ *
+ * The sync error is the difference between the time a node starts
+ * transmitting in a slot and the nominal start of that slot according
+ * to the time master.  Samples are only taken after the first two
+ * schedule rounds, once all nodes had a chance to synchronise.
+ * The global time error is the difference between the network time a
+ * node interpolates with GTTCAN_get_global_time() when it starts
+ * transmitting and the clock of the time master at that instant.
+ */
+typedef struct gttcan_sim_stats_s {
+    double simulated_time;       // simulated time in s
+    uint64_t events;             // number of processed events
+    uint64_t frames;             // number of frames sent on the bus
+    uint64_t slot_overruns;      // frames that did not end within their slot
+    uint64_t arbitration_losses; // frames that had to wait for the bus
+    uint64_t sync_samples;       // number of sync error samples
+    double sync_error_mean;      // mean absolute sync error in ns
+    double sync_error_rms;       // RMS sync error in ns
+    double sync_error_max;       // maximum absolute sync error in ns
+    uint64_t time_samples;       // number of network time samples
+    double time_error_mean;      // mean absolute network time error in ns
+    double time_error_max;       // maximum absolute network time error in ns
+    uint64_t global_samples;     // number of interpolated global time samples
+    double global_error_mean;    // mean absolute error of GTTCAN_get_global_time() in ns
+    double global_error_max;     // maximum absolute error of GTTCAN_get_global_time() in ns
+    double bus_utilisation;      // fraction of the simulated time the bus was busy
+    double join_latency;         // from the power-up of the last node to its first transmission in ns,
+                                 // negative if it never transmitted (0 without join_time)
+    uint64_t sporadic_sent;      // sporadic messages sent
+    uint64_t sporadic_lost;      // sporadic frames that lost arbitration (and were retried)
+    uint64_t sporadic_dropped;   // sporadic messages dropped because a queue was full
+    double sporadic_latency_mean[GTTCAN_SPORADIC_PRIORITIES]; // mean time from queueing to the end of the frame in ns
+    double sporadic_latency_max[GTTCAN_SPORADIC_PRIORITIES];  // longest time from queueing to the end of the frame in ns
+    uint32_t schedule_switches;  // nodes that switched to the new schedule
+    uint64_t filtered_frames;    // frames not received because of the acceptance filters (counted per node)
+} gttcan_sim_stats_t;
+
+/**
+ * @brief Fill in the default simulation parameters.
+ *
+ * Four nodes at 1 Mbit/s, 16 slots of 200 us, 50 ppm drift,
+ * 1 us jitter, 10 simulated seconds, all nodes powered up together.
+ *
+ * @param config The configuration to initialise.
+ */
+void GTTCAN_sim_default_config(gttcan_sim_config_t *config);
+
+/**
+ * @brief Run a simulation.
+ *
+ * @param config The simulation parameters.
+ * @param stats Receives the results.
+ * @return false if the configuration is invalid (e.g. a node would own
+ *         more than #GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH slots, or filters
+ *         with a schedule switch), a node could not build, attach or
+ *         stage its schedule or memory could not be allocated, true
+ *         otherwise.
+ */
+bool GTTCAN_sim_run(const gttcan_sim_config_t *config, gttcan_sim_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GTTCAN_SIM_H
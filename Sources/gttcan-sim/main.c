@@ -0,0 +1,334 @@
+/**
+ * @file main.c
+ * @brief Command line front end of the GTTCAN bus simulator.
+ *
+ * Runs one simulation, or a sweep over the slot duration, and prints
+ * the results as text or as JSON (one object per line).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gttcan_sim.h"
+#include "gttcan_trace.h"
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --nodes N               number of nodes (default 4)\n"
+            "  --slots N               global schedule length (default 16)\n"
+            "  --reference-interval N  a reference frame every N slots (default 0: start of schedule only)\n"
+            "  --arbitration-interval N  an arbitration slot every N slots (default 0: none)\n"
+            "  --sporadic-rate R       sporadic messages per second and node, sent in the arbitration slots\n"
+            "  --slot-duration NTU     slot duration (default 2000)\n"
+            "  --sweep FROM:TO:STEP    run once for each slot duration in the range\n"
+            "  --bitrate BPS           CAN bit rate (default 1000000)\n"
+            "  --ntu NS                duration of a network time unit (default 100)\n"
+            "  --drift PPM             maximum clock drift (default 50)\n"
+            "  --jitter NS             maximum timer/timestamp jitter (default 1000)\n"
+            "  --duration S            simulated time (default 10)\n"
+            "  --exact-offset          compensate the exact reference frame duration\n"
+            "  --servo                 correct the clock rate and phase of the non-master nodes\n"
+            "  --fta-outliers K        discard K outliers at each end of the FTA (default 1)\n"
+            "  --fta-window N          average the FTA over N rounds (default 1)\n"
+            "  --join-time S           power up the last node S seconds into the run (default 0)\n"
+            "  --join-observations N   join after N consistent frames of any kind (default 0: start of schedule)\n"
+            "  --switch-time S         switch to a schedule with every data slot moved to the next node after S seconds\n"
+            "  --filters N             receive through N acceptance filters per node, each consuming the next node's data\n"
+            "  --trace FILE            write the last events of node 2 to FILE (see gttcan-trace)\n"
+            "  --seed N                random seed (default 1)\n"
+            "  --json                  print JSON instead of text\n",
+            name);
+}
+
+static double elapsed(const struct timespec *start)
+{
+    struct timespec now;
+    (void)timespec_get(&now, TIME_UTC);
+    return (double)(now.tv_sec - start->tv_sec) + (1e-9 * (double)(now.tv_nsec - start->tv_nsec));
+}
+
+static void print_text(const gttcan_sim_config_t *config, const gttcan_sim_stats_t *stats, double wall)
+{
+    printf("%u nodes, %u slots of %u NTU (%.1f us), %u bit/s, drift %.1f ppm, jitter %.0f ns%s%s, FTA k=%u window %u\n",
+           config->nodes, config->slots, config->slotduration, (double)config->slotduration * config->ntu / 1e3,
+           config->bitrate, config->drift_ppm, config->jitter, config->exact_offset ? ", exact offset" : "",
+           config->servo ? ", servo" : "", config->fta_outliers, config->fta_window);
+    printf("  simulated %.3f s in %.3f s (%.0fx real time), %llu events\n",
+           stats->simulated_time, wall, (wall > 0.0) ? (stats->simulated_time / wall) : 0.0,
+           (unsigned long long)stats->events);
+    printf("  frames %llu, bus utilisation %.1f %%, slot overruns %llu, arbitration losses %llu\n",
+           (unsigned long long)stats->frames, 100.0 * stats->bus_utilisation,
+           (unsigned long long)stats->slot_overruns, (unsigned long long)stats->arbitration_losses);
+    printf("  sync error: mean %.1f ns, rms %.1f ns, max %.1f ns (%llu samples)\n",
+           stats->sync_error_mean, stats->sync_error_rms, stats->sync_error_max,
+           (unsigned long long)stats->sync_samples);
+    printf("  network time error: mean %.1f ns, max %.1f ns (%llu samples)\n",
+           stats->time_error_mean, stats->time_error_max, (unsigned long long)stats->time_samples);
+    printf("  global time error: mean %.1f ns, max %.1f ns (%llu samples)\n",
+           stats->global_error_mean, stats->global_error_max, (unsigned long long)stats->global_samples);
+    if (config->arbitration_interval != 0U)
+    {
+        printf("  sporadic: %llu sent, %llu lost arbitration, %llu dropped; latency per priority (mean/max us):",
+               (unsigned long long)stats->sporadic_sent, (unsigned long long)stats->sporadic_lost,
+               (unsigned long long)stats->sporadic_dropped);
+        for (uint32_t priority = 0U; priority < (uint32_t)GTTCAN_SPORADIC_PRIORITIES; priority++)
+        {
+            printf(" %.1f/%.1f", stats->sporadic_latency_mean[priority] / 1e3, stats->sporadic_latency_max[priority] / 1e3);
+        }
+        printf("\n");
+    }
+    if (config->switch_time > 0.0)
+    {
+        printf("  schedule switch at %.3f s: %u of %u nodes switched\n", config->switch_time, stats->schedule_switches, config->nodes);
+    }
+    if (config->filter_banks != 0U)
+    {
+        printf("  acceptance filters: %u per node, %llu of %llu received frames filtered out\n", config->filter_banks,
+               (unsigned long long)stats->filtered_frames, (unsigned long long)(stats->frames * (config->nodes - 1U)));
+    }
+    if (config->join_time > 0.0)
+    {
+        if (stats->join_latency < 0.0)
+        {
+            printf("  node %u powered up at %.3f s, never transmitted\n", config->nodes, config->join_time);
+        }
+        else
+        {
+            printf("  node %u powered up at %.3f s, first transmission after %.1f us\n",
+                   config->nodes, config->join_time, stats->join_latency / 1e3);
+        }
+    }
+}
+
+static void print_json(const gttcan_sim_config_t *config, const gttcan_sim_stats_t *stats, double wall)
+{
+    printf("{\"nodes\":%u,\"slots\":%u,\"reference_interval\":%u,\"slotduration\":%u,\"bitrate\":%u,"
+           "\"ntu\":%g,\"drift_ppm\":%g,\"jitter\":%g,\"exact_offset\":%s,\"servo\":%s,\"fta_outliers\":%u,\"fta_window\":%u,"
+           "\"join_time\":%g,\"join_observations\":%u,\"seed\":%llu,"
+           "\"simulated_time\":%g,\"wall_time\":%g,\"events\":%llu,\"frames\":%llu,"
+           "\"bus_utilisation\":%g,\"slot_overruns\":%llu,\"arbitration_losses\":%llu,"
+           "\"sync_samples\":%llu,\"sync_error_mean\":%g,\"sync_error_rms\":%g,\"sync_error_max\":%g,"
+           "\"time_samples\":%llu,\"time_error_mean\":%g,\"time_error_max\":%g,"
+           "\"global_samples\":%llu,\"global_error_mean\":%g,\"global_error_max\":%g,\"join_latency\":%g,"
+           "\"arbitration_interval\":%u,\"sporadic_rate\":%g,\"sporadic_sent\":%llu,\"sporadic_lost\":%llu,"
+           "\"sporadic_dropped\":%llu,\"switch_time\":%g,\"schedule_switches\":%u,\"filter_banks\":%u,\"filtered_frames\":%llu,"
+           "\"sporadic_latency_mean\":[",
+           config->nodes, config->slots, config->reference_interval, config->slotduration, config->bitrate,
+           config->ntu, config->drift_ppm, config->jitter, config->exact_offset ? "true" : "false",
+           config->servo ? "true" : "false", config->fta_outliers, config->fta_window,
+           config->join_time, config->join_observations, (unsigned long long)config->seed,
+           stats->simulated_time, wall, (unsigned long long)stats->events,
+           (unsigned long long)stats->frames, stats->bus_utilisation, (unsigned long long)stats->slot_overruns,
+           (unsigned long long)stats->arbitration_losses, (unsigned long long)stats->sync_samples,
+           stats->sync_error_mean, stats->sync_error_rms, stats->sync_error_max,
+           (unsigned long long)stats->time_samples, stats->time_error_mean, stats->time_error_max,
+           (unsigned long long)stats->global_samples, stats->global_error_mean, stats->global_error_max,
+           stats->join_latency, config->arbitration_interval, config->sporadic_rate,
+           (unsigned long long)stats->sporadic_sent, (unsigned long long)stats->sporadic_lost,
+           (unsigned long long)stats->sporadic_dropped, config->switch_time, stats->schedule_switches,
+           config->filter_banks, (unsigned long long)stats->filtered_frames);
+    for (uint32_t priority = 0U; priority < (uint32_t)GTTCAN_SPORADIC_PRIORITIES; priority++)
+    {
+        printf("%s%g", (priority > 0U) ? "," : "", stats->sporadic_latency_mean[priority]);
+    }
+    printf("],\"sporadic_latency_max\":[");
+    for (uint32_t priority = 0U; priority < (uint32_t)GTTCAN_SPORADIC_PRIORITIES; priority++)
+    {
+        printf("%s%g", (priority > 0U) ? "," : "", stats->sporadic_latency_max[priority]);
+    }
+    printf("]}\n");
+}
+
+int main(int argc, char *argv[])
+{
+    gttcan_sim_config_t config;
+    GTTCAN_sim_default_config(&config);
+    unsigned long sweep_from = 0UL;
+    unsigned long sweep_to = 0UL;
+    unsigned long sweep_step = 0UL;
+    int json = 0;
+    const char *trace_path = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char * const option = argv[i];
+        const char * const value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int consumed = 1;
+        if (strcmp(option, "--exact-offset") == 0)
+        {
+            config.exact_offset = true;
+            consumed = 0;
+        }
+        else if (strcmp(option, "--servo") == 0)
+        {
+            config.servo = true;
+            consumed = 0;
+        }
+        else if (strcmp(option, "--json") == 0)
+        {
+            json = 1;
+            consumed = 0;
+        }
+        else if ((strcmp(option, "--help") == 0) || (strcmp(option, "-h") == 0))
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        else if (value == NULL)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        else if (strcmp(option, "--nodes") == 0)
+        {
+            config.nodes = (uint32_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--slots") == 0)
+        {
+            config.slots = (uint16_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--reference-interval") == 0)
+        {
+            config.reference_interval = (uint16_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--arbitration-interval") == 0)
+        {
+            config.arbitration_interval = (uint16_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--sporadic-rate") == 0)
+        {
+            config.sporadic_rate = strtod(value, NULL);
+        }
+        else if (strcmp(option, "--slot-duration") == 0)
+        {
+            config.slotduration = (uint32_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--sweep") == 0)
+        {
+            if ((sscanf(value, "%lu:%lu:%lu", &sweep_from, &sweep_to, &sweep_step) != 3) || (sweep_step == 0UL))
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(option, "--bitrate") == 0)
+        {
+            config.bitrate = (uint32_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--ntu") == 0)
+        {
+            config.ntu = strtod(value, NULL);
+        }
+        else if (strcmp(option, "--drift") == 0)
+        {
+            config.drift_ppm = strtod(value, NULL);
+        }
+        else if (strcmp(option, "--jitter") == 0)
+        {
+            config.jitter = strtod(value, NULL);
+        }
+        else if (strcmp(option, "--duration") == 0)
+        {
+            config.duration = strtod(value, NULL);
+        }
+        else if (strcmp(option, "--fta-outliers") == 0)
+        {
+            config.fta_outliers = (uint8_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--fta-window") == 0)
+        {
+            config.fta_window = (uint8_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--join-time") == 0)
+        {
+            config.join_time = strtod(value, NULL);
+        }
+        else if (strcmp(option, "--join-observations") == 0)
+        {
+            config.join_observations = (uint8_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--switch-time") == 0)
+        {
+            config.switch_time = strtod(value, NULL);
+        }
+        else if (strcmp(option, "--filters") == 0)
+        {
+            config.filter_banks = (uint32_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--trace") == 0)
+        {
+            trace_path = value;
+        }
+        else if (strcmp(option, "--seed") == 0)
+        {
+            config.seed = strtoull(value, NULL, 0);
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        i += consumed;
+    }
+    if (sweep_step == 0UL)
+    {
+        sweep_from = config.slotduration;
+        sweep_to = config.slotduration;
+        sweep_step = 1UL;
+    }
+
+    static gttcan_trace_t trace;
+    if (trace_path != NULL)
+    {
+#if GTTCAN_TRACE
+        GTTCAN_trace_init(&trace);
+        config.trace = &trace;
+#else
+        fprintf(stderr, "%s: tracing is not compiled in (GTTCAN_TRACE)\n", argv[0]);
+        return 1;
+#endif
+    }
+
+    for (unsigned long slotduration = sweep_from; slotduration <= sweep_to; slotduration += sweep_step)
+    {
+        gttcan_sim_stats_t stats;
+        struct timespec start;
+        config.slotduration = (uint32_t)slotduration;
+        (void)timespec_get(&start, TIME_UTC);
+        if (!GTTCAN_sim_run(&config, &stats))
+        {
+            fprintf(stderr, "%s: invalid configuration\n", argv[0]);
+            return 2;
+        }
+        const double wall = elapsed(&start);
+        if (json != 0)
+        {
+            print_json(&config, &stats, wall);
+        }
+        else
+        {
+            print_text(&config, &stats, wall);
+        }
+    }
+
+    if (trace_path != NULL)
+    {
+        static uint8_t blob[GTTCAN_TRACE_BLOB_SIZE(GTTCAN_TRACE_SIZE)];
+        const uint32_t size = GTTCAN_trace_serialize(&trace, blob, sizeof(blob));
+        FILE * const file = fopen(trace_path, "wb");
+        bool written = (file != NULL);
+        if (written)
+        {
+            written = (fwrite(blob, 1U, size, file) == size);
+            written = (fclose(file) == 0) && written;
+        }
+        if (!written)
+        {
+            fprintf(stderr, "%s: cannot write %s\n", argv[0], trace_path);
+            return 2;
+        }
+    }
+    return 0;
+}
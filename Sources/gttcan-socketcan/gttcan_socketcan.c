@@ -0,0 +1,631 @@
+/**
+ * @file gttcan_socketcan.c
+ * @brief Linux SocketCAN backend for GTTCAN.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include "gttcan_socketcan.h"
+
+/// Maximum number of epoll events dispatched per wait.
+#define GTTCAN_SOCKETCAN_MAX_EVENTS 16
+/// Maximum number of frames passed to GTTCAN_process_frames() at once.
+#define GTTCAN_SOCKETCAN_RX_BATCH 16U
+
+/**
+ * @brief Return a time in ns.
+ */
+static inline uint64_t GTTCAN_socketcan_ns(const struct timespec *time)
+{
+    return ((uint64_t)time->tv_sec * 1000000000ULL) + (uint64_t)time->tv_nsec;
+}
+
+/**
+ * @brief Return the current CLOCK_MONOTONIC time in ns.
+ */
+static uint64_t GTTCAN_socketcan_now(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return GTTCAN_socketcan_ns(&now);
+}
+
+/**
+ * @brief Return CLOCK_REALTIME minus CLOCK_MONOTONIC in ns.
+ *
+ * Receive timestamps are on CLOCK_REALTIME.  The real time is read
+ * between two reads of the monotonic clock and compared with their
+ * midpoint, so the offset is exact to a fraction of a clock read.
+ */
+static int64_t GTTCAN_socketcan_realtime_offset(void)
+{
+    struct timespec before;
+    struct timespec realtime;
+    struct timespec after;
+    (void)clock_gettime(CLOCK_MONOTONIC, &before);
+    (void)clock_gettime(CLOCK_REALTIME, &realtime);
+    (void)clock_gettime(CLOCK_MONOTONIC, &after);
+    const uint64_t monotonic = GTTCAN_socketcan_ns(&before) + ((GTTCAN_socketcan_ns(&after) - GTTCAN_socketcan_ns(&before)) / 2U);
+    return (int64_t)(GTTCAN_socketcan_ns(&realtime) - monotonic);
+}
+
+/**
+ * @brief Transmit callback: write a frame to the CAN socket.
+ */
+static void GTTCAN_socketcan_transmit(uint32_t id, uint64_t data, void *context)
+{
+    gttcan_socketcan_t * const socketcan = context;
+    struct can_frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.can_id = (id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+    frame.can_dlc = 8U;
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        frame.data[i] = (uint8_t)(data >> (56U - (8U * i)));
+    }
+    socketcan->reference_time = socketcan->event_time;
+    GTTCAN_set_local_reference(&socketcan->gttcan, (uint32_t)(socketcan->reference_time / socketcan->ntu));
+    if (write(socketcan->can.fd, &frame, sizeof(frame)) == (ssize_t)sizeof(frame))
+    {
+        socketcan->tx_frames++;
+    }
+    else
+    {
+        socketcan->tx_errors++;
+    }
+}
+
+/**
+ * @brief Timer callback: arm the timerfd relative to the current event.
+ */
+static void GTTCAN_socketcan_set_timer(uint32_t delay, void *context)
+{
+    gttcan_socketcan_t * const socketcan = context;
+    socketcan->timer_deadline = socketcan->event_time + ((uint64_t)delay * socketcan->ntu);
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = (time_t)(socketcan->timer_deadline / 1000000000ULL);
+    spec.it_value.tv_nsec = (long)(socketcan->timer_deadline % 1000000000ULL);
+    (void)timerfd_settime(socketcan->timer.fd, TFD_TIMER_ABSTIME, &spec, NULL);
+}
+
+/**
+ * @brief CAN FD transmit callback: write a CAN FD frame to the CAN socket.
+ *
+ * The payload is padded with zero bytes to the next CAN FD length.
+ */
+static void GTTCAN_socketcan_transmit_fd(uint32_t id, const uint8_t *data, uint8_t length, void *context)
+{
+    gttcan_socketcan_t * const socketcan = context;
+    struct canfd_frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.can_id = (id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+    frame.len = GTTCAN_fd_dlc_to_length(GTTCAN_fd_length_to_dlc(length));
+    frame.flags = (socketcan->data_bit_time != 0U) ? CANFD_BRS : 0U;
+    memcpy(frame.data, data, (length > frame.len) ? frame.len : length);
+    socketcan->reference_time = socketcan->event_time;
+    GTTCAN_set_local_reference(&socketcan->gttcan, (uint32_t)(socketcan->reference_time / socketcan->ntu));
+    if (write(socketcan->can.fd, &frame, sizeof(frame)) == (ssize_t)sizeof(frame))
+    {
+        socketcan->tx_frames++;
+    }
+    else
+    {
+        socketcan->tx_errors++;
+    }
+}
+
+static uint8_t GTTCAN_socketcan_read_buffer(uint16_t dataID, uint8_t *data, void *context)
+{
+    gttcan_socketcan_t * const socketcan = context;
+    return socketcan->read_buffer(dataID, data, socketcan->context);
+}
+
+static void GTTCAN_socketcan_write_buffer(uint16_t dataID, const uint8_t *data, uint8_t length, void *context)
+{
+    gttcan_socketcan_t * const socketcan = context;
+    socketcan->write_buffer(dataID, data, length, socketcan->context);
+}
+
+static uint64_t GTTCAN_socketcan_read_value(uint16_t dataID, void *context)
+{
+    gttcan_socketcan_t * const socketcan = context;
+    return socketcan->read_value(dataID, socketcan->context);
+}
+
+static void GTTCAN_socketcan_write_value(uint16_t dataID, uint64_t value, void *context)
+{
+    gttcan_socketcan_t * const socketcan = context;
+    socketcan->write_value(dataID, value, socketcan->context);
+}
+
+/**
+ * @brief Return the CLOCK_REALTIME receive timestamp of a message in ns, or 0 if there is none.
+ */
+static uint64_t GTTCAN_socketcan_timestamp(const gttcan_socketcan_t *socketcan, struct msghdr *message)
+{
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(message); cmsg != NULL; cmsg = CMSG_NXTHDR(message, cmsg))
+    {
+        if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SO_TIMESTAMPING))
+        {
+            struct timespec stamps[3]; // software, (deprecated), raw hardware
+            memcpy(stamps, CMSG_DATA(cmsg), sizeof(stamps));
+            const struct timespec *stamp = &stamps[0];
+            if (socketcan->hardware_timestamps && ((stamps[2].tv_sec != 0) || (stamps[2].tv_nsec != 0)))
+            {
+                stamp = &stamps[2];
+            }
+            return GTTCAN_socketcan_ns(stamp);
+        }
+    }
+    return 0U;
+}
+
+/**
+ * @brief Pass a batch of received frames to GTTCAN_process_frames().
+ *
+ * The timer is re-armed relative to the last frame of the batch.
+ */
+static void GTTCAN_socketcan_flush(gttcan_socketcan_t *socketcan, const gttcan_rx_frame_t *frames, uint32_t count, uint64_t last_time)
+{
+    if (count > 0U)
+    {
+        socketcan->event_time = last_time;
+        socketcan->rx_frames += count;
+        GTTCAN_process_frames(&socketcan->gttcan, frames, count);
+    }
+}
+
+/**
+ * @brief Pass all pending frames of the CAN socket to GTTCAN_process_frames().
+ *
+ * Timestamps are taken at the end of the frame and moved from
+ * CLOCK_REALTIME to CLOCK_MONOTONIC with an offset read once per call,
+ * so a step of the real time only affects the frames it overlaps.
+ * With a known bit rate,
+ * the exact frame duration is subtracted so that `current_time` refers
+ * to the start of the frame, like the start of our own transmissions.
+ * Frames are processed in batches of up to #GTTCAN_SOCKETCAN_RX_BATCH,
+ * so the timer is re-armed once per batch.  CAN FD frames end the
+ * batch and are passed to GTTCAN_process_fd_frame() one by one.
+ */
+static void GTTCAN_socketcan_receive(gttcan_socketcan_t *socketcan)
+{
+    gttcan_rx_frame_t frames[GTTCAN_SOCKETCAN_RX_BATCH];
+    uint32_t count = 0U;
+    uint64_t last_time = 0U;
+    const int64_t offset = GTTCAN_socketcan_realtime_offset();
+    for (;;)
+    {
+        struct canfd_frame frame;
+        struct iovec iov = { &frame, sizeof(frame) };
+        union {
+            char buffer[CMSG_SPACE(3U * sizeof(struct timespec))];
+            struct cmsghdr align;
+        } control;
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1U;
+        message.msg_control = control.buffer;
+        message.msg_controllen = sizeof(control.buffer);
+        const ssize_t received = recvmsg(socketcan->can.fd, &message, MSG_DONTWAIT);
+        if (received < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break; // EAGAIN: no more frames
+        }
+        const bool fd = (received == (ssize_t)CANFD_MTU);
+        if ((!fd && (received != (ssize_t)CAN_MTU)) || (fd && (socketcan->gttcan.fd == NULL)) ||
+            ((frame.can_id & CAN_EFF_FLAG) == 0U) || ((frame.can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG)) != 0U))
+        {
+            continue; // not a GTTCAN frame
+        }
+        const uint8_t length = fd ? ((frame.len > CANFD_MAX_DLEN) ? (uint8_t)CANFD_MAX_DLEN : frame.len)
+                                  : ((frame.len > 8U) ? 8U : frame.len);
+        const uint32_t id = frame.can_id & CAN_EFF_MASK;
+        uint64_t data = 0U;
+        for (uint32_t i = 0U; i < length; i++)
+        {
+            data |= (uint64_t)frame.data[i] << (56U - (8U * i));
+        }
+        uint64_t timestamp = GTTCAN_socketcan_timestamp(socketcan, &message);
+        if (timestamp != 0U)
+        {
+            timestamp = (uint64_t)((int64_t)timestamp - offset);
+        }
+        else
+        {
+            timestamp = GTTCAN_socketcan_now();
+        }
+        if ((socketcan->bit_time != 0U) && fd)
+        {
+            gttcan_fd_frame_bits_t bits;
+            const bool brs = (frame.flags & CANFD_BRS) != 0U;
+            gttcan_fd_frame_prefix_t * const prefix = &socketcan->fd_prefixes[GTTCAN_CAN_ID_INDEX(id) % GTTCAN_SOCKETCAN_FD_PREFIX_CACHE_SIZE];
+            if ((prefix->id != id) || (prefix->length != length) || ((prefix->brs != 0U) != brs))
+            {
+                GTTCAN_prepare_fd_frame_prefix(id, length, brs, prefix);
+            }
+            (void)GTTCAN_calculate_fd_frame_bits_from_prefix(prefix, frame.data, &bits);
+            timestamp -= GTTCAN_fd_frame_duration(&bits, socketcan->bit_time,
+                                                  (socketcan->data_bit_time != 0U) ? socketcan->data_bit_time : socketcan->bit_time);
+        }
+        else if (socketcan->bit_time != 0U)
+        {
+            timestamp -= (uint64_t)GTTCAN_calculate_extended_frame_bits(id, frame.data, length) * socketcan->bit_time;
+        }
+        if ((GTTCAN_CAN_ID_INDEX(id) == 0U) && (GTTCAN_CAN_ID_DATAID(id) == (uint16_t)NETWORK_TIME_SLOT) && !socketcan->gttcan.transmitted)
+        {
+            // The start of schedule becomes the new reference, which a batch cannot span.
+            GTTCAN_socketcan_flush(socketcan, frames, count, last_time);
+            count = 0U;
+            socketcan->reference_time = timestamp;
+            GTTCAN_set_local_reference(&socketcan->gttcan, (uint32_t)(timestamp / socketcan->ntu));
+        }
+        const uint64_t elapsed = (timestamp > socketcan->reference_time) ? (timestamp - socketcan->reference_time) : 0U;
+        if (fd)
+        {
+            GTTCAN_socketcan_flush(socketcan, frames, count, last_time);
+            count = 0U;
+            socketcan->event_time = timestamp;
+            socketcan->rx_frames++;
+            GTTCAN_process_fd_frame(&socketcan->gttcan, (uint32_t)(elapsed / socketcan->ntu), id, frame.data, length);
+            continue;
+        }
+        frames[count].timestamp = (uint32_t)(elapsed / socketcan->ntu);
+        frames[count].id = id;
+        frames[count].data = data;
+        count++;
+        last_time = timestamp;
+        if (count == GTTCAN_SOCKETCAN_RX_BATCH)
+        {
+            GTTCAN_socketcan_flush(socketcan, frames, count, last_time);
+            count = 0U;
+        }
+    }
+    GTTCAN_socketcan_flush(socketcan, frames, count, last_time);
+}
+
+/**
+ * @brief Handle an expired timer: transmit the next local frame.
+ */
+static void GTTCAN_socketcan_timer_expired(gttcan_socketcan_t *socketcan)
+{
+    uint64_t expirations;
+    if (read(socketcan->timer.fd, &expirations, sizeof(expirations)) != (ssize_t)sizeof(expirations))
+    {
+        return; // spurious wakeup or the timer was re-armed
+    }
+    socketcan->event_time = socketcan->timer_deadline;
+    GTTCAN_transmit_next_frame(&socketcan->gttcan);
+}
+
+/**
+ * @brief Create an event loop.
+ *
+ * @param loop The event loop to initialise.
+ * @return true on success, false on error (with `errno` set).
+ */
+bool GTTCAN_socketcan_loop_init(gttcan_socketcan_loop_t *loop)
+{
+    loop->running = false;
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    return loop->epoll_fd >= 0;
+}
+
+/**
+ * @brief Release an event loop.
+ *
+ * All instances using the loop must have been closed.
+ *
+ * @param loop The event loop.
+ */
+void GTTCAN_socketcan_loop_close(gttcan_socketcan_loop_t *loop)
+{
+    if (loop->epoll_fd >= 0)
+    {
+        (void)close(loop->epoll_fd);
+        loop->epoll_fd = -1;
+    }
+}
+
+/**
+ * @brief Wait for and dispatch pending events.
+ *
+ * @param loop The event loop.
+ * @param timeout_ms The maximum time to wait in ms, -1 to wait forever.
+ * @return The number of dispatched events, or -1 on error (with `errno` set).
+ */
+int GTTCAN_socketcan_loop_run_once(gttcan_socketcan_loop_t *loop, int timeout_ms)
+{
+    struct epoll_event events[GTTCAN_SOCKETCAN_MAX_EVENTS];
+    const int count = epoll_wait(loop->epoll_fd, events, GTTCAN_SOCKETCAN_MAX_EVENTS, timeout_ms);
+    if (count < 0)
+    {
+        return (errno == EINTR) ? 0 : -1;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        const gttcan_socketcan_source_t * const source = events[i].data.ptr;
+        gttcan_socketcan_t * const socketcan = source->owner;
+        if (source == &socketcan->can)
+        {
+            GTTCAN_socketcan_receive(socketcan);
+        }
+        else
+        {
+            GTTCAN_socketcan_timer_expired(socketcan);
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Dispatch events until GTTCAN_socketcan_loop_stop() is called.
+ *
+ * @param loop The event loop.
+ * @return true if stopped, false on error (with `errno` set).
+ */
+bool GTTCAN_socketcan_loop_run(gttcan_socketcan_loop_t *loop)
+{
+    loop->running = true;
+    while (loop->running)
+    {
+        if (GTTCAN_socketcan_loop_run_once(loop, -1) < 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Stop GTTCAN_socketcan_loop_run() after the current events.
+ *
+ * @param loop The event loop.
+ */
+void GTTCAN_socketcan_loop_stop(gttcan_socketcan_loop_t *loop)
+{
+    loop->running = false;
+}
+
+/**
+ * @brief Register a file descriptor with the event loop.
+ */
+static bool GTTCAN_socketcan_register(gttcan_socketcan_loop_t *loop, gttcan_socketcan_source_t *source)
+{
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = source;
+    return epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, source->fd, &event) == 0;
+}
+
+/**
+ * @brief Initialise a GTTCAN instance on a CAN interface.
+ *
+ * Opens a CAN_RAW socket on the interface, enables receive
+ * timestamps, creates the timer and registers both with the loop.
+ * The parameters after `config` are passed on to GTTCAN_init().
+ *
+ * @param socketcan The instance to initialise.
+ * @param loop The event loop to register with.
+ * @param config The interface parameters.
+ * @param localNodeId The local node ID.
+ * @param slotduration The duration of a slot in NTU.
+ * @param globalScheduleLength The length of the global schedule.
+ * @param read_value The read value function of the application.
+ * @param write_value The write value function of the application.
+ * @param context The context pointer passed to `read_value` and `write_value`.
+ * @return true on success, false on error (with `errno` set).
+ */
+bool GTTCAN_socketcan_open(gttcan_socketcan_t *socketcan,
+                           gttcan_socketcan_loop_t *loop,
+                           const gttcan_socketcan_config_t *config,
+                           uint8_t localNodeId,
+                           uint32_t slotduration,
+                           uint16_t globalScheduleLength,
+                           read_value_fp read_value,
+                           write_value_fp write_value,
+                           void *context)
+{
+    memset(socketcan, 0, sizeof(*socketcan));
+    socketcan->loop = loop;
+    socketcan->can.owner = socketcan;
+    socketcan->can.fd = -1;
+    socketcan->timer.owner = socketcan;
+    socketcan->timer.fd = -1;
+    if ((config->ntu == 0U) || (read_value == NULL) || (write_value == NULL))
+    {
+        errno = EINVAL;
+        return false;
+    }
+    socketcan->ntu = config->ntu;
+    socketcan->bit_time = (config->bitrate != 0U) ? (1000000000U / config->bitrate) : 0U;
+    for (uint32_t i = 0U; i < GTTCAN_SOCKETCAN_FD_PREFIX_CACHE_SIZE; i++)
+    {
+        socketcan->fd_prefixes[i].id = UINT32_MAX; // no valid 29-bit identifier
+    }
+    socketcan->hardware_timestamps = config->hardware_timestamps;
+    socketcan->read_value = read_value;
+    socketcan->write_value = write_value;
+    socketcan->context = context;
+    GTTCAN_init(&socketcan->gttcan, localNodeId, slotduration, globalScheduleLength,
+                GTTCAN_socketcan_transmit, GTTCAN_socketcan_set_timer,
+                GTTCAN_socketcan_read_value, GTTCAN_socketcan_write_value, socketcan);
+    GTTCAN_clock_init(&socketcan->global_clock);
+    GTTCAN_set_global_clock(&socketcan->gttcan, &socketcan->global_clock);
+
+    const unsigned int ifindex = if_nametoindex(config->interface);
+    if (ifindex == 0U)
+    {
+        return false;
+    }
+    socketcan->can.fd = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+    struct sockaddr_can address;
+    memset(&address, 0, sizeof(address));
+    address.can_family = AF_CAN;
+    address.can_ifindex = (int)ifindex;
+    if ((socketcan->can.fd < 0) || (bind(socketcan->can.fd, (struct sockaddr *)&address, sizeof(address)) != 0))
+    {
+        const int error = errno;
+        GTTCAN_socketcan_close(socketcan);
+        errno = error;
+        return false;
+    }
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (config->hardware_timestamps)
+    {
+        flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    }
+    // Without kernel timestamps, frames are timestamped when they are read.
+    (void)setsockopt(socketcan->can.fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags));
+
+    socketcan->timer.fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if ((socketcan->timer.fd < 0) ||
+        !GTTCAN_socketcan_register(loop, &socketcan->can) ||
+        !GTTCAN_socketcan_register(loop, &socketcan->timer))
+    {
+        const int error = errno;
+        GTTCAN_socketcan_close(socketcan);
+        errno = error;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Send and receive CAN FD frames.
+ *
+ * Enables CAN_RAW_FD_FRAMES on the socket and attaches a CAN FD
+ * interface to the GTTCAN instance (see gttcan_fd.h), so that data
+ * frames carry the payloads of `read_buffer` and received payloads
+ * are passed to `write_buffer`.  Classic CAN frames are still received.
+ *
+ * @param socketcan The instance (opened with GTTCAN_socketcan_open()).
+ * @param data_bitrate The data bit rate in bit/s, or 0 to send frames
+ *                     without bit rate switch.
+ * @param read_buffer The read buffer function of the application.
+ * @param write_buffer The write buffer function of the application.
+ * @return true on success, false if the interface does not support
+ *         CAN FD (with `errno` set).
+ */
+bool GTTCAN_socketcan_set_fd(gttcan_socketcan_t *socketcan, uint32_t data_bitrate,
+                             read_buffer_fp read_buffer, write_buffer_fp write_buffer)
+{
+    if ((read_buffer == NULL) || (write_buffer == NULL))
+    {
+        errno = EINVAL;
+        return false;
+    }
+    const int enable = 1;
+    if (setsockopt(socketcan->can.fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable)) != 0)
+    {
+        return false;
+    }
+    socketcan->data_bit_time = (data_bitrate != 0U) ? (1000000000U / data_bitrate) : 0U;
+    socketcan->read_buffer = read_buffer;
+    socketcan->write_buffer = write_buffer;
+    // Rounded up, so that any data bit rate selects the bit rate switch.
+    const uint32_t data_bit_ntu = (socketcan->data_bit_time + socketcan->ntu - 1U) / socketcan->ntu;
+    GTTCAN_fd_init(&socketcan->fd, GTTCAN_socketcan_transmit_fd, GTTCAN_socketcan_read_buffer,
+                   GTTCAN_socketcan_write_buffer, data_bit_ntu);
+    GTTCAN_set_fd(&socketcan->gttcan, &socketcan->fd);
+    return true;
+}
+
+/**
+ * @brief Receive only the frames accepted by a list of filters.
+ *
+ * Installs the filters, e.g. from GTTCAN_build_filters(), as the
+ * CAN_RAW_FILTER list of the socket, so that the kernel drops the
+ * other frames before they wake up the event loop.  The filters only
+ * match extended data frames.
+ *
+ * @param socketcan The instance (opened with GTTCAN_socketcan_open()).
+ * @param filters The filters.
+ * @param count The number of filters (up to #GTTCAN_SOCKETCAN_MAX_FILTERS),
+ *              0 to receive all frames again.
+ * @return true on success, false on error (with `errno` set).
+ */
+bool GTTCAN_socketcan_set_filters(gttcan_socketcan_t *socketcan, const gttcan_filter_t *filters, uint32_t count)
+{
+    if ((count > GTTCAN_SOCKETCAN_MAX_FILTERS) || ((count > 0U) && (filters == NULL)))
+    {
+        errno = EINVAL;
+        return false;
+    }
+    struct can_filter list[GTTCAN_SOCKETCAN_MAX_FILTERS];
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        list[i].can_id = (filters[i].id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+        list[i].can_mask = (filters[i].mask & CAN_EFF_MASK) | CAN_EFF_FLAG | CAN_RTR_FLAG;
+    }
+    if (count == 0U) // the default filter of a new socket
+    {
+        list[0].can_id = 0U;
+        list[0].can_mask = 0U;
+    }
+    const uint32_t length = (count > 0U) ? count : 1U;
+    return setsockopt(socketcan->can.fd, SOL_CAN_RAW, CAN_RAW_FILTER, list, (socklen_t)(length * sizeof(list[0]))) == 0;
+}
+
+/**
+ * @brief Unregister an instance from its loop and close its descriptors.
+ *
+ * @param socketcan The instance.
+ */
+void GTTCAN_socketcan_close(gttcan_socketcan_t *socketcan)
+{
+    gttcan_socketcan_source_t * const sources[2] = { &socketcan->can, &socketcan->timer };
+    for (uint32_t i = 0U; i < 2U; i++)
+    {
+        if (sources[i]->fd >= 0)
+        {
+            (void)epoll_ctl(socketcan->loop->epoll_fd, EPOLL_CTL_DEL, sources[i]->fd, NULL);
+            (void)close(sources[i]->fd);
+            sources[i]->fd = -1;
+        }
+    }
+}
+
+/**
+ * @brief Start the schedule on the time master.
+ *
+ * Calls GTTCAN_start() with the current time as the start of schedule.
+ *
+ * @param socketcan The instance.
+ */
+void GTTCAN_socketcan_start(gttcan_socketcan_t *socketcan)
+{
+    socketcan->event_time = GTTCAN_socketcan_now();
+    GTTCAN_start(&socketcan->gttcan);
+}
+
+/**
+ * @brief Return the current network time.
+ *
+ * Interpolated from the last reference frame with
+ * GTTCAN_get_global_time(), on CLOCK_MONOTONIC in NTU.
+ * May be called from any thread.
+ *
+ * @param socketcan The instance.
+ * @return The network time in NTU, or 0 if no reference frame was seen yet.
+ */
+uint64_t GTTCAN_socketcan_global_time(const gttcan_socketcan_t *socketcan)
+{
+    return GTTCAN_get_global_time(&socketcan->gttcan, (uint32_t)(GTTCAN_socketcan_now() / socketcan->ntu));
+}
@@ -0,0 +1,258 @@
+/**
+ * @file gttcan_socketcan.h
+ * @brief Linux SocketCAN backend for GTTCAN.
+ *
+ * Binds the transmit and timer callbacks of a gttcan_t to a CAN_RAW
+ * socket and a timerfd.  Received frames are passed to
+ * GTTCAN_process_frame() with their kernel receive timestamp
+ * (SO_TIMESTAMPING), so the scheduling delay of the process does not
+ * enter `current_time`.  Timers are armed at absolute deadlines
+ * relative to the instant of the event that set them.  Any number of
+ * instances (on the same or different interfaces) can share one
+ * epoll-based event loop.
+ *
+ * With GTTCAN_socketcan_set_fd(), frames are sent as CAN FD frames
+ * (CAN_RAW_FD_FRAMES) with payloads of up to 64 bytes, see gttcan_fd.h.
+ * GTTCAN_socketcan_set_filters() installs acceptance filters derived
+ * from the schedule (CAN_RAW_FILTER), see gttcan_filter.h.
+ *
+ * All times are taken from CLOCK_MONOTONIC, so that setting the wall
+ * clock (or NTP stepping it) cannot move the timers or the local
+ * reference.  Receive timestamps, which the kernel takes on
+ * CLOCK_REALTIME, are converted with the current offset between both
+ * clocks.  Works on `vcan` interfaces without hardware.
+ */
+#ifndef GTTCAN_SOCKETCAN_H
+#define GTTCAN_SOCKETCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gttcan.h"
+#include "gttcan_fd.h"
+#include "gttcan_clock.h"
+#include "gttcan_filter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum number of filters of GTTCAN_socketcan_set_filters().
+ */
+#ifndef GTTCAN_SOCKETCAN_MAX_FILTERS
+#define GTTCAN_SOCKETCAN_MAX_FILTERS 64U
+#endif
+
+/**
+ * @brief Number of received CAN FD frame prefixes cached per instance.
+ *
+ * With a known bit rate, the identifier and control field of received
+ * CAN FD frames are cached by global schedule index (see
+ * GTTCAN_prepare_fd_frame_prefix()), so that only their payload is
+ * serialised to find the start of the frame.
+ */
+#ifndef GTTCAN_SOCKETCAN_FD_PREFIX_CACHE_SIZE
+#define GTTCAN_SOCKETCAN_FD_PREFIX_CACHE_SIZE 32U
+#endif
+
+/**
+ * @brief An event loop shared by several SocketCAN instances.
+ */
+typedef struct gttcan_socketcan_loop_s {
+    int epoll_fd;
+    bool running;
+} gttcan_socketcan_loop_t;
+
+struct gttcan_socketcan_s;
+
+/**
+ * @brief A file descriptor registered with the event loop.
+ */
+typedef struct gttcan_socketcan_source_s {
+    struct gttcan_socketcan_s *owner;
+    int fd;
+} gttcan_socketcan_source_t;
+
+/**
+ * @brief Parameters of a SocketCAN instance.
+ */
+typedef struct gttcan_socketcan_config_s {
+    const char *interface;    // CAN interface name, e.g. "can0" or "vcan0"
+    uint32_t ntu;             // duration of one network time unit in ns
+    uint32_t bitrate;         // bit rate in bit/s, 0 to use end-of-frame timestamps as is
+    bool hardware_timestamps; // prefer raw hardware receive timestamps (must be in the CLOCK_REALTIME domain, like software timestamps)
+} gttcan_socketcan_config_t;
+
+/**
+ * @brief A GTTCAN instance bound to a CAN socket and a timer.
+ *
+ * The read_value and write_value callbacks of the application are
+ * called with the application context, the transmit and timer
+ * callbacks of `gttcan` are provided by the backend.
+ */
+typedef struct gttcan_socketcan_s {
+    gttcan_t gttcan;
+    gttcan_socketcan_loop_t *loop;
+    gttcan_socketcan_source_t can;
+    gttcan_socketcan_source_t timer;
+
+    uint32_t ntu;         // ns per NTU
+    uint32_t bit_time;    // ns per bit, 0 if unknown
+    uint32_t data_bit_time; // ns per CAN FD data-phase bit, 0 without bit rate switch
+    bool hardware_timestamps;
+
+    uint64_t event_time;     // ns, instant of the event being processed
+    uint64_t reference_time; // ns, start of the last transmission or start of schedule
+    uint64_t timer_deadline; // ns, absolute expiry time of the armed timer
+
+    read_value_fp read_value;
+    write_value_fp write_value;
+    read_buffer_fp read_buffer;   // CAN FD payloads, see GTTCAN_socketcan_set_fd()
+    write_buffer_fp write_buffer;
+    void *context;
+    gttcan_fd_t fd;
+    gttcan_clock_t global_clock; // see GTTCAN_socketcan_global_time()
+    gttcan_fd_frame_prefix_t fd_prefixes[GTTCAN_SOCKETCAN_FD_PREFIX_CACHE_SIZE]; // received CAN FD frames
+
+    uint64_t rx_frames;
+    uint64_t tx_frames;
+    uint64_t tx_errors; // frames the socket did not accept
+} gttcan_socketcan_t;
+
+/**
+ * @brief Create an event loop.
+ *
+ * @param loop The event loop to initialise.
+ * @return true on success, false on error (with `errno` set).
+ */
+bool GTTCAN_socketcan_loop_init(gttcan_socketcan_loop_t *loop);
+
+/**
+ * @brief Release an event loop.
+ *
+ * All instances using the loop must have been closed.
+ *
+ * @param loop The event loop.
+ */
+void GTTCAN_socketcan_loop_close(gttcan_socketcan_loop_t *loop);
+
+/**
+ * @brief Wait for and dispatch pending events.
+ *
+ * @param loop The event loop.
+ * @param timeout_ms The maximum time to wait in ms, -1 to wait forever.
+ * @return The number of dispatched events, or -1 on error (with `errno` set).
+ */
+int GTTCAN_socketcan_loop_run_once(gttcan_socketcan_loop_t *loop, int timeout_ms);
+
+/**
+ * @brief Dispatch events until GTTCAN_socketcan_loop_stop() is called.
+ *
+ * @param loop The event loop.
+ * @return true if stopped, false on error (with `errno` set).
+ */
+bool GTTCAN_socketcan_loop_run(gttcan_socketcan_loop_t *loop);
+
+/**
+ * @brief Stop GTTCAN_socketcan_loop_run() after the current events.
+ *
+ * @param loop The event loop.
+ */
+void GTTCAN_socketcan_loop_stop(gttcan_socketcan_loop_t *loop);
+
+/**
+ * @brief Initialise a GTTCAN instance on a CAN interface.
+ *
+ * Opens a CAN_RAW socket on the interface, enables receive
+ * timestamps, creates the timer and registers both with the loop.
+ * The parameters after `config` are passed on to GTTCAN_init().
+ *
+ * @param socketcan The instance to initialise.
+ * @param loop The event loop to register with.
+ * @param config The interface parameters.
+ * @param localNodeId The local node ID.
+ * @param slotduration The duration of a slot in NTU.
+ * @param globalScheduleLength The length of the global schedule.
+ * @param read_value The read value function of the application.
+ * @param write_value The write value function of the application.
+ * @param context The context pointer passed to `read_value` and `write_value`.
+ * @return true on success, false on error (with `errno` set).
+ */
+bool GTTCAN_socketcan_open(gttcan_socketcan_t *socketcan,
+                           gttcan_socketcan_loop_t *loop,
+                           const gttcan_socketcan_config_t *config,
+                           uint8_t localNodeId,
+                           uint32_t slotduration,
+                           uint16_t globalScheduleLength,
+                           read_value_fp read_value,
+                           write_value_fp write_value,
+                           void *context);
+
+/**
+ * @brief Send and receive CAN FD frames.
+ *
+ * Enables CAN_RAW_FD_FRAMES on the socket and attaches a CAN FD
+ * interface to the GTTCAN instance (see gttcan_fd.h), so that data
+ * frames carry the payloads of `read_buffer` and received payloads
+ * are passed to `write_buffer`.  Classic CAN frames are still received.
+ *
+ * @param socketcan The instance (opened with GTTCAN_socketcan_open()).
+ * @param data_bitrate The data bit rate in bit/s, or 0 to send frames
+ *                     without bit rate switch.
+ * @param read_buffer The read buffer function of the application.
+ * @param write_buffer The write buffer function of the application.
+ * @return true on success, false if the interface does not support
+ *         CAN FD (with `errno` set).
+ */
+bool GTTCAN_socketcan_set_fd(gttcan_socketcan_t *socketcan, uint32_t data_bitrate,
+                             read_buffer_fp read_buffer, write_buffer_fp write_buffer);
+
+/**
+ * @brief Receive only the frames accepted by a list of filters.
+ *
+ * Installs the filters, e.g. from GTTCAN_build_filters(), as the
+ * CAN_RAW_FILTER list of the socket, so that the kernel drops the
+ * other frames before they wake up the event loop.  The filters only
+ * match extended data frames.
+ *
+ * @param socketcan The instance (opened with GTTCAN_socketcan_open()).
+ * @param filters The filters.
+ * @param count The number of filters (up to #GTTCAN_SOCKETCAN_MAX_FILTERS),
+ *              0 to receive all frames again.
+ * @return true on success, false on error (with `errno` set).
+ */
+bool GTTCAN_socketcan_set_filters(gttcan_socketcan_t *socketcan, const gttcan_filter_t *filters, uint32_t count);
+
+/**
+ * @brief Unregister an instance from its loop and close its descriptors.
+ *
+ * @param socketcan The instance.
+ */
+void GTTCAN_socketcan_close(gttcan_socketcan_t *socketcan);
+
+/**
+ * @brief Return the current network time.
+ *
+ * Interpolated from the last reference frame with
+ * GTTCAN_get_global_time(), on CLOCK_MONOTONIC in NTU.
+ * May be called from any thread.
+ *
+ * @param socketcan The instance.
+ * @return The network time in NTU, or 0 if no reference frame was seen yet.
+ */
+uint64_t GTTCAN_socketcan_global_time(const gttcan_socketcan_t *socketcan);
+
+/**
+ * @brief Start the schedule on the time master.
+ *
+ * Calls GTTCAN_start() with the current time as the start of schedule.
+ *
+ * @param socketcan The instance.
+ */
+void GTTCAN_socketcan_start(gttcan_socketcan_t *socketcan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GTTCAN_SOCKETCAN_H
@@ -0,0 +1,273 @@
+/**
+ * @file main.c
+ * @brief Run GTTCAN nodes on a SocketCAN interface.
+ *
+ * Runs a range of nodes of a generated schedule in one process, e.g.
+ * to try the backend on a virtual CAN interface:
+ * ```
+ * ip link add dev vcan0 type vcan && ip link set up vcan0
+ * gttcan-socketcan vcan0 --nodes 4 --duration 5
+ * ```
+ * Node 1 is the time master.  Nodes can also be split across
+ * processes with `--local FIRST:LAST`.  With `--fd`, data frames are
+ * sent as CAN FD frames (the interface needs `mtu 72`).  With
+ * `--filters N`, every node consumes the data of the next node and
+ * only receives the frames accepted by N filters (see gttcan_filter.h).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gttcan_socketcan.h"
+
+#define MAX_NODES 32U
+/// Payload of the CAN FD data frames in bytes.
+#define FD_PAYLOAD 16U
+
+typedef struct node_data_s {
+    uint32_t ntu;
+    uint64_t counter;
+    uint64_t network_time;
+    uint64_t writes;
+} node_data_t;
+
+static uint64_t read_value(uint16_t dataID, void *context)
+{
+    node_data_t * const node = context;
+    if (dataID == (uint16_t)NETWORK_TIME_SLOT)
+    {
+        struct timespec now;
+        (void)clock_gettime(CLOCK_MONOTONIC, &now);
+        return (((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec) / node->ntu;
+    }
+    return ++node->counter;
+}
+
+static void write_value(uint16_t dataID, uint64_t value, void *context)
+{
+    node_data_t * const node = context;
+    if (dataID == (uint16_t)NETWORK_TIME_SLOT)
+    {
+        node->network_time = value;
+    }
+    node->writes++;
+}
+
+static uint8_t read_buffer(uint16_t dataID, uint8_t *data, void *context)
+{
+    const uint64_t value = read_value(dataID, context);
+    for (uint32_t i = 0U; i < FD_PAYLOAD; i += 8U)
+    {
+        GTTCAN_fd_write_u64(&data[i], value);
+    }
+    return FD_PAYLOAD;
+}
+
+static void write_buffer(uint16_t dataID, const uint8_t *data, uint8_t length, void *context)
+{
+    write_value(dataID, GTTCAN_fd_read_u64(data, length), context);
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s INTERFACE [options]\n"
+            "  --nodes N              number of nodes in the schedule (default 4)\n"
+            "  --local FIRST:LAST     nodes run by this process (default all)\n"
+            "  --slots N              global schedule length (default 16)\n"
+            "  --slot-duration NTU    slot duration (default 2000)\n"
+            "  --ntu NS               duration of a network time unit (default 100)\n"
+            "  --bitrate BPS          bit rate for start-of-frame timestamps (default 1000000, 0 to disable)\n"
+            "  --hardware-timestamps  prefer hardware receive timestamps\n"
+            "  --fd                   send CAN FD frames with %u-byte payloads\n"
+            "  --data-bitrate BPS     CAN FD data bit rate (default 0: no bit rate switch)\n"
+            "  --filters N            receive through N acceptance filters (default 0: all frames)\n"
+            "  --duration S           run time (default 10)\n",
+            name, FD_PAYLOAD);
+}
+
+int main(int argc, char *argv[])
+{
+    if ((argc < 2) || (argv[1][0] == '-'))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    gttcan_socketcan_config_t config = { argv[1], 100U, 1000000U, false };
+    unsigned nodes = 4U;
+    unsigned first = 0U;
+    unsigned last = 0U;
+    unsigned slots = 16U;
+    unsigned long slotduration = 2000UL;
+    double duration = 10.0;
+    bool fd = false;
+    uint32_t data_bitrate = 0U;
+    unsigned filter_banks = 0U;
+    for (int i = 2; i < argc; i++)
+    {
+        const char * const option = argv[i];
+        const char * const value = (i + 1 < argc) ? argv[i + 1] : "";
+        if (strcmp(option, "--hardware-timestamps") == 0)
+        {
+            config.hardware_timestamps = true;
+            continue;
+        }
+        else if (strcmp(option, "--fd") == 0)
+        {
+            fd = true;
+            continue;
+        }
+        else if (strcmp(option, "--data-bitrate") == 0)
+        {
+            data_bitrate = (uint32_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--nodes") == 0)
+        {
+            nodes = (unsigned)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--local") == 0)
+        {
+            if (sscanf(value, "%u:%u", &first, &last) != 2)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(option, "--slots") == 0)
+        {
+            slots = (unsigned)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--slot-duration") == 0)
+        {
+            slotduration = strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--ntu") == 0)
+        {
+            config.ntu = (uint32_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--bitrate") == 0)
+        {
+            config.bitrate = (uint32_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--filters") == 0)
+        {
+            filter_banks = (unsigned)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(option, "--duration") == 0)
+        {
+            duration = strtod(value, NULL);
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (first == 0U)
+    {
+        first = 1U;
+        last = nodes;
+    }
+    if ((nodes == 0U) || (nodes > MAX_NODES) || (first > last) || (last > nodes) ||
+        (slots == 0U) || (slots > (unsigned)GTTCAN_MAX_SLOTS) || (config.ntu == 0U) ||
+        (filter_banks > GTTCAN_SOCKETCAN_MAX_FILTERS))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Slot 0 is the start-of-schedule reference frame of node 1, the
+    // other slots are assigned round-robin.
+    static uint32_t entries[GTTCAN_MAX_SLOTS];
+    static uint8_t schedule[GTTCAN_SCHEDULE_SIZE(GTTCAN_MAX_SLOTS)];
+    entries[0] = (1UL << 16U) | (uint32_t)NETWORK_TIME_SLOT;
+    for (unsigned g = 1U; g < slots; g++)
+    {
+        entries[g] = ((((g - 1U) % nodes) + 1U) << 16U) | (g + 1U);
+    }
+    const uint32_t size = GTTCAN_pack_schedule(schedule, sizeof(schedule), entries, (uint16_t)slots, (uint32_t)slotduration);
+
+    static gttcan_socketcan_t instances[MAX_NODES];
+    static gttcan_node_schedule_t node_schedules[MAX_NODES]; // also without GTTCAN_EMBEDDED_SCHEDULE
+    static node_data_t data[MAX_NODES];
+    gttcan_socketcan_loop_t loop;
+    if (!GTTCAN_socketcan_loop_init(&loop))
+    {
+        perror("epoll");
+        return 2;
+    }
+    for (unsigned id = first; id <= last; id++)
+    {
+        gttcan_socketcan_t * const instance = &instances[id - first];
+        data[id - first].ntu = config.ntu;
+        if (!GTTCAN_socketcan_open(instance, &loop, &config, (uint8_t)id, (uint32_t)slotduration, (uint16_t)slots,
+                                   read_value, write_value, &data[id - first]))
+        {
+            perror(config.interface);
+            return 2;
+        }
+        if (fd && !GTTCAN_socketcan_set_fd(instance, data_bitrate, read_buffer, write_buffer))
+        {
+            perror(config.interface);
+            return 2;
+        }
+        if (!GTTCAN_build_node_schedule(&node_schedules[id - first], schedule, size, (uint8_t)id, false) ||
+            !GTTCAN_set_node_schedule(&instance->gttcan, &node_schedules[id - first]))
+        {
+            fprintf(stderr, "%s: invalid schedule\n", argv[0]);
+            return 2;
+        }
+        if (filter_banks > 0U)
+        {
+            // The data of the next node.
+            static uint16_t consumed[GTTCAN_MAX_SLOTS];
+            gttcan_filter_t filters[GTTCAN_SOCKETCAN_MAX_FILTERS];
+            static gttcan_filter_workspace_t filter_workspace;
+            uint32_t count = 0U;
+            for (unsigned g = 1U; g < slots; g++)
+            {
+                if ((((g - 1U) % nodes) + 1U) == ((id % nodes) + 1U))
+                {
+                    consumed[count++] = (uint16_t)(g + 1U);
+                }
+            }
+            const uint32_t filter_count = GTTCAN_build_filters(&instance->gttcan, consumed, count, 0U, filters, filter_banks, &filter_workspace);
+            if ((filter_count > 0U) && !GTTCAN_socketcan_set_filters(instance, filters, filter_count))
+            {
+                perror(config.interface);
+                return 2;
+            }
+        }
+    }
+    if (first == 1U)
+    {
+        GTTCAN_socketcan_start(&instances[0]);
+    }
+
+    struct timespec start;
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    do
+    {
+        if (GTTCAN_socketcan_loop_run_once(&loop, 100) < 0)
+        {
+            perror("epoll_wait");
+            return 2;
+        }
+        (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    } while (((double)(now.tv_sec - start.tv_sec) + (1e-9 * (double)(now.tv_nsec - start.tv_nsec))) < duration);
+
+    for (unsigned id = first; id <= last; id++)
+    {
+        gttcan_socketcan_t * const instance = &instances[id - first];
+        printf("node %u: %s, rx %llu, tx %llu, tx errors %llu, network time %llu NTU (now %llu NTU)\n",
+               id, instance->gttcan.isActive ? "active" : "inactive",
+               (unsigned long long)instance->rx_frames, (unsigned long long)instance->tx_frames,
+               (unsigned long long)instance->tx_errors, (unsigned long long)data[id - first].network_time,
+               (unsigned long long)GTTCAN_socketcan_global_time(instance));
+        GTTCAN_socketcan_close(instance);
+    }
+    GTTCAN_socketcan_loop_close(&loop);
+    return 0;
+}
@@ -0,0 +1,305 @@
+/**
+ * @file main.c
+ * @brief Decoder for binary GTTCAN event traces.
+ *
+ * Reads a trace dumped with GTTCAN_trace_serialize() and prints a
+ * per-round timeline of the events and a jitter report: the clock
+ * error of the received frames per global schedule index and the
+ * FTA results.  Rounds start at a transmitted or received
+ * start-of-schedule frame.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gttcan_trace.h"
+
+/// Error statistics of one global schedule index.
+typedef struct error_stats_s {
+    uint64_t samples;
+    double sum;
+    double sum_squares;
+    int32_t min;
+    int32_t max;
+} error_stats_t;
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] TRACE\n"
+            "  --summary               print only the jitter report\n"
+            "  --json                  print the jitter report as JSON (one object per line)\n",
+            name);
+}
+
+static void add_sample(error_stats_t *stats, int32_t value)
+{
+    if (stats->samples == 0U)
+    {
+        stats->min = value;
+        stats->max = value;
+    }
+    stats->min = (value < stats->min) ? value : stats->min;
+    stats->max = (value > stats->max) ? value : stats->max;
+    stats->sum += (double)value;
+    stats->sum_squares += (double)value * (double)value;
+    stats->samples++;
+}
+
+static double mean(const error_stats_t *stats)
+{
+    return (stats->samples > 0U) ? (stats->sum / (double)stats->samples) : 0.0;
+}
+
+/// Standard deviation of the samples (the jitter).
+static double deviation(const error_stats_t *stats)
+{
+    if (stats->samples == 0U)
+    {
+        return 0.0;
+    }
+    const double m = mean(stats);
+    const double variance = (stats->sum_squares / (double)stats->samples) - (m * m);
+    return (variance > 0.0) ? sqrt(variance) : 0.0;
+}
+
+static const char *event_name(uint8_t type)
+{
+    switch (type)
+    {
+        case GTTCAN_TRACE_TRANSMIT:
+            return "tx";
+        case GTTCAN_TRACE_RECEIVE:
+            return "rx";
+        case GTTCAN_TRACE_REFERENCE:
+            return "rx-ref";
+        case GTTCAN_TRACE_INVALID:
+            return "invalid";
+        default:
+            return "?";
+    }
+}
+
+static bool is_round_start(const gttcan_trace_record_t *record)
+{
+    return (record->flags & GTTCAN_TRACE_FLAG_START) != 0U;
+}
+
+static void print_record(const gttcan_trace_record_t *record)
+{
+    char error[16] = "-";
+    char timer[16] = "-";
+    if (((record->type == GTTCAN_TRACE_RECEIVE) || (record->type == GTTCAN_TRACE_REFERENCE)) &&
+        ((record->flags & GTTCAN_TRACE_FLAG_MEASURED) != 0U))
+    {
+        (void)snprintf(error, sizeof(error), "%d", record->error);
+    }
+    if ((record->flags & GTTCAN_TRACE_FLAG_REARM) != 0U)
+    {
+        (void)snprintf(timer, sizeof(timer), "%u", record->timer);
+    }
+    printf("  %6u %6u  %-8s%s %10u %8s %8d %10s\n", record->index, record->slot_id, event_name(record->type),
+           is_round_start(record) ? "S" : " ", record->current_time, error, record->fta, timer);
+}
+
+static bool read_file(const char *path, uint8_t **data, uint32_t *size)
+{
+    FILE * const file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    uint8_t *buffer = NULL;
+    size_t length = 0U;
+    size_t capacity = 0U;
+    for (;;)
+    {
+        if (length == capacity)
+        {
+            capacity = (capacity == 0U) ? 4096U : (2U * capacity);
+            uint8_t * const grown = realloc(buffer, capacity);
+            if (grown == NULL)
+            {
+                free(buffer);
+                (void)fclose(file);
+                return false;
+            }
+            buffer = grown;
+        }
+        const size_t got = fread(&buffer[length], 1U, capacity - length, file);
+        if (got == 0U)
+        {
+            break;
+        }
+        length += got;
+    }
+    (void)fclose(file);
+    if (length > UINT32_MAX)
+    {
+        free(buffer);
+        return false;
+    }
+    *data = buffer;
+    *size = (uint32_t)length;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = NULL;
+    int summary = 0;
+    int json = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--summary") == 0)
+        {
+            summary = 1;
+        }
+        else if (strcmp(argv[i], "--json") == 0)
+        {
+            json = 1;
+            summary = 1;
+        }
+        else if ((strcmp(argv[i], "--help") == 0) || (strcmp(argv[i], "-h") == 0))
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        else if ((argv[i][0] == '-') || (path != NULL))
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+    if (path == NULL)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    uint8_t *blob = NULL;
+    uint32_t size = 0U;
+    if (!read_file(path, &blob, &size))
+    {
+        fprintf(stderr, "%s: cannot read %s\n", argv[0], path);
+        return 2;
+    }
+    const uint32_t capacity = (size > GTTCAN_TRACE_HEADER_SIZE) ? ((size - GTTCAN_TRACE_HEADER_SIZE) / GTTCAN_TRACE_RECORD_SIZE) : 0U;
+    gttcan_trace_record_t * const records = calloc((capacity > 0U) ? capacity : 1U, sizeof(*records));
+    error_stats_t * const per_index = calloc((size_t)GTTCAN_INDEX_MASK + 1U, sizeof(*per_index));
+    uint32_t count = 0U;
+    uint32_t written = 0U;
+    if ((records == NULL) || (per_index == NULL) ||
+        !GTTCAN_trace_deserialize(blob, size, records, capacity, &count, &written))
+    {
+        fprintf(stderr, "%s: %s is not a valid trace\n", argv[0], path);
+        free(blob);
+        free(records);
+        free(per_index);
+        return 2;
+    }
+    free(blob);
+
+    error_stats_t all = { 0U, 0.0, 0.0, 0, 0 };
+    error_stats_t fta = { 0U, 0.0, 0.0, 0, 0 };
+    uint32_t rounds = 0U;
+    uint32_t transmitted = 0U;
+    uint32_t received = 0U;
+    uint32_t invalid = 0U;
+    uint32_t highest_index = 0U;
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        const gttcan_trace_record_t * const record = &records[i];
+        if (is_round_start(record))
+        {
+            rounds++;
+            if (summary == 0)
+            {
+                printf("round %u\n", rounds);
+                printf("  %6s %6s  %-9s %10s %8s %8s %10s\n", "index", "slot", "event", "time", "error", "fta", "timer");
+            }
+        }
+        else if ((i == 0U) && (summary == 0))
+        {
+            printf("round 0 (partial)\n");
+            printf("  %6s %6s  %-9s %10s %8s %8s %10s\n", "index", "slot", "event", "time", "error", "fta", "timer");
+        }
+        if (summary == 0)
+        {
+            print_record(record);
+        }
+        highest_index = (record->index > highest_index) ? record->index : highest_index;
+        switch (record->type)
+        {
+            case GTTCAN_TRACE_TRANSMIT:
+                transmitted++;
+                break;
+            case GTTCAN_TRACE_RECEIVE:
+            case GTTCAN_TRACE_REFERENCE:
+                received++;
+                if ((record->flags & GTTCAN_TRACE_FLAG_MEASURED) != 0U)
+                {
+                    add_sample(&per_index[record->index & GTTCAN_INDEX_MASK], record->error);
+                    add_sample(&all, record->error);
+                }
+                if ((record->flags & GTTCAN_TRACE_FLAG_REARM) != 0U)
+                {
+                    add_sample(&fta, record->fta);
+                }
+                break;
+            default:
+                invalid++;
+                break;
+        }
+    }
+
+    if (json != 0)
+    {
+        for (uint32_t index = 0U; index <= highest_index; index++)
+        {
+            const error_stats_t * const stats = &per_index[index];
+            if (stats->samples > 0U)
+            {
+                printf("{\"index\":%u,\"samples\":%llu,\"error_mean\":%g,\"jitter\":%g,\"error_min\":%d,\"error_max\":%d}\n",
+                       index, (unsigned long long)stats->samples, mean(stats), deviation(stats), stats->min, stats->max);
+            }
+        }
+        printf("{\"records\":%u,\"written\":%u,\"lost\":%u,\"rounds\":%u,\"transmitted\":%u,\"received\":%u,\"invalid\":%u,"
+               "\"error_samples\":%llu,\"error_mean\":%g,\"jitter\":%g,\"error_min\":%d,\"error_max\":%d,"
+               "\"fta_samples\":%llu,\"fta_mean\":%g,\"fta_deviation\":%g,\"fta_min\":%d,\"fta_max\":%d}\n",
+               count, written, written - count, rounds, transmitted, received, invalid,
+               (unsigned long long)all.samples, mean(&all), deviation(&all), all.min, all.max,
+               (unsigned long long)fta.samples, mean(&fta), deviation(&fta), fta.min, fta.max);
+    }
+    else
+    {
+        if (summary == 0)
+        {
+            printf("\n");
+        }
+        printf("%u records (%u written, %u overwritten), %u rounds, %u transmitted, %u received, %u invalid\n",
+               count, written, written - count, rounds, transmitted, received, invalid);
+        printf("  %6s %8s %10s %10s %8s %8s\n", "index", "samples", "mean", "jitter", "min", "max");
+        for (uint32_t index = 0U; index <= highest_index; index++)
+        {
+            const error_stats_t * const stats = &per_index[index];
+            if (stats->samples > 0U)
+            {
+                printf("  %6u %8llu %10.1f %10.1f %8d %8d\n", index, (unsigned long long)stats->samples,
+                       mean(stats), deviation(stats), stats->min, stats->max);
+            }
+        }
+        printf("  %6s %8llu %10.1f %10.1f %8d %8d\n", "all", (unsigned long long)all.samples,
+               mean(&all), deviation(&all), all.min, all.max);
+        printf("  %6s %8llu %10.1f %10.1f %8d %8d\n", "fta", (unsigned long long)fta.samples,
+               mean(&fta), deviation(&fta), fta.min, fta.max);
+        printf("  (error, jitter and FTA in NTU; jitter is the standard deviation)\n");
+    }
+    free(records);
+    free(per_index);
+    return 0;
+}
@@ -6,6 +6,292 @@
 #include <stdbool.h>
 
 #include "gttcan.h"
+#include "crc15_tables.h"
+
+/**
+ * @brief Continue a bit-serial CRC-15 computation over a buffer.
+ *
+ * @param crc The current CRC register.
+ * @param buffer Pointer to the bytes to fold into the CRC.
+ * @param length The number of bytes to process.
+ * @return The updated (15-bit) CRC register.
+ */
+static inline uint16_t GTTCAN_crc15_update_bitwise(uint16_t crc, const uint8_t * const buffer, const uint32_t length)
+{
+    uint16_t reg = crc;
+    for (uint32_t i = 0U; i < length; i++)
+    {
+        reg ^= (uint16_t)buffer[i] << 7U;
+        for (int j = 0; j < 8; j++)
+        {
+            if ((reg & 0x4000U) != 0U)
+            {
+                reg = (uint16_t)((unsigned)(reg << 1U) ^ 0x4599U);
+            }
+            else
+            {
+                reg <<= 1U;
+            }
+        }
+    }
+    return reg & 0x7FFFU;
+}
+
+/**
+ * @brief Continue a CRC-15 computation over a buffer.
+ *
+ * This function folds `length` bytes into the given CRC register
+ * using the lookup tables selected by #GTTCAN_CRC15_SLICES
+ * (or the bit-serial algorithm if no tables are configured).
+ *
+ * @param crc The current CRC register.
+ * @param buffer Pointer to the bytes to fold into the CRC.
+ * @param length The number of bytes to process.
+ * @return The updated (15-bit) CRC register.
+ */
+static inline uint16_t GTTCAN_crc15_update(uint16_t crc, const uint8_t * const buffer, const uint32_t length)
+{
+#if GTTCAN_CRC15_SLICES == 0
+    return GTTCAN_crc15_update_bitwise(crc, buffer, length);
+#else
+    uint32_t reg = (uint32_t)crc & 0x7FFFU;
+    uint32_t i = 0U;
+#if GTTCAN_CRC15_SLICES == 8
+    for (; (i + 8U) <= length; i += 8U)
+    {
+        const uint32_t high = (reg << 17U) ^
+            ((uint32_t)buffer[i] << 24U) ^ ((uint32_t)buffer[i + 1U] << 16U) ^
+            ((uint32_t)buffer[i + 2U] << 8U) ^ (uint32_t)buffer[i + 3U];
+        reg = (uint32_t)GTTCAN_crc15_table[7][high >> 24U] ^
+            (uint32_t)GTTCAN_crc15_table[6][(high >> 16U) & 0xFFU] ^
+            (uint32_t)GTTCAN_crc15_table[5][(high >> 8U) & 0xFFU] ^
+            (uint32_t)GTTCAN_crc15_table[4][high & 0xFFU] ^
+            (uint32_t)GTTCAN_crc15_table[3][buffer[i + 4U]] ^
+            (uint32_t)GTTCAN_crc15_table[2][buffer[i + 5U]] ^
+            (uint32_t)GTTCAN_crc15_table[1][buffer[i + 6U]] ^
+            (uint32_t)GTTCAN_crc15_table[0][buffer[i + 7U]];
+    }
+#endif
+#if GTTCAN_CRC15_SLICES >= 4
+    for (; (i + 4U) <= length; i += 4U)
+    {
+        const uint32_t word = (reg << 17U) ^
+            ((uint32_t)buffer[i] << 24U) ^ ((uint32_t)buffer[i + 1U] << 16U) ^
+            ((uint32_t)buffer[i + 2U] << 8U) ^ (uint32_t)buffer[i + 3U];
+        reg = (uint32_t)GTTCAN_crc15_table[3][word >> 24U] ^
+            (uint32_t)GTTCAN_crc15_table[2][(word >> 16U) & 0xFFU] ^
+            (uint32_t)GTTCAN_crc15_table[1][(word >> 8U) & 0xFFU] ^
+            (uint32_t)GTTCAN_crc15_table[0][word & 0xFFU];
+    }
+#endif
+    for (; i < length; i++)
+    {
+        reg = ((reg << 8U) & 0x7FFFU) ^ (uint32_t)GTTCAN_crc15_table[0][((reg >> 7U) ^ buffer[i]) & 0xFFU];
+    }
+    return (uint16_t)reg;
+#endif
+}
+
+/**
+ * @brief Compute the CRC-15 of a CAN frame.
+ *
+ * This function calculates a 15-bit CRC using the polynomial
+ * x^15 + x^14 + x^10 + x^8 + x^7 + x^4 + x^3 + 1 (0x4599),
+ * which is used in the CAN protocol.
+ * Depending on #GTTCAN_CRC15_SLICES, the CRC is computed
+ * bit by bit, byte-wise, or 4/8 bytes at a time.
+ *
+ * @param buffer Pointer to the buffer containing the CAN frame.
+ * @param length The length of the CAN frame.
+ */
+uint16_t GTTCAN_crc15(const uint8_t * const buffer, const uint32_t length)
+{
+    return GTTCAN_crc15_update(0x4599U, buffer, length);
+}
+
+/**
+ * @brief Compute the CRC-15 of a CAN frame bit by bit.
+ *
+ * This is the reference implementation of GTTCAN_crc15()
+ * that processes one bit per iteration without a lookup table.
+ *
+ * @param buffer Pointer to the buffer containing the CAN frame.
+ * @param length The length of the CAN frame.
+ */
+uint16_t GTTCAN_crc15_bitwise(const uint8_t * const buffer, const uint32_t length)
+{
+    return GTTCAN_crc15_update_bitwise(0x4599U, buffer, length);
+}
+
+/**
+ * @brief Compute the CRC-15 of several CAN frames in one call.
+ *
+ * The frames are stored back to back in a single buffer,
+ * `stride` bytes apart.  Keeping the loop inside this
+ * translation unit allows the table lookups to be inlined
+ * and avoids one function call per frame.
+ *
+ * @param frames Pointer to the first frame.
+ * @param stride Distance in bytes between consecutive frames.
+ * @param lengths Array of `count` frame lengths.
+ * @param crcs Array of `count` entries receiving the CRCs.
+ * @param count The number of frames.
+ */
+void GTTCAN_crc15_batch(const uint8_t * const frames, const uint32_t stride, const uint32_t * const lengths, uint16_t * const crcs, const uint32_t count)
+{
+    const uint8_t *frame = frames;
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        crcs[i] = GTTCAN_crc15_update(0x4599U, frame, lengths[i]);
+        frame += stride;
+    }
+}
+
+/**
+ * @brief Number of stream bits examined per stuffing-counter step.
+ *
+ * The stuffing counter works on 64-bit windows whose four most
+ * significant bits carry the history of the preceding bits,
+ * leaving 60 bits for the stream itself.
+ */
+#define GTTCAN_STUFFING_CHUNK_BITS 60U
+
+/**
+ * @brief Stuffing history nibbles, indexed by last bit and run length.
+ *
+ * Each nibble encodes four preceding bits (oldest in bit 3) that end
+ * in a run of `run_length` copies of `last_bit`, preceded by the
+ * complementary bit, so that the window never contains a longer run
+ * than the history it represents.
+ */
+static const uint8_t GTTCAN_stuffing_history[2][5] =
+{
+    { 0x5U, 0xAU, 0x4U, 0x8U, 0x0U },
+    { 0xAU, 0x5U, 0xBU, 0x7U, 0xFU }
+};
+
+/**
+ * @brief Count the leading zero bits of a non-zero 64-bit value.
+ */
+static inline uint32_t GTTCAN_clz64(const uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_clzll(value);
+#else
+    uint32_t count = 0U;
+    uint64_t bits = value;
+    while ((bits & 0x8000000000000000ULL) == 0U)
+    {
+        bits <<= 1U;
+        count++;
+    }
+    return count;
+#endif
+}
+
+/**
+ * @brief Count the trailing zero bits of a non-zero 64-bit value.
+ */
+static inline uint32_t GTTCAN_ctz64(const uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctzll(value);
+#else
+    uint32_t count = 0U;
+    uint64_t bits = value;
+    while ((bits & 1U) == 0U)
+    {
+        bits >>= 1U;
+        count++;
+    }
+    return count;
+#endif
+}
+
+/**
+ * @brief Reverse the order of the bits in a 64-bit value.
+ */
+static inline uint64_t GTTCAN_reverse64(const uint64_t value)
+{
+    uint64_t bits = value;
+    bits = ((bits >> 1U) & 0x5555555555555555ULL) | ((bits & 0x5555555555555555ULL) << 1U);
+    bits = ((bits >> 2U) & 0x3333333333333333ULL) | ((bits & 0x3333333333333333ULL) << 2U);
+    bits = ((bits >> 4U) & 0x0F0F0F0F0F0F0F0FULL) | ((bits & 0x0F0F0F0F0F0F0F0FULL) << 4U);
+    bits = ((bits >> 8U) & 0x00FF00FF00FF00FFULL) | ((bits & 0x00FF00FF00FF00FFULL) << 8U);
+    bits = ((bits >> 16U) & 0x0000FFFF0000FFFFULL) | ((bits & 0x0000FFFF0000FFFFULL) << 16U);
+    return (bits >> 32U) | (bits << 32U);
+}
+
+/**
+ * @brief Count the stuffing bits in a chunk of a bit stream.
+ *
+ * Instead of walking the chunk one bit at a time, this function
+ * marks every bit that equals its predecessor and ANDs four shifted
+ * copies of that mask together, which leaves a bit set wherever a
+ * run of five identical bits ends.  The first such position is a
+ * stuffing point; the chunk is then restarted just after it.  The
+ * cost is therefore proportional to the number of stuffing bits,
+ * not to the number of bits in the chunk.
+ *
+ * @param chunk The stream bits, first bit in the most significant bit.
+ * @param count The number of valid bits in `chunk` (at most 60).
+ * @param last_bit The last bit before the chunk (updated).
+ * @param run_length The run length of `last_bit` before the chunk,
+ *                   0 if there is no history (updated).
+ * @param restart_fresh Whether a stuffing bit clears the history (as in
+ *                      GTTCAN_calculate_stuffing_bits()) instead of
+ *                      starting a new run (as in ISO 11898-1).
+ * @return The number of stuffing bits in the chunk.
+ */
+static uint32_t GTTCAN_count_chunk_stuffing_bits(const uint64_t chunk, const uint32_t count, uint8_t * const last_bit, uint8_t * const run_length, const bool restart_fresh)
+{
+    uint32_t stuffing_bits = 0U;
+    uint64_t remaining = chunk;
+    uint32_t remaining_bits = count;
+    uint8_t last = *last_bit;
+    uint8_t run = *run_length;
+
+    while (remaining_bits > 0U)
+    {
+        if (run == 0U) // no history, so pretend the previous bit differed
+        {
+            last = (uint8_t)((remaining >> 63U) ^ 1U);
+            run = 1U;
+        }
+        const uint64_t window = ((uint64_t)GTTCAN_stuffing_history[last][run] << 60U) | (remaining >> 4U);
+        const uint64_t valid = ~0ULL << (GTTCAN_STUFFING_CHUNK_BITS - remaining_bits);
+        const uint64_t equal = ~(window ^ (window >> 1U)) & valid & 0x7FFFFFFFFFFFFFFFULL;
+        const uint64_t runs = equal & (equal >> 1U) & (equal >> 2U) & (equal >> 3U);
+        if (runs == 0U)
+        {
+            // No more stuffing in this chunk: record the trailing run.
+            const uint64_t tail = window >> (GTTCAN_STUFFING_CHUNK_BITS - remaining_bits);
+            last = (uint8_t)(tail & 1U);
+            const uint64_t differing = (last != 0U) ? ~tail : tail;
+            const uint32_t trailing = GTTCAN_ctz64(differing);
+            run = (uint8_t)((trailing > 4U) ? 4U : trailing);
+            break;
+        }
+        const uint32_t position = GTTCAN_clz64(runs); // fifth identical bit
+        const uint32_t consumed = position - 3U;      // stream bits up to and including it
+        stuffing_bits++;
+        if (restart_fresh)
+        {
+            run = 0U;
+        }
+        else // the complementary stuffing bit starts a new run
+        {
+            last = (uint8_t)(((window >> (63U - position)) & 1U) ^ 1U);
+            run = 1U;
+        }
+        remaining <<= consumed;
+        remaining_bits -= consumed;
+    }
+
+    *last_bit = last;
+    *run_length = run;
+    return stuffing_bits;
+}
 
 /**
  * @brief Calculate the number of stuffing bits in a CAN frame.
@@ -13,6 +299,9 @@
  * This function calculates the number of stuffing bits in a CAN frame.
  * The CAN frame is assumed to be in the format specified by ISO 11898-1.
  * The CRC delimiter and ACK slot are assumed to be present.
+ * The bytes are examined least-significant bit first, up to seven
+ * bytes at a time.  For the exact number of stuffing bits of a frame
+ * on the bus, see GTTCAN_count_bitstream_stuffing_bits().
  *
  * @param buffer Pointer to the buffer containing the CAN frame.
  * @param length Length of the CAN frame.
@@ -20,41 +309,109 @@
 uint32_t GTTCAN_calculate_stuffing_bits(const uint8_t * const buffer, const uint32_t length) // cppcheck-suppress misra-c2012-8.7
 {
     uint32_t stuffing_bits = 0U;
-    uint32_t consecutive_bits = 0U;
     uint8_t last_bit = 0U;
+    uint8_t run_length = 0U;
 
-    for (uint32_t i = 0U; i < length; i++)
+    for (uint32_t i = 0U; i < length; i += 7U)
     {
-        uint8_t remaining_bits = buffer[i];
-        for (uint32_t j = 0U; j < 8U; j++)
+        const uint32_t bytes = ((length - i) < 7U) ? (length - i) : 7U;
+        uint64_t word = 0U;
+        for (uint32_t j = 0U; j < bytes; j++)
         {
-            const uint8_t bit = remaining_bits & 1U;
-            remaining_bits >>= 1U;
-            if (bit == last_bit)
-            {
-                consecutive_bits++;
-                if (consecutive_bits == 5U)
-                {
-                    stuffing_bits++;
-                    consecutive_bits = 0U;
-                }
-            }
-            else
-            {
-                consecutive_bits = 1U;
-                last_bit = bit;
-            }
+            word |= (uint64_t)buffer[i + j] << (8U * j);
         }
+        stuffing_bits += GTTCAN_count_chunk_stuffing_bits(GTTCAN_reverse64(word), bytes * 8U, &last_bit, &run_length, true);
+    }
+    return stuffing_bits;
+}
+
+/**
+ * @brief Append bits to a CAN bit stream.
+ *
+ * @param stream The stream to append to.
+ * @param value The bits to append, right-aligned, sent MSB first.
+ * @param count The number of bits to append (1 to 64).
+ */
+static inline void GTTCAN_bitstream_append(gttcan_bitstream_t * const stream, const uint64_t value, const uint32_t count)
+{
+    const uint32_t word = stream->length / 64U;
+    const uint32_t offset = stream->length % 64U;
+    const uint64_t aligned = value << (64U - count);
+    stream->bits[word] |= aligned >> offset;
+    if ((offset + count) > 64U)
+    {
+        stream->bits[word + 1U] |= aligned << (64U - offset);
+    }
+    stream->length += count;
+}
+
+/**
+ * @brief Return 64 bits of a CAN bit stream starting at a given position.
+ *
+ * @param stream The stream to read from.
+ * @param position The position of the first bit to return.
+ * @return The bits, first bit in the most significant bit.
+ */
+static inline uint64_t GTTCAN_bitstream_window(const gttcan_bitstream_t * const stream, const uint32_t position)
+{
+    const uint32_t word = position / 64U;
+    const uint32_t offset = position % 64U;
+    uint64_t window = stream->bits[word] << offset;
+    if ((offset != 0U) && ((word + 1U) < GTTCAN_BITSTREAM_WORDS))
+    {
+        window |= stream->bits[word + 1U] >> (64U - offset);
+    }
+    return window;
+}
+
+/**
+ * @brief Count the stuffing bits of a bit stream, continuing a previous run.
+ *
+ * @param stream The bit stream.
+ * @param last_bit The last bit before the stream (updated).
+ * @param run_length The run length of `last_bit`, 0 if there is no history (updated).
+ * @return The number of stuffing bits inserted on the bus.
+ */
+static uint32_t GTTCAN_count_bitstream_stuffing_bits_from(const gttcan_bitstream_t * const stream, uint8_t * const last_bit, uint8_t * const run_length)
+{
+    uint32_t stuffing_bits = 0U;
+
+    for (uint32_t position = 0U; position < stream->length; position += GTTCAN_STUFFING_CHUNK_BITS)
+    {
+        const uint32_t remaining = stream->length - position;
+        const uint32_t count = (remaining < GTTCAN_STUFFING_CHUNK_BITS) ? remaining : GTTCAN_STUFFING_CHUNK_BITS;
+        stuffing_bits += GTTCAN_count_chunk_stuffing_bits(GTTCAN_bitstream_window(stream, position), count, last_bit, run_length, false);
     }
     return stuffing_bits;
 }
 
+/**
+ * @brief Count the stuffing bits of a serialised CAN frame.
+ *
+ * This function applies the ISO 11898-1 bit stuffing rule to the
+ * given bit stream: after five consecutive bits of the same value,
+ * a complementary bit is inserted, which itself counts towards the
+ * next run.
+ *
+ * @param stream The bit stream, e.g. from GTTCAN_serialise_extended_frame().
+ * @return The number of stuffing bits inserted on the bus.
+ */
+uint32_t GTTCAN_count_bitstream_stuffing_bits(const gttcan_bitstream_t * const stream)
+{
+    uint8_t last_bit = 0U;
+    uint8_t run_length = 0U;
+    return GTTCAN_count_bitstream_stuffing_bits_from(stream, &last_bit, &run_length);
+}
+
 /**
  * @brief Calculate the total number of bits in a CAN frame.
  *
  * This function calculates the number of bits in a CAN frame on the bus.
  * The CAN frame is assumed to be in the format specified by ISO 11898-1.
  * The CRC delimiter and ACK slot are assumed to be present.
+ * As the identifier and CRC are unknown, only the stuffing bits of the
+ * payload are taken into account.  GTTCAN_calculate_extended_frame_bits()
+ * returns the exact length of an extended frame.
  *
  * @param buffer Pointer to the buffer containing the CAN frame.
  * @param length Length of the CAN frame.
@@ -62,8 +419,8 @@ uint32_t GTTCAN_calculate_stuffing_bits(const uint8_t * const buffer, const uint
  */
 uint32_t GTTCAN_calculate_can_frame_bits(const uint8_t * const buffer, const uint32_t length, const bool is_extended)
 {
-    // Fixed bits: SOF(1), Identifier(11 or 29), RTR(1), IDE(1), r0(1), DLC(4), CRC(15), CRC Delimiter(1), ACK Slot(1), ACK Delimiter(1), EOF(7)
-    const uint32_t identifier_bits = is_extended ? 29U : 11U;
+    // Fixed bits: SOF(1), Identifier(11 or 29), SRR(extended only), RTR(1), IDE(1), r1(extended only), r0(1), DLC(4), CRC(15), CRC Delimiter(1), ACK Slot(1), ACK Delimiter(1), EOF(7)
+    const uint32_t identifier_bits = is_extended ? (29U + 1U + 1U) : 11U;
     const uint32_t fixed_bits = 1U + identifier_bits + 1U + 1U + 1U + 4U + 15U + 1U + 1U + 1U + 7U;
     const uint32_t payload_bits = length * 8U; // 8 bits per byte
     const uint32_t stuffing_bits = GTTCAN_calculate_stuffing_bits(buffer, length);
@@ -72,35 +429,187 @@ uint32_t GTTCAN_calculate_can_frame_bits(const uint8_t * const buffer, const uin
 }
 
 /**
- * @brief Compute the CRC-15 of a CAN frame.
+ * @brief Return the first 39 bits of an extended data frame.
  *
- * This function calculates a 15-bit CRC using the polynomial
- * x^15 + x^14 + x^10 + x^8 + x^7 + x^4 + x^3 + 1 (0x4599),
- * which is used in the CAN protocol.
+ * @param id The 29-bit identifier of the frame.
+ * @param length The number of payload bytes (0 to 8).
+ * @return SOF(1), base ID(11), SRR(1), IDE(1), ID extension(18),
+ *         RTR(1), r1(1), r0(1) and DLC(4), right-aligned.
+ */
+static inline uint64_t GTTCAN_extended_frame_header(const uint32_t id, const uint8_t length)
+{
+    return ((uint64_t)((id >> 18U) & 0x7FFU) << 27U) |
+        (0x3ULL << 25U) |
+        ((uint64_t)(id & 0x3FFFFU) << 7U) |
+        ((uint64_t)length & 0xFU);
+}
+
+/**
+ * @brief Return the CAN CRC register after the first 39 bits of an extended data frame.
  *
- * @param buffer Pointer to the buffer containing the CAN frame.
- * @param length The length of the CAN frame.
+ * The CRC covers SOF to the end of the data field; a leading zero
+ * bit does not change it, so the 39 header bits are processed as 5 bytes.
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param length The number of payload bytes (0 to 8).
+ * @return The CRC-15 register.
  */
-uint16_t GTTCAN_crc15(const uint8_t * const buffer, const uint32_t length)
+static inline uint16_t GTTCAN_extended_frame_header_crc(const uint32_t id, const uint8_t length)
 {
-    uint16_t crc = 0x4599U;
-    uint32_t i;
-    for (i = 0U; i < length; i++)
+    const uint64_t header = GTTCAN_extended_frame_header(id, length);
+    uint8_t crc_input[5];
+    for (uint32_t i = 0U; i < 5U; i++)
     {
-        crc ^= (uint16_t)buffer[i] << 7U;
-        for (int j = 0; j < 8; j++)
+        crc_input[i] = (uint8_t)(header >> (32U - (8U * i)));
+    }
+    return GTTCAN_crc15_update(0U, crc_input, 5U);
+}
+
+/**
+ * @brief Serialise an extended CAN data frame into a bit stream.
+ *
+ * This function produces the part of an ISO 11898-1 extended data frame
+ * that is subject to bit stuffing, i.e. SOF, base identifier, SRR, IDE,
+ * identifier extension, RTR, r1, r0, DLC, data field and CRC sequence,
+ * in the order in which the bits are sent on the bus.
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param data Pointer to the payload.
+ * @param length The number of payload bytes (0 to 8).
+ * @param stream The stream receiving the serialised frame.
+ * @return The number of bits in the stream.
+ */
+uint32_t GTTCAN_serialise_extended_frame(const uint32_t id, const uint8_t * const data, const uint8_t length, gttcan_bitstream_t * const stream)
+{
+    const uint8_t payload_length = (length > 8U) ? 8U : length;
+    const uint16_t crc = GTTCAN_crc15_update(GTTCAN_extended_frame_header_crc(id, payload_length), data, payload_length);
+
+    for (uint32_t i = 0U; i < GTTCAN_BITSTREAM_WORDS; i++)
+    {
+        stream->bits[i] = 0U;
+    }
+    stream->length = 0U;
+    GTTCAN_bitstream_append(stream, GTTCAN_extended_frame_header(id, payload_length), 39U);
+    if (payload_length > 0U)
+    {
+        uint64_t payload = 0U;
+        for (uint32_t i = 0U; i < payload_length; i++)
         {
-            if ((crc & 0x4000U) != 0U)
-            {
-                crc = (uint16_t)((unsigned)(crc << 1U) ^ 0x4599U);
-            }
-            else
-            {
-                crc <<= 1U;
-            }
+            payload = (payload << 8U) | data[i];
         }
+        GTTCAN_bitstream_append(stream, payload, (uint32_t)payload_length * 8U);
     }
-    return crc & 0x7FFFU;
+    GTTCAN_bitstream_append(stream, crc, 15U);
+
+    return stream->length;
+}
+
+/**
+ * @brief Pre-compute the identifier and control field of an extended CAN frame.
+ *
+ * The stuffing state and CRC after the first 39 bits of an extended
+ * data frame (SOF to DLC) only depend on the identifier and the payload
+ * length.  This function computes them once so that the length of frames
+ * that share an identifier can be calculated from the payload alone using
+ * GTTCAN_calculate_extended_frame_bits_from_prefix().
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param length The number of payload bytes (0 to 8).
+ * @param prefix The prefix to initialise.
+ */
+void GTTCAN_prepare_extended_frame_prefix(const uint32_t id, const uint8_t length, gttcan_frame_prefix_t * const prefix)
+{
+    const uint8_t payload_length = (length > 8U) ? 8U : length;
+    const uint64_t header = GTTCAN_extended_frame_header(id, payload_length);
+    uint8_t last_bit = 0U;
+    uint8_t run_length = 0U;
+    const uint32_t stuffing_bits = GTTCAN_count_chunk_stuffing_bits(header << 25U, 39U, &last_bit, &run_length, false);
+
+    prefix->id = id;
+    prefix->crc = GTTCAN_extended_frame_header_crc(id, payload_length);
+    prefix->length = payload_length;
+    prefix->stuffing_bits = (uint8_t)stuffing_bits;
+    prefix->last_bit = last_bit;
+    prefix->run_length = run_length;
+}
+
+/**
+ * @brief Calculate the exact number of bits of an extended CAN frame from its prefix.
+ *
+ * Only the data field and CRC sequence are serialised and scanned for
+ * stuffing bits; the identifier and control field are taken from a
+ * prefix computed by GTTCAN_prepare_extended_frame_prefix().
+ *
+ * @param prefix The pre-computed identifier and control field.
+ * @param data Pointer to the payload (`prefix->length` bytes).
+ * @return The number of bits the frame occupies on the bus.
+ */
+uint32_t GTTCAN_calculate_extended_frame_bits_from_prefix(const gttcan_frame_prefix_t * const prefix, const uint8_t * const data)
+{
+    const uint32_t payload_length = prefix->length;
+    const uint16_t crc = GTTCAN_crc15_update(prefix->crc, data, payload_length);
+
+    gttcan_bitstream_t stream = { { 0U }, 0U };
+    if (payload_length > 0U)
+    {
+        uint64_t payload = 0U;
+        for (uint32_t i = 0U; i < payload_length; i++)
+        {
+            payload = (payload << 8U) | data[i];
+        }
+        GTTCAN_bitstream_append(&stream, payload, payload_length * 8U);
+    }
+    GTTCAN_bitstream_append(&stream, crc, 15U);
+
+    uint8_t last_bit = prefix->last_bit;
+    uint8_t run_length = prefix->run_length;
+    const uint32_t stuffing_bits = (uint32_t)prefix->stuffing_bits + GTTCAN_count_bitstream_stuffing_bits_from(&stream, &last_bit, &run_length);
+    // Header(39), CRC Delimiter(1), ACK Slot(1), ACK Delimiter(1), EOF(7)
+    return 39U + stream.length + stuffing_bits + 1U + 1U + 1U + 7U;
+}
+
+/**
+ * @brief Calculate the exact number of bits of an extended CAN frame.
+ *
+ * This function serialises the frame, counts its stuffing bits,
+ * and adds the unstuffed CRC delimiter, ACK slot, ACK delimiter,
+ * and end-of-frame bits.  Interframe space is not included.
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param data Pointer to the payload.
+ * @param length The number of payload bytes (0 to 8).
+ * @return The number of bits the frame occupies on the bus.
+ */
+uint32_t GTTCAN_calculate_extended_frame_bits(const uint32_t id, const uint8_t * const data, const uint8_t length)
+{
+    gttcan_frame_prefix_t prefix;
+    GTTCAN_prepare_extended_frame_prefix(id, length, &prefix);
+    return GTTCAN_calculate_extended_frame_bits_from_prefix(&prefix, data);
+}
+
+/**
+ * @brief Calculate an upper bound on the number of bits of an extended CAN frame.
+ *
+ * The identifier and control field are stuffed exactly (see
+ * GTTCAN_prepare_extended_frame_prefix()); for the data field and CRC
+ * sequence, whose content is unknown, every stuffing opportunity is
+ * assumed to be taken: the first after the run left by the DLC, then
+ * one every four bits.  Interframe space is not included.
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param length The number of payload bytes (0 to 8).
+ * @return The largest number of bits a frame with this identifier and
+ *         length can occupy on the bus.
+ */
+uint32_t GTTCAN_calculate_extended_frame_max_bits(const uint32_t id, const uint8_t length)
+{
+    gttcan_frame_prefix_t prefix;
+    GTTCAN_prepare_extended_frame_prefix(id, length, &prefix);
+    const uint32_t stuffed_bits = ((uint32_t)prefix.length * 8U) + 15U; // data field and CRC sequence
+    const uint32_t first_stuffing = 5U - (uint32_t)prefix.run_length;
+    const uint32_t stuffing_bits = (stuffed_bits >= first_stuffing) ? (1U + ((stuffed_bits - first_stuffing) / 4U)) : 0U;
+    // Header(39), CRC Delimiter(1), ACK Slot(1), ACK Delimiter(1), EOF(7)
+    return 39U + stuffed_bits + (uint32_t)prefix.stuffing_bits + stuffing_bits + 1U + 1U + 1U + 7U;
 }
 
 /**
@@ -123,3 +632,420 @@ uint32_t GTTCAN_append_crc_to_can_frame(uint8_t * const frame, const uint32_t le
 
     return len;
 }
+
+/// CRC-17 polynomial of CAN FD (payloads of up to 16 bytes)
+#define GTTCAN_CRC17_POLYNOMIAL 0x1685BU
+/// CRC-21 polynomial of CAN FD (payloads of more than 16 bytes)
+#define GTTCAN_CRC21_POLYNOMIAL 0x102899U
+/// Initial CRC-17 register of ISO 11898-1:2015
+#define GTTCAN_CRC17_INIT 0x10000U
+/// Initial CRC-21 register of ISO 11898-1:2015
+#define GTTCAN_CRC21_INIT 0x100000U
+/// Bits of an extended CAN FD frame from SOF to BRS, sent at the nominal bit rate
+#define GTTCAN_FD_ARBITRATION_BITS 36U
+
+/**
+ * @brief CRC-17 of every 4-bit value in the top bits of the register.
+ *
+ * Folds a nibble per lookup into the register of a byte of the data
+ * field that has no stuffing bit, see GTTCAN_fd_push_byte().
+ */
+static const uint32_t GTTCAN_crc17_nibbles[16] =
+{
+    0x000000U, 0x01685BU, 0x01B8EDU, 0x00D0B6U, 0x001981U, 0x0171DAU, 0x01A16CU, 0x00C937U,
+    0x003302U, 0x015B59U, 0x018BEFU, 0x00E3B4U, 0x002A83U, 0x0142D8U, 0x01926EU, 0x00FA35U
+};
+
+/**
+ * @brief CRC-21 of every 4-bit value in the top bits of the register.
+ */
+static const uint32_t GTTCAN_crc21_nibbles[16] =
+{
+    0x000000U, 0x102899U, 0x1079ABU, 0x005132U, 0x10DBCFU, 0x00F356U, 0x00A264U, 0x108AFDU,
+    0x119F07U, 0x01B79EU, 0x01E6ACU, 0x11CE35U, 0x0144C8U, 0x116C51U, 0x113D63U, 0x0115FAU
+};
+
+/**
+ * @brief Payload lengths of the CAN FD data length codes.
+ */
+static const uint8_t GTTCAN_fd_lengths[16] =
+{
+    0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 12U, 16U, 20U, 24U, 32U, 48U, 64U
+};
+
+/**
+ * @brief Return the payload length of a CAN FD data length code.
+ *
+ * @param dlc The data length code (0 to 15).
+ * @return The number of payload bytes.
+ */
+uint8_t GTTCAN_fd_dlc_to_length(const uint8_t dlc)
+{
+    return GTTCAN_fd_lengths[dlc & 0xFU];
+}
+
+/**
+ * @brief Return the smallest CAN FD data length code that holds a payload.
+ *
+ * @param length The number of payload bytes (payloads above 64 bytes
+ *               are truncated to 64).
+ * @return The data length code (0 to 15).
+ */
+uint8_t GTTCAN_fd_length_to_dlc(const uint8_t length)
+{
+    uint8_t dlc = 0U;
+    while ((dlc < 15U) && (GTTCAN_fd_lengths[dlc] < length))
+    {
+        dlc++;
+    }
+    return dlc;
+}
+
+/**
+ * @brief State of a bit-serial CAN FD frame serialiser.
+ *
+ * Tracks the CRC register over the stuffed bit stream (ISO 11898-1:2015
+ * includes the dynamic stuffing bits in the CRC) and the stuffing bits
+ * before and after the bit rate switch.
+ */
+typedef struct gttcan_fd_serialiser_s {
+    uint32_t crc;              // CRC register
+    uint32_t polynomial;       // CRC-17 or CRC-21 polynomial
+    const uint32_t *nibbles;   // GTTCAN_crc17_nibbles or GTTCAN_crc21_nibbles
+    uint32_t width;            // CRC width in bits
+    uint32_t bits;             // frame bits pushed so far, without stuffing bits
+    uint32_t nominal_stuffing; // stuffing bits up to the BRS bit
+    uint32_t data_stuffing;    // stuffing bits after the BRS bit
+    uint8_t last_bit;
+    uint8_t run_length;
+} gttcan_fd_serialiser_t;
+
+/**
+ * @brief Fold one bit into a CRC-17 or CRC-21 register.
+ */
+static inline uint32_t GTTCAN_crc_fd_bit(const uint32_t crc, const uint32_t polynomial, const uint32_t width, const uint32_t bit)
+{
+    const uint32_t mask = ((uint32_t)1U << width) - 1U;
+    const uint32_t feedback = ((crc >> (width - 1U)) ^ bit) & 1U;
+    const uint32_t shifted = (crc << 1U) & mask;
+    return (feedback != 0U) ? (shifted ^ polynomial) : shifted;
+}
+
+/**
+ * @brief Fold a bit string (MSB first) into a CRC-17 or CRC-21 register.
+ */
+static uint32_t GTTCAN_crc_fd_update(const uint32_t crc, const uint32_t polynomial, const uint32_t width, const uint8_t * const buffer, const uint32_t bits)
+{
+    uint32_t reg = crc;
+    for (uint32_t i = 0U; i < bits; i++)
+    {
+        reg = GTTCAN_crc_fd_bit(reg, polynomial, width, ((uint32_t)buffer[i / 8U] >> (7U - (i % 8U))) & 1U);
+    }
+    return reg;
+}
+
+/**
+ * @brief Compute the CAN FD CRC-17 of a bit string.
+ *
+ * Uses the polynomial 0x1685B and the initial value 2^16 of
+ * ISO 11898-1:2015; used for payloads of up to 16 bytes.
+ *
+ * @param buffer The bits, most significant bit of the first byte first.
+ * @param bits The number of bits.
+ * @return The 17-bit CRC.
+ */
+uint32_t GTTCAN_crc17(const uint8_t * const buffer, const uint32_t bits)
+{
+    return GTTCAN_crc_fd_update(GTTCAN_CRC17_INIT, GTTCAN_CRC17_POLYNOMIAL, 17U, buffer, bits);
+}
+
+/**
+ * @brief Compute the CAN FD CRC-21 of a bit string.
+ *
+ * Uses the polynomial 0x102899 and the initial value 2^20 of
+ * ISO 11898-1:2015; used for payloads of more than 16 bytes.
+ *
+ * @param buffer The bits, most significant bit of the first byte first.
+ * @param bits The number of bits.
+ * @return The 21-bit CRC.
+ */
+uint32_t GTTCAN_crc21(const uint8_t * const buffer, const uint32_t bits)
+{
+    return GTTCAN_crc_fd_update(GTTCAN_CRC21_INIT, GTTCAN_CRC21_POLYNOMIAL, 21U, buffer, bits);
+}
+
+/**
+ * @brief Push a bit of the dynamically stuffed part of a CAN FD frame.
+ *
+ * A stuffing bit that follows the BRS bit (bit 35) is sent at the
+ * data bit rate.
+ */
+static inline void GTTCAN_fd_push_bit(gttcan_fd_serialiser_t * const serialiser, const uint8_t bit)
+{
+    serialiser->crc = GTTCAN_crc_fd_bit(serialiser->crc, serialiser->polynomial, serialiser->width, bit);
+    serialiser->bits++;
+    if ((serialiser->run_length > 0U) && (bit == serialiser->last_bit))
+    {
+        serialiser->run_length++;
+    }
+    else
+    {
+        serialiser->last_bit = bit;
+        serialiser->run_length = 1U;
+    }
+    if (serialiser->run_length == 5U)
+    {
+        const uint8_t stuffing = bit ^ 1U;
+        serialiser->crc = GTTCAN_crc_fd_bit(serialiser->crc, serialiser->polynomial, serialiser->width, stuffing);
+        if (serialiser->bits < GTTCAN_FD_ARBITRATION_BITS)
+        {
+            serialiser->nominal_stuffing++;
+        }
+        else
+        {
+            serialiser->data_stuffing++;
+        }
+        serialiser->last_bit = stuffing;
+        serialiser->run_length = 1U;
+    }
+}
+
+/**
+ * @brief Push bits (MSB first) of the dynamically stuffed part of a CAN FD frame.
+ */
+static void GTTCAN_fd_push_bits(gttcan_fd_serialiser_t * const serialiser, const uint32_t value, const uint32_t count)
+{
+    for (uint32_t i = count; i > 0U; i--)
+    {
+        GTTCAN_fd_push_bit(serialiser, (uint8_t)((value >> (i - 1U)) & 1U));
+    }
+}
+
+/**
+ * @brief Push a byte of the data field of a CAN FD frame.
+ *
+ * Most bytes of a payload, together with the run of equal bits before
+ * them, contain no run of five equal bits.  Such a byte is folded into
+ * the CRC a nibble at a time; only a byte that needs a stuffing bit is
+ * pushed bit by bit.
+ */
+static void GTTCAN_fd_push_byte(gttcan_fd_serialiser_t * const serialiser, const uint8_t byte)
+{
+    const uint32_t run_length = serialiser->run_length; // 1 to 4 after the DLC
+    const uint32_t run = (serialiser->last_bit != 0U) ? (((uint32_t)1U << run_length) - 1U) : 0U;
+    const uint32_t window = (run << 8U) | byte;
+    // Equal neighbours within the run and the byte; four in a row are five equal bits.
+    const uint32_t equal = ~(window ^ (window >> 1U)) & (((uint32_t)1U << (run_length + 7U)) - 1U);
+    if ((equal & (equal >> 1U) & (equal >> 2U) & (equal >> 3U)) != 0U)
+    {
+        GTTCAN_fd_push_bits(serialiser, byte, 8U);
+        return; // cppcheck-suppress misra-c2012-15.5
+    }
+    const uint32_t mask = ((uint32_t)1U << serialiser->width) - 1U;
+    const uint32_t shift = serialiser->width - 4U;
+    uint32_t crc = serialiser->crc;
+    crc = ((crc << 4U) & mask) ^ serialiser->nibbles[((crc >> shift) ^ ((uint32_t)byte >> 4U)) & 0xFU];
+    crc = ((crc << 4U) & mask) ^ serialiser->nibbles[((crc >> shift) ^ (uint32_t)byte) & 0xFU];
+    serialiser->crc = crc;
+    serialiser->bits += 8U;
+    // The byte is not all equal bits, so the trailing run ends within it.
+    const uint8_t last_bit = byte & 1U;
+    uint8_t trailing = 1U;
+    while ((((uint32_t)byte >> trailing) & 1U) == last_bit)
+    {
+        trailing++;
+    }
+    serialiser->last_bit = last_bit;
+    serialiser->run_length = trailing;
+}
+
+/**
+ * @brief Serialise the identifier and control field of an extended CAN FD frame.
+ *
+ * Pushes SOF, base identifier, SRR, IDE, identifier extension, RRS,
+ * FDF, res, BRS, ESI and DLC (41 bits).
+ */
+static void GTTCAN_fd_push_header(gttcan_fd_serialiser_t * const serialiser, const uint32_t id, const uint8_t dlc, const bool brs)
+{
+    const uint32_t payload_length = GTTCAN_fd_dlc_to_length(dlc);
+    serialiser->width = (payload_length > 16U) ? 21U : 17U;
+    serialiser->polynomial = (payload_length > 16U) ? GTTCAN_CRC21_POLYNOMIAL : GTTCAN_CRC17_POLYNOMIAL;
+    serialiser->nibbles = (payload_length > 16U) ? GTTCAN_crc21_nibbles : GTTCAN_crc17_nibbles;
+    serialiser->crc = (payload_length > 16U) ? GTTCAN_CRC21_INIT : GTTCAN_CRC17_INIT;
+    serialiser->bits = 0U;
+    serialiser->nominal_stuffing = 0U;
+    serialiser->data_stuffing = 0U;
+    serialiser->last_bit = 0U;
+    serialiser->run_length = 0U;
+    GTTCAN_fd_push_bits(serialiser, 0U, 1U);                  // SOF
+    GTTCAN_fd_push_bits(serialiser, (id >> 18U) & 0x7FFU, 11U); // base identifier
+    GTTCAN_fd_push_bits(serialiser, 0x3U, 2U);                // SRR, IDE
+    GTTCAN_fd_push_bits(serialiser, id & 0x3FFFFU, 18U);      // identifier extension
+    GTTCAN_fd_push_bits(serialiser, 0x2U, 3U);                // RRS, FDF, res
+    GTTCAN_fd_push_bits(serialiser, brs ? 1U : 0U, 1U);       // BRS
+    GTTCAN_fd_push_bits(serialiser, 0U, 1U);                  // ESI (error active)
+    GTTCAN_fd_push_bits(serialiser, dlc, 4U);
+}
+
+/**
+ * @brief Split the bits of a CAN FD frame between the two bit rates.
+ *
+ * @param serialiser The serialiser after the data field.
+ * @param brs Whether the bit rate is switched.
+ * @param bits Receives the bit counts.
+ * @return The total number of bits.
+ */
+static uint32_t GTTCAN_fd_frame_bits(const gttcan_fd_serialiser_t * const serialiser, const bool brs, gttcan_fd_frame_bits_t * const bits)
+{
+    // Stuff count (4) and CRC with a fixed stuffing bit before every four bits, CRC delimiter
+    const uint32_t crc_field = 4U + serialiser->width;
+    const uint32_t crc_bits = crc_field + ((crc_field + 3U) / 4U) + 1U;
+    const uint32_t nominal = GTTCAN_FD_ARBITRATION_BITS + serialiser->nominal_stuffing + 1U + 1U + 7U; // ACK slot, ACK delimiter, EOF
+    const uint32_t data = (serialiser->bits - GTTCAN_FD_ARBITRATION_BITS) + serialiser->data_stuffing + crc_bits;
+    bits->nominal_bits = brs ? nominal : (nominal + data);
+    bits->data_bits = brs ? data : 0U;
+    bits->stuffing_bits = serialiser->nominal_stuffing + serialiser->data_stuffing;
+    return nominal + data;
+}
+
+/**
+ * @brief Pre-compute the identifier and control field of an extended CAN FD frame.
+ *
+ * The stuffing state and CRC after the first 41 bits of an extended
+ * CAN FD frame (SOF to DLC) only depend on the identifier, the payload
+ * length and the bit rate switch.  This function computes them once so
+ * that the length of frames that share them can be calculated from the
+ * payload alone using GTTCAN_calculate_fd_frame_bits_from_prefix().
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param length The number of payload bytes (0 to 64).
+ * @param brs Whether the bit rate is switched for the data phase.
+ * @param prefix The prefix to initialise.
+ */
+void GTTCAN_prepare_fd_frame_prefix(const uint32_t id, const uint8_t length, const bool brs, gttcan_fd_frame_prefix_t * const prefix)
+{
+    const uint8_t payload_length = (length > GTTCAN_FD_MAX_PAYLOAD) ? (uint8_t)GTTCAN_FD_MAX_PAYLOAD : length;
+    const uint8_t dlc = GTTCAN_fd_length_to_dlc(payload_length);
+    gttcan_fd_serialiser_t serialiser;
+    GTTCAN_fd_push_header(&serialiser, id, dlc, brs);
+    prefix->id = id;
+    prefix->crc = serialiser.crc;
+    prefix->length = payload_length;
+    prefix->dlc = dlc;
+    prefix->brs = brs ? 1U : 0U;
+    prefix->nominal_stuffing = (uint8_t)serialiser.nominal_stuffing;
+    prefix->data_stuffing = (uint8_t)serialiser.data_stuffing;
+    prefix->last_bit = serialiser.last_bit;
+    prefix->run_length = serialiser.run_length;
+}
+
+/**
+ * @brief Calculate the exact number of bits of an extended CAN FD frame from its prefix.
+ *
+ * Only the data field, stuff count and CRC are serialised; the
+ * identifier and control field are taken from a prefix computed by
+ * GTTCAN_prepare_fd_frame_prefix().  The result is the same as that of
+ * GTTCAN_calculate_fd_frame_bits().
+ *
+ * @param prefix The pre-computed identifier and control field.
+ * @param data Pointer to the payload (`prefix->length` bytes).
+ * @param bits Receives the bits at each bit rate, the number of
+ *             dynamic stuffing bits, the stuff count field and the CRC.
+ * @return The number of bits the frame occupies on the bus.
+ */
+uint32_t GTTCAN_calculate_fd_frame_bits_from_prefix(const gttcan_fd_frame_prefix_t * const prefix, const uint8_t * const data, gttcan_fd_frame_bits_t * const bits)
+{
+    const uint32_t padded_length = GTTCAN_fd_dlc_to_length(prefix->dlc);
+    gttcan_fd_serialiser_t serialiser;
+    serialiser.width = (padded_length > 16U) ? 21U : 17U;
+    serialiser.polynomial = (padded_length > 16U) ? GTTCAN_CRC21_POLYNOMIAL : GTTCAN_CRC17_POLYNOMIAL;
+    serialiser.nibbles = (padded_length > 16U) ? GTTCAN_crc21_nibbles : GTTCAN_crc17_nibbles;
+    serialiser.crc = prefix->crc;
+    serialiser.bits = GTTCAN_FD_ARBITRATION_BITS + 5U; // ESI and DLC
+    serialiser.nominal_stuffing = prefix->nominal_stuffing;
+    serialiser.data_stuffing = prefix->data_stuffing;
+    serialiser.last_bit = prefix->last_bit;
+    serialiser.run_length = prefix->run_length;
+    for (uint32_t i = 0U; i < padded_length; i++)
+    {
+        GTTCAN_fd_push_byte(&serialiser, (i < prefix->length) ? data[i] : 0U);
+    }
+    // Stuffing bits modulo 8, Gray coded, with even parity
+    const uint32_t count = (serialiser.nominal_stuffing + serialiser.data_stuffing) & 0x7U;
+    const uint32_t gray = count ^ (count >> 1U);
+    const uint32_t parity = (gray ^ (gray >> 1U) ^ (gray >> 2U)) & 1U;
+    bits->stuff_count = (uint8_t)((gray << 1U) | parity);
+    uint32_t crc = serialiser.crc;
+    for (uint32_t i = 4U; i > 0U; i--)
+    {
+        crc = GTTCAN_crc_fd_bit(crc, serialiser.polynomial, serialiser.width, ((uint32_t)bits->stuff_count >> (i - 1U)) & 1U);
+    }
+    bits->crc = crc;
+    return GTTCAN_fd_frame_bits(&serialiser, prefix->brs != 0U, bits);
+}
+
+/**
+ * @brief Calculate the exact number of bits of an extended CAN FD frame.
+ *
+ * The payload is padded with zero bytes to the next CAN FD length.
+ * Stuffing bits of the identifier, control and data field and the
+ * fixed stuffing bits of the CRC field are counted; interframe space
+ * is not included.  With a bit rate switch, the bits from the BRS
+ * sample point to the CRC delimiter are sent at the data bit rate.
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param data Pointer to the payload.
+ * @param length The number of payload bytes (0 to 64).
+ * @param brs Whether the bit rate is switched for the data phase.
+ * @param bits Receives the bits at each bit rate, the number of
+ *             dynamic stuffing bits, the stuff count field and the CRC.
+ * @return The number of bits the frame occupies on the bus.
+ */
+uint32_t GTTCAN_calculate_fd_frame_bits(const uint32_t id, const uint8_t * const data, const uint8_t length, const bool brs, gttcan_fd_frame_bits_t * const bits)
+{
+    gttcan_fd_frame_prefix_t prefix;
+    GTTCAN_prepare_fd_frame_prefix(id, length, brs, &prefix);
+    return GTTCAN_calculate_fd_frame_bits_from_prefix(&prefix, data, bits);
+}
+
+/**
+ * @brief Calculate an upper bound on the number of bits of an extended CAN FD frame.
+ *
+ * Like GTTCAN_calculate_extended_frame_max_bits(): the identifier and
+ * control field are stuffed exactly, and every stuffing opportunity of
+ * the data field is assumed to be taken.  `stuff_count` and `crc` of
+ * `bits` are set to 0.
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param length The number of payload bytes (0 to 64).
+ * @param brs Whether the bit rate is switched for the data phase.
+ * @param bits Receives the bits at each bit rate and the number of dynamic stuffing bits.
+ * @return The largest number of bits a frame with this identifier and
+ *         length can occupy on the bus.
+ */
+uint32_t GTTCAN_calculate_fd_frame_max_bits(const uint32_t id, const uint8_t length, const bool brs, gttcan_fd_frame_bits_t * const bits)
+{
+    const uint8_t dlc = GTTCAN_fd_length_to_dlc((length > GTTCAN_FD_MAX_PAYLOAD) ? (uint8_t)GTTCAN_FD_MAX_PAYLOAD : length);
+    gttcan_fd_serialiser_t serialiser;
+    GTTCAN_fd_push_header(&serialiser, id, dlc, brs);
+    const uint32_t data_bits = (uint32_t)GTTCAN_fd_dlc_to_length(dlc) * 8U;
+    const uint32_t first_stuffing = 5U - (uint32_t)serialiser.run_length;
+    serialiser.data_stuffing += (data_bits >= first_stuffing) ? (1U + ((data_bits - first_stuffing) / 4U)) : 0U;
+    serialiser.bits += data_bits;
+    bits->stuff_count = 0U;
+    bits->crc = 0U;
+    return GTTCAN_fd_frame_bits(&serialiser, brs, bits);
+}
+
+/**
+ * @brief Return the duration of a CAN FD frame.
+ *
+ * @param bits The bits of the frame at each bit rate.
+ * @param nominal_bit_time The duration of a bit at the nominal bit rate.
+ * @param data_bit_time The duration of a bit at the data bit rate.
+ * @return The duration, in the unit of the bit times.
+ */
+uint32_t GTTCAN_fd_frame_duration(const gttcan_fd_frame_bits_t * const bits, const uint32_t nominal_bit_time, const uint32_t data_bit_time)
+{
+    return (bits->nominal_bits * nominal_bit_time) + (bits->data_bits * data_bit_time);
+}
@@ -0,0 +1,133 @@
+/**
+ * @file clock.c
+ * @brief Global time interpolated between reference frames.
+ */
+#include "gttcan.h"
+#include "gttcan_clock.h"
+
+/**
+ * @brief Initialise a global clock without an anchor.
+ *
+ * @param global_clock The clock.
+ */
+void GTTCAN_clock_init(gttcan_clock_t *global_clock)
+{
+    GTTCAN_ATOMIC_INIT(global_clock->sequence, 0U);
+    for (uint32_t i = 0U; i < 2U; i++)
+    {
+        GTTCAN_ATOMIC_INIT(global_clock->copies[i].time_high, 0U);
+        GTTCAN_ATOMIC_INIT(global_clock->copies[i].time_low, 0U);
+        GTTCAN_ATOMIC_INIT(global_clock->copies[i].local, 0U);
+        GTTCAN_ATOMIC_INIT(global_clock->copies[i].drift, 0U);
+    }
+    global_clock->reference = 0U;
+}
+
+/**
+ * @brief Read a consistent snapshot of the last anchor.
+ *
+ * May be called from any context, concurrently with the GTTCAN instance.
+ *
+ * @param global_clock The clock.
+ * @param anchor Receives the anchor.
+ */
+void GTTCAN_clock_read(const gttcan_clock_t *global_clock, gttcan_clock_anchor_t *anchor)
+{
+    uint32_t sequence = GTTCAN_ATOMIC_LOAD(global_clock->sequence, acquire);
+    uint32_t check;
+    do
+    {
+        const gttcan_clock_copy_t * const copy = &global_clock->copies[sequence & 1U];
+        const uint32_t high = GTTCAN_ATOMIC_LOAD(copy->time_high, relaxed);
+        const uint32_t low = GTTCAN_ATOMIC_LOAD(copy->time_low, relaxed);
+        anchor->local = GTTCAN_ATOMIC_LOAD(copy->local, relaxed);
+        anchor->drift = (int32_t)GTTCAN_ATOMIC_LOAD(copy->drift, relaxed);
+        anchor->time = ((uint64_t)high << 32U) | (uint64_t)low;
+        GTTCAN_ATOMIC_FENCE(acquire);
+        check = sequence;
+        sequence = GTTCAN_ATOMIC_LOAD(global_clock->sequence, acquire);
+    } while (sequence != check);
+    anchor->generation = sequence;
+}
+
+/**
+ * @brief Return the network time at a local time, extrapolated from an anchor.
+ *
+ * The local time may lie up to 2^31 NTU before or after the anchor;
+ * the 32-bit local clock may wrap in between.
+ *
+ * @param anchor The anchor.
+ * @param local_now The local time in NTU.
+ * @return The network time in NTU (62 bits).
+ */
+uint64_t GTTCAN_clock_extrapolate(const gttcan_clock_anchor_t *anchor, uint32_t local_now)
+{
+    // The wrapping difference, taken as signed so that a local time read
+    // just before the anchor was published does not count as 2^32 NTU later.
+    const int64_t elapsed = (int64_t)(int32_t)(local_now - anchor->local);
+    const int64_t correction = (elapsed * (int64_t)anchor->drift) / ((int64_t)1 << 32U);
+    return (anchor->time + (uint64_t)(elapsed + correction)) & 0x3FFFFFFFFFFFFFFFULL;
+}
+
+/**
+ * @brief Attach a global clock.
+ *
+ * With a clock attached, every reference frame records the network
+ * time and the local time of its start, from which
+ * GTTCAN_get_global_time() interpolates.  The driver has to report
+ * its `current_time` reference with GTTCAN_set_local_reference().
+ * See gttcan_clock.h.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param global_clock The clock (initialised with GTTCAN_clock_init()),
+ *                     or NULL to stop keeping the global time.
+ */
+void GTTCAN_set_global_clock(gttcan_t *gttcan, gttcan_clock_t *global_clock)
+{
+    gttcan->global_clock = global_clock;
+}
+
+/**
+ * @brief Report the local time from which `current_time` is counted.
+ *
+ * Should be called by the driver whenever it moves the reference of
+ * `current_time`: in the transmit callback, and before passing a
+ * start-of-schedule frame to GTTCAN_process_frame() while the node
+ * has not transmitted.  Does nothing without a global clock.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param local_reference The reference on the free-running local clock in NTU.
+ */
+void GTTCAN_set_local_reference(gttcan_t *gttcan, uint32_t local_reference)
+{
+    if (gttcan->global_clock != (struct gttcan_clock_s *)0)
+    {
+        gttcan->global_clock->reference = local_reference;
+    }
+}
+
+/**
+ * @brief Return the network time at a local time.
+ *
+ * The network time of the last reference frame, plus the local time
+ * since its start corrected by the drift estimate of the clock servo
+ * (without the servo, the local clock is assumed to run at the
+ * nominal rate; on the time master, the network time is its own).
+ * May be called from any thread or interrupt; see gttcan_clock.h.
+ *
+ * @param gttcan The GTTCAN instance, with a global clock attached.
+ * @param local_now The local time on the clock of GTTCAN_set_local_reference(),
+ *                  at most 2^31 NTU after the last reference frame.
+ * @return The network time in NTU (62 bits), or 0 if no clock is
+ *         attached or no reference frame was seen yet.
+ */
+uint64_t GTTCAN_get_global_time(const gttcan_t *gttcan, uint32_t local_now)
+{
+    if (gttcan->global_clock == (struct gttcan_clock_s *)0)
+    {
+        return 0U; // cppcheck-suppress misra-c2012-15.5
+    }
+    gttcan_clock_anchor_t anchor;
+    GTTCAN_clock_read(gttcan->global_clock, &anchor);
+    return (anchor.generation == 0U) ? 0U : GTTCAN_clock_extrapolate(&anchor, local_now);
+}
@@ -0,0 +1,303 @@
+/**
+ * @file crc15_tables.h
+ * @brief Lookup tables for the table-driven CRC-15 implementation.
+ *
+ * Table 0 holds the CRC-15 remainder of each byte value shifted
+ * into the top of the register, i.e. one full byte step of the
+ * bit-serial algorithm.  Table k holds the remainder of the same
+ * byte followed by k zero bytes, which allows GTTCAN_crc15() to
+ * fold 4 or 8 bytes per iteration (slicing-by-4/8).
+ *
+ * This file is private to cansupport.c and only provides the
+ * tables selected by #GTTCAN_CRC15_SLICES.
+ */
+#ifndef CRC15_TABLES_H
+#define CRC15_TABLES_H
+
+#include <stdint.h>
+
+#include "gttcan.h"
+
+#if GTTCAN_CRC15_SLICES > 0
+static const uint16_t GTTCAN_crc15_table[GTTCAN_CRC15_SLICES][256] =
+{
+    {
+        0x0000U, 0x4599U, 0x4EABU, 0x0B32U, 0x58CFU, 0x1D56U, 0x1664U, 0x53FDU,
+        0x7407U, 0x319EU, 0x3AACU, 0x7F35U, 0x2CC8U, 0x6951U, 0x6263U, 0x27FAU,
+        0x2D97U, 0x680EU, 0x633CU, 0x26A5U, 0x7558U, 0x30C1U, 0x3BF3U, 0x7E6AU,
+        0x5990U, 0x1C09U, 0x173BU, 0x52A2U, 0x015FU, 0x44C6U, 0x4FF4U, 0x0A6DU,
+        0x5B2EU, 0x1EB7U, 0x1585U, 0x501CU, 0x03E1U, 0x4678U, 0x4D4AU, 0x08D3U,
+        0x2F29U, 0x6AB0U, 0x6182U, 0x241BU, 0x77E6U, 0x327FU, 0x394DU, 0x7CD4U,
+        0x76B9U, 0x3320U, 0x3812U, 0x7D8BU, 0x2E76U, 0x6BEFU, 0x60DDU, 0x2544U,
+        0x02BEU, 0x4727U, 0x4C15U, 0x098CU, 0x5A71U, 0x1FE8U, 0x14DAU, 0x5143U,
+        0x73C5U, 0x365CU, 0x3D6EU, 0x78F7U, 0x2B0AU, 0x6E93U, 0x65A1U, 0x2038U,
+        0x07C2U, 0x425BU, 0x4969U, 0x0CF0U, 0x5F0DU, 0x1A94U, 0x11A6U, 0x543FU,
+        0x5E52U, 0x1BCBU, 0x10F9U, 0x5560U, 0x069DU, 0x4304U, 0x4836U, 0x0DAFU,
+        0x2A55U, 0x6FCCU, 0x64FEU, 0x2167U, 0x729AU, 0x3703U, 0x3C31U, 0x79A8U,
+        0x28EBU, 0x6D72U, 0x6640U, 0x23D9U, 0x7024U, 0x35BDU, 0x3E8FU, 0x7B16U,
+        0x5CECU, 0x1975U, 0x1247U, 0x57DEU, 0x0423U, 0x41BAU, 0x4A88U, 0x0F11U,
+        0x057CU, 0x40E5U, 0x4BD7U, 0x0E4EU, 0x5DB3U, 0x182AU, 0x1318U, 0x5681U,
+        0x717BU, 0x34E2U, 0x3FD0U, 0x7A49U, 0x29B4U, 0x6C2DU, 0x671FU, 0x2286U,
+        0x2213U, 0x678AU, 0x6CB8U, 0x2921U, 0x7ADCU, 0x3F45U, 0x3477U, 0x71EEU,
+        0x5614U, 0x138DU, 0x18BFU, 0x5D26U, 0x0EDBU, 0x4B42U, 0x4070U, 0x05E9U,
+        0x0F84U, 0x4A1DU, 0x412FU, 0x04B6U, 0x574BU, 0x12D2U, 0x19E0U, 0x5C79U,
+        0x7B83U, 0x3E1AU, 0x3528U, 0x70B1U, 0x234CU, 0x66D5U, 0x6DE7U, 0x287EU,
+        0x793DU, 0x3CA4U, 0x3796U, 0x720FU, 0x21F2U, 0x646BU, 0x6F59U, 0x2AC0U,
+        0x0D3AU, 0x48A3U, 0x4391U, 0x0608U, 0x55F5U, 0x106CU, 0x1B5EU, 0x5EC7U,
+        0x54AAU, 0x1133U, 0x1A01U, 0x5F98U, 0x0C65U, 0x49FCU, 0x42CEU, 0x0757U,
+        0x20ADU, 0x6534U, 0x6E06U, 0x2B9FU, 0x7862U, 0x3DFBU, 0x36C9U, 0x7350U,
+        0x51D6U, 0x144FU, 0x1F7DU, 0x5AE4U, 0x0919U, 0x4C80U, 0x47B2U, 0x022BU,
+        0x25D1U, 0x6048U, 0x6B7AU, 0x2EE3U, 0x7D1EU, 0x3887U, 0x33B5U, 0x762CU,
+        0x7C41U, 0x39D8U, 0x32EAU, 0x7773U, 0x248EU, 0x6117U, 0x6A25U, 0x2FBCU,
+        0x0846U, 0x4DDFU, 0x46EDU, 0x0374U, 0x5089U, 0x1510U, 0x1E22U, 0x5BBBU,
+        0x0AF8U, 0x4F61U, 0x4453U, 0x01CAU, 0x5237U, 0x17AEU, 0x1C9CU, 0x5905U,
+        0x7EFFU, 0x3B66U, 0x3054U, 0x75CDU, 0x2630U, 0x63A9U, 0x689BU, 0x2D02U,
+        0x276FU, 0x62F6U, 0x69C4U, 0x2C5DU, 0x7FA0U, 0x3A39U, 0x310BU, 0x7492U,
+        0x5368U, 0x16F1U, 0x1DC3U, 0x585AU, 0x0BA7U, 0x4E3EU, 0x450CU, 0x0095U
+    },
+#if GTTCAN_CRC15_SLICES >= 4
+    {
+        0x0000U, 0x4426U, 0x4DD5U, 0x09F3U, 0x5E33U, 0x1A15U, 0x13E6U, 0x57C0U,
+        0x79FFU, 0x3DD9U, 0x342AU, 0x700CU, 0x27CCU, 0x63EAU, 0x6A19U, 0x2E3FU,
+        0x3667U, 0x7241U, 0x7BB2U, 0x3F94U, 0x6854U, 0x2C72U, 0x2581U, 0x61A7U,
+        0x4F98U, 0x0BBEU, 0x024DU, 0x466BU, 0x11ABU, 0x558DU, 0x5C7EU, 0x1858U,
+        0x6CCEU, 0x28E8U, 0x211BU, 0x653DU, 0x32FDU, 0x76DBU, 0x7F28U, 0x3B0EU,
+        0x1531U, 0x5117U, 0x58E4U, 0x1CC2U, 0x4B02U, 0x0F24U, 0x06D7U, 0x42F1U,
+        0x5AA9U, 0x1E8FU, 0x177CU, 0x535AU, 0x049AU, 0x40BCU, 0x494FU, 0x0D69U,
+        0x2356U, 0x6770U, 0x6E83U, 0x2AA5U, 0x7D65U, 0x3943U, 0x30B0U, 0x7496U,
+        0x1C05U, 0x5823U, 0x51D0U, 0x15F6U, 0x4236U, 0x0610U, 0x0FE3U, 0x4BC5U,
+        0x65FAU, 0x21DCU, 0x282FU, 0x6C09U, 0x3BC9U, 0x7FEFU, 0x761CU, 0x323AU,
+        0x2A62U, 0x6E44U, 0x67B7U, 0x2391U, 0x7451U, 0x3077U, 0x3984U, 0x7DA2U,
+        0x539DU, 0x17BBU, 0x1E48U, 0x5A6EU, 0x0DAEU, 0x4988U, 0x407BU, 0x045DU,
+        0x70CBU, 0x34EDU, 0x3D1EU, 0x7938U, 0x2EF8U, 0x6ADEU, 0x632DU, 0x270BU,
+        0x0934U, 0x4D12U, 0x44E1U, 0x00C7U, 0x5707U, 0x1321U, 0x1AD2U, 0x5EF4U,
+        0x46ACU, 0x028AU, 0x0B79U, 0x4F5FU, 0x189FU, 0x5CB9U, 0x554AU, 0x116CU,
+        0x3F53U, 0x7B75U, 0x7286U, 0x36A0U, 0x6160U, 0x2546U, 0x2CB5U, 0x6893U,
+        0x380AU, 0x7C2CU, 0x75DFU, 0x31F9U, 0x6639U, 0x221FU, 0x2BECU, 0x6FCAU,
+        0x41F5U, 0x05D3U, 0x0C20U, 0x4806U, 0x1FC6U, 0x5BE0U, 0x5213U, 0x1635U,
+        0x0E6DU, 0x4A4BU, 0x43B8U, 0x079EU, 0x505EU, 0x1478U, 0x1D8BU, 0x59ADU,
+        0x7792U, 0x33B4U, 0x3A47U, 0x7E61U, 0x29A1U, 0x6D87U, 0x6474U, 0x2052U,
+        0x54C4U, 0x10E2U, 0x1911U, 0x5D37U, 0x0AF7U, 0x4ED1U, 0x4722U, 0x0304U,
+        0x2D3BU, 0x691DU, 0x60EEU, 0x24C8U, 0x7308U, 0x372EU, 0x3EDDU, 0x7AFBU,
+        0x62A3U, 0x2685U, 0x2F76U, 0x6B50U, 0x3C90U, 0x78B6U, 0x7145U, 0x3563U,
+        0x1B5CU, 0x5F7AU, 0x5689U, 0x12AFU, 0x456FU, 0x0149U, 0x08BAU, 0x4C9CU,
+        0x240FU, 0x6029U, 0x69DAU, 0x2DFCU, 0x7A3CU, 0x3E1AU, 0x37E9U, 0x73CFU,
+        0x5DF0U, 0x19D6U, 0x1025U, 0x5403U, 0x03C3U, 0x47E5U, 0x4E16U, 0x0A30U,
+        0x1268U, 0x564EU, 0x5FBDU, 0x1B9BU, 0x4C5BU, 0x087DU, 0x018EU, 0x45A8U,
+        0x6B97U, 0x2FB1U, 0x2642U, 0x6264U, 0x35A4U, 0x7182U, 0x7871U, 0x3C57U,
+        0x48C1U, 0x0CE7U, 0x0514U, 0x4132U, 0x16F2U, 0x52D4U, 0x5B27U, 0x1F01U,
+        0x313EU, 0x7518U, 0x7CEBU, 0x38CDU, 0x6F0DU, 0x2B2BU, 0x22D8U, 0x66FEU,
+        0x7EA6U, 0x3A80U, 0x3373U, 0x7755U, 0x2095U, 0x64B3U, 0x6D40U, 0x2966U,
+        0x0759U, 0x437FU, 0x4A8CU, 0x0EAAU, 0x596AU, 0x1D4CU, 0x14BFU, 0x5099U
+    },
+    {
+        0x0000U, 0x7014U, 0x25B1U, 0x55A5U, 0x4B62U, 0x3B76U, 0x6ED3U, 0x1EC7U,
+        0x535DU, 0x2349U, 0x76ECU, 0x06F8U, 0x183FU, 0x682BU, 0x3D8EU, 0x4D9AU,
+        0x6323U, 0x1337U, 0x4692U, 0x3686U, 0x2841U, 0x5855U, 0x0DF0U, 0x7DE4U,
+        0x307EU, 0x406AU, 0x15CFU, 0x65DBU, 0x7B1CU, 0x0B08U, 0x5EADU, 0x2EB9U,
+        0x03DFU, 0x73CBU, 0x266EU, 0x567AU, 0x48BDU, 0x38A9U, 0x6D0CU, 0x1D18U,
+        0x5082U, 0x2096U, 0x7533U, 0x0527U, 0x1BE0U, 0x6BF4U, 0x3E51U, 0x4E45U,
+        0x60FCU, 0x10E8U, 0x454DU, 0x3559U, 0x2B9EU, 0x5B8AU, 0x0E2FU, 0x7E3BU,
+        0x33A1U, 0x43B5U, 0x1610U, 0x6604U, 0x78C3U, 0x08D7U, 0x5D72U, 0x2D66U,
+        0x07BEU, 0x77AAU, 0x220FU, 0x521BU, 0x4CDCU, 0x3CC8U, 0x696DU, 0x1979U,
+        0x54E3U, 0x24F7U, 0x7152U, 0x0146U, 0x1F81U, 0x6F95U, 0x3A30U, 0x4A24U,
+        0x649DU, 0x1489U, 0x412CU, 0x3138U, 0x2FFFU, 0x5FEBU, 0x0A4EU, 0x7A5AU,
+        0x37C0U, 0x47D4U, 0x1271U, 0x6265U, 0x7CA2U, 0x0CB6U, 0x5913U, 0x2907U,
+        0x0461U, 0x7475U, 0x21D0U, 0x51C4U, 0x4F03U, 0x3F17U, 0x6AB2U, 0x1AA6U,
+        0x573CU, 0x2728U, 0x728DU, 0x0299U, 0x1C5EU, 0x6C4AU, 0x39EFU, 0x49FBU,
+        0x6742U, 0x1756U, 0x42F3U, 0x32E7U, 0x2C20U, 0x5C34U, 0x0991U, 0x7985U,
+        0x341FU, 0x440BU, 0x11AEU, 0x61BAU, 0x7F7DU, 0x0F69U, 0x5ACCU, 0x2AD8U,
+        0x0F7CU, 0x7F68U, 0x2ACDU, 0x5AD9U, 0x441EU, 0x340AU, 0x61AFU, 0x11BBU,
+        0x5C21U, 0x2C35U, 0x7990U, 0x0984U, 0x1743U, 0x6757U, 0x32F2U, 0x42E6U,
+        0x6C5FU, 0x1C4BU, 0x49EEU, 0x39FAU, 0x273DU, 0x5729U, 0x028CU, 0x7298U,
+        0x3F02U, 0x4F16U, 0x1AB3U, 0x6AA7U, 0x7460U, 0x0474U, 0x51D1U, 0x21C5U,
+        0x0CA3U, 0x7CB7U, 0x2912U, 0x5906U, 0x47C1U, 0x37D5U, 0x6270U, 0x1264U,
+        0x5FFEU, 0x2FEAU, 0x7A4FU, 0x0A5BU, 0x149CU, 0x6488U, 0x312DU, 0x4139U,
+        0x6F80U, 0x1F94U, 0x4A31U, 0x3A25U, 0x24E2U, 0x54F6U, 0x0153U, 0x7147U,
+        0x3CDDU, 0x4CC9U, 0x196CU, 0x6978U, 0x77BFU, 0x07ABU, 0x520EU, 0x221AU,
+        0x08C2U, 0x78D6U, 0x2D73U, 0x5D67U, 0x43A0U, 0x33B4U, 0x6611U, 0x1605U,
+        0x5B9FU, 0x2B8BU, 0x7E2EU, 0x0E3AU, 0x10FDU, 0x60E9U, 0x354CU, 0x4558U,
+        0x6BE1U, 0x1BF5U, 0x4E50U, 0x3E44U, 0x2083U, 0x5097U, 0x0532U, 0x7526U,
+        0x38BCU, 0x48A8U, 0x1D0DU, 0x6D19U, 0x73DEU, 0x03CAU, 0x566FU, 0x267BU,
+        0x0B1DU, 0x7B09U, 0x2EACU, 0x5EB8U, 0x407FU, 0x306BU, 0x65CEU, 0x15DAU,
+        0x5840U, 0x2854U, 0x7DF1U, 0x0DE5U, 0x1322U, 0x6336U, 0x3693U, 0x4687U,
+        0x683EU, 0x182AU, 0x4D8FU, 0x3D9BU, 0x235CU, 0x5348U, 0x06EDU, 0x76F9U,
+        0x3B63U, 0x4B77U, 0x1ED2U, 0x6EC6U, 0x7001U, 0x0015U, 0x55B0U, 0x25A4U
+    },
+    {
+        0x0000U, 0x1EF8U, 0x3DF0U, 0x2308U, 0x7BE0U, 0x6518U, 0x4610U, 0x58E8U,
+        0x3259U, 0x2CA1U, 0x0FA9U, 0x1151U, 0x49B9U, 0x5741U, 0x7449U, 0x6AB1U,
+        0x64B2U, 0x7A4AU, 0x5942U, 0x47BAU, 0x1F52U, 0x01AAU, 0x22A2U, 0x3C5AU,
+        0x56EBU, 0x4813U, 0x6B1BU, 0x75E3U, 0x2D0BU, 0x33F3U, 0x10FBU, 0x0E03U,
+        0x0CFDU, 0x1205U, 0x310DU, 0x2FF5U, 0x771DU, 0x69E5U, 0x4AEDU, 0x5415U,
+        0x3EA4U, 0x205CU, 0x0354U, 0x1DACU, 0x4544U, 0x5BBCU, 0x78B4U, 0x664CU,
+        0x684FU, 0x76B7U, 0x55BFU, 0x4B47U, 0x13AFU, 0x0D57U, 0x2E5FU, 0x30A7U,
+        0x5A16U, 0x44EEU, 0x67E6U, 0x791EU, 0x21F6U, 0x3F0EU, 0x1C06U, 0x02FEU,
+        0x19FAU, 0x0702U, 0x240AU, 0x3AF2U, 0x621AU, 0x7CE2U, 0x5FEAU, 0x4112U,
+        0x2BA3U, 0x355BU, 0x1653U, 0x08ABU, 0x5043U, 0x4EBBU, 0x6DB3U, 0x734BU,
+        0x7D48U, 0x63B0U, 0x40B8U, 0x5E40U, 0x06A8U, 0x1850U, 0x3B58U, 0x25A0U,
+        0x4F11U, 0x51E9U, 0x72E1U, 0x6C19U, 0x34F1U, 0x2A09U, 0x0901U, 0x17F9U,
+        0x1507U, 0x0BFFU, 0x28F7U, 0x360FU, 0x6EE7U, 0x701FU, 0x5317U, 0x4DEFU,
+        0x275EU, 0x39A6U, 0x1AAEU, 0x0456U, 0x5CBEU, 0x4246U, 0x614EU, 0x7FB6U,
+        0x71B5U, 0x6F4DU, 0x4C45U, 0x52BDU, 0x0A55U, 0x14ADU, 0x37A5U, 0x295DU,
+        0x43ECU, 0x5D14U, 0x7E1CU, 0x60E4U, 0x380CU, 0x26F4U, 0x05FCU, 0x1B04U,
+        0x33F4U, 0x2D0CU, 0x0E04U, 0x10FCU, 0x4814U, 0x56ECU, 0x75E4U, 0x6B1CU,
+        0x01ADU, 0x1F55U, 0x3C5DU, 0x22A5U, 0x7A4DU, 0x64B5U, 0x47BDU, 0x5945U,
+        0x5746U, 0x49BEU, 0x6AB6U, 0x744EU, 0x2CA6U, 0x325EU, 0x1156U, 0x0FAEU,
+        0x651FU, 0x7BE7U, 0x58EFU, 0x4617U, 0x1EFFU, 0x0007U, 0x230FU, 0x3DF7U,
+        0x3F09U, 0x21F1U, 0x02F9U, 0x1C01U, 0x44E9U, 0x5A11U, 0x7919U, 0x67E1U,
+        0x0D50U, 0x13A8U, 0x30A0U, 0x2E58U, 0x76B0U, 0x6848U, 0x4B40U, 0x55B8U,
+        0x5BBBU, 0x4543U, 0x664BU, 0x78B3U, 0x205BU, 0x3EA3U, 0x1DABU, 0x0353U,
+        0x69E2U, 0x771AU, 0x5412U, 0x4AEAU, 0x1202U, 0x0CFAU, 0x2FF2U, 0x310AU,
+        0x2A0EU, 0x34F6U, 0x17FEU, 0x0906U, 0x51EEU, 0x4F16U, 0x6C1EU, 0x72E6U,
+        0x1857U, 0x06AFU, 0x25A7U, 0x3B5FU, 0x63B7U, 0x7D4FU, 0x5E47U, 0x40BFU,
+        0x4EBCU, 0x5044U, 0x734CU, 0x6DB4U, 0x355CU, 0x2BA4U, 0x08ACU, 0x1654U,
+        0x7CE5U, 0x621DU, 0x4115U, 0x5FEDU, 0x0705U, 0x19FDU, 0x3AF5U, 0x240DU,
+        0x26F3U, 0x380BU, 0x1B03U, 0x05FBU, 0x5D13U, 0x43EBU, 0x60E3U, 0x7E1BU,
+        0x14AAU, 0x0A52U, 0x295AU, 0x37A2U, 0x6F4AU, 0x71B2U, 0x52BAU, 0x4C42U,
+        0x4241U, 0x5CB9U, 0x7FB1U, 0x6149U, 0x39A1U, 0x2759U, 0x0451U, 0x1AA9U,
+        0x7018U, 0x6EE0U, 0x4DE8U, 0x5310U, 0x0BF8U, 0x1500U, 0x3608U, 0x28F0U
+    },
+#endif
+#if GTTCAN_CRC15_SLICES >= 8
+    {
+        0x0000U, 0x67E8U, 0x0A49U, 0x6DA1U, 0x1492U, 0x737AU, 0x1EDBU, 0x7933U,
+        0x2924U, 0x4ECCU, 0x236DU, 0x4485U, 0x3DB6U, 0x5A5EU, 0x37FFU, 0x5017U,
+        0x5248U, 0x35A0U, 0x5801U, 0x3FE9U, 0x46DAU, 0x2132U, 0x4C93U, 0x2B7BU,
+        0x7B6CU, 0x1C84U, 0x7125U, 0x16CDU, 0x6FFEU, 0x0816U, 0x65B7U, 0x025FU,
+        0x6109U, 0x06E1U, 0x6B40U, 0x0CA8U, 0x759BU, 0x1273U, 0x7FD2U, 0x183AU,
+        0x482DU, 0x2FC5U, 0x4264U, 0x258CU, 0x5CBFU, 0x3B57U, 0x56F6U, 0x311EU,
+        0x3341U, 0x54A9U, 0x3908U, 0x5EE0U, 0x27D3U, 0x403BU, 0x2D9AU, 0x4A72U,
+        0x1A65U, 0x7D8DU, 0x102CU, 0x77C4U, 0x0EF7U, 0x691FU, 0x04BEU, 0x6356U,
+        0x078BU, 0x6063U, 0x0DC2U, 0x6A2AU, 0x1319U, 0x74F1U, 0x1950U, 0x7EB8U,
+        0x2EAFU, 0x4947U, 0x24E6U, 0x430EU, 0x3A3DU, 0x5DD5U, 0x3074U, 0x579CU,
+        0x55C3U, 0x322BU, 0x5F8AU, 0x3862U, 0x4151U, 0x26B9U, 0x4B18U, 0x2CF0U,
+        0x7CE7U, 0x1B0FU, 0x76AEU, 0x1146U, 0x6875U, 0x0F9DU, 0x623CU, 0x05D4U,
+        0x6682U, 0x016AU, 0x6CCBU, 0x0B23U, 0x7210U, 0x15F8U, 0x7859U, 0x1FB1U,
+        0x4FA6U, 0x284EU, 0x45EFU, 0x2207U, 0x5B34U, 0x3CDCU, 0x517DU, 0x3695U,
+        0x34CAU, 0x5322U, 0x3E83U, 0x596BU, 0x2058U, 0x47B0U, 0x2A11U, 0x4DF9U,
+        0x1DEEU, 0x7A06U, 0x17A7U, 0x704FU, 0x097CU, 0x6E94U, 0x0335U, 0x64DDU,
+        0x0F16U, 0x68FEU, 0x055FU, 0x62B7U, 0x1B84U, 0x7C6CU, 0x11CDU, 0x7625U,
+        0x2632U, 0x41DAU, 0x2C7BU, 0x4B93U, 0x32A0U, 0x5548U, 0x38E9U, 0x5F01U,
+        0x5D5EU, 0x3AB6U, 0x5717U, 0x30FFU, 0x49CCU, 0x2E24U, 0x4385U, 0x246DU,
+        0x747AU, 0x1392U, 0x7E33U, 0x19DBU, 0x60E8U, 0x0700U, 0x6AA1U, 0x0D49U,
+        0x6E1FU, 0x09F7U, 0x6456U, 0x03BEU, 0x7A8DU, 0x1D65U, 0x70C4U, 0x172CU,
+        0x473BU, 0x20D3U, 0x4D72U, 0x2A9AU, 0x53A9U, 0x3441U, 0x59E0U, 0x3E08U,
+        0x3C57U, 0x5BBFU, 0x361EU, 0x51F6U, 0x28C5U, 0x4F2DU, 0x228CU, 0x4564U,
+        0x1573U, 0x729BU, 0x1F3AU, 0x78D2U, 0x01E1U, 0x6609U, 0x0BA8U, 0x6C40U,
+        0x089DU, 0x6F75U, 0x02D4U, 0x653CU, 0x1C0FU, 0x7BE7U, 0x1646U, 0x71AEU,
+        0x21B9U, 0x4651U, 0x2BF0U, 0x4C18U, 0x352BU, 0x52C3U, 0x3F62U, 0x588AU,
+        0x5AD5U, 0x3D3DU, 0x509CU, 0x3774U, 0x4E47U, 0x29AFU, 0x440EU, 0x23E6U,
+        0x73F1U, 0x1419U, 0x79B8U, 0x1E50U, 0x6763U, 0x008BU, 0x6D2AU, 0x0AC2U,
+        0x6994U, 0x0E7CU, 0x63DDU, 0x0435U, 0x7D06U, 0x1AEEU, 0x774FU, 0x10A7U,
+        0x40B0U, 0x2758U, 0x4AF9U, 0x2D11U, 0x5422U, 0x33CAU, 0x5E6BU, 0x3983U,
+        0x3BDCU, 0x5C34U, 0x3195U, 0x567DU, 0x2F4EU, 0x48A6U, 0x2507U, 0x42EFU,
+        0x12F8U, 0x7510U, 0x18B1U, 0x7F59U, 0x066AU, 0x6182U, 0x0C23U, 0x6BCBU
+    },
+    {
+        0x0000U, 0x1E2CU, 0x3C58U, 0x2274U, 0x78B0U, 0x669CU, 0x44E8U, 0x5AC4U,
+        0x34F9U, 0x2AD5U, 0x08A1U, 0x168DU, 0x4C49U, 0x5265U, 0x7011U, 0x6E3DU,
+        0x69F2U, 0x77DEU, 0x55AAU, 0x4B86U, 0x1142U, 0x0F6EU, 0x2D1AU, 0x3336U,
+        0x5D0BU, 0x4327U, 0x6153U, 0x7F7FU, 0x25BBU, 0x3B97U, 0x19E3U, 0x07CFU,
+        0x167DU, 0x0851U, 0x2A25U, 0x3409U, 0x6ECDU, 0x70E1U, 0x5295U, 0x4CB9U,
+        0x2284U, 0x3CA8U, 0x1EDCU, 0x00F0U, 0x5A34U, 0x4418U, 0x666CU, 0x7840U,
+        0x7F8FU, 0x61A3U, 0x43D7U, 0x5DFBU, 0x073FU, 0x1913U, 0x3B67U, 0x254BU,
+        0x4B76U, 0x555AU, 0x772EU, 0x6902U, 0x33C6U, 0x2DEAU, 0x0F9EU, 0x11B2U,
+        0x2CFAU, 0x32D6U, 0x10A2U, 0x0E8EU, 0x544AU, 0x4A66U, 0x6812U, 0x763EU,
+        0x1803U, 0x062FU, 0x245BU, 0x3A77U, 0x60B3U, 0x7E9FU, 0x5CEBU, 0x42C7U,
+        0x4508U, 0x5B24U, 0x7950U, 0x677CU, 0x3DB8U, 0x2394U, 0x01E0U, 0x1FCCU,
+        0x71F1U, 0x6FDDU, 0x4DA9U, 0x5385U, 0x0941U, 0x176DU, 0x3519U, 0x2B35U,
+        0x3A87U, 0x24ABU, 0x06DFU, 0x18F3U, 0x4237U, 0x5C1BU, 0x7E6FU, 0x6043U,
+        0x0E7EU, 0x1052U, 0x3226U, 0x2C0AU, 0x76CEU, 0x68E2U, 0x4A96U, 0x54BAU,
+        0x5375U, 0x4D59U, 0x6F2DU, 0x7101U, 0x2BC5U, 0x35E9U, 0x179DU, 0x09B1U,
+        0x678CU, 0x79A0U, 0x5BD4U, 0x45F8U, 0x1F3CU, 0x0110U, 0x2364U, 0x3D48U,
+        0x59F4U, 0x47D8U, 0x65ACU, 0x7B80U, 0x2144U, 0x3F68U, 0x1D1CU, 0x0330U,
+        0x6D0DU, 0x7321U, 0x5155U, 0x4F79U, 0x15BDU, 0x0B91U, 0x29E5U, 0x37C9U,
+        0x3006U, 0x2E2AU, 0x0C5EU, 0x1272U, 0x48B6U, 0x569AU, 0x74EEU, 0x6AC2U,
+        0x04FFU, 0x1AD3U, 0x38A7U, 0x268BU, 0x7C4FU, 0x6263U, 0x4017U, 0x5E3BU,
+        0x4F89U, 0x51A5U, 0x73D1U, 0x6DFDU, 0x3739U, 0x2915U, 0x0B61U, 0x154DU,
+        0x7B70U, 0x655CU, 0x4728U, 0x5904U, 0x03C0U, 0x1DECU, 0x3F98U, 0x21B4U,
+        0x267BU, 0x3857U, 0x1A23U, 0x040FU, 0x5ECBU, 0x40E7U, 0x6293U, 0x7CBFU,
+        0x1282U, 0x0CAEU, 0x2EDAU, 0x30F6U, 0x6A32U, 0x741EU, 0x566AU, 0x4846U,
+        0x750EU, 0x6B22U, 0x4956U, 0x577AU, 0x0DBEU, 0x1392U, 0x31E6U, 0x2FCAU,
+        0x41F7U, 0x5FDBU, 0x7DAFU, 0x6383U, 0x3947U, 0x276BU, 0x051FU, 0x1B33U,
+        0x1CFCU, 0x02D0U, 0x20A4U, 0x3E88U, 0x644CU, 0x7A60U, 0x5814U, 0x4638U,
+        0x2805U, 0x3629U, 0x145DU, 0x0A71U, 0x50B5U, 0x4E99U, 0x6CEDU, 0x72C1U,
+        0x6373U, 0x7D5FU, 0x5F2BU, 0x4107U, 0x1BC3U, 0x05EFU, 0x279BU, 0x39B7U,
+        0x578AU, 0x49A6U, 0x6BD2U, 0x75FEU, 0x2F3AU, 0x3116U, 0x1362U, 0x0D4EU,
+        0x0A81U, 0x14ADU, 0x36D9U, 0x28F5U, 0x7231U, 0x6C1DU, 0x4E69U, 0x5045U,
+        0x3E78U, 0x2054U, 0x0220U, 0x1C0CU, 0x46C8U, 0x58E4U, 0x7A90U, 0x64BCU
+    },
+    {
+        0x0000U, 0x7671U, 0x297BU, 0x5F0AU, 0x52F6U, 0x2487U, 0x7B8DU, 0x0DFCU,
+        0x6075U, 0x1604U, 0x490EU, 0x3F7FU, 0x3283U, 0x44F2U, 0x1BF8U, 0x6D89U,
+        0x0573U, 0x7302U, 0x2C08U, 0x5A79U, 0x5785U, 0x21F4U, 0x7EFEU, 0x088FU,
+        0x6506U, 0x1377U, 0x4C7DU, 0x3A0CU, 0x37F0U, 0x4181U, 0x1E8BU, 0x68FAU,
+        0x0AE6U, 0x7C97U, 0x239DU, 0x55ECU, 0x5810U, 0x2E61U, 0x716BU, 0x071AU,
+        0x6A93U, 0x1CE2U, 0x43E8U, 0x3599U, 0x3865U, 0x4E14U, 0x111EU, 0x676FU,
+        0x0F95U, 0x79E4U, 0x26EEU, 0x509FU, 0x5D63U, 0x2B12U, 0x7418U, 0x0269U,
+        0x6FE0U, 0x1991U, 0x469BU, 0x30EAU, 0x3D16U, 0x4B67U, 0x146DU, 0x621CU,
+        0x15CCU, 0x63BDU, 0x3CB7U, 0x4AC6U, 0x473AU, 0x314BU, 0x6E41U, 0x1830U,
+        0x75B9U, 0x03C8U, 0x5CC2U, 0x2AB3U, 0x274FU, 0x513EU, 0x0E34U, 0x7845U,
+        0x10BFU, 0x66CEU, 0x39C4U, 0x4FB5U, 0x4249U, 0x3438U, 0x6B32U, 0x1D43U,
+        0x70CAU, 0x06BBU, 0x59B1U, 0x2FC0U, 0x223CU, 0x544DU, 0x0B47U, 0x7D36U,
+        0x1F2AU, 0x695BU, 0x3651U, 0x4020U, 0x4DDCU, 0x3BADU, 0x64A7U, 0x12D6U,
+        0x7F5FU, 0x092EU, 0x5624U, 0x2055U, 0x2DA9U, 0x5BD8U, 0x04D2U, 0x72A3U,
+        0x1A59U, 0x6C28U, 0x3322U, 0x4553U, 0x48AFU, 0x3EDEU, 0x61D4U, 0x17A5U,
+        0x7A2CU, 0x0C5DU, 0x5357U, 0x2526U, 0x28DAU, 0x5EABU, 0x01A1U, 0x77D0U,
+        0x2B98U, 0x5DE9U, 0x02E3U, 0x7492U, 0x796EU, 0x0F1FU, 0x5015U, 0x2664U,
+        0x4BEDU, 0x3D9CU, 0x6296U, 0x14E7U, 0x191BU, 0x6F6AU, 0x3060U, 0x4611U,
+        0x2EEBU, 0x589AU, 0x0790U, 0x71E1U, 0x7C1DU, 0x0A6CU, 0x5566U, 0x2317U,
+        0x4E9EU, 0x38EFU, 0x67E5U, 0x1194U, 0x1C68U, 0x6A19U, 0x3513U, 0x4362U,
+        0x217EU, 0x570FU, 0x0805U, 0x7E74U, 0x7388U, 0x05F9U, 0x5AF3U, 0x2C82U,
+        0x410BU, 0x377AU, 0x6870U, 0x1E01U, 0x13FDU, 0x658CU, 0x3A86U, 0x4CF7U,
+        0x240DU, 0x527CU, 0x0D76U, 0x7B07U, 0x76FBU, 0x008AU, 0x5F80U, 0x29F1U,
+        0x4478U, 0x3209U, 0x6D03U, 0x1B72U, 0x168EU, 0x60FFU, 0x3FF5U, 0x4984U,
+        0x3E54U, 0x4825U, 0x172FU, 0x615EU, 0x6CA2U, 0x1AD3U, 0x45D9U, 0x33A8U,
+        0x5E21U, 0x2850U, 0x775AU, 0x012BU, 0x0CD7U, 0x7AA6U, 0x25ACU, 0x53DDU,
+        0x3B27U, 0x4D56U, 0x125CU, 0x642DU, 0x69D1U, 0x1FA0U, 0x40AAU, 0x36DBU,
+        0x5B52U, 0x2D23U, 0x7229U, 0x0458U, 0x09A4U, 0x7FD5U, 0x20DFU, 0x56AEU,
+        0x34B2U, 0x42C3U, 0x1DC9U, 0x6BB8U, 0x6644U, 0x1035U, 0x4F3FU, 0x394EU,
+        0x54C7U, 0x22B6U, 0x7DBCU, 0x0BCDU, 0x0631U, 0x7040U, 0x2F4AU, 0x593BU,
+        0x31C1U, 0x47B0U, 0x18BAU, 0x6ECBU, 0x6337U, 0x1546U, 0x4A4CU, 0x3C3DU,
+        0x51B4U, 0x27C5U, 0x78CFU, 0x0EBEU, 0x0342U, 0x7533U, 0x2A39U, 0x5C48U
+    },
+    {
+        0x0000U, 0x5730U, 0x6BF9U, 0x3CC9U, 0x126BU, 0x455BU, 0x7992U, 0x2EA2U,
+        0x24D6U, 0x73E6U, 0x4F2FU, 0x181FU, 0x36BDU, 0x618DU, 0x5D44U, 0x0A74U,
+        0x49ACU, 0x1E9CU, 0x2255U, 0x7565U, 0x5BC7U, 0x0CF7U, 0x303EU, 0x670EU,
+        0x6D7AU, 0x3A4AU, 0x0683U, 0x51B3U, 0x7F11U, 0x2821U, 0x14E8U, 0x43D8U,
+        0x56C1U, 0x01F1U, 0x3D38U, 0x6A08U, 0x44AAU, 0x139AU, 0x2F53U, 0x7863U,
+        0x7217U, 0x2527U, 0x19EEU, 0x4EDEU, 0x607CU, 0x374CU, 0x0B85U, 0x5CB5U,
+        0x1F6DU, 0x485DU, 0x7494U, 0x23A4U, 0x0D06U, 0x5A36U, 0x66FFU, 0x31CFU,
+        0x3BBBU, 0x6C8BU, 0x5042U, 0x0772U, 0x29D0U, 0x7EE0U, 0x4229U, 0x1519U,
+        0x681BU, 0x3F2BU, 0x03E2U, 0x54D2U, 0x7A70U, 0x2D40U, 0x1189U, 0x46B9U,
+        0x4CCDU, 0x1BFDU, 0x2734U, 0x7004U, 0x5EA6U, 0x0996U, 0x355FU, 0x626FU,
+        0x21B7U, 0x7687U, 0x4A4EU, 0x1D7EU, 0x33DCU, 0x64ECU, 0x5825U, 0x0F15U,
+        0x0561U, 0x5251U, 0x6E98U, 0x39A8U, 0x170AU, 0x403AU, 0x7CF3U, 0x2BC3U,
+        0x3EDAU, 0x69EAU, 0x5523U, 0x0213U, 0x2CB1U, 0x7B81U, 0x4748U, 0x1078U,
+        0x1A0CU, 0x4D3CU, 0x71F5U, 0x26C5U, 0x0867U, 0x5F57U, 0x639EU, 0x34AEU,
+        0x7776U, 0x2046U, 0x1C8FU, 0x4BBFU, 0x651DU, 0x322DU, 0x0EE4U, 0x59D4U,
+        0x53A0U, 0x0490U, 0x3859U, 0x6F69U, 0x41CBU, 0x16FBU, 0x2A32U, 0x7D02U,
+        0x15AFU, 0x429FU, 0x7E56U, 0x2966U, 0x07C4U, 0x50F4U, 0x6C3DU, 0x3B0DU,
+        0x3179U, 0x6649U, 0x5A80U, 0x0DB0U, 0x2312U, 0x7422U, 0x48EBU, 0x1FDBU,
+        0x5C03U, 0x0B33U, 0x37FAU, 0x60CAU, 0x4E68U, 0x1958U, 0x2591U, 0x72A1U,
+        0x78D5U, 0x2FE5U, 0x132CU, 0x441CU, 0x6ABEU, 0x3D8EU, 0x0147U, 0x5677U,
+        0x436EU, 0x145EU, 0x2897U, 0x7FA7U, 0x5105U, 0x0635U, 0x3AFCU, 0x6DCCU,
+        0x67B8U, 0x3088U, 0x0C41U, 0x5B71U, 0x75D3U, 0x22E3U, 0x1E2AU, 0x491AU,
+        0x0AC2U, 0x5DF2U, 0x613BU, 0x360BU, 0x18A9U, 0x4F99U, 0x7350U, 0x2460U,
+        0x2E14U, 0x7924U, 0x45EDU, 0x12DDU, 0x3C7FU, 0x6B4FU, 0x5786U, 0x00B6U,
+        0x7DB4U, 0x2A84U, 0x164DU, 0x417DU, 0x6FDFU, 0x38EFU, 0x0426U, 0x5316U,
+        0x5962U, 0x0E52U, 0x329BU, 0x65ABU, 0x4B09U, 0x1C39U, 0x20F0U, 0x77C0U,
+        0x3418U, 0x6328U, 0x5FE1U, 0x08D1U, 0x2673U, 0x7143U, 0x4D8AU, 0x1ABAU,
+        0x10CEU, 0x47FEU, 0x7B37U, 0x2C07U, 0x02A5U, 0x5595U, 0x695CU, 0x3E6CU,
+        0x2B75U, 0x7C45U, 0x408CU, 0x17BCU, 0x391EU, 0x6E2EU, 0x52E7U, 0x05D7U,
+        0x0FA3U, 0x5893U, 0x645AU, 0x336AU, 0x1DC8U, 0x4AF8U, 0x7631U, 0x2101U,
+        0x62D9U, 0x35E9U, 0x0920U, 0x5E10U, 0x70B2U, 0x2782U, 0x1B4BU, 0x4C7BU,
+        0x460FU, 0x113FU, 0x2DF6U, 0x7AC6U, 0x5464U, 0x0354U, 0x3F9DU, 0x68ADU
+    },
+#endif
+};
+#endif
+
+#endif // CRC15_TABLES_H
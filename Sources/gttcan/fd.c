@@ -0,0 +1,42 @@
+/**
+ * @file fd.c
+ * @brief CAN FD frames with payloads of up to 64 bytes.
+ */
+#include "gttcan.h"
+#include "gttcan_fd.h"
+
+/**
+ * @brief Initialise a CAN FD interface.
+ *
+ * @param fd The interface.
+ * @param transmit Sends a CAN FD frame.
+ * @param read_buffer Reads the payload of a transmitted data ID.
+ * @param write_buffer Writes the payload of a received data ID.
+ * @param data_bit_time The duration of a data-phase bit in NTU
+ *                      (e.g. 2 at 5 Mbit/s), or 0 to send frames
+ *                      without bit rate switch.
+ */
+void GTTCAN_fd_init(gttcan_fd_t *fd, transmit_fd_callback_fp transmit, read_buffer_fp read_buffer,
+                    write_buffer_fp write_buffer, uint32_t data_bit_time)
+{
+    fd->transmit = transmit;
+    fd->read_buffer = read_buffer;
+    fd->write_buffer = write_buffer;
+    fd->data_bit_time = data_bit_time;
+}
+
+/**
+ * @brief Attach a CAN FD interface.
+ *
+ * With an interface attached, GTTCAN_transmit_next_frame() sends all
+ * frames with its `transmit` callback instead of `transmit_callback`
+ * and reads the payload of data frames with `read_buffer`.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param fd The interface (initialised with GTTCAN_fd_init()),
+ *           or NULL to send classic CAN frames again.
+ */
+void GTTCAN_set_fd(gttcan_t *gttcan, gttcan_fd_t *fd)
+{
+    gttcan->fd = fd;
+}
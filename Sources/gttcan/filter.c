@@ -0,0 +1,294 @@
+/**
+ * @file filter.c
+ * @brief CAN acceptance filters derived from the global schedule.
+ */
+#include "gttcan.h"
+#include "gttcan_filter.h"
+
+/// The index bits of a GTTCAN ID.
+#define GTTCAN_FILTER_INDEX_BITS (GTTCAN_INDEX_MASK << GTTCAN_NUM_DATAID_BITS)
+/// Bitmap words for the slots of a schedule.
+#define GTTCAN_FILTER_SLOT_WORDS (((uint32_t)GTTCAN_MAX_SLOTS + 31U) / 32U)
+
+/**
+ * @brief Test a bit of a bitmap.
+ */
+static inline bool GTTCAN_filter_test(const uint32_t *bitmap, uint32_t bit)
+{
+    return (bitmap[bit / 32U] & ((uint32_t)1U << (bit % 32U))) != 0U;
+}
+
+/**
+ * @brief Set a bit of a bitmap.
+ */
+static inline void GTTCAN_filter_set(uint32_t *bitmap, uint32_t bit)
+{
+    bitmap[bit / 32U] |= (uint32_t)1U << (bit % 32U);
+}
+
+/**
+ * @brief Return whether a data ID is in a list.
+ */
+static bool GTTCAN_filter_contains(const uint16_t *dataIDs, uint32_t count, uint16_t dataID)
+{
+    bool found = false;
+    for (uint32_t i = 0U; (i < count) && !found; i++)
+    {
+        found = (dataIDs[i] == dataID);
+    }
+    return found;
+}
+
+/**
+ * @brief Return the smallest filter that accepts everything two filters accept.
+ */
+static inline gttcan_filter_t GTTCAN_filter_merge(gttcan_filter_t a, gttcan_filter_t b)
+{
+    gttcan_filter_t merged;
+    merged.mask = a.mask & b.mask & ~(a.id ^ b.id);
+    merged.id = a.id & merged.mask;
+    return merged;
+}
+
+/**
+ * @brief Count the unneeded frames of a round that a filter accepts.
+ *
+ * A frame in an arbitration slot counts once, unless the filter only
+ * accepts a single data ID there and the node consumes it.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param wanted The slots to accept.
+ * @param dataIDs The data IDs the node consumes.
+ * @param count The number of data IDs.
+ * @param filter The filter.
+ * @return The number of unneeded frames.
+ */
+static uint32_t GTTCAN_filter_cost(const gttcan_t *gttcan, const uint32_t *wanted, const uint16_t *dataIDs, uint32_t count,
+                                   gttcan_filter_t filter)
+{
+    const uint16_t length = gttcan->node_schedule->globalScheduleLength;
+    const bool exact_dataID = ((filter.mask & GTTCAN_DATAID_MASK) == GTTCAN_DATAID_MASK) &&
+                              GTTCAN_filter_contains(dataIDs, count, (uint16_t)(filter.id & GTTCAN_DATAID_MASK));
+    uint32_t cost = 0U;
+    for (uint16_t g = 0U; g < length; g++)
+    {
+        const uint32_t entry = GTTCAN_get_schedule_entry(gttcan, g);
+        const uint32_t node = (entry >> 16U) & 0xFFU;
+        const uint32_t id = GTTCAN_CAN_ID(g, entry & 0xFFFFU);
+        if ((node == 0U) || (node == (uint32_t)gttcan->localNodeId) || GTTCAN_filter_test(wanted, g))
+        {
+            // free, our own or needed
+        }
+        else if (node == (uint32_t)GTTCAN_ARBITRATION_NODE)
+        {
+            const uint32_t index_mask = filter.mask & GTTCAN_FILTER_INDEX_BITS;
+            if (((id & index_mask) == (filter.id & index_mask)) && !exact_dataID)
+            {
+                cost++;
+            }
+        }
+        else if ((id & filter.mask) == filter.id)
+        {
+            cost++;
+        }
+        else
+        {
+            // rejected
+        }
+    }
+    return cost;
+}
+
+/**
+ * @brief Mark further slots of other nodes to accept as clock error samples.
+ *
+ * Slots of nodes not yet heard from are taken first, so that the
+ * samples of a single faulty node can be discarded as outliers.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param wanted The slots to accept, updated.
+ * @param accepted The number of slots of other nodes already accepted.
+ * @param samples The number of slots to accept.
+ */
+static void GTTCAN_filter_add_samples(const gttcan_t *gttcan, uint32_t *wanted, uint32_t accepted, uint32_t samples)
+{
+    const uint16_t length = gttcan->node_schedule->globalScheduleLength;
+    uint32_t heard[256U / 32U] = { 0U };
+    uint32_t total = accepted;
+    for (uint16_t g = 0U; g < length; g++)
+    {
+        if (GTTCAN_filter_test(wanted, g))
+        {
+            GTTCAN_filter_set(heard, (GTTCAN_get_schedule_entry(gttcan, g) >> 16U) & 0xFFU);
+        }
+    }
+    for (uint32_t pass = 0U; pass < 2U; pass++)
+    {
+        for (uint16_t g = 0U; (g < length) && (total < samples); g++)
+        {
+            const uint32_t node = (GTTCAN_get_schedule_entry(gttcan, g) >> 16U) & 0xFFU;
+            if ((node != 0U) && (node != (uint32_t)gttcan->localNodeId) && (node != (uint32_t)GTTCAN_ARBITRATION_NODE) &&
+                !GTTCAN_filter_test(wanted, g) && ((pass == 1U) || !GTTCAN_filter_test(heard, node)))
+            {
+                GTTCAN_filter_set(wanted, g);
+                GTTCAN_filter_set(heard, node);
+                total++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Derive acceptance filters for a node from its loaded schedule.
+ *
+ * The filters accept the reference frames, the slots that carry one
+ * of the given data IDs, and further slots of other nodes until a
+ * round has at least `samples` received frames, and at least one more
+ * than twice the outliers discarded by the FTA.  These are taken from
+ * nodes not yet heard from first.  A data ID without a slot of its own
+ * can only be sent in an arbitration slot, so it is accepted in every
+ * arbitration slot.  If more filters are needed than `max_filters`,
+ * adjacent filters are merged greedily, choosing the merge that lets
+ * the fewest other frames of a round through (a frame in an
+ * arbitration slot counts once).
+ *
+ * The slots of the node itself and the free slots are ignored, so
+ * the filters assume that the controller does not receive its own
+ * frames.
+ *
+ * @param gttcan The GTTCAN instance, with its schedule loaded and its FTA configured.
+ * @param dataIDs The data IDs the node consumes (duplicates are ignored).
+ * @param count The number of data IDs.
+ * @param samples The minimum number of frames per round to accept for the clock synchronisation.
+ * @param filters Receives the filters.
+ * @param max_filters The number of filter banks available.
+ * @param workspace Scratch memory for the filters before merging.
+ * @return The number of filters written, or 0 if no schedule is loaded,
+ *         the schedule is longer than #GTTCAN_MAX_SLOTS (possible
+ *         without transmit tables), `max_filters` is 0 or a round has
+ *         more than #GTTCAN_FILTER_MAX_IDS frames to accept.
+ */
+uint32_t GTTCAN_build_filters(const gttcan_t *gttcan, const uint16_t *dataIDs, uint32_t count, uint32_t samples,
+                              gttcan_filter_t *filters, uint32_t max_filters, gttcan_filter_workspace_t *workspace)
+{
+    const uint16_t length = gttcan->node_schedule->globalScheduleLength;
+    if ((length == 0U) || ((uint32_t)length > (uint32_t)GTTCAN_MAX_SLOTS) || (max_filters == 0U))
+    {
+        return 0U; // cppcheck-suppress misra-c2012-15.5
+    }
+
+    // Slots to accept: reference frames and consumed data IDs, then clock error samples.
+    uint32_t wanted[GTTCAN_FILTER_SLOT_WORDS] = { 0U };
+    uint32_t accepted = 0U;
+    bool arbitration = false;
+    for (uint16_t g = 0U; g < length; g++)
+    {
+        const uint32_t entry = GTTCAN_get_schedule_entry(gttcan, g);
+        const uint32_t node = (entry >> 16U) & 0xFFU;
+        const uint16_t dataID = (uint16_t)(entry & 0xFFFFU);
+        if (node == (uint32_t)GTTCAN_ARBITRATION_NODE)
+        {
+            arbitration = true;
+        }
+        else if ((node != 0U) && (node != (uint32_t)gttcan->localNodeId) &&
+                 ((dataID == (uint16_t)NETWORK_TIME_SLOT) || GTTCAN_filter_contains(dataIDs, count, dataID)))
+        {
+            GTTCAN_filter_set(wanted, g);
+            accepted++;
+        }
+        else
+        {
+            // not needed, or free or our own
+        }
+    }
+    const uint32_t fta_samples = (2U * (uint32_t)gttcan->fta.outliers) + 1U;
+    GTTCAN_filter_add_samples(gttcan, wanted, accepted, (samples > fta_samples) ? samples : fta_samples);
+
+    // One exact filter per slot to accept, and one per data ID only sent in arbitration slots.
+    gttcan_filter_t * const work = workspace->filters;
+    uint32_t n = 0U;
+    for (uint16_t g = 0U; g < length; g++)
+    {
+        if (GTTCAN_filter_test(wanted, g))
+        {
+            work[n].id = GTTCAN_CAN_ID(g, GTTCAN_get_schedule_entry(gttcan, g) & 0xFFFFU);
+            work[n].mask = GTTCAN_FILTER_ID_MASK;
+            n++;
+        }
+    }
+    for (uint32_t i = 0U; arbitration && (i < count); i++)
+    {
+        const uint16_t dataID = dataIDs[i];
+        bool scheduled = (dataID == (uint16_t)NETWORK_TIME_SLOT) || !GTTCAN_DATAID_FITS(dataID) ||
+                         GTTCAN_filter_contains(dataIDs, i, dataID);
+        for (uint16_t g = 0U; (g < length) && !scheduled; g++)
+        {
+            const uint32_t entry = GTTCAN_get_schedule_entry(gttcan, g);
+            scheduled = (((entry >> 16U) & 0xFFU) != (uint32_t)GTTCAN_ARBITRATION_NODE) && ((entry & 0xFFFFU) == (uint32_t)dataID);
+        }
+        if (!scheduled)
+        {
+            if (n >= (uint32_t)GTTCAN_FILTER_MAX_IDS)
+            {
+                return 0U; // cppcheck-suppress misra-c2012-15.5
+            }
+            work[n].id = (uint32_t)dataID;
+            work[n].mask = GTTCAN_FILTER_ID_MASK & ~GTTCAN_FILTER_INDEX_BITS;
+            n++;
+        }
+    }
+
+    // Sort by ID, so that filters of neighbouring slots are adjacent.
+    for (uint32_t i = 1U; i < n; i++)
+    {
+        const gttcan_filter_t filter = work[i];
+        uint32_t j = i;
+        while ((j > 0U) && (work[j - 1U].id > filter.id))
+        {
+            work[j] = work[j - 1U];
+            j--;
+        }
+        work[j] = filter;
+    }
+
+    // Merge the adjacent pair that lets the fewest more frames through until the filters fit.
+    uint16_t * const cost = workspace->costs;
+    int32_t * const merge_cost = workspace->merge_costs;
+    for (uint32_t i = 0U; (n > max_filters) && (i < n); i++)
+    {
+        cost[i] = (uint16_t)GTTCAN_filter_cost(gttcan, wanted, dataIDs, count, work[i]);
+    }
+    for (uint32_t i = 0U; (n > max_filters) && ((i + 1U) < n); i++)
+    {
+        const gttcan_filter_t merged = GTTCAN_filter_merge(work[i], work[i + 1U]);
+        merge_cost[i] = (int32_t)GTTCAN_filter_cost(gttcan, wanted, dataIDs, count, merged) - (int32_t)cost[i] - (int32_t)cost[i + 1U];
+    }
+    while (n > max_filters)
+    {
+        uint32_t best = 0U;
+        for (uint32_t i = 1U; (i + 1U) < n; i++)
+        {
+            best = (merge_cost[i] < merge_cost[best]) ? i : best;
+        }
+        work[best] = GTTCAN_filter_merge(work[best], work[best + 1U]);
+        cost[best] = (uint16_t)GTTCAN_filter_cost(gttcan, wanted, dataIDs, count, work[best]);
+        for (uint32_t i = best + 1U; (i + 1U) < n; i++)
+        {
+            work[i] = work[i + 1U];
+            cost[i] = cost[i + 1U];
+            merge_cost[i] = merge_cost[i + 1U];
+        }
+        n--;
+        for (uint32_t i = (best > 0U) ? (best - 1U) : 0U; (i <= best) && ((i + 1U) < n); i++)
+        {
+            const gttcan_filter_t merged = GTTCAN_filter_merge(work[i], work[i + 1U]);
+            merge_cost[i] = (int32_t)GTTCAN_filter_cost(gttcan, wanted, dataIDs, count, merged) - (int32_t)cost[i] - (int32_t)cost[i + 1U];
+        }
+    }
+
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        filters[i] = work[i];
+    }
+    return n;
+}
@@ -2,95 +2,1197 @@
  * @file gttcan.c
  * @brief This file contains the implementation of the GTTCAN protocol.
  */
+#include <stddef.h>
 #include "gttcan.h"
 #include "slot_defs.h"
+#include "gttcan_rx_ring.h"
+#include "gttcan_whiteboard.h"
+#include "gttcan_stats.h"
+#include "gttcan_trace.h"
+#include "gttcan_fd.h"
+#include "gttcan_sporadic.h"
+#include "gttcan_staging.h"
+#include "gttcan_clock.h"
 
-static uint32_t GTTCAN_create_entry(uint8_t id, uint16_t dataslot) {
-    return ((uint32_t)id << 16) | dataslot;
+_Static_assert((GTTCAN_NUM_INDEX_BITS >= 1U) && (GTTCAN_NUM_INDEX_BITS <= 16U), "schedule indices are stored as uint16_t");
+_Static_assert((GTTCAN_NUM_DATAID_BITS >= 1U) && (GTTCAN_NUM_DATAID_BITS <= 16U), "data IDs are stored as uint16_t");
+_Static_assert((GTTCAN_NUM_INDEX_BITS + GTTCAN_NUM_DATAID_BITS) <= 29U, "an extended CAN identifier only has 29 bits");
+_Static_assert((uint32_t)GTTCAN_MAX_SLOTS <= (GTTCAN_INDEX_MASK + 1U), "GTTCAN_MAX_SLOTS does not fit into GTTCAN_NUM_INDEX_BITS");
+_Static_assert((GTTCAN_FTA_MAX_OUTLIERS >= 1U) && ((2U * GTTCAN_FTA_MAX_OUTLIERS) <= (uint32_t)GTTCAN_MAX_SLOTS), "the FTA cannot discard more samples than there are slots");
+_Static_assert((GTTCAN_FTA_MAX_WINDOW >= 1U) && (GTTCAN_FTA_MAX_WINDOW <= 255U), "FTA window indices are stored as uint8_t");
+_Static_assert(offsetof(gttcan_t, fta.window_counts) <= GTTCAN_CACHE_LINE_SIZE,
+               "the state modified per frame must fit into one cache line");
+_Static_assert(offsetof(gttcan_t, node_schedule) == (offsetof(gttcan_t, fta) + sizeof(gttcan_fta_t)),
+               "the FTA window entries must complete the state modified on the receive and transmit paths");
+
+/**
+ * @brief Read a little-endian 16-bit value from a schedule blob.
+ */
+static inline uint16_t GTTCAN_read_le16(const uint8_t * const bytes)
+{
+    return (uint16_t)((uint16_t)bytes[0] | (uint16_t)((uint16_t)bytes[1] << 8U));
+}
+
+/**
+ * @brief Read a little-endian 32-bit value from a schedule blob.
+ */
+static inline uint32_t GTTCAN_read_le32(const uint8_t * const bytes)
+{
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8U) | ((uint32_t)bytes[2] << 16U) | ((uint32_t)bytes[3] << 24U);
+}
+
+/**
+ * @brief Find the first local schedule entry after a global schedule index.
+ *
+ * Binary search over the (ascending) global schedule indices of a local schedule.
+ *
+ * @param slotIDs The global schedule indices of the local schedule (`localScheduleSlotID`).
+ * @param localLength The length of the local schedule.
+ * @param index The global schedule index.
+ * @return The local schedule index of the first local slot after `index`,
+ *         or `localLength` if there is none in this round.
+ */
+static inline uint8_t GTTCAN_find_next_local_index(const uint16_t *slotIDs, uint8_t localLength, uint16_t index)
+{
+    uint8_t low = 0U;
+    uint8_t high = localLength;
+    while (low < high)
+    {
+        const uint8_t middle = (uint8_t)((low + high) / 2U);
+        if (slotIDs[middle] <= index)
+        {
+            low = middle + 1U;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Calculate the slots from a global index to the next local transmission.
+ *
+ * @param slotIDs The global schedule indices of the local schedule.
+ * @param localLength The length of the local schedule.
+ * @param scheduleLength The length of the global schedule.
+ * @param index The global schedule index.
+ * @param next The result of GTTCAN_find_next_local_index() for `index`.
+ * @return The number of slots until the next local slot (strictly after `index`).
+ */
+static inline uint16_t GTTCAN_calculate_slots_to_next(const uint16_t *slotIDs, uint8_t localLength, uint32_t scheduleLength,
+                                                      uint16_t index, uint8_t next)
+{
+    if (localLength == 0U) // never transmitting: wake up at the start of the next round
+    {
+        return (uint16_t)(scheduleLength - index); // cppcheck-suppress misra-c2012-15.5
+    }
+    const uint32_t nextSlot = (next < localLength) ?
+        (uint32_t)slotIDs[next] :
+        ((uint32_t)slotIDs[0] + scheduleLength); // first slot of the next round
+    return (uint16_t)(nextSlot - index);
+}
+
+/**
+ * @brief Calculate the slots from the previous local transmission to a global index.
+ *
+ * @param slotIDs The global schedule indices of the local schedule.
+ * @param localLength The length of the local schedule.
+ * @param scheduleLength The length of the global schedule.
+ * @param index The global schedule index.
+ * @param next The result of GTTCAN_find_next_local_index() for `index`.
+ * @return The number of slots since the previous local slot (strictly before `index`).
+ */
+static inline uint16_t GTTCAN_calculate_slots_since_last(const uint16_t *slotIDs, uint8_t localLength, uint32_t scheduleLength,
+                                                         uint16_t index, uint8_t next)
+{
+    if (localLength == 0U)
+    {
+        return index; // cppcheck-suppress misra-c2012-15.5
+    }
+    uint32_t previous = next;
+    if ((previous > 0U) && (slotIDs[previous - 1U] == index))
+    {
+        previous--; // skip our own slot
+    }
+    const uint32_t distance = (previous > 0U) ?
+        ((uint32_t)index - (uint32_t)slotIDs[previous - 1U]) :
+        ((uint32_t)index + scheduleLength - (uint32_t)slotIDs[localLength - 1U]); // last slot of the previous round
+    return (uint16_t)distance;
+}
+
+/**
+ * @brief Return the local schedule index of the next local transmission after a global index.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param index The global schedule index (must be within the schedule).
+ * @return The index into the local schedule.
+ */
+static inline uint8_t GTTCAN_next_local_schedule_index(const gttcan_t *gttcan, uint16_t index)
+{
+    const gttcan_node_schedule_t * const node_schedule = gttcan->node_schedule;
+#if GTTCAN_TRANSMIT_TABLES
+    return node_schedule->nextLocalScheduleIndex[index];
+#else
+    const uint8_t next = GTTCAN_find_next_local_index(node_schedule->localScheduleSlotID, node_schedule->localScheduleLength, index);
+    return (next < node_schedule->localScheduleLength) ? next : 0U;
+#endif
+}
+
+#if GTTCAN_TRANSMIT_TABLES
+/**
+ * @brief Build the per-global-index transmit lookup tables.
+ *
+ * For every index of the global schedule, this function records
+ * the number of slots to the next local transmission (strictly after
+ * the index), the number of slots since the previous local transmission
+ * (strictly before the index), and the local schedule index of the next
+ * local transmission.  This turns the distance calculations on the
+ * receive and timer paths into a single table lookup.
+ *
+ * @param slotIDs The global schedule indices of the local schedule.
+ * @param localLength The length of the local schedule.
+ * @param scheduleLength The length of the global schedule.
+ * @param slotsToNext Receives `slotsToNextTransmit`.
+ * @param slotsSinceLast Receives `slotsSinceLastTransmit`.
+ * @param nextLocalIndex Receives `nextLocalScheduleIndex`.
+ */
+static void GTTCAN_build_transmit_tables(const uint16_t *slotIDs, uint8_t localLength, uint16_t scheduleLength,
+                                         uint16_t *slotsToNext, uint16_t *slotsSinceLast, uint8_t *nextLocalIndex)
+{
+    for (uint16_t index = 0U; index < scheduleLength; index++)
+    {
+        const uint8_t next = GTTCAN_find_next_local_index(slotIDs, localLength, index);
+        slotsToNext[index] = GTTCAN_calculate_slots_to_next(slotIDs, localLength, scheduleLength, index, next);
+        slotsSinceLast[index] = GTTCAN_calculate_slots_since_last(slotIDs, localLength, scheduleLength, index, next);
+        nextLocalIndex[index] = (next < localLength) ? next : 0U;
+    }
+}
+#endif
+
+/**
+ * @brief Return an entry of packed global schedule entries.
+ *
+ * @param entries The packed entries, or NULL if all slots are free.
+ * @param index The global schedule index (must be within the schedule).
+ * @return The node ID in bits 16-23 and the data ID in bits 0-15.
+ */
+static inline uint32_t GTTCAN_read_schedule_entry(const uint8_t *entries, uint16_t index)
+{
+    if (entries == (const uint8_t *)0)
+    {
+        return 0U; // cppcheck-suppress misra-c2012-15.5
+    }
+    const uint8_t * const entry = &entries[(uint32_t)index * GTTCAN_SCHEDULE_ENTRY_SIZE];
+    return ((uint32_t)entry[0] << 16U) | (uint32_t)GTTCAN_read_le16(&entry[1]);
+}
+
+/**
+ * @brief Count the slots of the global schedule that belong to a node.
+ *
+ * @param entries The packed entries, or NULL if all slots are free.
+ * @param scheduleLength The length of the global schedule.
+ * @param localNodeId The node ID.
+ * @param arbitration Whether the arbitration slots are part of the local schedule.
+ * @return The length of the local schedule.
+ */
+static uint32_t GTTCAN_count_local_slots(const uint8_t *entries, uint16_t scheduleLength, uint8_t localNodeId, bool arbitration)
+{
+    uint32_t localLength = 0U;
+    for (uint16_t i = 0U; i < scheduleLength; i++)
+    {
+        const uint8_t nodeid = (uint8_t)((GTTCAN_read_schedule_entry(entries, i) >> 16) & 0XFFU);
+        if ((nodeid == localNodeId) || ((nodeid == (uint8_t)GTTCAN_ARBITRATION_NODE) && arbitration))
+        {
+            localLength++;
+        }
+    }
+    return localLength;
+}
+
+/**
+ * @brief Build a node schedule from packed global schedule entries.
+ *
+ * This function collects the slots of the global schedule that belong
+ * to the node (and the arbitration slots if requested) and builds the
+ * transmit lookup tables.
+ *
+ * @param node_schedule Receives the node schedule.
+ * @param entries The packed entries, or NULL if all slots are free.
+ * @param scheduleLength The length of the global schedule.
+ * @param slotduration The slot duration in NTU, 0 to keep the configured one.
+ * @param localNodeId The node ID.
+ * @param arbitration Whether the arbitration slots are part of the local schedule.
+ * @return false (leaving `node_schedule` unchanged) if the node has more
+ *         than #GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH slots.
+ */
+static bool GTTCAN_fill_node_schedule(gttcan_node_schedule_t *node_schedule, const uint8_t *entries, uint16_t scheduleLength,
+                                      uint32_t slotduration, uint8_t localNodeId, bool arbitration)
+{
+    if (GTTCAN_count_local_slots(entries, scheduleLength, localNodeId, arbitration) > (uint32_t)GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH)
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    uint8_t localLength = 0U;
+    for (uint16_t i = 0; i < scheduleLength; i++)
+    {
+        const uint32_t entry = GTTCAN_read_schedule_entry(entries, i);
+        uint8_t nodeid = (uint8_t)((entry >> 16) & 0XFFU);
+        uint16_t dataid = (uint16_t)(entry & 0xFFFFU);
+        const bool arbitrationSlot = (nodeid == (uint8_t)GTTCAN_ARBITRATION_NODE) && arbitration;
+        if ((nodeid == localNodeId) || arbitrationSlot)
+        {
+            node_schedule->localScheduleSlotID[localLength] = i;
+            node_schedule->localScheduleDataID[localLength] = arbitrationSlot ? (uint16_t)GTTCAN_ARBITRATION_DATAID : dataid;
+            localLength++;
+        }
+    }
+    node_schedule->schedule = entries;
+    node_schedule->slotduration = slotduration;
+    node_schedule->globalScheduleLength = scheduleLength;
+    node_schedule->localNodeId = localNodeId;
+    node_schedule->localScheduleLength = localLength;
+    node_schedule->arbitration = arbitration;
+#if GTTCAN_TRANSMIT_TABLES
+    GTTCAN_build_transmit_tables(node_schedule->localScheduleSlotID, localLength, scheduleLength,
+                                 node_schedule->slotsToNextTransmit, node_schedule->slotsSinceLastTransmit,
+                                 node_schedule->nextLocalScheduleIndex);
+#endif
+    return true;
+}
+
+#if GTTCAN_EMBEDDED_SCHEDULE
+/**
+ * @brief Copy the used part of a node schedule.
+ *
+ * @param destination The node schedule to overwrite.
+ * @param source The node schedule to copy.
+ */
+static void GTTCAN_copy_node_schedule(gttcan_node_schedule_t *destination, const gttcan_node_schedule_t *source)
+{
+    destination->schedule = source->schedule;
+    destination->slotduration = source->slotduration;
+    destination->globalScheduleLength = source->globalScheduleLength;
+    destination->localNodeId = source->localNodeId;
+    destination->localScheduleLength = source->localScheduleLength;
+    destination->arbitration = source->arbitration;
+    for (uint8_t i = 0U; i < source->localScheduleLength; i++)
+    {
+        destination->localScheduleSlotID[i] = source->localScheduleSlotID[i];
+        destination->localScheduleDataID[i] = source->localScheduleDataID[i];
+    }
+#if GTTCAN_TRANSMIT_TABLES
+    for (uint16_t index = 0U; index < source->globalScheduleLength; index++)
+    {
+        destination->slotsToNextTransmit[index] = source->slotsToNextTransmit[index];
+        destination->slotsSinceLastTransmit[index] = source->slotsSinceLastTransmit[index];
+        destination->nextLocalScheduleIndex[index] = source->nextLocalScheduleIndex[index];
+    }
+#endif
+}
+#else
+/**
+ * @brief The schedule of instances without a node schedule: no slots, so all frames are ignored.
+ */
+static const gttcan_node_schedule_t GTTCAN_empty_node_schedule = { 0 };
+#endif
+
+/**
+ * @brief Return whether a node schedule can be used by an instance.
+ */
+static inline bool GTTCAN_node_schedule_matches(const gttcan_t *gttcan, const gttcan_node_schedule_t *node_schedule)
+{
+    return (node_schedule->localNodeId == gttcan->localNodeId) &&
+        (node_schedule->arbitration == (gttcan->sporadic != (struct gttcan_sporadic_s *)0));
+}
+
+/**
+ * @brief Make a node schedule the current one and reset the node.
+ *
+ * The node is reset to the inactive state at the start of the schedule.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param node_schedule The node schedule.
+ */
+static void GTTCAN_use_node_schedule(gttcan_t *gttcan, const gttcan_node_schedule_t *node_schedule)
+{
+    gttcan->node_schedule = node_schedule;
+    if (node_schedule->slotduration != 0U)
+    {
+        gttcan->slotduration = node_schedule->slotduration;
+    }
+    gttcan->isActive = false;
+    gttcan->transmitted = false;
+    gttcan->join.consistent = 0U;
+    gttcan->localScheduleIndex = 0;
+    gttcan->lastTransmitIndex = 0U;
+    gttcan->scheduleStale = false;
+    // Reset the FTA
+    (void) GTTCAN_fta(gttcan);
+}
+
+/**
+ * @brief Validate a packed binary schedule blob.
+ *
+ * @param schedule Pointer to the schedule blob.
+ * @param size The size of the blob in bytes.
+ * @param length Receives the length of the global schedule.
+ * @param slotduration Receives the slot duration (0 = keep the configured one).
+ * @return true if the blob is a valid schedule.
+ */
+static bool GTTCAN_parse_schedule(const uint8_t *schedule, uint32_t size, uint16_t *length, uint32_t *slotduration)
+{
+    if ((schedule == (const uint8_t *)0) || (size < GTTCAN_SCHEDULE_HEADER_SIZE) ||
+        (schedule[0] != GTTCAN_SCHEDULE_MAGIC_0) || (schedule[1] != GTTCAN_SCHEDULE_MAGIC_1) ||
+        (schedule[2] != GTTCAN_SCHEDULE_MAGIC_2) || (schedule[3] != GTTCAN_SCHEDULE_MAGIC_3) ||
+        (schedule[4] != GTTCAN_SCHEDULE_VERSION))
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    *length = GTTCAN_read_le16(&schedule[6]);
+    *slotduration = GTTCAN_read_le32(&schedule[8]);
+    if ((*length == 0U) || ((uint32_t)*length > GTTCAN_MAX_SCHEDULE_LENGTH) || (size < GTTCAN_SCHEDULE_SIZE(*length)))
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+#if GTTCAN_NUM_DATAID_BITS < 16
+    const uint8_t * const entries = &schedule[GTTCAN_SCHEDULE_HEADER_SIZE];
+    for (uint16_t i = 0U; i < *length; i++)
+    {
+        if (!GTTCAN_DATAID_FITS(GTTCAN_read_le16(&entries[(i * GTTCAN_SCHEDULE_ENTRY_SIZE) + 1U])))
+        {
+            return false; // cppcheck-suppress misra-c2012-15.5
+        }
+    }
+#endif
+    return true;
+}
+
+/**
+ * @brief Initialize a GTTCAN instance.
+ *
+ * The instance starts with a global schedule of `globalScheduleLength`
+ * free slots.  Use GTTCAN_load_schedule() to load the actual schedule.
+ * Without #GTTCAN_EMBEDDED_SCHEDULE, the instance has an empty schedule
+ * and ignores all frames until GTTCAN_set_node_schedule() is called.
+ *
+ * @param gttcan The GTTCAN instance to initialize.
+ * @param localNodeId The local node ID.
+ * @param slotduration The duration of a slot.
+ * @param globalScheduleLength The length of the global schedule.
+ * @param transmit_callback The transmit callback function.
+ * @param set_timer_int_callback The set timer interrupt callback function.
+ * @param read_value The read value function.
+ * @param write_value The write value function.
+ * @param context_pointer The context pointer.
+ */
+void GTTCAN_init(gttcan_t *gttcan,
+                 uint8_t localNodeId,
+                 uint32_t slotduration,
+                 uint16_t globalScheduleLength,
+                 transmit_callback_fp transmit_callback,
+                 set_timer_int_callback_fp set_timer_int_callback,
+                 read_value_fp read_value,
+                 write_value_fp write_value,
+                 void *context_pointer)
+{
+    gttcan->slotduration = slotduration;
+    gttcan->localNodeId = localNodeId;
+    gttcan->action_time = 0;
+    gttcan->error_offset = 0;
+    GTTCAN_set_exact_slot_offset(gttcan, 0U, 0U);
+    GTTCAN_set_clock_servo(gttcan, false, (uint8_t)GTTCAN_SERVO_KP_SHIFT, (uint8_t)GTTCAN_SERVO_KI_SHIFT, 0U);
+    (void)GTTCAN_set_fta(gttcan, 1U, 1U);
+    GTTCAN_set_fast_join(gttcan, 0U);
+
+    gttcan->transmit_callback = transmit_callback;
+    gttcan->set_timer_int_callback = set_timer_int_callback;
+    gttcan->read_value = read_value;
+    gttcan->write_value = write_value;
+    gttcan->context_pointer = context_pointer;
+    gttcan->rx_ring = (struct gttcan_rx_ring_s *)0;
+    gttcan->whiteboard = (struct gttcan_whiteboard_s *)0;
+    gttcan->stats = (struct gttcan_stats_s *)0;
+#if GTTCAN_TRACE
+    gttcan->trace = (struct gttcan_trace_s *)0;
+#endif
+    gttcan->fd = (struct gttcan_fd_s *)0;
+    gttcan->sporadic = (struct gttcan_sporadic_s *)0;
+    gttcan->staging = (struct gttcan_staging_s *)0;
+    gttcan->global_clock = (struct gttcan_clock_s *)0;
+
+    // Create Local Schedule
+#if GTTCAN_EMBEDDED_SCHEDULE
+    (void)GTTCAN_fill_node_schedule(&gttcan->embedded_schedule, (const uint8_t *)0,
+                                    ((uint32_t)globalScheduleLength > GTTCAN_MAX_SCHEDULE_LENGTH) ?
+                                        (uint16_t)GTTCAN_MAX_SCHEDULE_LENGTH : globalScheduleLength,
+                                    0U, localNodeId, false); // no local slots
+    GTTCAN_use_node_schedule(gttcan, &gttcan->embedded_schedule);
+#else
+    (void)globalScheduleLength;
+    GTTCAN_use_node_schedule(gttcan, &GTTCAN_empty_node_schedule);
+#endif
+}
+
+/**
+ * @brief Load a global schedule from a packed binary blob.
+ *
+ * The blob is referenced, not copied, so it must remain valid
+ * (and unchanged) for as long as the instance uses it.
+ * This allows the schedule to live in a flash-resident const
+ * table on MCUs or in a memory-mapped file on hosts.
+ * The local schedule is rebuilt, and the node is deactivated
+ * until the next start-of-schedule reference frame.
+ *
+ * @param gttcan The GTTCAN instance (initialised with GTTCAN_init()).
+ * @param schedule Pointer to the schedule blob.
+ * @param size The size of the blob in bytes.
+ * @return true if the schedule was valid and loaded, false otherwise,
+ *         e.g. if the node has more than #GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH
+ *         slots (always without #GTTCAN_EMBEDDED_SCHEDULE).
+ */
+bool GTTCAN_load_schedule(gttcan_t *gttcan, const uint8_t *schedule, uint32_t size)
+{
+#if GTTCAN_EMBEDDED_SCHEDULE
+    if (!GTTCAN_build_node_schedule(&gttcan->embedded_schedule, schedule, size, gttcan->localNodeId,
+                                    gttcan->sporadic != (struct gttcan_sporadic_s *)0))
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    GTTCAN_use_node_schedule(gttcan, &gttcan->embedded_schedule);
+    return true;
+#else
+    (void)gttcan;
+    (void)schedule;
+    (void)size;
+    return false;
+#endif
+}
+
+/**
+ * @brief Build the read-only schedule of a node from a packed binary blob.
+ *
+ * The result can be attached to any number of instances with the node
+ * ID `localNodeId` with GTTCAN_set_node_schedule().  The blob is
+ * referenced, not copied, like by GTTCAN_load_schedule().
+ *
+ * @param node_schedule Receives the node schedule.
+ * @param schedule Pointer to the schedule blob.
+ * @param size The size of the blob in bytes.
+ * @param localNodeId The node ID.
+ * @param arbitration Whether to add the arbitration slots to the local
+ *                    schedule, for instances with a sporadic message queue.
+ * @return true if the schedule was valid, false if the blob is invalid
+ *         (see #GTTCAN_MAX_SCHEDULE_LENGTH) or the node has more than
+ *         #GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH slots.
+ */
+bool GTTCAN_build_node_schedule(gttcan_node_schedule_t *node_schedule, const uint8_t *schedule, uint32_t size,
+                                uint8_t localNodeId, bool arbitration)
+{
+    uint16_t length;
+    uint32_t slotduration;
+    if (!GTTCAN_parse_schedule(schedule, size, &length, &slotduration))
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    return GTTCAN_fill_node_schedule(node_schedule, &schedule[GTTCAN_SCHEDULE_HEADER_SIZE], length, slotduration,
+                                     localNodeId, arbitration);
+}
+
+/**
+ * @brief Attach a shared node schedule.
+ *
+ * Like GTTCAN_load_schedule(), but the instance references the node
+ * schedule instead of building its own: the node is deactivated until
+ * the next start-of-schedule reference frame.  The node schedule must
+ * remain valid (and unchanged) for as long as the instance uses it.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param node_schedule The node schedule (see GTTCAN_build_node_schedule()).
+ * @return false if the node schedule was built for another node ID, or
+ *         its arbitration slots do not match whether a sporadic message
+ *         queue is attached.
+ */
+bool GTTCAN_set_node_schedule(gttcan_t *gttcan, const gttcan_node_schedule_t *node_schedule)
+{
+    if (!GTTCAN_node_schedule_matches(gttcan, node_schedule))
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    GTTCAN_use_node_schedule(gttcan, node_schedule);
+    return true;
+}
+
+/**
+ * @brief Initialise an empty staging buffer.
+ *
+ * @param staging The buffer.
+ */
+void GTTCAN_staging_init(gttcan_staging_t *staging)
+{
+    staging->node_schedule = (const gttcan_node_schedule_t *)0;
+    staging->switches = 0U;
+    GTTCAN_ATOMIC_INIT(staging->state, GTTCAN_STAGING_EMPTY);
+    GTTCAN_ATOMIC_INIT(staging->announce, 0U);
+}
+
+/**
+ * @brief Attach a buffer for staging the next global schedule.
+ *
+ * See GTTCAN_stage_schedule() and gttcan_staging.h.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param staging The buffer (initialised with GTTCAN_staging_init()),
+ *                or NULL to detach it.
+ */
+void GTTCAN_set_staging(gttcan_t *gttcan, gttcan_staging_t *staging)
+{
+    gttcan->staging = staging;
+}
+
+/**
+ * @brief Stage the next global schedule without interrupting the current one.
+ *
+ * Validates the blob (like GTTCAN_load_schedule(), and referenced in
+ * the same way) and precomputes its local schedule and transmit tables
+ * in the attached staging buffer.  The schedule takes effect with the
+ * next start-of-schedule frame that carries #GTTCAN_SCHEDULE_SWITCH_FLAG,
+ * without touching the activation, clock servo or FTA state.  Can be
+ * called from a lower-priority context than the protocol (the main loop).
+ *
+ * @param gttcan The GTTCAN instance, with a staging buffer attached.
+ * @param schedule Pointer to the schedule blob.
+ * @param size The size of the blob in bytes.
+ * @return false if no staging buffer is attached, a staged schedule is
+ *         still waiting for its switch, or the blob is invalid (always
+ *         without #GTTCAN_EMBEDDED_SCHEDULE, see GTTCAN_stage_node_schedule()).
+ */
+bool GTTCAN_stage_schedule(gttcan_t *gttcan, const uint8_t *schedule, uint32_t size)
+{
+#if GTTCAN_EMBEDDED_SCHEDULE
+    gttcan_staging_t * const staging = gttcan->staging;
+    if ((staging == (gttcan_staging_t *)0) || (GTTCAN_ATOMIC_LOAD(staging->state, acquire) != GTTCAN_STAGING_EMPTY) ||
+        !GTTCAN_build_node_schedule(&staging->built, schedule, size, gttcan->localNodeId,
+                                    gttcan->sporadic != (struct gttcan_sporadic_s *)0))
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    staging->node_schedule = &staging->built;
+    GTTCAN_ATOMIC_STORE(staging->announce, 0U, relaxed);
+    GTTCAN_ATOMIC_STORE(staging->state, GTTCAN_STAGING_STAGED, release);
+    return true;
+#else
+    (void)gttcan;
+    (void)schedule;
+    (void)size;
+    return false;
+#endif
+}
+
+/**
+ * @brief Stage a shared node schedule as the next schedule.
+ *
+ * Like GTTCAN_stage_schedule(), but the instance references the node
+ * schedule (see GTTCAN_set_node_schedule()) once it switches to it,
+ * instead of copying staged tables.
+ *
+ * @param gttcan The GTTCAN instance, with a staging buffer attached.
+ * @param node_schedule The node schedule (see GTTCAN_build_node_schedule()).
+ * @return false if no staging buffer is attached, a staged schedule is
+ *         still waiting for its switch, or the node schedule does not
+ *         match the instance.
+ */
+bool GTTCAN_stage_node_schedule(gttcan_t *gttcan, const gttcan_node_schedule_t *node_schedule)
+{
+    gttcan_staging_t * const staging = gttcan->staging;
+    if ((staging == (gttcan_staging_t *)0) || (GTTCAN_ATOMIC_LOAD(staging->state, acquire) != GTTCAN_STAGING_EMPTY) ||
+        !GTTCAN_node_schedule_matches(gttcan, node_schedule))
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    staging->node_schedule = node_schedule;
+    GTTCAN_ATOMIC_STORE(staging->announce, 0U, relaxed);
+    GTTCAN_ATOMIC_STORE(staging->state, GTTCAN_STAGING_STAGED, release);
+    return true;
+}
+
+/**
+ * @brief Switch all nodes to the staged schedule (time master only).
+ *
+ * The next start-of-schedule frame sent by this node carries
+ * #GTTCAN_SCHEDULE_SWITCH_FLAG, and this node switches with it.  The
+ * staged schedule must keep slot 0 as the reference slot of this node.
+ * The same schedule has to be staged on every node first: a node that
+ * receives the flag without a staged schedule deactivates itself until
+ * a schedule is loaded with GTTCAN_load_schedule().
+ *
+ * @param gttcan The GTTCAN instance, with a staged schedule.
+ * @return false if no schedule is staged.
+ */
+bool GTTCAN_request_schedule_switch(gttcan_t *gttcan)
+{
+    gttcan_staging_t * const staging = gttcan->staging;
+    if ((staging == (gttcan_staging_t *)0) || (GTTCAN_ATOMIC_LOAD(staging->state, acquire) != GTTCAN_STAGING_STAGED))
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    GTTCAN_ATOMIC_STORE(staging->announce, 1U, release);
+    return true;
+}
+
+/**
+ * @brief Return whether a staged schedule is ready to be switched to.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param announced Only if the time master was asked to switch.
+ */
+static inline bool GTTCAN_schedule_staged(const gttcan_t *gttcan, bool announced)
+{
+    const gttcan_staging_t * const staging = gttcan->staging;
+    return (staging != (gttcan_staging_t *)0) && (GTTCAN_ATOMIC_LOAD(staging->state, acquire) == GTTCAN_STAGING_STAGED) &&
+        (!announced || (GTTCAN_ATOMIC_LOAD(staging->announce, relaxed) != 0U));
+}
+
+/**
+ * @brief Make the staged schedule the current one.
+ *
+ * Called at the start of a round.  The local time reference of the node
+ * (its last transmission) is a slot of the previous schedule, so clock
+ * errors are only measured again after its first transmission in the
+ * new schedule.
+ *
+ * @param gttcan The GTTCAN instance, with a staged schedule.
+ */
+static void GTTCAN_commit_staged_schedule(gttcan_t *gttcan)
+{
+    gttcan_staging_t * const staging = gttcan->staging;
+    const gttcan_node_schedule_t *node_schedule = staging->node_schedule;
+#if GTTCAN_EMBEDDED_SCHEDULE
+    if (node_schedule == &staging->built) // the buffer is reused for the next schedule
+    {
+        GTTCAN_copy_node_schedule(&gttcan->embedded_schedule, node_schedule);
+        node_schedule = &gttcan->embedded_schedule;
+    }
+#endif
+    gttcan->node_schedule = node_schedule;
+    if (node_schedule->slotduration != 0U)
+    {
+        gttcan->slotduration = node_schedule->slotduration;
+    }
+    gttcan->transmitted = false;
+    gttcan->lastTransmitIndex = 0U;
+    gttcan->join.consistent = 0U;
+    staging->switches++;
+    GTTCAN_ATOMIC_STORE(staging->announce, 0U, relaxed);
+    GTTCAN_ATOMIC_STORE(staging->state, GTTCAN_STAGING_EMPTY, release);
+}
+
+/**
+ * @brief Attach a sporadic message queue.
+ *
+ * With a queue attached, the arbitration slots of the global schedule
+ * (see #GTTCAN_ARBITRATION_NODE) are added to the local schedule, and
+ * GTTCAN_transmit_next_frame() sends the most urgent queued message in
+ * them; in an arbitration slot without a queued message, nothing is sent.
+ * The driver has to report the outcome of every transmission with
+ * GTTCAN_transmit_result(), and should send the frames of arbitration
+ * slots single-shot (without automatic retransmission), so that a
+ * message that lost arbitration is retried in the next arbitration
+ * slot instead of disturbing the following slot.
+ * The local schedule is rebuilt, and the node is deactivated until the
+ * next start-of-schedule reference frame.  A shared node schedule (see
+ * GTTCAN_set_node_schedule()) is replaced by an embedded copy with or
+ * without the arbitration slots, or, without #GTTCAN_EMBEDDED_SCHEDULE,
+ * by an empty schedule until a matching one is attached.  See
+ * gttcan_sporadic.h.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param sporadic The queue (initialised with GTTCAN_sporadic_init()),
+ *                 or NULL to ignore the arbitration slots again.
+ * @return false (leaving the instance unchanged) if the local schedule
+ *         would have more than #GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH slots.
+ */
+bool GTTCAN_set_sporadic(gttcan_t *gttcan, gttcan_sporadic_t *sporadic)
+{
+    const gttcan_node_schedule_t * const current = gttcan->node_schedule;
+    const bool arbitration = (sporadic != (gttcan_sporadic_t *)0);
+#if GTTCAN_EMBEDDED_SCHEDULE
+    if (!GTTCAN_fill_node_schedule(&gttcan->embedded_schedule, current->schedule, current->globalScheduleLength,
+                                   current->slotduration, gttcan->localNodeId, arbitration))
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    gttcan->sporadic = sporadic;
+    GTTCAN_use_node_schedule(gttcan, &gttcan->embedded_schedule);
+#else
+    (void)arbitration;
+    gttcan->sporadic = sporadic;
+    GTTCAN_use_node_schedule(gttcan, GTTCAN_node_schedule_matches(gttcan, current) ? current : &GTTCAN_empty_node_schedule);
+#endif
+    return true;
+}
+
+/**
+ * @brief Pack a global schedule into a binary blob.
+ *
+ * This is the inverse of GTTCAN_load_schedule() and is meant for
+ * tools that generate schedules.  Each entry holds the node ID in
+ * bits 16-23 and the data ID in bits 0-15.
+ *
+ * @param blob The buffer receiving the blob.
+ * @param size The size of `blob` in bytes.
+ * @param entries The global schedule entries.
+ * @param length The number of entries.
+ * @param slotduration The slot duration in NTU (0 to keep the configured one).
+ * @return The number of bytes written, or 0 if `blob` is too small.
+ */
+uint32_t GTTCAN_pack_schedule(uint8_t *blob, uint32_t size, const uint32_t *entries, uint16_t length, uint32_t slotduration)
+{
+    const uint32_t blobSize = GTTCAN_SCHEDULE_SIZE(length);
+    if (size < blobSize)
+    {
+        return 0U; // cppcheck-suppress misra-c2012-15.5
+    }
+    blob[0] = GTTCAN_SCHEDULE_MAGIC_0;
+    blob[1] = GTTCAN_SCHEDULE_MAGIC_1;
+    blob[2] = GTTCAN_SCHEDULE_MAGIC_2;
+    blob[3] = GTTCAN_SCHEDULE_MAGIC_3;
+    blob[4] = GTTCAN_SCHEDULE_VERSION;
+    blob[5] = 0U; // reserved
+    blob[6] = (uint8_t)(length & 0xFFU);
+    blob[7] = (uint8_t)(length >> 8U);
+    for (uint32_t i = 0U; i < 4U; i++)
+    {
+        blob[8U + i] = (uint8_t)(slotduration >> (8U * i));
+    }
+    for (uint32_t i = 0U; i < length; i++)
+    {
+        uint8_t * const entry = &blob[GTTCAN_SCHEDULE_HEADER_SIZE + (i * GTTCAN_SCHEDULE_ENTRY_SIZE)];
+        entry[0] = (uint8_t)((entries[i] >> 16U) & 0xFFU);
+        entry[1] = (uint8_t)(entries[i] & 0xFFU);
+        entry[2] = (uint8_t)((entries[i] >> 8U) & 0xFFU);
+    }
+    return blobSize;
+}
+
+/**
+ * @brief Return an entry of the global schedule.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param index The global schedule index.
+ * @return The node ID in bits 16-23 and the data ID in bits 0-15,
+ *         or 0 (a free slot) if no schedule is loaded or `index`
+ *         is outside the schedule.
+ */
+uint32_t GTTCAN_get_schedule_entry(const gttcan_t *gttcan, uint16_t index)
+{
+    if (index >= gttcan->node_schedule->globalScheduleLength)
+    {
+        return 0U; // cppcheck-suppress misra-c2012-15.5
+    }
+    return GTTCAN_read_schedule_entry(gttcan->node_schedule->schedule, index);
+}
+
+/**
+ * @brief Configure the clock servo.
+ *
+ * Without the servo (the default), a node uses the nominal slot
+ * duration and only re-synchronises its phase when it re-arms the
+ * timer on a reference frame, so its timer drifts for up to a whole
+ * schedule round.  With the servo, every FTA result drives a PI
+ * controller: the integral term corrects the slot duration, kept with
+ * #GTTCAN_SERVO_FRACTION_BITS fractional bits so that corrections
+ * below one NTU accumulate (limited to #GTTCAN_SERVO_MAX_PPM), and the
+ * proportional term shifts the next timer interrupt (limited to half a
+ * slot).  Configuring the servo resets its state.
+ *
+ * The integral term drives the mean FTA error to zero, so a constant
+ * delay between the start of a received frame and the `current_time`
+ * passed for it (interrupt latency, timestamping in the CAN
+ * controller) has to be given as `timestamp_latency`; otherwise the
+ * servo would lengthen the slots to make up for it.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param enabled Whether to correct the clock rate and phase.
+ * @param kp_shift Proportional gain 2^-kp_shift (e.g. #GTTCAN_SERVO_KP_SHIFT).
+ * @param ki_shift Integral gain 2^-ki_shift per schedule round (e.g. #GTTCAN_SERVO_KI_SHIFT).
+ * @param timestamp_latency Mean receive timestamp latency in NTU.
+ */
+void GTTCAN_set_clock_servo(gttcan_t *gttcan, bool enabled, uint8_t kp_shift, uint8_t ki_shift, uint32_t timestamp_latency)
+{
+    gttcan->servo.rate_correction = 0;
+    gttcan->servo.phase_correction = 0;
+    gttcan->servo.last_error = 0;
+    gttcan->servo.updates = 0U;
+    gttcan->servo_remainder = 0U;
+    gttcan->servo.timestamp_latency = timestamp_latency;
+    gttcan->servo.kp_shift = (kp_shift > 30U) ? 30U : kp_shift;
+    gttcan->servo.ki_shift = (ki_shift > 30U) ? 30U : ki_shift;
+    gttcan->servo.enabled = enabled;
+}
+
+/**
+ * @brief Configure the fast join.
+ *
+ * By default, an inactive node waits for a start-of-schedule reference
+ * frame before it transmits, which can take up to a full round after a
+ * reset or hot-plug.  With the fast join, an inactive node derives its
+ * position in the round from the global schedule index of any received
+ * frame and activates once `observations` frames in a row were
+ * consistent: the time between two frames matches the distance of
+ * their indices (modulo whole rounds) within
+ * #GTTCAN_JOIN_TOLERANCE_SHIFT.  The node then arms its timer for its
+ * next slot.  Clock errors are only accumulated after the first local
+ * transmission, so the `current_time` of the frames before it only
+ * needs a common, arbitrary reference.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param observations Consistent frames needed to join, 1 to join on the
+ *                     first frame, 0 to wait for a start-of-schedule frame (the default).
+ */
+void GTTCAN_set_fast_join(gttcan_t *gttcan, uint8_t observations)
+{
+    gttcan->join.last_time = 0U;
+    gttcan->join.last_index = 0U;
+    gttcan->join.observations = observations;
+    gttcan->join.consistent = 0U;
+}
+
+/**
+ * @brief Return the corrected slot duration.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @return The slot duration in local time, in 2^-#GTTCAN_SERVO_FRACTION_BITS NTU.
+ */
+uint64_t GTTCAN_get_corrected_slot_duration(const gttcan_t *gttcan)
+{
+    const int64_t nominal = (int64_t)((uint64_t)gttcan->slotduration << GTTCAN_SERVO_FRACTION_BITS);
+    return (uint64_t)(nominal - (int64_t)gttcan->servo.rate_correction);
+}
+
+/**
+ * @brief Return the local duration of a number of slots in NTU.
+ */
+static inline uint32_t GTTCAN_slots_duration(const gttcan_t *gttcan, uint32_t slots)
+{
+    if (!gttcan->servo.enabled)
+    {
+        return slots * gttcan->slotduration; // cppcheck-suppress misra-c2012-15.5
+    }
+    return (uint32_t)(((uint64_t)slots * GTTCAN_get_corrected_slot_duration(gttcan)) >> GTTCAN_SERVO_FRACTION_BITS);
+}
+
+/**
+ * @brief Return the timer delay for a number of slots in NTU.
+ *
+ * Like GTTCAN_slots_duration(), but the fraction of an NTU that is
+ * cut off is carried over to the next delay, and the phase correction
+ * is subtracted.
+ */
+static inline uint32_t GTTCAN_timer_delay(gttcan_t *gttcan, uint32_t slots, int32_t phase_correction)
+{
+    if (!gttcan->servo.enabled)
+    {
+        return slots * gttcan->slotduration; // cppcheck-suppress misra-c2012-15.5
+    }
+    const uint64_t duration = ((uint64_t)slots * GTTCAN_get_corrected_slot_duration(gttcan)) + gttcan->servo_remainder;
+    gttcan->servo_remainder = (uint32_t)(duration & (((uint64_t)1U << GTTCAN_SERVO_FRACTION_BITS) - 1U));
+    const int64_t delay = (int64_t)(duration >> GTTCAN_SERVO_FRACTION_BITS) - (int64_t)phase_correction;
+    return (delay < 0) ? 0U : (uint32_t)delay;
+}
+
+/**
+ * @brief Feed an FTA result to the clock servo.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param error The FTA error in NTU (positive if frames arrived early).
+ * @return The phase correction for the next timer delay in NTU.
+ */
+static int32_t GTTCAN_servo_update(gttcan_t *gttcan, int32_t error)
+{
+    gttcan_servo_t * const servo = &gttcan->servo;
+    if (!servo->enabled)
+    {
+        return 0; // cppcheck-suppress misra-c2012-15.5
+    }
+    const int64_t nominal = (int64_t)((uint64_t)gttcan->slotduration << GTTCAN_SERVO_FRACTION_BITS);
+    int64_t limit = (nominal * (int64_t)GTTCAN_SERVO_MAX_PPM) / 1000000;
+    limit = (limit > (int64_t)INT32_MAX) ? (int64_t)INT32_MAX : limit;
+    const uint16_t length = gttcan->node_schedule->globalScheduleLength;
+    const int64_t round = (length > 0U) ? (int64_t)length : 1;
+    const int64_t window = round << servo->ki_shift;
+    int64_t rate = (int64_t)servo->rate_correction + ((((int64_t)error) * ((int64_t)1 << GTTCAN_SERVO_FRACTION_BITS)) / window);
+    rate = (rate > limit) ? limit : ((rate < -limit) ? -limit : rate);
+    const int32_t half_slot = (int32_t)(gttcan->slotduration / 2U);
+    int32_t phase = error / (int32_t)((uint32_t)1U << servo->kp_shift);
+    phase = (phase > half_slot) ? half_slot : ((phase < -half_slot) ? -half_slot : phase);
+
+    servo->rate_correction = (int32_t)rate;
+    servo->phase_correction = phase;
+    servo->last_error = error;
+    servo->updates++;
+    return phase;
+}
+
+/**
+ * @brief Observe a received frame while joining, see GTTCAN_set_fast_join().
+ *
+ * A frame is consistent with the previous one if the local time
+ * between them is within the join tolerance of the nominal duration
+ * of the slots between their global schedule indices, plus any number
+ * of whole rounds (frames may have been missed).  An inconsistent
+ * frame restarts the count with itself.
+ *
+ * @param gttcan The GTTCAN instance (inactive, with the fast join enabled).
+ * @param index The global schedule index of the frame (within the schedule).
+ * @return true once enough consistent frames have been observed.
+ */
+static bool GTTCAN_join_observe(gttcan_t *gttcan, uint16_t index)
+{
+    gttcan_join_t * const join = &gttcan->join;
+    const uint32_t length = gttcan->node_schedule->globalScheduleLength;
+    const uint32_t round = GTTCAN_slots_duration(gttcan, length);
+    const uint32_t tolerance = gttcan->slotduration >> GTTCAN_JOIN_TOLERANCE_SHIFT;
+    bool consistent = false;
+    if ((join->consistent > 0U) && (round > (2U * tolerance)))
+    {
+        const uint32_t slots = (((uint32_t)index + length) - (uint32_t)join->last_index) % length;
+        const uint32_t expected = GTTCAN_slots_duration(gttcan, (slots == 0U) ? length : slots);
+        const uint32_t elapsed = (gttcan->action_time - join->last_time) + tolerance;
+        consistent = (elapsed >= expected) && (((elapsed - expected) % round) <= (2U * tolerance));
+    }
+    join->consistent = consistent ? (uint8_t)(join->consistent + 1U) : 1U;
+    join->last_time = gttcan->action_time;
+    join->last_index = index;
+    return join->consistent >= join->observations;
+}
+
+/**
+ * @brief Record a timer re-arm in the statistics, if attached.
+ *
+ * The recorded delta is the correction applied by the re-arm, i.e.
+ * the timer delay minus the nominal duration of the same number of slots.
+ */
+static inline void GTTCAN_record_rearm(gttcan_t *gttcan, uint32_t slots, uint32_t timer_delay)
+{
+    if (gttcan->stats != (struct gttcan_stats_s *)0)
+    {
+        GTTCAN_stats_record_rearm(gttcan->stats, (int32_t)(timer_delay - (slots * gttcan->slotduration)));
+    }
+}
+
+/**
+ * @brief Append an event to the trace ring, if tracing is compiled in and a ring is attached.
+ */
+static inline void GTTCAN_trace_event(const gttcan_t *gttcan, uint8_t type, uint8_t flags, uint32_t current_time,
+                                      uint16_t index, uint16_t slotID, int32_t error, uint32_t timer)
+{
+#if GTTCAN_TRACE
+    if (gttcan->trace != (struct gttcan_trace_s *)0)
+    {
+        const uint8_t active = gttcan->isActive ? (uint8_t)GTTCAN_TRACE_FLAG_ACTIVE : 0U;
+        const gttcan_trace_record_t record = {
+            current_time, error, gttcan->error_offset, timer, index, slotID, type, (uint8_t)(flags | active), 0U
+        };
+        GTTCAN_trace_append(gttcan->trace, &record);
+    }
+#else
+    (void)gttcan;
+    (void)type;
+    (void)flags;
+    (void)current_time;
+    (void)index;
+    (void)slotID;
+    (void)error;
+    (void)timer;
+#endif
 }
 
+/**
+ * @brief Record a reference frame on the global clock, if attached.
+ *
+ * The drift is that of the corrected slot duration against the
+ * nominal one, i.e. 0 without the clock servo and on the time master.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param time The network time of the frame in NTU.
+ * @param current_time The start of the frame, relative to the `current_time` reference.
+ * @param master Whether the local node sent the frame.
+ */
+static inline void GTTCAN_record_anchor(gttcan_t *gttcan, uint64_t time, uint32_t current_time, bool master)
+{
+    gttcan_clock_t * const global_clock = gttcan->global_clock;
+    if (global_clock != (struct gttcan_clock_s *)0)
+    {
+        int64_t drift = 0;
+        if (gttcan->servo.enabled && !master)
+        {
+            const int64_t corrected = (int64_t)GTTCAN_get_corrected_slot_duration(gttcan);
+            drift = (corrected > 0) ? (((int64_t)gttcan->servo.rate_correction * ((int64_t)1 << 32U)) / corrected) : 0;
+        }
+        GTTCAN_clock_write(global_clock, time, global_clock->reference + current_time, (int32_t)drift);
+    }
+}
 
 /**
- * @brief Initialize a GTTCAN instance.
+ * @brief Pass a received value to the whiteboard.
  *
- * @param gttcan The GTTCAN instance to initialize.
- * @param localNodeId The local node ID.
- * @param slotduration The duration of a slot.
- * @param globalScheduleLength The length of the global schedule.
- * @param transmit_callback The transmit callback function.
- * @param set_timer_int_callback The set timer interrupt callback function.
- * @param read_value The read value function.
- * @param write_value The write value function.
- * @param context_pointer The context pointer.
+ * Queues the value on the receive ring for GTTCAN_drain_rx_ring()
+ * if one is attached, otherwise writes it to the built-in whiteboard
+ * or calls `write_value`.
  */
-void GTTCAN_init(gttcan_t *gttcan,
-                 uint8_t localNodeId,
-                 uint32_t slotduration,
-                 uint16_t globalScheduleLength,
-                 transmit_callback_fp transmit_callback,
-                 set_timer_int_callback_fp set_timer_int_callback,
-                 read_value_fp read_value,
-                 write_value_fp write_value,
-                 void *context_pointer)
+static inline void GTTCAN_deliver_value(gttcan_t *gttcan, uint32_t current_time, uint32_t can_frame_id_field, uint16_t dataID, uint64_t value)
 {
-    gttcan->globalScheduleLength = globalScheduleLength;
-    gttcan->slotduration = slotduration;
-    gttcan->isActive = false;
-    gttcan->transmitted = false;
-    gttcan->localNodeId = localNodeId;
-    gttcan->action_time = 0;
-    gttcan->error_offset = 0;
+    if (gttcan->rx_ring != (struct gttcan_rx_ring_s *)0)
+    {
+        const gttcan_rx_frame_t frame = { current_time, can_frame_id_field, value };
+        (void)GTTCAN_rx_ring_push(gttcan->rx_ring, &frame);
+    }
+    else if (gttcan->whiteboard != (struct gttcan_whiteboard_s *)0)
+    {
+        (void)GTTCAN_whiteboard_write(gttcan->whiteboard, dataID, value, current_time);
+    }
+    else
+    {
+        gttcan->write_value(dataID, value, gttcan->context_pointer);
+    }
+}
 
-    gttcan->transmit_callback = transmit_callback;
-    gttcan->set_timer_int_callback = set_timer_int_callback;
-    gttcan->read_value = read_value;
-    gttcan->write_value = write_value;
-    gttcan->context_pointer = context_pointer;
+/**
+ * @brief Process a received CAN frame without re-arming the timer.
+ *
+ * This is GTTCAN_process_frame() except that the timer interrupt
+ * is returned instead of set, so that a batch of frames can
+ * re-arm the timer only once.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param current_time The local time since the last transmission.
+ * @param can_frame_id_field The ID field of the received CAN frame.
+ * @param received_data The data of the received CAN frame.
+ * @param payload The payload of a received CAN FD frame, passed to
+ *                `write_buffer` for data frames, or NULL.
+ * @param length The number of bytes of `payload`.
+ * @param timer_delay Receives the timer delay relative to this frame.
+ * @return true if the timer needs to be re-armed to `timer_delay`.
+ */
+static bool GTTCAN_ingest_frame(gttcan_t *gttcan, uint32_t current_time, uint32_t can_frame_id_field, const uint64_t received_data,
+                                const uint8_t *payload, uint8_t length, uint32_t *timer_delay)
+{
+    const uint32_t latency = gttcan->servo.timestamp_latency;
+    gttcan->action_time = (current_time > latency) ? (current_time - latency) : 0U;
+    uint64_t data = received_data;
+    bool rearm = false;
+    bool joined = false;
+    uint16_t slotID = GTTCAN_CAN_ID_DATAID(can_frame_id_field);
+    uint16_t globalScheduleIndex = GTTCAN_CAN_ID_INDEX(can_frame_id_field);
 
-    // FIXME: the following hard-coded slot initialisations need to be removed
-    // Create global schedule. This could be changed to whiteboard slots
-    gttcan->slots[0] = GTTCAN_create_entry(1, NETWORK_TIME_SLOT); // Reference Frame from Time Master
-    gttcan->slots[1] = GTTCAN_create_entry(10, NODE10_NUM_RECEIVED_FRAMES);
-    gttcan->slots[2] = GTTCAN_create_entry(8, NODE8_NUM_RECEIVED_FRAMES);
-    gttcan->slots[3] = GTTCAN_create_entry(9, NODE9_NUM_RECEIVED_FRAMES);
-    /*
-     gttcan->slots[1] = GTTCAN_create_entry(8, NODE8_NUM_RECEIVED_FRAMES);
-     gttcan->slots[2] = GTTCAN_create_entry(9, NODE9_NUM_RECEIVED_FRAMES);
-     gttcan->slots[3] = GTTCAN_create_entry(10, NODE10_NUM_RECEIVED_FRAMES);
-     gttcan->slots[4] = GTTCAN_create_entry(8, NODE8_NUM_RECEIVED_FRAMES);
-     gttcan->slots[5] = GTTCAN_create_entry(9, NODE9_NUM_RECEIVED_FRAMES);
-     gttcan->slots[6] = GTTCAN_create_entry(10, NODE10_NUM_RECEIVED_FRAMES);
-     gttcan->slots[7] = GTTCAN_create_entry(8, NODE8_NUM_RECEIVED_FRAMES);
-     gttcan->slots[8] = GTTCAN_create_entry(9, NODE9_NUM_RECEIVED_FRAMES);
-     gttcan->slots[9] = GTTCAN_create_entry(10, NODE10_NUM_RECEIVED_FRAMES);
-     gttcan->slots[10] = GTTCAN_create_entry(8, NODE8_NUM_RECEIVED_FRAMES);
-     gttcan->slots[11] = GTTCAN_create_entry(9, NODE9_NUM_RECEIVED_FRAMES);
-     gttcan->slots[12] = GTTCAN_create_entry(10, NODE10_NUM_RECEIVED_FRAMES);
-     gttcan->slots[13] = GTTCAN_create_entry(8, NODE8_NUM_RECEIVED_FRAMES);
-     gttcan->slots[14] = GTTCAN_create_entry(9, NODE9_NUM_RECEIVED_FRAMES);*/
+    if (globalScheduleIndex >= gttcan->node_schedule->globalScheduleLength)
+    {
+        // Error - invalid frame recieved
+        if (gttcan->stats != (struct gttcan_stats_s *)0)
+        {
+            GTTCAN_stats_record_invalid(gttcan->stats);
+        }
+        GTTCAN_trace_event(gttcan, (uint8_t)GTTCAN_TRACE_INVALID, 0U, current_time, globalScheduleIndex, slotID, 0, 0U);
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    gttcan->localScheduleIndex = GTTCAN_next_local_schedule_index(gttcan, globalScheduleIndex);
 
-    // Create Local Schedule
-    gttcan->localScheduleIndex = 0;
-    gttcan->localScheduleLength = 0;
-    for (uint16_t i = 0; i < globalScheduleLength; i++)
+    uint32_t slot_since_last = GTTCAN_get_slots_since_last_transmit(gttcan, globalScheduleIndex);
+    uint32_t expected_time = GTTCAN_slots_duration(gttcan, slot_since_last);
+    int32_t error = (int32_t)expected_time - (int32_t)gttcan->action_time; // positive if we received the frame earlier than expected
+
+    GTTCAN_accumulate_error(gttcan, error);
+    if (gttcan->stats != (struct gttcan_stats_s *)0)
+    {
+        GTTCAN_stats_record_frame(gttcan->stats, globalScheduleIndex, gttcan->node_schedule->globalScheduleLength,
+                                  slotID == (uint16_t)NETWORK_TIME_SLOT, gttcan->transmitted, error);
+    }
+    if (!gttcan->isActive && (gttcan->join.observations > 0U) && !gttcan->scheduleStale)
+    {
+        joined = GTTCAN_join_observe(gttcan, globalScheduleIndex);
+        gttcan->isActive = joined;
+    }
+
+    // If Reference Frame
+    if (slotID == (uint16_t)NETWORK_TIME_SLOT)
     {
-        uint8_t nodeid = (uint8_t)((uint32_t)(gttcan->slots[i] >> 16) & 0XFFU);
-        uint16_t dataid = (uint16_t)(gttcan->slots[i] & 0xFFFFU);
-        if (nodeid == localNodeId)
+        if ((data & 0x8000000000000000ULL) != 0U) // If Start-of-schedule frame
         {
-            gttcan->localScheduleSlotID[gttcan->localScheduleLength] = i;
-            gttcan->localScheduleDataID[gttcan->localScheduleLength] = dataid;
-            gttcan->localScheduleLength++;
-            if (gttcan->localScheduleLength >= (uint8_t)GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH)
+            if ((data & GTTCAN_SCHEDULE_SWITCH_FLAG) != 0U) // the new schedule starts with this frame
             {
-                break;
+                if (GTTCAN_schedule_staged(gttcan, false))
+                {
+                    GTTCAN_commit_staged_schedule(gttcan);
+                    gttcan->localScheduleIndex = GTTCAN_next_local_schedule_index(gttcan, globalScheduleIndex);
+                }
+                else
+                {
+                    gttcan->scheduleStale = true; // the slots of the new schedule are unknown
+                }
             }
+            gttcan->isActive = !gttcan->scheduleStale; // Activate node (if not already)
+        }
+        // Add the transmission time of the reference frame (exact or ~150us by default)
+        data = (data & 0x3FFFFFFFFFFFFFFFULL) + GTTCAN_reference_frame_offset(gttcan, can_frame_id_field, received_data);
+        // Update global time using Data && 0x3FFFFFFFFFFFFFFF
+        GTTCAN_deliver_value(gttcan, current_time, can_frame_id_field, NETWORK_TIME_SLOT, (data & 0x3FFFFFFFFFFFFFFFULL));
+        const bool measured = (gttcan->slots_accumulated > 0U);
+        gttcan->error_offset = GTTCAN_fta(gttcan);
+        const int32_t phase_correction = measured ? GTTCAN_servo_update(gttcan, gttcan->error_offset) : 0;
+        GTTCAN_record_anchor(gttcan, received_data & 0x3FFFFFFFFFFFFFFFULL, gttcan->action_time, false);
+        uint32_t slotsToNextEntry = GTTCAN_get_slots_to_next_transmit(gttcan, globalScheduleIndex);
+        *timer_delay = GTTCAN_timer_delay(gttcan, slotsToNextEntry, phase_correction);
+        GTTCAN_record_rearm(gttcan, slotsToNextEntry, *timer_delay);
+        rearm = true;
+        gttcan->state_correction = 0;
+    }
+    else if (slotID >= 1U) // Else if Normal message (id between 8 and 2^numIdBits-1), slotID between 1 and WBSIZE-1)
+    {
+        // Update datastructure (whiteboard) with data in slot slotID
+        if (payload != (const uint8_t *)0)
+        {
+            gttcan->fd->write_buffer(slotID, payload, length, gttcan->context_pointer);
+        }
+        else
+        {
+            GTTCAN_deliver_value(gttcan, current_time, can_frame_id_field, slotID, data);
         }
     }
-    // Reset the FTA
-    (void) GTTCAN_fta(gttcan);
+    else // FIXME: not reached, may need a different check above!
+    {
+        // Error - invalid frame recieved
+        GTTCAN_trace_event(gttcan, (uint8_t)GTTCAN_TRACE_INVALID, 0U, current_time, globalScheduleIndex, slotID, 0, 0U);
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+
+    if (gttcan->slots_accumulated >= gttcan->node_schedule->globalScheduleLength)
+    {
+        gttcan->error_offset = GTTCAN_fta(gttcan);
+        const int32_t phase_correction = GTTCAN_servo_update(gttcan, gttcan->error_offset);
+        uint32_t slotsToNextEntry = GTTCAN_get_slots_to_next_transmit(gttcan, globalScheduleIndex);
+        uint32_t timeToNextEntry = GTTCAN_timer_delay(gttcan, slotsToNextEntry, phase_correction);
+        *timer_delay = timeToNextEntry;
+        GTTCAN_record_rearm(gttcan, slotsToNextEntry, timeToNextEntry);
+        rearm = true;
+    }
+    if (joined && !rearm) // joined on a data frame, arm the timer for the next local slot
+    {
+        uint32_t slotsToNextEntry = GTTCAN_get_slots_to_next_transmit(gttcan, globalScheduleIndex);
+        *timer_delay = GTTCAN_timer_delay(gttcan, slotsToNextEntry, 0);
+        GTTCAN_record_rearm(gttcan, slotsToNextEntry, *timer_delay);
+        rearm = true;
+    }
+    const bool start = (slotID == (uint16_t)NETWORK_TIME_SLOT) && ((received_data & 0x8000000000000000ULL) != 0U);
+    const uint8_t flags = (uint8_t)((start ? GTTCAN_TRACE_FLAG_START : 0U) | (rearm ? GTTCAN_TRACE_FLAG_REARM : 0U) |
+                                    (gttcan->transmitted ? GTTCAN_TRACE_FLAG_MEASURED : 0U));
+    GTTCAN_trace_event(gttcan, (uint8_t)((slotID == (uint16_t)NETWORK_TIME_SLOT) ? GTTCAN_TRACE_REFERENCE : GTTCAN_TRACE_RECEIVE),
+                       flags, current_time, globalScheduleIndex, slotID, error, rearm ? *timer_delay : 0U);
+    return rearm;
 }
 
+
 /**
  * @brief Process a received CAN frame.
  *
@@ -105,8 +1207,13 @@ void GTTCAN_init(gttcan_t *gttcan,
  * slot ID. It also calculates the time to the next entry and sets a 
  * timer interrupt for that time.
  *
- * When a reference frame is received, the node is activated,
- * and the local schedule is reset.
+ * When a start-of-schedule reference frame is received, the node is activated
+ * (with the fast join, see GTTCAN_set_fast_join(), already after a number of
+ * consistent frames of any kind).
+ * The position in the local schedule is re-derived from the global schedule
+ * index of every received frame, so missed frames do not put the local
+ * schedule out of step.  Frames with a global schedule index outside the
+ * schedule are ignored.
  *
  * If no reference fram has been received for the duration
  * of the global schedule, clock synchronisation is performed
@@ -118,64 +1225,200 @@ void GTTCAN_init(gttcan_t *gttcan,
  */
 void GTTCAN_process_frame(gttcan_t *gttcan, uint32_t current_time, uint32_t can_frame_id_field, const uint64_t received_data)
 {
-    gttcan->action_time = current_time;
-    //gttcan->action_time -= (uint32_t)gttcan->state_correction;
-    uint64_t data = received_data;
-    uint16_t slotID = (uint16_t)(can_frame_id_field & 0x3FFFU); // TODO: CHECK IF THESE ARE VALID
-    uint16_t globalScheduleIndex = (uint16_t)((can_frame_id_field >> 14) & 0x3FFFU); // TODO: CHECK IF THESE ARE VALID
-
-    uint32_t slot_since_last = GTTCAN_get_slots_since_last_transmit(gttcan, globalScheduleIndex);
-    uint32_t expected_time = slot_since_last * gttcan->slotduration;
-    int32_t error = (int32_t)expected_time - (int32_t)gttcan->action_time; // positive if we received the frame earlier than expected
-
-    GTTCAN_accumulate_error(gttcan, error);
+    uint32_t timer_delay;
+    if (GTTCAN_ingest_frame(gttcan, current_time, can_frame_id_field, received_data, (const uint8_t *)0, 0U, &timer_delay))
+    {
+        gttcan->set_timer_int_callback(timer_delay, gttcan->context_pointer);
+    }
+}
 
-    // If Reference Frame
-    if (slotID == (uint16_t)NETWORK_TIME_SLOT)
+/**
+ * @brief Process a batch of received CAN frames.
+ *
+ * Equivalent to calling GTTCAN_process_frame() for each frame in order
+ * (whiteboard writes, error accumulation and clock synchronisation
+ * happen per frame), except that the timer interrupt is re-armed at most
+ * once, for the state after the last frame.  This is meant for drivers
+ * that drain a receive FIFO or DMA ring.
+ *
+ * The timestamps of a batch must share the same reference (the last
+ * local transmission), and the timer delay is relative to the
+ * timestamp of the last frame of the batch.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param frames The received frames, oldest first.
+ * @param count The number of frames.
+ */
+void GTTCAN_process_frames(gttcan_t *gttcan, const gttcan_rx_frame_t *frames, uint32_t count)
+{
+    bool rearm = false;
+    uint32_t timer_delay = 0U;
+    uint32_t armed_at = 0U;
+    for (uint32_t i = 0U; i < count; i++)
     {
-        if ((data & 0x8000000000000000ULL) != 0U) // If Start-of-schedule frame
+        uint32_t delay;
+        if (GTTCAN_ingest_frame(gttcan, frames[i].timestamp, frames[i].id, frames[i].data, (const uint8_t *)0, 0U, &delay))
         {
-            gttcan->isActive = true;    // Activate node (if not already)
-            gttcan->localScheduleIndex = 0;
+            rearm = true;
+            timer_delay = delay;
+            armed_at = frames[i].timestamp;
         }
-        data |= GTTCAN_DEFAULT_SLOT_OFFSET; // Add 150us offset for transmission time - not exact because of stuffing bits, but gets it close
-        // Update global time using Data && 0x3FFFFFFFFFFFFFFF
-        gttcan->write_value(NETWORK_TIME_SLOT, (data & 0x3FFFFFFFFFFFFFFFULL), gttcan->context_pointer);
-        gttcan->error_offset = GTTCAN_fta(gttcan);
-        //gttcan->slotduration -= gttcan->error_offset; TODO: add this back in
-        uint32_t slotsToNextEntry = GTTCAN_get_slots_to_next_transmit(gttcan, globalScheduleIndex);
-        uint32_t timeToNextEntry = slotsToNextEntry * gttcan->slotduration;
-        gttcan->state_correction = 0;
-        gttcan->set_timer_int_callback(timeToNextEntry, gttcan->context_pointer);
     }
-    else if (slotID >= 1U) // Else if Normal message (id between 8 and 2^numIdBits-1), slotID between 1 and WBSIZE-1)
+    if (rearm)
     {
-        // Update datastructure (whiteboard) with data in slot slotID
-        gttcan->write_value(slotID, data, gttcan->context_pointer);
+        const uint32_t elapsed = frames[count - 1U].timestamp - armed_at;
+        gttcan->set_timer_int_callback((timer_delay > elapsed) ? (timer_delay - elapsed) : 0U, gttcan->context_pointer);
     }
-    else // FIXME: not reached, may need a different check above!
+}
+
+/**
+ * @brief Process a received CAN FD frame.
+ *
+ * Like GTTCAN_process_frame(), except that the payload of a data frame
+ * is passed to the `write_buffer` callback of the attached CAN FD
+ * interface (see gttcan_fd.h).  The payload of a reference frame is
+ * read as a 64-bit value, most significant byte first.
+ *
+ * @param gttcan The GTTCAN instance, with a CAN FD interface attached.
+ * @param current_time The local time since the last transmission.
+ * @param can_frame_id_field The ID field of the received CAN frame.
+ * @param data The payload of the received CAN frame.
+ * @param length The number of payload bytes (0 to #GTTCAN_FD_MAX_PAYLOAD).
+ */
+void GTTCAN_process_fd_frame(gttcan_t *gttcan, uint32_t current_time, uint32_t can_frame_id_field, const uint8_t *data, uint8_t length)
+{
+    uint32_t timer_delay;
+    const uint8_t payload_length = (length > (uint8_t)GTTCAN_FD_MAX_PAYLOAD) ? (uint8_t)GTTCAN_FD_MAX_PAYLOAD : length;
+    if (GTTCAN_ingest_frame(gttcan, current_time, can_frame_id_field, GTTCAN_fd_read_u64(data, payload_length),
+                            data, payload_length, &timer_delay))
     {
-        // Error - invalid frame recieved
-        return; // cppcheck-suppress misra-c2012-15.5
+        gttcan->set_timer_int_callback(timer_delay, gttcan->context_pointer);
+    }
+}
+
+/**
+ * @brief Report the outcome of a transmission.
+ *
+ * Should be called by the driver when a frame passed to the transmit
+ * callback has been sent, or was dropped (e.g. after losing arbitration
+ * in single-shot mode).  Only frames sent from the sporadic message
+ * queue are tracked: a sent message is removed from the queue, one that
+ * was not sent stays at the head of its queue for the next arbitration
+ * slot.  Other frames are ignored.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param can_frame_id_field The ID field of the frame.
+ * @param sent Whether the frame was sent.
+ * @param timestamp The time of the outcome on the clock passed to
+ *                  GTTCAN_sporadic_push(), for the latency statistics.
+ */
+void GTTCAN_transmit_result(gttcan_t *gttcan, uint32_t can_frame_id_field, bool sent, uint32_t timestamp)
+{
+    if (gttcan->sporadic != (gttcan_sporadic_t *)0)
+    {
+        GTTCAN_sporadic_complete(gttcan->sporadic, can_frame_id_field, sent, timestamp);
     }
+}
 
-    if (gttcan->slots_accumulated >= gttcan->globalScheduleLength)
+/**
+ * @brief Enable or disable exact transmission-delay compensation.
+ *
+ * By default, the network time received in a reference frame is
+ * advanced by the constant #GTTCAN_DEFAULT_SLOT_OFFSET to account for
+ * the transmission time of the frame.  When a non-zero `bit_time` is
+ * set, the offset is instead calculated from the exact number of bits
+ * of the received frame (including stuffing bits) plus `frame_latency`.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param bit_time The duration of one bit in NTU (e.g. 10 at 1 Mbit/s),
+ *                 or 0 to use #GTTCAN_DEFAULT_SLOT_OFFSET.
+ * @param frame_latency Additional reception latency in NTU.
+ */
+void GTTCAN_set_exact_slot_offset(gttcan_t *gttcan, uint32_t bit_time, uint32_t frame_latency)
+{
+    gttcan->bit_time = bit_time;
+    gttcan->frame_latency = frame_latency;
+    for (uint32_t i = 0U; i < (uint32_t)GTTCAN_FRAME_PREFIX_CACHE_SIZE; i++)
     {
-        gttcan->error_offset = GTTCAN_fta(gttcan);
-        //gttcan->slotduration -= gttcan->error_offset; TODO: add this back in
-        uint32_t slotsToNextEntry = GTTCAN_get_slots_to_next_transmit(gttcan, globalScheduleIndex);
-        uint32_t timeToNextEntry = slotsToNextEntry * gttcan->slotduration;
-        /*
-        int32_t state_correction = gttcan->error_offset * (int32_t)slotsToNextEntry - (error - gttcan->error_offset);
-        // TODO: this should never happen, so we should signal the error, so the system can reset
-        while ((uint32_t)(-state_correction) > timeToNextEntry)
+        gttcan->reference_frame_prefixes[i].id = UINT32_MAX; // no valid 29-bit identifier
+        gttcan->reference_fd_frame_prefixes[i].id = UINT32_MAX;
+    }
+}
+
+/**
+ * @brief Return the transmission-delay offset of a reference frame.
+ *
+ * This function returns the time (in NTU) between the start of
+ * transmission of the given reference frame and its reception.
+ * Without a configured bit time, this is #GTTCAN_DEFAULT_SLOT_OFFSET.
+ * Otherwise, the identifier and control field of the frame are looked
+ * up in a small cache indexed by the global schedule index, so only
+ * the payload (sent MSB first) and CRC are scanned for stuffing bits.
+ * With a CAN FD interface attached, the frame is counted as a CAN FD
+ * frame, with the data phase at its data bit time, and its identifier
+ * and control field are cached in the same way.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param can_frame_id_field The ID field of the reference frame.
+ * @param received_data The payload of the reference frame.
+ * @return The offset in NTU.
+ */
+uint32_t GTTCAN_reference_frame_offset(gttcan_t *gttcan, uint32_t can_frame_id_field, uint64_t received_data)
+{
+    if (gttcan->bit_time == 0U)
+    {
+        return GTTCAN_DEFAULT_SLOT_OFFSET; // cppcheck-suppress misra-c2012-15.5
+    }
+    const uint32_t id = can_frame_id_field & 0x1FFFFFFFU;
+    if (gttcan->fd != (struct gttcan_fd_s *)0)
+    {
+        uint8_t fd_payload[8];
+        gttcan_fd_frame_bits_t bits;
+        const uint32_t data_bit_time = gttcan->fd->data_bit_time;
+        const uint8_t brs = (data_bit_time != 0U) ? 1U : 0U;
+        gttcan_fd_frame_prefix_t * const fd_prefix = &gttcan->reference_fd_frame_prefixes[GTTCAN_CAN_ID_INDEX(id) % (uint32_t)GTTCAN_FRAME_PREFIX_CACHE_SIZE];
+        if ((fd_prefix->id != id) || (fd_prefix->brs != brs))
         {
-            timeToNextEntry += gttcan->globalScheduleLength * gttcan->slotduration;
+            GTTCAN_prepare_fd_frame_prefix(id, 8U, brs != 0U, fd_prefix);
         }
-        uint32_t corrected_time_to_next_entry = timeToNextEntry + (uint32_t)state_correction;
-        */
-        gttcan->set_timer_int_callback(timeToNextEntry, gttcan->context_pointer);
+        GTTCAN_fd_write_u64(fd_payload, received_data);
+        (void)GTTCAN_calculate_fd_frame_bits_from_prefix(fd_prefix, fd_payload, &bits);
+        return GTTCAN_fd_frame_duration(&bits, gttcan->bit_time, data_bit_time) + gttcan->frame_latency; // cppcheck-suppress misra-c2012-15.5
+    }
+    gttcan_frame_prefix_t * const prefix = &gttcan->reference_frame_prefixes[GTTCAN_CAN_ID_INDEX(id) % (uint32_t)GTTCAN_FRAME_PREFIX_CACHE_SIZE];
+    if (prefix->id != id)
+    {
+        GTTCAN_prepare_extended_frame_prefix(id, 8U, prefix);
+    }
+    uint8_t payload[8];
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        payload[i] = (uint8_t)(received_data >> (56U - (8U * i)));
+    }
+    return (GTTCAN_calculate_extended_frame_bits_from_prefix(prefix, payload) * gttcan->bit_time) + gttcan->frame_latency;
+}
+
+/**
+ * @brief Move to the next entry of the local schedule and arm the timer for it.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param globalScheduleIndex The global schedule index of the current entry.
+ * @return The timer delay in NTU.
+ */
+static uint32_t GTTCAN_arm_next_slot(gttcan_t *gttcan, uint16_t globalScheduleIndex)
+{
+    gttcan->localScheduleIndex++; // move to next entry
+    // if end of local schedule
+    if (gttcan->localScheduleIndex == gttcan->node_schedule->localScheduleLength)
+    {
+        gttcan->localScheduleIndex = 0; // reset
     }
+
+    uint16_t slotsToNextEntry = GTTCAN_get_slots_to_next_transmit(gttcan, globalScheduleIndex);
+    uint32_t timeToNextEntry = GTTCAN_timer_delay(gttcan, slotsToNextEntry, 0);
+    gttcan->set_timer_int_callback(timeToNextEntry, gttcan->context_pointer);
+    gttcan->state_correction = 0;
+    return timeToNextEntry;
 }
 
 /**
@@ -186,6 +1429,8 @@ void GTTCAN_process_frame(gttcan_t *gttcan, uint32_t current_time, uint32_t can_
  * the next frame in the local schedule. It also calculates 
  * the time to the next entry and runs the callback function 
  * to set a new timer interrupt for that point in time.
+ * In an arbitration slot, the most urgent message of the sporadic
+ * message queue is sent, or nothing if the queue is empty.
  *
  * @param gttcan The GTTCAN instance.
  */
@@ -196,12 +1441,51 @@ void GTTCAN_transmit_next_frame(gttcan_t *gttcan) // cppcheck-suppress misra-c20
     {
         return; // cppcheck-suppress misra-c2012-15.5
     }
+    // Transmit local schedule entry
+    const gttcan_node_schedule_t * const node_schedule = gttcan->node_schedule;
+    uint16_t globalScheduleIndex = node_schedule->localScheduleSlotID[gttcan->localScheduleIndex];
+    uint16_t dataID = node_schedule->localScheduleDataID[gttcan->localScheduleIndex];
+    uint64_t data = 0U;
+    uint32_t can_frame_header = GTTCAN_CAN_ID(globalScheduleIndex, dataID);
+    const bool sporadic = (dataID == (uint16_t)GTTCAN_ARBITRATION_DATAID);
+    if (sporadic)
+    {
+        if (!GTTCAN_sporadic_begin(gttcan->sporadic, globalScheduleIndex, &can_frame_header, &data))
+        {
+            // Nothing queued for this arbitration slot, wait for the next local slot.
+            // After a whole round without a transmission, the local time has no usable reference.
+            gttcan->transmitted = gttcan->transmitted && (gttcan->lastTransmitIndex != globalScheduleIndex);
+            (void)GTTCAN_arm_next_slot(gttcan, globalScheduleIndex);
+            return; // cppcheck-suppress misra-c2012-15.5
+        }
+        dataID = GTTCAN_CAN_ID_DATAID(can_frame_header);
+    }
+    // The time master switches to the staged schedule with its start-of-schedule frame
+    const bool switching = (globalScheduleIndex == 0U) && (dataID == (uint16_t)NETWORK_TIME_SLOT) &&
+        GTTCAN_schedule_staged(gttcan, true) && (gttcan->staging->node_schedule->localScheduleLength > 0U) &&
+        (gttcan->staging->node_schedule->localScheduleSlotID[0] == 0U);
+    if (switching)
+    {
+        GTTCAN_commit_staged_schedule(gttcan);
+        gttcan->localScheduleIndex = 0U;
+    }
     gttcan->action_time = 0;
     gttcan->transmitted = true;
-    // Transmit local schedule entry
-    uint16_t globalScheduleIndex = gttcan->localScheduleSlotID[gttcan->localScheduleIndex];
-    uint16_t dataID = gttcan->localScheduleDataID[gttcan->localScheduleIndex];
-    uint64_t data = gttcan->read_value(dataID, gttcan->context_pointer);
+    gttcan->lastTransmitIndex = globalScheduleIndex;
+    const bool fd_data = (gttcan->fd != (struct gttcan_fd_s *)0) && (dataID != (uint16_t)NETWORK_TIME_SLOT) && !sporadic;
+    uint8_t payload[GTTCAN_FD_MAX_PAYLOAD];
+    uint8_t length = 8U;
+    if (fd_data)
+    {
+        length = gttcan->fd->read_buffer(dataID, payload, gttcan->context_pointer);
+        length = (length > (uint8_t)GTTCAN_FD_MAX_PAYLOAD) ? (uint8_t)GTTCAN_FD_MAX_PAYLOAD : length;
+    }
+    else if (!sporadic) // sporadic messages bring their own value
+    {
+        data = (gttcan->whiteboard != (struct gttcan_whiteboard_s *)0)
+            ? GTTCAN_whiteboard_value(gttcan->whiteboard, dataID)
+            : gttcan->read_value(dataID, gttcan->context_pointer);
+    }
     if (dataID == (uint16_t)NETWORK_TIME_SLOT)  // this is a reference frame
     {
         gttcan->error_offset = GTTCAN_fta(gttcan); // reset error
@@ -209,22 +1493,37 @@ void GTTCAN_transmit_next_frame(gttcan_t *gttcan) // cppcheck-suppress misra-c20
     if (globalScheduleIndex == 0U) // if this is a start of schedule
     {
         data = data | 0x8000000000000000ULL; // set MSB to 1 (we may need to clear 62nd bit for TTCan compatibility)
+        data = switching ? (data | GTTCAN_SCHEDULE_SWITCH_FLAG) : (data & ~GTTCAN_SCHEDULE_SWITCH_FLAG);
+        if (fd_data && (length > 0U))
+        {
+            payload[0] |= 0x80U;
+        }
     }
-    uint32_t can_frame_header = ((uint32_t)globalScheduleIndex << 14) | dataID;
+    const uint32_t timeToNextEntry = GTTCAN_arm_next_slot(gttcan, globalScheduleIndex);
 
-    gttcan->localScheduleIndex++; // move to next entry
-    // if end of local schedule
-    if (gttcan->localScheduleIndex == gttcan->localScheduleLength)
+    if (gttcan->fd == (struct gttcan_fd_s *)0)
     {
-        gttcan->localScheduleIndex = 0; // reset
+        gttcan->transmit_callback(can_frame_header, data, gttcan->context_pointer);
     }
-
-    uint16_t slotsToNextEntry = GTTCAN_get_slots_to_next_transmit(gttcan, globalScheduleIndex);
-    uint32_t timeToNextEntry = slotsToNextEntry * gttcan->slotduration;
-    gttcan->set_timer_int_callback(timeToNextEntry, gttcan->context_pointer);
-    gttcan->state_correction = 0;
-
-    gttcan->transmit_callback(can_frame_header, data, gttcan->context_pointer);
+    else
+    {
+        if (!fd_data)
+        {
+            GTTCAN_fd_write_u64(payload, data);
+        }
+        gttcan->fd->transmit(can_frame_header, payload, length, gttcan->context_pointer);
+    }
+    if (dataID == (uint16_t)NETWORK_TIME_SLOT) // the driver has moved its reference to this frame
+    {
+        GTTCAN_record_anchor(gttcan, data & 0x3FFFFFFFFFFFFFFFULL, 0U, true);
+    }
+    if (gttcan->stats != (struct gttcan_stats_s *)0)
+    {
+        GTTCAN_stats_record_transmit(gttcan->stats, globalScheduleIndex, gttcan->node_schedule->globalScheduleLength);
+    }
+    GTTCAN_trace_event(gttcan, (uint8_t)GTTCAN_TRACE_TRANSMIT,
+                       (uint8_t)(GTTCAN_TRACE_FLAG_REARM | ((globalScheduleIndex == 0U) ? GTTCAN_TRACE_FLAG_START : 0U)),
+                       0U, globalScheduleIndex, dataID, 0, timeToNextEntry);
 }
 
 /**
@@ -247,50 +1546,109 @@ void GTTCAN_start(gttcan_t *gttcan)
 /**
  * @brief Get the number of slots to the next transmit.
  *
- * This function calculates the number of slots to the next transmit slot in the schedule.
+ * This function looks up the number of slots to the next transmit slot
+ * in the schedule in a table built by GTTCAN_init() (or, without
+ * #GTTCAN_TRANSMIT_TABLES, binary-searches the local schedule),
+ * so the result does not depend on `localScheduleIndex`.
  *
  * @param gttcan The GTTCAN instance.
  * @param currentScheduleIndex The current index in the schedule.
- * @return The number of slots to the next transmit.
+ * @return The number of slots to the next transmit,
+ *         or 0 if the index is outside the global schedule.
  */
 uint16_t GTTCAN_get_slots_to_next_transmit(gttcan_t *gttcan, uint16_t currentScheduleIndex) // cppcheck-suppress misra-c2012-8.7
 {
-    uint16_t nextTransmitIndex = gttcan->localScheduleSlotID[gttcan->localScheduleIndex];
-    return (currentScheduleIndex >= nextTransmitIndex) ?
-    (gttcan->globalScheduleLength - currentScheduleIndex + nextTransmitIndex) :
-    (nextTransmitIndex - currentScheduleIndex);
+    const gttcan_node_schedule_t * const node_schedule = gttcan->node_schedule;
+    if (currentScheduleIndex >= node_schedule->globalScheduleLength)
+    {
+        return 0U; // cppcheck-suppress misra-c2012-15.5
+    }
+#if GTTCAN_TRANSMIT_TABLES
+    return node_schedule->slotsToNextTransmit[currentScheduleIndex];
+#else
+    const uint8_t next = GTTCAN_find_next_local_index(node_schedule->localScheduleSlotID, node_schedule->localScheduleLength, currentScheduleIndex);
+    return GTTCAN_calculate_slots_to_next(node_schedule->localScheduleSlotID, node_schedule->localScheduleLength, node_schedule->globalScheduleLength,
+                                          currentScheduleIndex, next);
+#endif
 }
 
 /**
  * @brief Get the number of slots since the last transmit.
  *
- * This function calculates the number of slots since the last transmit in the schedule.
+ * This function looks up the number of slots since the last transmit
+ * in the schedule in a table built by GTTCAN_init() (or, without
+ * #GTTCAN_TRANSMIT_TABLES, binary-searches the local schedule).  If this node has
+ * not transmitted yet, the slots since the start of the schedule are returned.
+ * With a sporadic message queue attached, the slots since the global schedule
+ * index of the last actual transmission are returned instead, as arbitration
+ * slots without a queued message are skipped (0 for a frame in the slot of
+ * the last transmission, i.e. after losing arbitration).
  *
  * @param gttcan The GTTCAN instance.
  * @param currentScheduleIndex The current index in the schedule.
- * @return The number of slots since the last transmit.
+ * @return The number of slots since the last transmit,
+ *         or 0 if the index is outside the global schedule.
  */
 uint16_t GTTCAN_get_slots_since_last_transmit(gttcan_t * gttcan, uint16_t currentScheduleIndex) // cppcheck-suppress misra-c2012-8.7
 {
+    const gttcan_node_schedule_t * const node_schedule = gttcan->node_schedule;
     if (!gttcan->transmitted)
     {
         return currentScheduleIndex; // cppcheck-suppress misra-c2012-15.5
     }
 
-    const uint16_t lastTransmitIndex = (gttcan->localScheduleIndex > 0U) ? // if we are not at the first entry in our schedule
-    (gttcan->localScheduleSlotID[gttcan->localScheduleIndex - 1U]) : // last transmit index was the previous entry in local schedule
-    (gttcan->localScheduleSlotID[gttcan->localScheduleLength - 1U]); // else last transmit index is last entry in local schedule
-    // if the current schedule position is ahead of the last transmit index
-    if (currentScheduleIndex > lastTransmitIndex)
+    if (currentScheduleIndex >= node_schedule->globalScheduleLength)
+    {
+        return 0U; // cppcheck-suppress misra-c2012-15.5
+    }
+    if (gttcan->sporadic != (gttcan_sporadic_t *)0) // arbitration slots without a message are skipped
     {
-        // cppcheck-suppress misra-c2012-15.5
-        return (currentScheduleIndex - lastTransmitIndex); // last transmission was previous in the same schedule round
+        const uint16_t last = gttcan->lastTransmitIndex;
+        const uint16_t distance = (currentScheduleIndex >= last) ? (uint16_t)(currentScheduleIndex - last) :
+            (uint16_t)((currentScheduleIndex + node_schedule->globalScheduleLength) - last);
+        return distance; // cppcheck-suppress misra-c2012-15.5
     }
-    else // last transmission  was in the previous schedule round
+#if GTTCAN_TRANSMIT_TABLES
+    return node_schedule->slotsSinceLastTransmit[currentScheduleIndex];
+#else
+    const uint8_t next = GTTCAN_find_next_local_index(node_schedule->localScheduleSlotID, node_schedule->localScheduleLength, currentScheduleIndex);
+    return GTTCAN_calculate_slots_since_last(node_schedule->localScheduleSlotID, node_schedule->localScheduleLength, node_schedule->globalScheduleLength,
+                                             currentScheduleIndex, next);
+#endif
+}
+
+/**
+ * @brief Configure the fault-tolerant averaging.
+ *
+ * The FTA discards the `outliers` lowest and the `outliers` highest
+ * error samples of a round, so up to `outliers` faulty nodes are
+ * tolerated.  With a `window` of more than one round, the result is
+ * the average of the trimmed samples of the last `window` rounds,
+ * which smoothes the estimate at the cost of a slower response.
+ * Resets the accumulated errors and the window.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param outliers Number of outliers discarded at each end, 1 to #GTTCAN_FTA_MAX_OUTLIERS (default 1).
+ * @param window Number of rounds averaged over, 1 to #GTTCAN_FTA_MAX_WINDOW (default 1).
+ * @return false if a parameter is out of range (the configuration is unchanged).
+ */
+bool GTTCAN_set_fta(gttcan_t *gttcan, uint8_t outliers, uint8_t window)
+{
+    if ((outliers < 1U) || ((uint32_t)outliers > (uint32_t)GTTCAN_FTA_MAX_OUTLIERS) ||
+        (window < 1U) || ((uint32_t)window > (uint32_t)GTTCAN_FTA_MAX_WINDOW))
     {
-        // cppcheck-suppress misra-c2012-15.5
-        return ((gttcan->globalScheduleLength - lastTransmitIndex) + currentScheduleIndex);
+        return false; // cppcheck-suppress misra-c2012-15.5
     }
+    gttcan->fta.outliers = outliers;
+    gttcan->fta.window = window;
+    gttcan->fta.window_index = 0U;
+    gttcan->fta.window_filled = 0U;
+    gttcan->fta.window_total = 0;
+    gttcan->fta.window_count = 0U;
+    gttcan->error_accumulator = 0;
+    gttcan->slots_accumulated = 0U;
+    (void) GTTCAN_fta(gttcan);
+    return true;
 }
 
 /**
@@ -298,36 +1656,73 @@ uint16_t GTTCAN_get_slots_since_last_transmit(gttcan_t * gttcan, uint16_t curren
  *
  * This function returns the fault-tolerant average error
  * and resets the error accumulator.
- * If not enough errors have been accumulated, this function
- * will degrade to an arithmetic average.
+ * If not more than twice the configured number of outliers have
+ * been accumulated, this function will degrade to an arithmetic
+ * average.  See GTTCAN_set_fta() for averaging over several rounds.
  *
  * @param gttcan The gttcan instance.
  * @return The fault-tolerant average error.
  */
 int32_t GTTCAN_fta(gttcan_t *gttcan)
 {
-    int32_t error;
-    switch (gttcan->slots_accumulated)
+    gttcan_fta_t * const fta = &gttcan->fta;
+    const uint32_t outliers = fta->outliers;
+    const uint32_t samples = gttcan->slots_accumulated;
+    int64_t sum = gttcan->error_accumulator;
+    uint32_t count = samples;
+    int32_t error = 0;
+
+    if (samples > (2U * outliers)) // we have enough error samples to do fault-tolerant averaging
+    {
+        for (uint32_t i = 0U; i < outliers; i++)
+        {
+            sum -= (int64_t)gttcan->lower_outliers[i] + (int64_t)gttcan->upper_outliers[i];
+        }
+        count = samples - (2U * outliers);
+        error = (int32_t)(sum / (int64_t)count);
+        const int64_t correction = (int64_t)error * (int64_t)samples;
+        gttcan->state_correction = (correction > (int64_t)INT32_MAX) ? INT32_MAX : ((correction < (int64_t)INT32_MIN) ? INT32_MIN : (int32_t)correction);
+    }
+    else if (samples > 0U) // not enough errors to run an FTA, so degrade to an arithmetic average
+    {
+        error = (int32_t)(sum / (int64_t)count);
+        gttcan->state_correction = gttcan->error_accumulator;
+    }
+    else // no errors accumulated
     {
-        case 0:
-            error = 0;
-            gttcan->state_correction = 0;
-            break; // no errors accumulated
-        case 1: // not enough errors to run an FTA, so
-        case 2: // degrade to an arithmetic average
-            error = gttcan->error_accumulator / (int16_t)gttcan->slots_accumulated;
-            gttcan->state_correction = gttcan->error_accumulator;
-            break;
+        gttcan->state_correction = 0;
+    }
 
-        default: // we have enough error samples to do fault-tolerant averaging
-            error = (gttcan->error_accumulator - gttcan->lower_outlier - gttcan->upper_outlier) / ((int32_t)gttcan->slots_accumulated - 2);
-            gttcan->state_correction = error * (int16_t)gttcan->slots_accumulated;
-            break;
+    if ((samples > 0U) && (gttcan->stats != (struct gttcan_stats_s *)0))
+    {
+        GTTCAN_stats_record_fta(gttcan->stats, error);
+    }
+    if ((samples > 0U) && (fta->window > 1U))
+    {
+        // Replace the oldest round and average over the whole window.
+        if (fta->window_filled < fta->window)
+        {
+            fta->window_filled++;
+        }
+        else
+        {
+            fta->window_total -= fta->window_sums[fta->window_index];
+            fta->window_count -= fta->window_counts[fta->window_index];
+        }
+        fta->window_sums[fta->window_index] = sum;
+        fta->window_counts[fta->window_index] = (uint16_t)count;
+        fta->window_total += sum;
+        fta->window_count += count;
+        fta->window_index = (uint8_t)((fta->window_index + 1U) % fta->window);
+        error = (int32_t)(fta->window_total / (int64_t)fta->window_count);
     }
 
     gttcan->error_accumulator = 0;
-    gttcan->lower_outlier = INT32_MAX;
-    gttcan->upper_outlier = INT32_MIN;
+    for (uint32_t i = 0U; i < outliers; i++)
+    {
+        gttcan->lower_outliers[i] = INT32_MAX;
+        gttcan->upper_outliers[i] = INT32_MIN;
+    }
     gttcan->slots_accumulated = 0;
 
     return error;
@@ -337,7 +1732,8 @@ int32_t GTTCAN_fta(gttcan_t *gttcan)
  * @brief Accumulate an error sample.
  *
  * This function adds the given error to the accumulator
- * and updates the lower and upper outliers as necessary.
+ * and inserts it into the sorted lower and upper outliers
+ * as necessary (O(k) for k outliers).
  *
  * @param gttcan The gttcan instance to operate on.
  * @param error  The error to accumulate.
@@ -352,13 +1748,26 @@ void GTTCAN_accumulate_error(gttcan_t *gttcan, int32_t error) // cppcheck-suppre
     gttcan->previous_accumulator = gttcan->error_accumulator;
     gttcan->error_accumulator += error;
 
-    if (error < gttcan->lower_outlier)
+    const uint32_t last = (uint32_t)gttcan->fta.outliers - 1U;
+    if (error < gttcan->lower_outliers[last])
     {
-        gttcan->lower_outlier = error;
+        uint32_t i = last;
+        while ((i > 0U) && (error < gttcan->lower_outliers[i - 1U]))
+        {
+            gttcan->lower_outliers[i] = gttcan->lower_outliers[i - 1U];
+            i--;
+        }
+        gttcan->lower_outliers[i] = error;
     }
-    if (error > gttcan->upper_outlier)
+    if (error > gttcan->upper_outliers[last])
     {
-        gttcan->upper_outlier = error;
+        uint32_t i = last;
+        while ((i > 0U) && (error > gttcan->upper_outliers[i - 1U]))
+        {
+            gttcan->upper_outliers[i] = gttcan->upper_outliers[i - 1U];
+            i--;
+        }
+        gttcan->upper_outliers[i] = error;
     }
 
     gttcan->slots_accumulated++;
@@ -16,56 +16,481 @@ extern "C" {
 #define GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH 32
 #endif
 
+/**
+ * @brief Split of the 29-bit extended CAN identifier.
+ *
+ * The identifier carries the global schedule index in the upper
+ * #GTTCAN_NUM_INDEX_BITS bits and the data ID in the lower
+ * #GTTCAN_NUM_DATAID_BITS bits.  Short schedules can trade index bits
+ * for data-ID bits and vice versa; both widths are validated at build
+ * time (see gttcan.c).
+ */
+#ifndef GTTCAN_NUM_INDEX_BITS
+#define GTTCAN_NUM_INDEX_BITS 14U
+#endif
+
+#ifndef GTTCAN_NUM_DATAID_BITS
+#define GTTCAN_NUM_DATAID_BITS 14U
+#endif
+
+#define GTTCAN_INDEX_MASK (((uint32_t)1U << GTTCAN_NUM_INDEX_BITS) - 1U)
+#define GTTCAN_DATAID_MASK (((uint32_t)1U << GTTCAN_NUM_DATAID_BITS) - 1U)
+
+/** @brief The CAN identifier of a global schedule index and data ID. */
+#define GTTCAN_CAN_ID(index, dataID) ((((uint32_t)(index) & GTTCAN_INDEX_MASK) << GTTCAN_NUM_DATAID_BITS) | ((uint32_t)(dataID) & GTTCAN_DATAID_MASK))
+/** @brief The global schedule index of a CAN identifier. */
+#define GTTCAN_CAN_ID_INDEX(id) ((uint16_t)(((uint32_t)(id) >> GTTCAN_NUM_DATAID_BITS) & GTTCAN_INDEX_MASK))
+/** @brief The data ID of a CAN identifier. */
+#define GTTCAN_CAN_ID_DATAID(id) ((uint16_t)((uint32_t)(id) & GTTCAN_DATAID_MASK))
+
+/**
+ * @brief Whether a 16-bit data ID fits into the data ID bits.
+ *
+ * Always true with 16 data ID bits, where a comparison with the mask
+ * would be constant.
+ */
+#if GTTCAN_NUM_DATAID_BITS < 16
+#define GTTCAN_DATAID_FITS(dataID) ((uint32_t)(dataID) <= GTTCAN_DATAID_MASK)
+#else
+#define GTTCAN_DATAID_FITS(dataID) ((void)(dataID), true)
+#endif
+
+/**
+ * @brief Whether to keep per-global-index transmit lookup tables.
+ *
+ * With tables (the default), the distance to the next and previous
+ * local transmission is a single load, at the cost of 5 bytes of RAM
+ * per global schedule slot (#GTTCAN_MAX_SLOTS).  Without tables, the
+ * local schedule is binary-searched instead, which allows very long
+ * global schedules without per-slot RAM.
+ */
+#ifndef GTTCAN_TRANSMIT_TABLES
+#define GTTCAN_TRANSMIT_TABLES 1
+#endif
+
+/**
+ * @brief Maximum length of a global schedule.
+ *
+ * #GTTCAN_MAX_SLOTS with transmit tables, which have one entry per
+ * slot.  Without tables, only the schedule index bits of the CAN ID
+ * limit the length (at most 65535 slots).
+ */
+#if GTTCAN_TRANSMIT_TABLES
+#define GTTCAN_MAX_SCHEDULE_LENGTH ((uint32_t)GTTCAN_MAX_SLOTS)
+#else
+#define GTTCAN_MAX_SCHEDULE_LENGTH (((GTTCAN_INDEX_MASK + 1U) > 0xFFFFU) ? 0xFFFFU : (GTTCAN_INDEX_MASK + 1U))
+#endif
+
+/**
+ * @brief Whether every instance embeds storage for its node schedule.
+ *
+ * With embedded storage (the default), GTTCAN_load_schedule() and
+ * GTTCAN_stage_schedule() build the local schedule and transmit tables
+ * into the instance.  Without it, an instance only references a node
+ * schedule built with GTTCAN_build_node_schedule() and attached with
+ * GTTCAN_set_node_schedule(), which all instances with the same global
+ * schedule and node ID can share.  This saves
+ * sizeof(gttcan_node_schedule_t) of RAM per instance (2.7 KiB with the
+ * default #GTTCAN_MAX_SLOTS), e.g. for hosts that run thousands of
+ * instances.  The CMake build reports both sizes when it is configured.
+ */
+#ifndef GTTCAN_EMBEDDED_SCHEDULE
+#define GTTCAN_EMBEDDED_SCHEDULE 1
+#endif
+
+/**
+ * @brief The cache line size the layout of gttcan_t is checked against.
+ *
+ * The state that the receive and transmit paths modify on every frame
+ * is kept at the start of gttcan_t, within one line, followed by the
+ * FTA window entries that are written once per round (checked in
+ * gttcan.c).  Allocate instances on this alignment to keep the
+ * per-frame state in a single line.
+ */
+#ifndef GTTCAN_CACHE_LINE_SIZE
+#define GTTCAN_CACHE_LINE_SIZE 64U
+#endif
+
+/**
+ * @brief Whether events can be recorded into a trace ring.
+ *
+ * With tracing compiled in, GTTCAN_set_trace() attaches a trace ring
+ * (see gttcan_trace.h), at the cost of a pointer in the instance and
+ * a pointer test per event while no ring is attached.
+ */
+#ifndef GTTCAN_TRACE
+#define GTTCAN_TRACE 0
+#endif
+
+/**
+ * @brief Binary schedule format, see GTTCAN_load_schedule().
+ *
+ * All multi-byte fields are little-endian.
+ * ```
+ * offset  size  field
+ *      0     4  magic "GTSC"
+ *      4     1  version (1)
+ *      5     1  reserved (0)
+ *      6     2  number of entries n
+ *      8     4  slot duration in NTU (0 = keep the configured one)
+ *     12    3n  entries: node ID (1 byte), data ID (2 bytes)
+ * ```
+ */
+#define GTTCAN_SCHEDULE_MAGIC_0 0x47U // 'G'
+#define GTTCAN_SCHEDULE_MAGIC_1 0x54U // 'T'
+#define GTTCAN_SCHEDULE_MAGIC_2 0x53U // 'S'
+#define GTTCAN_SCHEDULE_MAGIC_3 0x43U // 'C'
+#define GTTCAN_SCHEDULE_VERSION 1U
+#define GTTCAN_SCHEDULE_HEADER_SIZE 12U
+#define GTTCAN_SCHEDULE_ENTRY_SIZE 3U
+#define GTTCAN_SCHEDULE_SIZE(length) (GTTCAN_SCHEDULE_HEADER_SIZE + ((uint32_t)(length) * GTTCAN_SCHEDULE_ENTRY_SIZE))
+
+/**
+ * @brief Node ID of the arbitration slots in the global schedule.
+ *
+ * Any node with a sporadic message queue (see GTTCAN_set_sporadic())
+ * may send in a slot with this node ID; CAN arbitration decides
+ * between the nodes.  The data ID of the entry is ignored, so this
+ * node ID cannot be used by a real node.
+ */
+#define GTTCAN_ARBITRATION_NODE 0xFFU
+
+/**
+ * @brief Data ID of the arbitration slots in the local schedule.
+ *
+ * Never sent: the data ID of the queued message is sent instead.
+ * Sporadic messages cannot use this data ID.
+ */
+#define GTTCAN_ARBITRATION_DATAID 0xFFFFU
+
+/**
+ * @brief Payload bit of a start-of-schedule frame that switches the schedule.
+ *
+ * Set by the time master when it commits a staged schedule (see
+ * GTTCAN_request_schedule_switch()); every receiver commits its staged
+ * schedule on the same frame.  The bit is not part of the network time.
+ */
+#define GTTCAN_SCHEDULE_SWITCH_FLAG 0x4000000000000000ULL
+
+/**
+ * @brief CRC-15 implementation selected at build time.
+ *
+ * 0 selects the bit-serial implementation (no lookup table,
+ * smallest ROM footprint for MCUs), 1 the byte-wise table
+ * (512 bytes of ROM), and 4 or 8 the slicing-by-4/8 variants
+ * that fold 4 or 8 bytes per iteration (2 KiB / 4 KiB of ROM).
+ */
+#ifndef GTTCAN_CRC15_SLICES
+#define GTTCAN_CRC15_SLICES 1
+#endif
+
+#if (GTTCAN_CRC15_SLICES != 0) && (GTTCAN_CRC15_SLICES != 1) && (GTTCAN_CRC15_SLICES != 4) && (GTTCAN_CRC15_SLICES != 8)
+#error "GTTCAN_CRC15_SLICES must be 0, 1, 4, or 8"
+#endif
+
 #ifdef STM32
 #define GTTCAN_DEFAULT_SLOT_OFFSET 1600U
 #else
 #define GTTCAN_DEFAULT_SLOT_OFFSET 1480U
 #endif
 
+/**
+ * @brief Number of reference-frame identifiers whose frame prefix is cached.
+ *
+ * Used when the exact slot offset is enabled, see
+ * GTTCAN_set_exact_slot_offset().  Should be at least the number
+ * of reference frames in the global schedule.
+ */
+#ifndef GTTCAN_FRAME_PREFIX_CACHE_SIZE
+#define GTTCAN_FRAME_PREFIX_CACHE_SIZE 4
+#endif
+
+/**
+ * @brief Number of 64-bit words in a CAN bit stream.
+ *
+ * Large enough for the stuffed part of an extended data frame
+ * with an 8-byte payload (118 bits).
+ */
+#ifndef GTTCAN_BITSTREAM_WORDS
+#define GTTCAN_BITSTREAM_WORDS 2U
+#endif
+
+/**
+ * @brief Largest number of outliers the FTA can discard at each end.
+ *
+ * The k lowest and k highest error samples of a round are kept in two
+ * sorted arrays of this size, see GTTCAN_set_fta().
+ */
+#ifndef GTTCAN_FTA_MAX_OUTLIERS
+#define GTTCAN_FTA_MAX_OUTLIERS 4U
+#endif
+
+/**
+ * @brief Largest number of rounds the FTA can average over, see GTTCAN_set_fta().
+ */
+#ifndef GTTCAN_FTA_MAX_WINDOW
+#define GTTCAN_FTA_MAX_WINDOW 8U
+#endif
+
+/**
+ * @brief Default proportional gain of the clock servo (2^-n of the FTA error).
+ */
+#ifndef GTTCAN_SERVO_KP_SHIFT
+#define GTTCAN_SERVO_KP_SHIFT 2U
+#endif
+
+/**
+ * @brief Default integral gain of the clock servo.
+ *
+ * Each update corrects the slot duration by 2^-n of the FTA error
+ * spread over one schedule round.
+ */
+#ifndef GTTCAN_SERVO_KI_SHIFT
+#define GTTCAN_SERVO_KI_SHIFT 3U
+#endif
+
+/**
+ * @brief Largest rate correction of the clock servo in ppm of the slot duration.
+ */
+#ifndef GTTCAN_SERVO_MAX_PPM
+#define GTTCAN_SERVO_MAX_PPM 1000U
+#endif
+
+/**
+ * @brief Timing tolerance of the fast join as a fraction 2^-n of a slot.
+ *
+ * Two frames observed by a joining node are consistent if the time
+ * between them is within this tolerance of the time their global
+ * schedule indices are apart (modulo whole rounds), see
+ * GTTCAN_set_fast_join().
+ */
+#ifndef GTTCAN_JOIN_TOLERANCE_SHIFT
+#define GTTCAN_JOIN_TOLERANCE_SHIFT 2U
+#endif
+
+/**
+ * @brief Number of fractional bits of the corrected slot duration.
+ */
+#define GTTCAN_SERVO_FRACTION_BITS 16U
+
 typedef void (*transmit_callback_fp)(uint32_t, uint64_t, void*);
 typedef void (*set_timer_int_callback_fp)(uint32_t, void*);
 typedef uint64_t (*read_value_fp)(uint16_t, void*);
 typedef void (*write_value_fp)(uint16_t, uint64_t, void*);
 
-typedef struct gttcan_s {
+/**
+ * @brief The identifier and control field of an extended CAN frame.
+ *
+ * Holds the CRC register and stuffing state after the first 39 bits
+ * (SOF to DLC) of an extended data frame, see
+ * GTTCAN_prepare_extended_frame_prefix().
+ */
+typedef struct gttcan_frame_prefix_s {
+    uint32_t id;           // 29-bit identifier
+    uint16_t crc;          // CRC-15 register after the DLC
+    uint8_t length;        // number of payload bytes
+    uint8_t stuffing_bits; // stuffing bits up to the DLC
+    uint8_t last_bit;      // last bit of the DLC
+    uint8_t run_length;    // number of consecutive bits equal to last_bit
+} gttcan_frame_prefix_t;
+
+/**
+ * @brief The identifier and control field of an extended CAN FD frame.
+ *
+ * Holds the CRC register and stuffing state after the first 41 bits
+ * (SOF to DLC) of an extended CAN FD frame, see
+ * GTTCAN_prepare_fd_frame_prefix().
+ */
+typedef struct gttcan_fd_frame_prefix_s {
+    uint32_t id;              // 29-bit identifier
+    uint32_t crc;             // CRC-17 or CRC-21 register after the DLC
+    uint8_t length;           // number of payload bytes (0 to 64)
+    uint8_t dlc;              // data length code
+    uint8_t brs;              // 1 if the bit rate is switched
+    uint8_t nominal_stuffing; // stuffing bits up to the BRS bit
+    uint8_t data_stuffing;    // stuffing bits from the BRS bit to the DLC
+    uint8_t last_bit;         // last bit of the DLC
+    uint8_t run_length;       // number of consecutive bits equal to last_bit
+} gttcan_fd_frame_prefix_t;
+
+/**
+ * @brief A received CAN frame, see GTTCAN_process_frames().
+ */
+typedef struct gttcan_rx_frame_s {
+    uint32_t timestamp; // local time since the last transmission (current_time)
+    uint32_t id;        // ID field of the CAN frame
+    uint64_t data;      // data of the CAN frame
+} gttcan_rx_frame_t;
 
-    uint32_t slots[256]; // Array of 29 bit values masked by 0x1FFFFFFF
-    uint32_t localSchedule[GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH];
+/**
+ * @brief State of the clock servo, see GTTCAN_set_clock_servo().
+ *
+ * Corrections are positive if the other nodes are ahead of the local
+ * clock, i.e. if local slots have to be shortened.
+ */
+typedef struct gttcan_servo_s {
+    int32_t rate_correction;  // slot duration correction in 2^-GTTCAN_SERVO_FRACTION_BITS NTU (integral term)
+    int32_t phase_correction; // correction applied to the last timer re-arm in NTU (proportional term)
+    int32_t last_error;       // FTA error of the last update in NTU
+    uint32_t updates;         // number of servo updates
+    uint32_t timestamp_latency; // delay between the start of a received frame and its current_time in NTU
+    uint8_t kp_shift;         // proportional gain 2^-kp_shift
+    uint8_t ki_shift;         // integral gain 2^-ki_shift
+    bool enabled;
+} gttcan_servo_t;
+
+/**
+ * @brief State of the fault-tolerant averaging, see GTTCAN_set_fta().
+ */
+typedef struct gttcan_fta_s {
+    int64_t window_total;  // sum of the valid entries of window_sums
+    uint32_t window_count; // sum of the valid entries of window_counts
+    uint8_t outliers;      // number of outliers discarded at each end (k)
+    uint8_t window;        // number of rounds averaged over, 1 for the current round only
+    uint8_t window_index;  // next entry of window_sums to overwrite
+    uint8_t window_filled; // number of valid entries in window_sums
+    uint16_t window_counts[GTTCAN_FTA_MAX_WINDOW]; // number of samples in window_sums
+    int64_t window_sums[GTTCAN_FTA_MAX_WINDOW]; // trimmed error sums of the last rounds
+} gttcan_fta_t;
 
+/**
+ * @brief State of the fast join, see GTTCAN_set_fast_join().
+ */
+typedef struct gttcan_join_s {
+    uint32_t last_time;   // action time of the last observed frame in NTU
+    uint16_t last_index;  // global schedule index of the last observed frame
+    uint8_t observations; // consistent frames needed to join, 0 to wait for a start-of-schedule frame
+    uint8_t consistent;   // consistent frames observed so far
+} gttcan_join_t;
+
+struct gttcan_rx_ring_s;
+struct gttcan_whiteboard_s;
+struct gttcan_stats_s;
+struct gttcan_trace_s;
+struct gttcan_fd_s;
+struct gttcan_sporadic_s;
+struct gttcan_staging_s;
+struct gttcan_clock_s;
+
+/**
+ * @brief The read-only schedule of a node, see GTTCAN_build_node_schedule().
+ *
+ * Holds the referenced global schedule, the local schedule of one node
+ * ID and the transmit tables.  Instances never modify it, so all
+ * instances with the same global schedule, node ID and sporadic
+ * message setting can share one.
+ */
+typedef struct gttcan_node_schedule_s {
+    const uint8_t *schedule;       // packed global schedule entries (not copied), NULL if all slots are free
+    uint32_t slotduration;         // slot duration in NTU, 0 to keep the configured one
+    uint16_t globalScheduleLength; // number of schedule entries
+    uint8_t localNodeId;           // node ID the local schedule was collected for
+    uint8_t localScheduleLength;
+    bool arbitration;              // whether the arbitration slots are part of the local schedule
     uint16_t localScheduleSlotID[GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH];
     uint16_t localScheduleDataID[GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH];
+#if GTTCAN_TRANSMIT_TABLES
+    uint16_t slotsToNextTransmit[GTTCAN_MAX_SLOTS]; // per global index: slots until the next local transmission
+    uint16_t slotsSinceLastTransmit[GTTCAN_MAX_SLOTS]; // per global index: slots since the previous local transmission
+    uint8_t nextLocalScheduleIndex[GTTCAN_MAX_SLOTS]; // per global index: local schedule index of the next local transmission
+#endif
+} gttcan_node_schedule_t;
 
-    uint32_t slotduration; // in NUT (0.1us)
+typedef struct gttcan_s {
+
+    // State modified on the receive and transmit paths.  Everything up to
+    // fta.window_counts shares the first GTTCAN_CACHE_LINE_SIZE bytes, the
+    // FTA window entries, written once per round, complete the block.
     uint32_t action_time; // The time the next transmission interrupt will fire
     int32_t error_offset; // Timer correction in NUT (0.1us)
     int32_t state_correction;
     int32_t error_accumulator; // accumulated error
     int32_t previous_accumulator;
-    int32_t lower_outlier;  // lower-end outlier error
-    int32_t upper_outlier;  // higher-end outlier error
-
+    uint32_t servo_remainder; // fraction of an NTU carried over to the next timer delay by the servo
     uint16_t slots_accumulated; // the number of slots we have accumulated errors for
-
-    uint16_t globalScheduleLength; // number of schedule entries        
-    uint8_t localNodeId;  
-    uint8_t localScheduleLength;
+    uint16_t lastTransmitIndex; // global schedule index of the last local transmission
     uint8_t localScheduleIndex;
-
     bool isActive;
     bool transmitted;
+    bool scheduleStale; // missed a schedule switch, stays inactive until a schedule is loaded
+    gttcan_join_t join; // activation from any received frame
+    gttcan_fta_t fta; // outlier count and averaging window
+
+    // Configuration, read on every frame.
+    const gttcan_node_schedule_t *node_schedule; // the current schedule, shared or embedded_schedule
+    uint32_t slotduration; // in NUT (0.1us)
+    uint8_t localNodeId;
 
     transmit_callback_fp transmit_callback;
     set_timer_int_callback_fp set_timer_int_callback;
     read_value_fp read_value;
     write_value_fp write_value;
     void *context_pointer;
-    
+    struct gttcan_rx_ring_s *rx_ring; // deferred whiteboard delivery, NULL to call write_value directly
+    struct gttcan_whiteboard_s *whiteboard; // built-in whiteboard, NULL to use read_value/write_value
+    struct gttcan_stats_s *stats; // runtime statistics, NULL if not collected
+#if GTTCAN_TRACE
+    struct gttcan_trace_s *trace; // event trace, NULL if not recorded
+#endif
+    struct gttcan_fd_s *fd; // CAN FD interface, NULL to send classic CAN frames
+    struct gttcan_sporadic_s *sporadic; // sporadic message queue, NULL to ignore the arbitration slots
+    struct gttcan_staging_s *staging; // buffer for the next schedule, NULL if schedules are only loaded
+    struct gttcan_clock_s *global_clock; // interpolated global time, NULL if not kept
+
+    gttcan_servo_t servo; // clock rate and phase correction
+
+    int32_t lower_outliers[GTTCAN_FTA_MAX_OUTLIERS]; // lowest errors of the round in ascending order
+    int32_t upper_outliers[GTTCAN_FTA_MAX_OUTLIERS]; // highest errors of the round in descending order
+
+    uint32_t bit_time; // duration of one bit in NTU, 0 to use GTTCAN_DEFAULT_SLOT_OFFSET
+    uint32_t frame_latency; // reception latency in NTU added to the exact frame duration
+    gttcan_frame_prefix_t reference_frame_prefixes[GTTCAN_FRAME_PREFIX_CACHE_SIZE];
+    gttcan_fd_frame_prefix_t reference_fd_frame_prefixes[GTTCAN_FRAME_PREFIX_CACHE_SIZE]; // used with a CAN FD interface
+
+#if GTTCAN_EMBEDDED_SCHEDULE
+    gttcan_node_schedule_t embedded_schedule; // built by GTTCAN_load_schedule(), unused while a shared schedule is attached
+#endif
 
 } gttcan_t;
 
+/**
+ * @brief A serialised CAN frame as sent on the bus (before stuffing).
+ *
+ * Bit `n` of the frame is stored in bit `63 - (n % 64)` of `bits[n / 64]`,
+ * i.e. the first bit on the bus is the most significant bit of `bits[0]`.
+ */
+typedef struct gttcan_bitstream_s {
+    uint64_t bits[GTTCAN_BITSTREAM_WORDS];
+    uint32_t length; // number of bits in the stream
+} gttcan_bitstream_t;
+
+/**
+ * @brief Largest payload of a CAN FD frame in bytes.
+ */
+#define GTTCAN_FD_MAX_PAYLOAD 64U
+
+/**
+ * @brief The bits of a CAN FD frame at the nominal and the data bit rate.
+ *
+ * See GTTCAN_calculate_fd_frame_bits().  Without a bit rate switch,
+ * all bits are counted as nominal bits.
+ */
+typedef struct gttcan_fd_frame_bits_s {
+    uint32_t nominal_bits;  // SOF to BRS, ACK and EOF, with their stuffing bits
+    uint32_t data_bits;     // ESI to the CRC delimiter, with dynamic and fixed stuffing bits
+    uint32_t stuffing_bits; // dynamic stuffing bits (SOF to the end of the data field)
+    uint32_t crc;           // CRC-17 or CRC-21 sequence
+    uint8_t stuff_count;    // stuff count field: Gray-coded count modulo 8 and parity bit
+} gttcan_fd_frame_bits_t;
+
 /**
  * @brief Initialize a GTTCAN instance.
  *
+ * The instance starts with a global schedule of `globalScheduleLength`
+ * free slots.  Use GTTCAN_load_schedule() to load the actual schedule.
+ * Without #GTTCAN_EMBEDDED_SCHEDULE, the instance has an empty schedule
+ * and ignores all frames until GTTCAN_set_node_schedule() is called.
+ *
  * @param gttcan The GTTCAN instance to initialize.
  * @param localNodeId The local node ID.
  * @param slotduration The duration of a slot.
@@ -86,6 +511,148 @@ void GTTCAN_init(gttcan_t *gttcan,
                 write_value_fp write_value,
                 void *context_pointer);
 
+/**
+ * @brief Load a global schedule from a packed binary blob.
+ *
+ * The blob (see #GTTCAN_SCHEDULE_MAGIC_0 for the format) is referenced,
+ * not copied, so it must remain valid (and unchanged) for as long as
+ * the instance uses it.  This allows the schedule to live in a
+ * flash-resident const table on MCUs or in a memory-mapped file on hosts.
+ * The local schedule is rebuilt, and the node is deactivated
+ * until the next start-of-schedule reference frame.
+ *
+ * @param gttcan The GTTCAN instance (initialised with GTTCAN_init()).
+ * @param schedule Pointer to the schedule blob.
+ * @param size The size of the blob in bytes.
+ * @return true if the schedule was valid and loaded, false otherwise,
+ *         e.g. if the node has more than #GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH
+ *         slots (always without #GTTCAN_EMBEDDED_SCHEDULE).
+ */
+bool GTTCAN_load_schedule(gttcan_t *gttcan, const uint8_t *schedule, uint32_t size);
+
+/**
+ * @brief Build the read-only schedule of a node from a packed binary blob.
+ *
+ * The result can be attached to any number of instances with the node
+ * ID `localNodeId` with GTTCAN_set_node_schedule().  The blob is
+ * referenced, not copied, like by GTTCAN_load_schedule().
+ *
+ * @param node_schedule Receives the node schedule.
+ * @param schedule Pointer to the schedule blob.
+ * @param size The size of the blob in bytes.
+ * @param localNodeId The node ID.
+ * @param arbitration Whether to add the arbitration slots to the local
+ *                    schedule, for instances with a sporadic message queue.
+ * @return true if the schedule was valid, false if the blob is invalid
+ *         (see #GTTCAN_MAX_SCHEDULE_LENGTH) or the node has more than
+ *         #GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH slots.
+ */
+bool GTTCAN_build_node_schedule(gttcan_node_schedule_t *node_schedule, const uint8_t *schedule, uint32_t size,
+                                uint8_t localNodeId, bool arbitration);
+
+/**
+ * @brief Attach a shared node schedule.
+ *
+ * Like GTTCAN_load_schedule(), but the instance references the node
+ * schedule instead of building its own: the node is deactivated until
+ * the next start-of-schedule reference frame.  The node schedule must
+ * remain valid (and unchanged) for as long as the instance uses it.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param node_schedule The node schedule (see GTTCAN_build_node_schedule()).
+ * @return false if the node schedule was built for another node ID, or
+ *         its arbitration slots do not match whether a sporadic message
+ *         queue is attached.
+ */
+bool GTTCAN_set_node_schedule(gttcan_t *gttcan, const gttcan_node_schedule_t *node_schedule);
+
+/**
+ * @brief Attach a buffer for staging the next global schedule.
+ *
+ * See GTTCAN_stage_schedule() and gttcan_staging.h.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param staging The buffer (initialised with GTTCAN_staging_init()),
+ *                or NULL to detach it.
+ */
+void GTTCAN_set_staging(gttcan_t *gttcan, struct gttcan_staging_s *staging);
+
+/**
+ * @brief Stage the next global schedule without interrupting the current one.
+ *
+ * Validates the blob (like GTTCAN_load_schedule(), and referenced in
+ * the same way) and precomputes its local schedule and transmit tables
+ * in the attached staging buffer.  The schedule takes effect with the
+ * next start-of-schedule frame that carries #GTTCAN_SCHEDULE_SWITCH_FLAG,
+ * without touching the activation, clock servo or FTA state.  Can be
+ * called from a lower-priority context than the protocol (the main loop).
+ *
+ * @param gttcan The GTTCAN instance, with a staging buffer attached.
+ * @param schedule Pointer to the schedule blob.
+ * @param size The size of the blob in bytes.
+ * @return false if no staging buffer is attached, a staged schedule is
+ *         still waiting for its switch, or the blob is invalid (always
+ *         without #GTTCAN_EMBEDDED_SCHEDULE, see GTTCAN_stage_node_schedule()).
+ */
+bool GTTCAN_stage_schedule(gttcan_t *gttcan, const uint8_t *schedule, uint32_t size);
+
+/**
+ * @brief Stage a shared node schedule as the next schedule.
+ *
+ * Like GTTCAN_stage_schedule(), but the instance references the node
+ * schedule (see GTTCAN_set_node_schedule()) once it switches to it,
+ * instead of copying staged tables.
+ *
+ * @param gttcan The GTTCAN instance, with a staging buffer attached.
+ * @param node_schedule The node schedule (see GTTCAN_build_node_schedule()).
+ * @return false if no staging buffer is attached, a staged schedule is
+ *         still waiting for its switch, or the node schedule does not
+ *         match the instance.
+ */
+bool GTTCAN_stage_node_schedule(gttcan_t *gttcan, const gttcan_node_schedule_t *node_schedule);
+
+/**
+ * @brief Switch all nodes to the staged schedule (time master only).
+ *
+ * The next start-of-schedule frame sent by this node carries
+ * #GTTCAN_SCHEDULE_SWITCH_FLAG, and this node switches with it.  The
+ * staged schedule must keep slot 0 as the reference slot of this node.
+ * The same schedule has to be staged on every node first: a node that
+ * receives the flag without a staged schedule deactivates itself until
+ * a schedule is loaded with GTTCAN_load_schedule().
+ *
+ * @param gttcan The GTTCAN instance, with a staged schedule.
+ * @return false if no schedule is staged.
+ */
+bool GTTCAN_request_schedule_switch(gttcan_t *gttcan);
+
+/**
+ * @brief Pack a global schedule into a binary blob.
+ *
+ * This is the inverse of GTTCAN_load_schedule() and is meant for
+ * tools that generate schedules.  Each entry holds the node ID in
+ * bits 16-23 and the data ID in bits 0-15.
+ *
+ * @param blob The buffer receiving the blob.
+ * @param size The size of `blob` in bytes.
+ * @param entries The global schedule entries.
+ * @param length The number of entries.
+ * @param slotduration The slot duration in NTU (0 to keep the configured one).
+ * @return The number of bytes written, or 0 if `blob` is too small.
+ */
+uint32_t GTTCAN_pack_schedule(uint8_t *blob, uint32_t size, const uint32_t *entries, uint16_t length, uint32_t slotduration);
+
+/**
+ * @brief Return an entry of the global schedule.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param index The global schedule index.
+ * @return The node ID in bits 16-23 and the data ID in bits 0-15,
+ *         or 0 (a free slot) if no schedule is loaded or `index`
+ *         is outside the schedule.
+ */
+uint32_t GTTCAN_get_schedule_entry(const gttcan_t *gttcan, uint16_t index);
+
 /**
  * @brief Process a received CAN frame.
  *
@@ -93,8 +660,12 @@ void GTTCAN_init(gttcan_t *gttcan,
  * and handles the data based on the slot ID. It also calculates the time
  * to the next entry and sets a timer interrupt for that time.
  *
- * When a reference frame is received, the node is activated,
- * and the local schedule is reset.
+ * When a start-of-schedule reference frame is received, the node is activated
+ * (with the fast join, see GTTCAN_set_fast_join(), already after a number of
+ * consistent frames of any kind).
+ * The position in the local schedule is re-derived from the global schedule
+ * index of every received frame.  Frames with a global schedule index
+ * outside the schedule are ignored.
  *
  * If no reference fram has been received for the duration
  * of the global schedule, clock synchronisation is performed
@@ -106,6 +677,301 @@ void GTTCAN_init(gttcan_t *gttcan,
  */
 void GTTCAN_process_frame(gttcan_t *gttcan, uint32_t current_time, uint32_t can_frame_id_field, const uint64_t received_data);
 
+/**
+ * @brief Process a batch of received CAN frames.
+ *
+ * Equivalent to calling GTTCAN_process_frame() for each frame in order
+ * (whiteboard writes, error accumulation and clock synchronisation
+ * happen per frame), except that the timer interrupt is re-armed at most
+ * once, for the state after the last frame.  This is meant for drivers
+ * that drain a receive FIFO or DMA ring.
+ *
+ * The timestamps of a batch must share the same reference (the last
+ * local transmission), and the timer delay is relative to the
+ * timestamp of the last frame of the batch.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param frames The received frames, oldest first.
+ * @param count The number of frames.
+ */
+void GTTCAN_process_frames(gttcan_t *gttcan, const gttcan_rx_frame_t *frames, uint32_t count);
+
+/**
+ * @brief Process a received CAN FD frame.
+ *
+ * Like GTTCAN_process_frame(), except that the payload of a data frame
+ * is passed to the `write_buffer` callback of the attached CAN FD
+ * interface (see gttcan_fd.h).  The payload of a reference frame is
+ * read as a 64-bit value, most significant byte first.
+ *
+ * @param gttcan The GTTCAN instance, with a CAN FD interface attached.
+ * @param current_time The local time since the last transmission.
+ * @param can_frame_id_field The ID field of the received CAN frame.
+ * @param data The payload of the received CAN frame.
+ * @param length The number of payload bytes (0 to #GTTCAN_FD_MAX_PAYLOAD).
+ */
+void GTTCAN_process_fd_frame(gttcan_t *gttcan, uint32_t current_time, uint32_t can_frame_id_field, const uint8_t *data, uint8_t length);
+
+/**
+ * @brief Enable or disable exact transmission-delay compensation.
+ *
+ * By default, the network time received in a reference frame is
+ * advanced by the constant #GTTCAN_DEFAULT_SLOT_OFFSET to account for
+ * the transmission time of the frame.  When a non-zero `bit_time` is
+ * set, the offset is instead calculated from the exact number of bits
+ * of the received frame (including stuffing bits) plus `frame_latency`.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param bit_time The duration of one bit in NTU (e.g. 10 at 1 Mbit/s),
+ *                 or 0 to use #GTTCAN_DEFAULT_SLOT_OFFSET.
+ * @param frame_latency Additional reception latency in NTU.
+ */
+void GTTCAN_set_exact_slot_offset(gttcan_t *gttcan, uint32_t bit_time, uint32_t frame_latency);
+
+/**
+ * @brief Configure the clock servo.
+ *
+ * Without the servo (the default), a node uses the nominal slot
+ * duration and only re-synchronises its phase when it re-arms the
+ * timer on a reference frame, so its timer drifts for up to a whole
+ * schedule round.  With the servo, every FTA result drives a PI
+ * controller: the integral term corrects the slot duration, kept with
+ * #GTTCAN_SERVO_FRACTION_BITS fractional bits so that corrections
+ * below one NTU accumulate (limited to #GTTCAN_SERVO_MAX_PPM), and the
+ * proportional term shifts the next timer interrupt (limited to half a
+ * slot).  Configuring the servo resets its state.
+ *
+ * The integral term drives the mean FTA error to zero, so a constant
+ * delay between the start of a received frame and the `current_time`
+ * passed for it (interrupt latency, timestamping in the CAN
+ * controller) has to be given as `timestamp_latency`; otherwise the
+ * servo would lengthen the slots to make up for it.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param enabled Whether to correct the clock rate and phase.
+ * @param kp_shift Proportional gain 2^-kp_shift (e.g. #GTTCAN_SERVO_KP_SHIFT).
+ * @param ki_shift Integral gain 2^-ki_shift per schedule round (e.g. #GTTCAN_SERVO_KI_SHIFT).
+ * @param timestamp_latency Mean receive timestamp latency in NTU.
+ */
+void GTTCAN_set_clock_servo(gttcan_t *gttcan, bool enabled, uint8_t kp_shift, uint8_t ki_shift, uint32_t timestamp_latency);
+
+/**
+ * @brief Configure the fast join.
+ *
+ * By default, an inactive node waits for a start-of-schedule reference
+ * frame before it transmits, which can take up to a full round after a
+ * reset or hot-plug.  With the fast join, an inactive node derives its
+ * position in the round from the global schedule index of any received
+ * frame and activates once `observations` frames in a row were
+ * consistent: the time between two frames matches the distance of
+ * their indices (modulo whole rounds) within
+ * #GTTCAN_JOIN_TOLERANCE_SHIFT.  The node then arms its timer for its
+ * next slot.  Clock errors are only accumulated after the first local
+ * transmission, so the `current_time` of the frames before it only
+ * needs a common, arbitrary reference.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param observations Consistent frames needed to join, 1 to join on the
+ *                     first frame, 0 to wait for a start-of-schedule frame (the default).
+ */
+void GTTCAN_set_fast_join(gttcan_t *gttcan, uint8_t observations);
+
+/**
+ * @brief Return the corrected slot duration.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @return The slot duration in local time, in 2^-#GTTCAN_SERVO_FRACTION_BITS NTU.
+ */
+uint64_t GTTCAN_get_corrected_slot_duration(const gttcan_t *gttcan);
+
+/**
+ * @brief Attach a receive ring for deferred whiteboard delivery.
+ *
+ * With a ring attached, GTTCAN_process_frame() and GTTCAN_process_frames()
+ * only perform the clock synchronisation and push the whiteboard values
+ * onto the ring; GTTCAN_drain_rx_ring() passes them to `write_value`.
+ * See gttcan_rx_ring.h.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param ring The ring (initialised with GTTCAN_rx_ring_init()),
+ *             or NULL to call `write_value` directly again.
+ */
+void GTTCAN_set_rx_ring(gttcan_t *gttcan, struct gttcan_rx_ring_s *ring);
+
+/**
+ * @brief Deliver the values queued on the receive ring to the whiteboard.
+ *
+ * The values are written to the built-in whiteboard (with their receive
+ * time as timestamp) if one is attached, otherwise passed to `write_value`.
+ * Must only be called from one context at a time (the ring consumer),
+ * e.g. the main loop or a whiteboard thread.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @return The number of values delivered.
+ */
+uint32_t GTTCAN_drain_rx_ring(gttcan_t *gttcan);
+
+/**
+ * @brief Attach a built-in whiteboard.
+ *
+ * With a whiteboard attached, GTTCAN_transmit_next_frame() reads the
+ * transmitted values from it instead of calling `read_value`, and
+ * received values are written to it instead of calling `write_value`
+ * (by GTTCAN_drain_rx_ring() if a receive ring is attached).
+ * See gttcan_whiteboard.h.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param whiteboard The whiteboard (initialised with GTTCAN_whiteboard_init()),
+ *                   or NULL to use the callbacks again.
+ */
+void GTTCAN_set_whiteboard(gttcan_t *gttcan, struct gttcan_whiteboard_s *whiteboard);
+
+/**
+ * @brief Attach a statistics block.
+ *
+ * See gttcan_stats.h.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param stats The statistics block (initialised with GTTCAN_stats_init()),
+ *              or NULL to stop collecting statistics.
+ */
+void GTTCAN_set_stats(gttcan_t *gttcan, struct gttcan_stats_s *stats);
+
+#if GTTCAN_TRACE
+/**
+ * @brief Attach a trace ring.
+ *
+ * See gttcan_trace.h.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param trace The trace ring (initialised with GTTCAN_trace_init()),
+ *              or NULL to stop tracing.
+ */
+void GTTCAN_set_trace(gttcan_t *gttcan, struct gttcan_trace_s *trace);
+#endif
+
+/**
+ * @brief Attach a CAN FD interface.
+ *
+ * With an interface attached, GTTCAN_transmit_next_frame() sends all
+ * frames with its `transmit` callback instead of `transmit_callback`
+ * and reads the payload of data frames with `read_buffer`.
+ * See gttcan_fd.h.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param fd The interface (initialised with GTTCAN_fd_init()),
+ *           or NULL to send classic CAN frames again.
+ */
+void GTTCAN_set_fd(gttcan_t *gttcan, struct gttcan_fd_s *fd);
+
+/**
+ * @brief Attach a sporadic message queue.
+ *
+ * With a queue attached, the arbitration slots of the global schedule
+ * (see #GTTCAN_ARBITRATION_NODE) are added to the local schedule, and
+ * GTTCAN_transmit_next_frame() sends the most urgent queued message in
+ * them; in an arbitration slot without a queued message, nothing is sent.
+ * The driver has to report the outcome of every transmission with
+ * GTTCAN_transmit_result(), and should send the frames of arbitration
+ * slots single-shot (without automatic retransmission), so that a
+ * message that lost arbitration is retried in the next arbitration
+ * slot instead of disturbing the following slot.
+ * The local schedule is rebuilt, and the node is deactivated until the
+ * next start-of-schedule reference frame.  A shared node schedule (see
+ * GTTCAN_set_node_schedule()) is replaced by an embedded copy with or
+ * without the arbitration slots, or, without #GTTCAN_EMBEDDED_SCHEDULE,
+ * by an empty schedule until a matching one is attached.  See
+ * gttcan_sporadic.h.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param sporadic The queue (initialised with GTTCAN_sporadic_init()),
+ *                 or NULL to ignore the arbitration slots again.
+ * @return false (leaving the instance unchanged) if the local schedule
+ *         would have more than #GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH slots.
+ */
+bool GTTCAN_set_sporadic(gttcan_t *gttcan, struct gttcan_sporadic_s *sporadic);
+
+/**
+ * @brief Report the outcome of a transmission.
+ *
+ * Should be called by the driver when a frame passed to the transmit
+ * callback has been sent, or was dropped (e.g. after losing arbitration
+ * in single-shot mode).  Only frames sent from the sporadic message
+ * queue are tracked: a sent message is removed from the queue, one that
+ * was not sent stays at the head of its queue for the next arbitration
+ * slot.  Other frames are ignored.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param can_frame_id_field The ID field of the frame.
+ * @param sent Whether the frame was sent.
+ * @param timestamp The time of the outcome on the clock passed to
+ *                  GTTCAN_sporadic_push(), for the latency statistics.
+ */
+void GTTCAN_transmit_result(gttcan_t *gttcan, uint32_t can_frame_id_field, bool sent, uint32_t timestamp);
+
+/**
+ * @brief Attach a global clock.
+ *
+ * With a clock attached, every reference frame records the network
+ * time and the local time of its start, from which
+ * GTTCAN_get_global_time() interpolates.  The driver has to report
+ * its `current_time` reference with GTTCAN_set_local_reference().
+ * See gttcan_clock.h.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param global_clock The clock (initialised with GTTCAN_clock_init()),
+ *                     or NULL to stop keeping the global time.
+ */
+void GTTCAN_set_global_clock(gttcan_t *gttcan, struct gttcan_clock_s *global_clock);
+
+/**
+ * @brief Report the local time from which `current_time` is counted.
+ *
+ * Should be called by the driver whenever it moves the reference of
+ * `current_time`: in the transmit callback, and before passing a
+ * start-of-schedule frame to GTTCAN_process_frame() while the node
+ * has not transmitted.  Does nothing without a global clock.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param local_reference The reference on the free-running local clock in NTU.
+ */
+void GTTCAN_set_local_reference(gttcan_t *gttcan, uint32_t local_reference);
+
+/**
+ * @brief Return the network time at a local time.
+ *
+ * The network time of the last reference frame, plus the local time
+ * since its start corrected by the drift estimate of the clock servo
+ * (without the servo, the local clock is assumed to run at the
+ * nominal rate; on the time master, the network time is its own).
+ * May be called from any thread or interrupt; see gttcan_clock.h.
+ *
+ * @param gttcan The GTTCAN instance, with a global clock attached.
+ * @param local_now The local time on the clock of GTTCAN_set_local_reference(),
+ *                  at most 2^31 NTU after the last reference frame.
+ * @return The network time in NTU (62 bits), or 0 if no clock is
+ *         attached or no reference frame was seen yet.
+ */
+uint64_t GTTCAN_get_global_time(const gttcan_t *gttcan, uint32_t local_now);
+
+/**
+ * @brief Return the transmission-delay offset of a reference frame.
+ *
+ * This function returns the time (in NTU) between the start of
+ * transmission of the given reference frame and its reception.
+ * The identifier and control field of recently seen reference
+ * frames are cached, so only the payload and CRC are scanned
+ * for stuffing bits.  With a CAN FD interface attached, the frame
+ * is counted as a CAN FD frame, with the data phase at its data
+ * bit time, and its prefix is cached separately.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param can_frame_id_field The ID field of the reference frame.
+ * @param received_data The payload of the reference frame.
+ * @return The offset in NTU.
+ */
+uint32_t GTTCAN_reference_frame_offset(gttcan_t *gttcan, uint32_t can_frame_id_field, uint64_t received_data);
+
 /**
  * @brief Transmit the next frame in the GTTCAN schedule.
  *
@@ -114,6 +980,8 @@ void GTTCAN_process_frame(gttcan_t *gttcan, uint32_t current_time, uint32_t can_
  * It also calculates the time to the next entry and
  * runs the callback function to set a timer interrupt
  * for that point in time.
+ * In an arbitration slot, the most urgent message of the sporadic
+ * message queue is sent, or nothing if the queue is empty.
  *
  * @param gttcan The GTTCAN instance.
  */
@@ -133,32 +1001,62 @@ void GTTCAN_start(gttcan_t * gttcan);
 /**
  * @brief Get the number of slots to the next transmit.
  *
- * This function calculates the number of slots to the next transmit slot in the schedule.
+ * This function looks up the number of slots to the next transmit slot
+ * in the schedule in a table built by GTTCAN_init() (or, without
+ * #GTTCAN_TRANSMIT_TABLES, binary-searches the local schedule),
+ * so the result does not depend on `localScheduleIndex`.
  *
  * @param gttcan The GTTCAN instance.
  * @param currentScheduleIndex The current index in the schedule.
- * @return The number of slots to the next transmit.
+ * @return The number of slots to the next transmit,
+ *         or 0 if the index is outside the global schedule.
  */
 uint16_t GTTCAN_get_slots_to_next_transmit(gttcan_t *gttcan, uint16_t currentScheduleIndex);
 
 /**
  * @brief Get the number of slots since the last transmit.
  *
- * This function calculates the number of slots since the last transmit in the schedule.
+ * This function looks up the number of slots since the last transmit
+ * in the schedule in a table built by GTTCAN_init() (or, without
+ * #GTTCAN_TRANSMIT_TABLES, binary-searches the local schedule).  If this node has
+ * not transmitted yet, the slots since the start of the schedule are returned.
+ * With a sporadic message queue attached, the slots since the global schedule
+ * index of the last actual transmission are returned instead, as arbitration
+ * slots without a queued message are skipped (0 for a frame in the slot of
+ * the last transmission, i.e. after losing arbitration).
  *
  * @param gttcan The GTTCAN instance.
  * @param currentScheduleIndex The current index in the schedule.
- * @return The number of slots since the last transmit.
+ * @return The number of slots since the last transmit,
+ *         or 0 if the index is outside the global schedule.
  */
 uint16_t GTTCAN_get_slots_since_last_transmit(gttcan_t * gttcan, uint16_t currentScheduleIndex);
 
+/**
+ * @brief Configure the fault-tolerant averaging.
+ *
+ * The FTA discards the `outliers` lowest and the `outliers` highest
+ * error samples of a round, so up to `outliers` faulty nodes are
+ * tolerated.  With a `window` of more than one round, the result is
+ * the average of the trimmed samples of the last `window` rounds,
+ * which smoothes the estimate at the cost of a slower response.
+ * Resets the accumulated errors and the window.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param outliers Number of outliers discarded at each end, 1 to #GTTCAN_FTA_MAX_OUTLIERS (default 1).
+ * @param window Number of rounds averaged over, 1 to #GTTCAN_FTA_MAX_WINDOW (default 1).
+ * @return false if a parameter is out of range (the configuration is unchanged).
+ */
+bool GTTCAN_set_fta(gttcan_t *gttcan, uint8_t outliers, uint8_t window);
+
 /**
  * @brief Return the fault-tolerant average error.
  *
  * This function returns the fault-tolerant average error
  * and resets the error accumulator.
- * If not enough errors have been accumulated, this function
- * will degrade to an arithmetic average.
+ * If not more than twice the configured number of outliers have
+ * been accumulated, this function will degrade to an arithmetic
+ * average.  See GTTCAN_set_fta() for averaging over several rounds.
  *
  * @param gttcan The gttcan instance.
  * @return The fault-tolerant average error.
@@ -169,7 +1067,8 @@ int32_t GTTCAN_fta(gttcan_t *gttcan);
  * @brief Accumulate an error sample.
  *
  * This function adds the given error to the accumulator
- * and updates the lower and upper outliers as necessary.
+ * and inserts it into the sorted lower and upper outliers
+ * as necessary (O(k) for k outliers).
  *
  * @param gttcan The gttcan instance to operate on.
  * @param error  The error to accumulate.
@@ -182,6 +1081,9 @@ void GTTCAN_accumulate_error(gttcan_t *gttcan, int32_t error);
  * This function calculates the number of stuffed bits in a CAN frame.
  * The CAN frame is assumed to be in the format specified by ISO 11898-1.
  * The CRC delimiter and ACK slot are assumed to be present.
+ * The bytes are examined least-significant bit first.  For the exact
+ * number of stuffing bits of a frame on the bus, see
+ * GTTCAN_count_bitstream_stuffing_bits().
  *
  * @param buffer Pointer to the buffer containing the CAN frame.
  * @param length Length of the CAN frame.
@@ -194,6 +1096,9 @@ uint32_t GTTCAN_calculate_stuffing_bits(const uint8_t * const buffer, const uint
  * This function calculates the number of bits in a CAN frame on the bus.
  * The CAN frame is assumed to be in the format specified by ISO 11898-1.
  * The CRC delimiter and ACK slot are assumed to be present.
+ * As the identifier and CRC are unknown, only the stuffing bits of the
+ * payload are taken into account.  GTTCAN_calculate_extended_frame_bits()
+ * returns the exact length of an extended frame.
  *
  * @param buffer Pointer to the buffer containing the CAN frame.
  * @param length Length of the CAN frame.
@@ -201,6 +1106,93 @@ uint32_t GTTCAN_calculate_stuffing_bits(const uint8_t * const buffer, const uint
  */
 uint32_t GTTCAN_calculate_can_frame_bits(const uint8_t * const buffer, const uint32_t length, const bool is_extended);
 
+/**
+ * @brief Count the stuffing bits of a serialised CAN frame.
+ *
+ * This function applies the ISO 11898-1 bit stuffing rule to the
+ * given bit stream: after five consecutive bits of the same value,
+ * a complementary bit is inserted, which itself counts towards the
+ * next run.
+ *
+ * @param stream The bit stream, e.g. from GTTCAN_serialise_extended_frame().
+ * @return The number of stuffing bits inserted on the bus.
+ */
+uint32_t GTTCAN_count_bitstream_stuffing_bits(const gttcan_bitstream_t * const stream);
+
+/**
+ * @brief Serialise an extended CAN data frame into a bit stream.
+ *
+ * This function produces the part of an ISO 11898-1 extended data frame
+ * that is subject to bit stuffing, i.e. SOF, base identifier, SRR, IDE,
+ * identifier extension, RTR, r1, r0, DLC, data field and CRC sequence,
+ * in the order in which the bits are sent on the bus.
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param data Pointer to the payload.
+ * @param length The number of payload bytes (0 to 8).
+ * @param stream The stream receiving the serialised frame.
+ * @return The number of bits in the stream.
+ */
+uint32_t GTTCAN_serialise_extended_frame(const uint32_t id, const uint8_t * const data, const uint8_t length, gttcan_bitstream_t * const stream);
+
+/**
+ * @brief Calculate the exact number of bits of an extended CAN frame.
+ *
+ * This function serialises the frame, counts its stuffing bits,
+ * and adds the unstuffed CRC delimiter, ACK slot, ACK delimiter,
+ * and end-of-frame bits.  Interframe space is not included.
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param data Pointer to the payload.
+ * @param length The number of payload bytes (0 to 8).
+ * @return The number of bits the frame occupies on the bus.
+ */
+uint32_t GTTCAN_calculate_extended_frame_bits(const uint32_t id, const uint8_t * const data, const uint8_t length);
+
+/**
+ * @brief Pre-compute the identifier and control field of an extended CAN frame.
+ *
+ * The stuffing state and CRC after the first 39 bits of an extended
+ * data frame (SOF to DLC) only depend on the identifier and the payload
+ * length.  This function computes them once so that the length of frames
+ * that share an identifier can be calculated from the payload alone using
+ * GTTCAN_calculate_extended_frame_bits_from_prefix().
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param length The number of payload bytes (0 to 8).
+ * @param prefix The prefix to initialise.
+ */
+void GTTCAN_prepare_extended_frame_prefix(const uint32_t id, const uint8_t length, gttcan_frame_prefix_t * const prefix);
+
+/**
+ * @brief Calculate the exact number of bits of an extended CAN frame from its prefix.
+ *
+ * Only the data field and CRC sequence are serialised and scanned for
+ * stuffing bits; the identifier and control field are taken from a
+ * prefix computed by GTTCAN_prepare_extended_frame_prefix().
+ *
+ * @param prefix The pre-computed identifier and control field.
+ * @param data Pointer to the payload (`prefix->length` bytes).
+ * @return The number of bits the frame occupies on the bus.
+ */
+uint32_t GTTCAN_calculate_extended_frame_bits_from_prefix(const gttcan_frame_prefix_t * const prefix, const uint8_t * const data);
+
+/**
+ * @brief Calculate an upper bound on the number of bits of an extended CAN frame.
+ *
+ * The identifier and control field are stuffed exactly (see
+ * GTTCAN_prepare_extended_frame_prefix()); for the data field and CRC
+ * sequence, whose content is unknown, every stuffing opportunity is
+ * assumed to be taken: the first after the run left by the DLC, then
+ * one every four bits.  Interframe space is not included.
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param length The number of payload bytes (0 to 8).
+ * @return The largest number of bits a frame with this identifier and
+ *         length can occupy on the bus.
+ */
+uint32_t GTTCAN_calculate_extended_frame_max_bits(const uint32_t id, const uint8_t length);
+
 /**
  * @brief Compute the CRC-15 of a CAN frame.
  *
@@ -213,6 +1205,34 @@ uint32_t GTTCAN_calculate_can_frame_bits(const uint8_t * const buffer, const uin
  */
 uint16_t GTTCAN_crc15(const uint8_t * const buffer, const uint32_t length);
 
+/**
+ * @brief Compute the CRC-15 of a CAN frame bit by bit.
+ *
+ * This is the reference implementation of GTTCAN_crc15()
+ * that processes one bit per iteration without a lookup table.
+ * It is used by GTTCAN_crc15() when #GTTCAN_CRC15_SLICES is 0.
+ *
+ * @param buffer Pointer to the buffer containing the CAN frame.
+ * @param length The length of the CAN frame.
+ */
+uint16_t GTTCAN_crc15_bitwise(const uint8_t * const buffer, const uint32_t length);
+
+/**
+ * @brief Compute the CRC-15 of several CAN frames in one call.
+ *
+ * The frames are stored back to back in a single buffer,
+ * `stride` bytes apart, with the number of valid bytes of
+ * each frame given in `lengths`.  The CRC of frame `i`
+ * (as computed by GTTCAN_crc15()) is stored in `crcs[i]`.
+ *
+ * @param frames Pointer to the first frame.
+ * @param stride Distance in bytes between consecutive frames.
+ * @param lengths Array of `count` frame lengths.
+ * @param crcs Array of `count` entries receiving the CRCs.
+ * @param count The number of frames.
+ */
+void GTTCAN_crc15_batch(const uint8_t * const frames, const uint32_t stride, const uint32_t * const lengths, uint16_t * const crcs, const uint32_t count);
+
 /**
  * @brief Append a CRC to a CAN frame.
  *
@@ -226,6 +1246,125 @@ uint16_t GTTCAN_crc15(const uint8_t * const buffer, const uint32_t length);
  */
 uint32_t GTTCAN_append_crc_to_can_frame(uint8_t * const frame, const uint32_t length);
 
+/**
+ * @brief Return the payload length of a CAN FD data length code.
+ *
+ * @param dlc The data length code (0 to 15).
+ * @return The number of payload bytes.
+ */
+uint8_t GTTCAN_fd_dlc_to_length(const uint8_t dlc);
+
+/**
+ * @brief Return the smallest CAN FD data length code that holds a payload.
+ *
+ * @param length The number of payload bytes (payloads above 64 bytes
+ *               are truncated to 64).
+ * @return The data length code (0 to 15).
+ */
+uint8_t GTTCAN_fd_length_to_dlc(const uint8_t length);
+
+/**
+ * @brief Compute the CAN FD CRC-17 of a bit string.
+ *
+ * Uses the polynomial 0x1685B and the initial value 2^16 of
+ * ISO 11898-1:2015; used for payloads of up to 16 bytes.
+ *
+ * @param buffer The bits, most significant bit of the first byte first.
+ * @param bits The number of bits.
+ * @return The 17-bit CRC.
+ */
+uint32_t GTTCAN_crc17(const uint8_t * const buffer, const uint32_t bits);
+
+/**
+ * @brief Compute the CAN FD CRC-21 of a bit string.
+ *
+ * Uses the polynomial 0x102899 and the initial value 2^20 of
+ * ISO 11898-1:2015; used for payloads of more than 16 bytes.
+ *
+ * @param buffer The bits, most significant bit of the first byte first.
+ * @param bits The number of bits.
+ * @return The 21-bit CRC.
+ */
+uint32_t GTTCAN_crc21(const uint8_t * const buffer, const uint32_t bits);
+
+/**
+ * @brief Calculate the exact number of bits of an extended CAN FD frame.
+ *
+ * The payload is padded with zero bytes to the next CAN FD length.
+ * Stuffing bits of the identifier, control and data field and the
+ * fixed stuffing bits of the CRC field are counted; interframe space
+ * is not included.  With a bit rate switch, the bits from the BRS
+ * sample point to the CRC delimiter are sent at the data bit rate.
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param data Pointer to the payload.
+ * @param length The number of payload bytes (0 to 64).
+ * @param brs Whether the bit rate is switched for the data phase.
+ * @param bits Receives the bits at each bit rate, the number of
+ *             dynamic stuffing bits, the stuff count field and the CRC.
+ * @return The number of bits the frame occupies on the bus.
+ */
+uint32_t GTTCAN_calculate_fd_frame_bits(const uint32_t id, const uint8_t * const data, const uint8_t length, const bool brs, gttcan_fd_frame_bits_t * const bits);
+
+/**
+ * @brief Pre-compute the identifier and control field of an extended CAN FD frame.
+ *
+ * The stuffing state and CRC after the first 41 bits of an extended
+ * CAN FD frame (SOF to DLC) only depend on the identifier, the payload
+ * length and the bit rate switch.  This function computes them once so
+ * that the length of frames that share them can be calculated from the
+ * payload alone using GTTCAN_calculate_fd_frame_bits_from_prefix().
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param length The number of payload bytes (0 to 64).
+ * @param brs Whether the bit rate is switched for the data phase.
+ * @param prefix The prefix to initialise.
+ */
+void GTTCAN_prepare_fd_frame_prefix(const uint32_t id, const uint8_t length, const bool brs, gttcan_fd_frame_prefix_t * const prefix);
+
+/**
+ * @brief Calculate the exact number of bits of an extended CAN FD frame from its prefix.
+ *
+ * Only the data field, stuff count and CRC are serialised; the
+ * identifier and control field are taken from a prefix computed by
+ * GTTCAN_prepare_fd_frame_prefix().  The result is the same as that of
+ * GTTCAN_calculate_fd_frame_bits().
+ *
+ * @param prefix The pre-computed identifier and control field.
+ * @param data Pointer to the payload (`prefix->length` bytes).
+ * @param bits Receives the bits at each bit rate, the number of
+ *             dynamic stuffing bits, the stuff count field and the CRC.
+ * @return The number of bits the frame occupies on the bus.
+ */
+uint32_t GTTCAN_calculate_fd_frame_bits_from_prefix(const gttcan_fd_frame_prefix_t * const prefix, const uint8_t * const data, gttcan_fd_frame_bits_t * const bits);
+
+/**
+ * @brief Calculate an upper bound on the number of bits of an extended CAN FD frame.
+ *
+ * Like GTTCAN_calculate_extended_frame_max_bits(): the identifier and
+ * control field are stuffed exactly, and every stuffing opportunity of
+ * the data field is assumed to be taken.  `stuff_count` and `crc` of
+ * `bits` are set to 0.
+ *
+ * @param id The 29-bit identifier of the frame.
+ * @param length The number of payload bytes (0 to 64).
+ * @param brs Whether the bit rate is switched for the data phase.
+ * @param bits Receives the bits at each bit rate and the number of dynamic stuffing bits.
+ * @return The largest number of bits a frame with this identifier and
+ *         length can occupy on the bus.
+ */
+uint32_t GTTCAN_calculate_fd_frame_max_bits(const uint32_t id, const uint8_t length, const bool brs, gttcan_fd_frame_bits_t * const bits);
+
+/**
+ * @brief Return the duration of a CAN FD frame.
+ *
+ * @param bits The bits of the frame at each bit rate.
+ * @param nominal_bit_time The duration of a bit at the nominal bit rate.
+ * @param data_bit_time The duration of a bit at the data bit rate.
+ * @return The duration, in the unit of the bit times.
+ */
+uint32_t GTTCAN_fd_frame_duration(const gttcan_fd_frame_bits_t * const bits, const uint32_t nominal_bit_time, const uint32_t data_bit_time);
+
 #ifdef __cplusplus
 }; // extern "C"
 #endif
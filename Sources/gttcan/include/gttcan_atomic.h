@@ -0,0 +1,43 @@
+/**
+ * @file gttcan_atomic.h
+ * @brief Minimal atomics shim shared by the receive ring and the whiteboard.
+ *
+ * Maps to C11 `<stdatomic.h>` in C, to `std::atomic` in C++, and to
+ * volatile accesses with compiler barriers on targets that define
+ * `__STDC_NO_ATOMICS__` (single-core MCUs, where aligned 32-bit
+ * accesses are atomic and only compiler reordering has to be prevented).
+ *
+ * Only 32-bit objects are used with these macros, so that no target
+ * needs lock-based atomics in interrupt context.
+ */
+#ifndef GTTCAN_ATOMIC_H
+#define GTTCAN_ATOMIC_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+#include <atomic>
+#define GTTCAN_ATOMIC(type) std::atomic<type>
+#define GTTCAN_ATOMIC_INIT(object, value) (object).store((value), std::memory_order_relaxed)
+#define GTTCAN_ATOMIC_LOAD(object, order) (object).load(std::memory_order_##order)
+#define GTTCAN_ATOMIC_STORE(object, value, order) (object).store((value), std::memory_order_##order)
+#define GTTCAN_ATOMIC_FENCE(order) std::atomic_thread_fence(std::memory_order_##order)
+#elif defined(__STDC_NO_ATOMICS__)
+#define GTTCAN_COMPILER_BARRIER() __asm__ volatile("" ::: "memory")
+#define GTTCAN_ATOMIC(type) volatile type
+#define GTTCAN_ATOMIC_INIT(object, value) ((object) = (value))
+#define GTTCAN_ATOMIC_LOAD(object, order) \
+    __extension__({ const uint32_t gttcan_loaded = (object); GTTCAN_COMPILER_BARRIER(); gttcan_loaded; })
+#define GTTCAN_ATOMIC_STORE(object, value, order) \
+    do { GTTCAN_COMPILER_BARRIER(); (object) = (value); } while (0)
+#define GTTCAN_ATOMIC_FENCE(order) GTTCAN_COMPILER_BARRIER()
+#else
+#include <stdatomic.h>
+#define GTTCAN_ATOMIC(type) _Atomic(type)
+#define GTTCAN_ATOMIC_INIT(object, value) atomic_init(&(object), (value))
+#define GTTCAN_ATOMIC_LOAD(object, order) atomic_load_explicit(&(object), memory_order_##order)
+#define GTTCAN_ATOMIC_STORE(object, value, order) atomic_store_explicit(&(object), (value), memory_order_##order)
+#define GTTCAN_ATOMIC_FENCE(order) atomic_thread_fence(memory_order_##order)
+#endif
+
+#endif // GTTCAN_ATOMIC_H
@@ -0,0 +1,122 @@
+/**
+ * @file gttcan_clock.h
+ * @brief Global time interpolated between reference frames.
+ *
+ * The network time is only sent in the reference frames, but
+ * applications often need it in between, e.g. to timestamp samples.
+ * When a clock is attached with GTTCAN_set_global_clock(), every
+ * reference frame (received, or sent by the time master) records an
+ * anchor: the network time of the frame and the local time of its
+ * start.  GTTCAN_get_global_time() extrapolates from the last anchor
+ * with the current drift estimate of the clock servo.
+ *
+ * Local times are given on a free-running, wrapping 32-bit NTU clock
+ * of the driver (e.g. a hardware timer), not relative to the last
+ * transmission like `current_time`.  The driver reports the time of
+ * each new `current_time` reference with GTTCAN_set_local_reference():
+ * in the transmit callback, and before passing a start-of-schedule
+ * frame to GTTCAN_process_frame() while the node has not transmitted.
+ *
+ * The anchor is published like a whiteboard entry (see
+ * gttcan_whiteboard.h): a sequence counter and two copies, so
+ * GTTCAN_get_global_time() takes no locks, makes no calls and can be
+ * used at a high rate from any thread or interrupt.
+ */
+#ifndef GTTCAN_CLOCK_H
+#define GTTCAN_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gttcan.h"
+#include "gttcan_atomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief One copy of an anchor, stored as 32-bit words (see gttcan_whiteboard_copy_t).
+ */
+typedef struct gttcan_clock_copy_s {
+    GTTCAN_ATOMIC(uint32_t) time_high; // network time of the reference frame
+    GTTCAN_ATOMIC(uint32_t) time_low;
+    GTTCAN_ATOMIC(uint32_t) local;     // local time of the start of the reference frame
+    GTTCAN_ATOMIC(uint32_t) drift;     // int32_t, network time per local time - 1, in 2^-32
+} gttcan_clock_copy_t;
+
+/**
+ * @brief The global clock, see GTTCAN_clock_init().
+ */
+typedef struct gttcan_clock_s {
+    GTTCAN_ATOMIC(uint32_t) sequence; // number of anchors, the current copy is sequence & 1
+    gttcan_clock_copy_t copies[2];
+    uint32_t reference; // local time of the `current_time` reference, driver context only
+} gttcan_clock_t;
+
+/**
+ * @brief A consistent snapshot of the last anchor.
+ */
+typedef struct gttcan_clock_anchor_s {
+    uint64_t time;       // network time of the reference frame in NTU
+    uint32_t local;      // local time of the start of the reference frame in NTU
+    int32_t drift;       // network time per local time - 1, in 2^-32
+    uint32_t generation; // number of anchors, 0 if no reference frame was seen yet
+} gttcan_clock_anchor_t;
+
+/**
+ * @brief Initialise a global clock without an anchor.
+ *
+ * @param global_clock The clock.
+ */
+void GTTCAN_clock_init(gttcan_clock_t *global_clock);
+
+/**
+ * @brief Record an anchor.
+ *
+ * Called by the GTTCAN receive and transmit paths for reference frames.
+ *
+ * @param global_clock The clock.
+ * @param time The network time of the reference frame in NTU.
+ * @param local The local time of the start of the frame in NTU.
+ * @param drift Network time per local time - 1, in 2^-32.
+ */
+static inline void GTTCAN_clock_write(gttcan_clock_t *global_clock, uint64_t time, uint32_t local, int32_t drift)
+{
+    const uint32_t sequence = GTTCAN_ATOMIC_LOAD(global_clock->sequence, relaxed);
+    gttcan_clock_copy_t * const copy = &global_clock->copies[(sequence + 1U) & 1U];
+    // Order the previous publication before overwriting the copy it retired.
+    GTTCAN_ATOMIC_FENCE(release);
+    GTTCAN_ATOMIC_STORE(copy->time_high, (uint32_t)(time >> 32U), relaxed);
+    GTTCAN_ATOMIC_STORE(copy->time_low, (uint32_t)time, relaxed);
+    GTTCAN_ATOMIC_STORE(copy->local, local, relaxed);
+    GTTCAN_ATOMIC_STORE(copy->drift, (uint32_t)drift, relaxed);
+    GTTCAN_ATOMIC_STORE(global_clock->sequence, sequence + 1U, release);
+}
+
+/**
+ * @brief Read a consistent snapshot of the last anchor.
+ *
+ * May be called from any context, concurrently with the GTTCAN instance.
+ *
+ * @param global_clock The clock.
+ * @param anchor Receives the anchor.
+ */
+void GTTCAN_clock_read(const gttcan_clock_t *global_clock, gttcan_clock_anchor_t *anchor);
+
+/**
+ * @brief Return the network time at a local time, extrapolated from an anchor.
+ *
+ * The local time may lie up to 2^31 NTU before or after the anchor;
+ * the 32-bit local clock may wrap in between.
+ *
+ * @param anchor The anchor.
+ * @param local_now The local time in NTU.
+ * @return The network time in NTU (62 bits).
+ */
+uint64_t GTTCAN_clock_extrapolate(const gttcan_clock_anchor_t *anchor, uint32_t local_now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GTTCAN_CLOCK_H
@@ -0,0 +1,107 @@
+/**
+ * @file gttcan_fd.h
+ * @brief CAN FD frames with payloads of up to 64 bytes.
+ *
+ * When a CAN FD interface is attached with GTTCAN_set_fd(), data
+ * frames are read from and written to the application with the
+ * variable-length `read_buffer`/`write_buffer` callbacks and sent
+ * with `transmit`, so that a slot can carry up to
+ * #GTTCAN_FD_MAX_PAYLOAD bytes.  Reference frames keep their 8-byte
+ * payload (the 64-bit network time, most significant byte first) and
+ * the `read_value`/`write_value` path (or the built-in whiteboard),
+ * but are sent as CAN FD frames as well.
+ *
+ * Received frames are passed to GTTCAN_process_fd_frame().  Data
+ * frames are delivered to `write_buffer` directly, also when a
+ * receive ring is attached (the ring and the whiteboard only hold
+ * 64-bit values).
+ *
+ * With a non-zero `data_bit_time`, frames are sent with a bit rate
+ * switch and the exact slot offset (GTTCAN_set_exact_slot_offset())
+ * counts the data phase of reference frames at the data bit rate.
+ */
+#ifndef GTTCAN_FD_H
+#define GTTCAN_FD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gttcan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Send a CAN FD frame (ID field, payload, number of payload bytes, context pointer).
+ */
+typedef void (*transmit_fd_callback_fp)(uint32_t, const uint8_t*, uint8_t, void*);
+
+/**
+ * @brief Read the payload of a data ID into a buffer of #GTTCAN_FD_MAX_PAYLOAD bytes.
+ *
+ * Returns the number of payload bytes.
+ */
+typedef uint8_t (*read_buffer_fp)(uint16_t, uint8_t*, void*);
+
+/**
+ * @brief Write a received payload (data ID, payload, number of payload bytes, context pointer).
+ */
+typedef void (*write_buffer_fp)(uint16_t, const uint8_t*, uint8_t, void*);
+
+/**
+ * @brief A CAN FD interface.
+ */
+typedef struct gttcan_fd_s {
+    transmit_fd_callback_fp transmit;
+    read_buffer_fp read_buffer;
+    write_buffer_fp write_buffer;
+    uint32_t data_bit_time; // duration of a data-phase bit in NTU, 0 to send without bit rate switch
+} gttcan_fd_t;
+
+/**
+ * @brief Initialise a CAN FD interface.
+ *
+ * @param fd The interface.
+ * @param transmit Sends a CAN FD frame.
+ * @param read_buffer Reads the payload of a transmitted data ID.
+ * @param write_buffer Writes the payload of a received data ID.
+ * @param data_bit_time The duration of a data-phase bit in NTU
+ *                      (e.g. 2 at 5 Mbit/s), or 0 to send frames
+ *                      without bit rate switch.
+ */
+void GTTCAN_fd_init(gttcan_fd_t *fd, transmit_fd_callback_fp transmit, read_buffer_fp read_buffer,
+                    write_buffer_fp write_buffer, uint32_t data_bit_time);
+
+/**
+ * @brief Write a 64-bit value as 8 bytes, most significant byte first.
+ *
+ * This is the payload layout of reference frames.
+ */
+static inline void GTTCAN_fd_write_u64(uint8_t * const bytes, const uint64_t value)
+{
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        bytes[i] = (uint8_t)(value >> (56U - (8U * i)));
+    }
+}
+
+/**
+ * @brief Read a 64-bit value from up to 8 bytes, most significant byte first.
+ *
+ * Missing bytes of shorter payloads read as 0.
+ */
+static inline uint64_t GTTCAN_fd_read_u64(const uint8_t * const bytes, const uint8_t length)
+{
+    uint64_t value = 0U;
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        value = (value << 8U) | ((i < (uint32_t)length) ? (uint64_t)bytes[i] : 0U);
+    }
+    return value;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GTTCAN_FD_H
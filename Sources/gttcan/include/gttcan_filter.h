@@ -0,0 +1,140 @@
+/**
+ * @file gttcan_filter.h
+ * @brief CAN acceptance filters derived from the global schedule.
+ *
+ * Without filters, every node runs GTTCAN_process_frame() for every
+ * frame on the bus, including the data IDs it never consumes.  The
+ * schedule tells which slots carry the data IDs a node needs, so
+ * GTTCAN_build_filters() derives ID/mask acceptance filters from the
+ * loaded schedule that fit into the filter banks of the CAN controller
+ * (or a SocketCAN CAN_RAW_FILTER list, see gttcan_socketcan.h).
+ *
+ * The filters always accept the reference frames.  Every received
+ * frame is also a sample of the clock error, so the filters accept
+ * enough frames per round, from as many nodes as possible, for the
+ * fault-tolerant average (see GTTCAN_set_fta()) to still discard the
+ * configured number of outliers at each end.  If the budget is
+ * smaller than the number of frames to accept, neighbouring filters
+ * are merged, each time choosing the merge that lets the fewest
+ * unneeded frames of a round through.
+ *
+ * The filters have to be rebuilt after the schedule, the FTA or the
+ * sporadic queue changes.  The statistics (gttcan_stats.h) count the
+ * slots skipped by the filters as missed frames.
+ */
+#ifndef GTTCAN_FILTER_H
+#define GTTCAN_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gttcan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief The bits of an extended (29-bit) CAN ID.
+ *
+ * GTTCAN IDs only use the lower 28 bits (see GTTCAN_CAN_ID()), so the
+ * filters also compare bit 28 and reject other extended frames.
+ */
+#define GTTCAN_FILTER_ID_MASK 0x1FFFFFFFU
+
+/**
+ * @brief Maximum number of frames per round a node can need.
+ *
+ * The schedule slots, plus one for each consumed data ID that is only
+ * sent in arbitration slots.  Sizes gttcan_filter_workspace_t.
+ */
+#ifndef GTTCAN_FILTER_MAX_IDS
+#define GTTCAN_FILTER_MAX_IDS (GTTCAN_MAX_SLOTS + 32U)
+#endif
+
+#if GTTCAN_FILTER_MAX_IDS < GTTCAN_MAX_SLOTS
+#error "GTTCAN_FILTER_MAX_IDS must be at least GTTCAN_MAX_SLOTS"
+#endif
+
+/**
+ * @brief An acceptance filter.
+ *
+ * A frame is accepted if `(id_field & mask) == id` for any filter of
+ * a list, as in the filter banks of most CAN controllers in mask mode.
+ */
+typedef struct gttcan_filter_s {
+    uint32_t id;   // the ID bits to match, within the mask
+    uint32_t mask; // the ID bits compared, within #GTTCAN_FILTER_ID_MASK
+} gttcan_filter_t;
+
+/**
+ * @brief Scratch memory of GTTCAN_build_filters().
+ *
+ * About 7.5 KB with the default #GTTCAN_FILTER_MAX_IDS, more than the
+ * stack of many microcontrollers, so the caller provides it, e.g. as
+ * a static variable.  It is only used during the call, so instances
+ * that do not build their filters concurrently can share one.
+ */
+typedef struct gttcan_filter_workspace_s {
+    gttcan_filter_t filters[GTTCAN_FILTER_MAX_IDS]; // one exact filter per frame to accept, merged in place
+    uint16_t costs[GTTCAN_FILTER_MAX_IDS];          // frames of a round each filter lets through unneeded
+    int32_t merge_costs[GTTCAN_FILTER_MAX_IDS];     // change in unneeded frames when merging a filter with the next
+} gttcan_filter_workspace_t;
+
+/**
+ * @brief Derive acceptance filters for a node from its loaded schedule.
+ *
+ * The filters accept the reference frames, the slots that carry one
+ * of the given data IDs, and further slots of other nodes until a
+ * round has at least `samples` received frames, and at least one more
+ * than twice the outliers discarded by the FTA.  These are taken from
+ * nodes not yet heard from first.  A data ID without a slot of its own
+ * can only be sent in an arbitration slot, so it is accepted in every
+ * arbitration slot.  If more filters are needed than `max_filters`,
+ * adjacent filters are merged greedily, choosing the merge that lets
+ * the fewest other frames of a round through (a frame in an
+ * arbitration slot counts once).
+ *
+ * The slots of the node itself and the free slots are ignored, so
+ * the filters assume that the controller does not receive its own
+ * frames.
+ *
+ * @param gttcan The GTTCAN instance, with its schedule loaded and its FTA configured.
+ * @param dataIDs The data IDs the node consumes (duplicates are ignored).
+ * @param count The number of data IDs.
+ * @param samples The minimum number of frames per round to accept for the clock synchronisation.
+ * @param filters Receives the filters.
+ * @param max_filters The number of filter banks available.
+ * @param workspace Scratch memory for the filters before merging.
+ * @return The number of filters written, or 0 if no schedule is loaded,
+ *         the schedule is longer than #GTTCAN_MAX_SLOTS (possible
+ *         without transmit tables), `max_filters` is 0 or a round has
+ *         more than #GTTCAN_FILTER_MAX_IDS frames to accept.
+ */
+uint32_t GTTCAN_build_filters(const gttcan_t *gttcan, const uint16_t *dataIDs, uint32_t count, uint32_t samples,
+                              gttcan_filter_t *filters, uint32_t max_filters, gttcan_filter_workspace_t *workspace);
+
+/**
+ * @brief Check a frame against a list of acceptance filters.
+ *
+ * For controllers and tests without filter banks.
+ *
+ * @param filters The filters.
+ * @param count The number of filters.
+ * @param can_frame_id_field The ID field of the frame.
+ * @return true if any filter accepts the frame.
+ */
+static inline bool GTTCAN_filters_accept(const gttcan_filter_t *filters, uint32_t count, uint32_t can_frame_id_field)
+{
+    bool accepted = false;
+    for (uint32_t i = 0U; (i < count) && !accepted; i++)
+    {
+        accepted = ((can_frame_id_field & filters[i].mask) == filters[i].id);
+    }
+    return accepted;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GTTCAN_FILTER_H
@@ -0,0 +1,104 @@
+/**
+ * @file gttcan_rx_ring.h
+ * @brief Lock-free single-producer/single-consumer receive ring.
+ *
+ * When a ring is attached with GTTCAN_set_rx_ring(), received frames
+ * still update the clock synchronisation (error accumulation, FTA and
+ * timer re-arm) in GTTCAN_process_frame(), but their whiteboard values
+ * are pushed onto the ring instead of being passed to `write_value`.
+ * GTTCAN_drain_rx_ring() later delivers them from thread or main-loop
+ * context, so a slow whiteboard does not stretch the receive interrupt.
+ *
+ * The receive interrupt (or thread) is the only producer and the caller
+ * of GTTCAN_drain_rx_ring() the only consumer.  Synchronisation uses C11
+ * atomics, so the ring works between an ISR and the main loop on bare
+ * metal as well as between threads on a multi-core host.
+ */
+#ifndef GTTCAN_RX_RING_H
+#define GTTCAN_RX_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gttcan.h"
+#include "gttcan_atomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of entries in a receive ring (a power of two).
+ */
+#ifndef GTTCAN_RX_RING_SIZE
+#define GTTCAN_RX_RING_SIZE 32U
+#endif
+
+#if (GTTCAN_RX_RING_SIZE == 0) || ((GTTCAN_RX_RING_SIZE & (GTTCAN_RX_RING_SIZE - 1)) != 0)
+#error "GTTCAN_RX_RING_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Alignment of the producer and consumer indices.
+ *
+ * Keeps the indices on separate cache lines on multi-core hosts;
+ * set to 4 on MCUs to save RAM, which leaves out the padding.
+ */
+#ifndef GTTCAN_RX_RING_ALIGNMENT
+#define GTTCAN_RX_RING_ALIGNMENT 64U
+#endif
+
+#if GTTCAN_RX_RING_ALIGNMENT < 4
+#error "GTTCAN_RX_RING_ALIGNMENT must be at least 4"
+#endif
+
+/**
+ * @brief A receive ring.
+ *
+ * `id` is the ID field of the received frame, `data` the value to be
+ * written to the whiteboard (for reference frames, the network time
+ * including the transmission delay), and `timestamp` the local
+ * receive time passed to GTTCAN_process_frame().
+ */
+typedef struct gttcan_rx_ring_s {
+    GTTCAN_ATOMIC(uint32_t) head; // next entry to write, producer only
+#if GTTCAN_RX_RING_ALIGNMENT > 4
+    uint8_t head_padding[GTTCAN_RX_RING_ALIGNMENT - sizeof(uint32_t)];
+#endif
+    GTTCAN_ATOMIC(uint32_t) tail; // next entry to read, consumer only
+#if GTTCAN_RX_RING_ALIGNMENT > 4
+    uint8_t tail_padding[GTTCAN_RX_RING_ALIGNMENT - sizeof(uint32_t)];
+#endif
+    uint32_t dropped; // entries lost because the ring was full, producer only
+    gttcan_rx_frame_t frames[GTTCAN_RX_RING_SIZE];
+} gttcan_rx_ring_t;
+
+/**
+ * @brief Initialise an empty receive ring.
+ *
+ * @param ring The ring.
+ */
+void GTTCAN_rx_ring_init(gttcan_rx_ring_t *ring);
+
+/**
+ * @brief Append an entry to a receive ring (producer side).
+ *
+ * @param ring The ring.
+ * @param frame The entry to append.
+ * @return false if the ring was full and the entry was dropped.
+ */
+bool GTTCAN_rx_ring_push(gttcan_rx_ring_t *ring, const gttcan_rx_frame_t *frame);
+
+/**
+ * @brief Remove the oldest entry from a receive ring (consumer side).
+ *
+ * @param ring The ring.
+ * @param frame Receives the entry.
+ * @return false if the ring was empty.
+ */
+bool GTTCAN_rx_ring_pop(gttcan_rx_ring_t *ring, gttcan_rx_frame_t *frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GTTCAN_RX_RING_H
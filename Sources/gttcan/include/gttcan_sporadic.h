@@ -0,0 +1,155 @@
+/**
+ * @file gttcan_sporadic.h
+ * @brief Bounded priority queue for sporadic messages in arbitration slots.
+ *
+ * Sporadic data (alarms, configuration responses) does not need an
+ * exclusive slot of its own.  The application queues a message with
+ * GTTCAN_sporadic_push(), and once the queue is attached with
+ * GTTCAN_set_sporadic(), GTTCAN_transmit_next_frame() sends the most
+ * urgent queued message in the next arbitration slot of the global
+ * schedule.  The frame carries the message's data ID, so receivers
+ * deliver it to the whiteboard like any other frame.  Between nodes,
+ * CAN arbitration prefers the lower data ID, so data IDs of sporadic
+ * messages should be assigned in the order of their urgency.
+ *
+ * Each priority level has its own single-producer/single-consumer
+ * ring: the application is the only producer, and the context that
+ * calls GTTCAN_transmit_next_frame() and GTTCAN_transmit_result()
+ * (usually the timer and CAN interrupts, which must not preempt each
+ * other) the only consumer.  A message is only removed once the driver
+ * reports that it was sent, so a message that lost arbitration is
+ * retried in the next arbitration slot.
+ */
+#ifndef GTTCAN_SPORADIC_H
+#define GTTCAN_SPORADIC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gttcan.h"
+#include "gttcan_atomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of priority levels, 0 being the most urgent.
+ */
+#ifndef GTTCAN_SPORADIC_PRIORITIES
+#define GTTCAN_SPORADIC_PRIORITIES 4U
+#endif
+
+/**
+ * @brief Number of messages queued per priority level (a power of two).
+ */
+#ifndef GTTCAN_SPORADIC_QUEUE_SIZE
+#define GTTCAN_SPORADIC_QUEUE_SIZE 8U
+#endif
+
+#if (GTTCAN_SPORADIC_QUEUE_SIZE == 0) || ((GTTCAN_SPORADIC_QUEUE_SIZE & (GTTCAN_SPORADIC_QUEUE_SIZE - 1)) != 0)
+#error "GTTCAN_SPORADIC_QUEUE_SIZE must be a power of two"
+#endif
+
+#if (GTTCAN_SPORADIC_PRIORITIES == 0) || (GTTCAN_SPORADIC_PRIORITIES > 255)
+#error "GTTCAN_SPORADIC_PRIORITIES must be between 1 and 255"
+#endif
+
+/**
+ * @brief A queued sporadic message.
+ */
+typedef struct gttcan_sporadic_message_s {
+    uint64_t data;      // the value sent in the frame
+    uint32_t timestamp; // time of GTTCAN_sporadic_push() on the application clock
+    uint16_t dataID;    // data ID sent in the frame
+} gttcan_sporadic_message_t;
+
+/**
+ * @brief The ring of one priority level.
+ */
+typedef struct gttcan_sporadic_queue_s {
+    GTTCAN_ATOMIC(uint32_t) head; // next entry to write, producer only
+    GTTCAN_ATOMIC(uint32_t) tail; // next entry to read, consumer only
+    uint32_t dropped; // messages not queued because the ring was full, producer only
+    gttcan_sporadic_message_t messages[GTTCAN_SPORADIC_QUEUE_SIZE];
+} gttcan_sporadic_queue_t;
+
+/**
+ * @brief Transmission statistics of one priority level, consumer only.
+ *
+ * The latency of a message is the time from GTTCAN_sporadic_push()
+ * to the GTTCAN_transmit_result() that reported it sent; the mean
+ * latency is `latency_sum / sent`.
+ */
+typedef struct gttcan_sporadic_stats_s {
+    uint64_t latency_sum; // sum of the latencies of the sent messages
+    uint32_t latency_max; // longest latency
+    uint32_t sent;        // messages sent
+    uint32_t lost;        // attempts that were not sent (lost arbitration), each retried
+} gttcan_sporadic_stats_t;
+
+/**
+ * @brief A sporadic message queue, see GTTCAN_sporadic_init().
+ */
+typedef struct gttcan_sporadic_s {
+    gttcan_sporadic_queue_t queues[GTTCAN_SPORADIC_PRIORITIES];
+    gttcan_sporadic_stats_t stats[GTTCAN_SPORADIC_PRIORITIES];
+    uint32_t pending_id;      // ID field of the frame in flight
+    uint8_t pending_priority; // priority level of the frame in flight
+    bool pending;             // a frame was sent and its outcome is not known yet
+} gttcan_sporadic_t;
+
+/**
+ * @brief Initialise an empty sporadic message queue.
+ *
+ * @param sporadic The queue.
+ */
+void GTTCAN_sporadic_init(gttcan_sporadic_t *sporadic);
+
+/**
+ * @brief Queue a sporadic message (producer side).
+ *
+ * Messages of the same priority are sent in the order they were queued.
+ *
+ * @param sporadic The queue.
+ * @param dataID The data ID (1 - GTTCAN_DATAID_MASK, not #GTTCAN_ARBITRATION_DATAID).
+ * @param data The value.
+ * @param priority The priority level, 0 (most urgent) to #GTTCAN_SPORADIC_PRIORITIES - 1.
+ * @param timestamp The current time on an application clock, which
+ *                  GTTCAN_transmit_result() has to be given as well.
+ * @return false if a parameter is invalid, or the ring of the priority
+ *         level was full and the message was dropped.
+ */
+bool GTTCAN_sporadic_push(gttcan_sporadic_t *sporadic, uint16_t dataID, uint64_t data, uint8_t priority, uint32_t timestamp);
+
+/**
+ * @brief Start sending the most urgent message in an arbitration slot (consumer side).
+ *
+ * The message stays queued until GTTCAN_sporadic_complete() reports
+ * that it was sent.  If the outcome of the previous attempt was never
+ * reported, it is counted as lost.
+ *
+ * @param sporadic The queue.
+ * @param index The global schedule index of the arbitration slot.
+ * @param can_frame_id_field Receives the ID field of the frame.
+ * @param data Receives the value.
+ * @return false if no message is queued.
+ */
+bool GTTCAN_sporadic_begin(gttcan_sporadic_t *sporadic, uint16_t index, uint32_t *can_frame_id_field, uint64_t *data);
+
+/**
+ * @brief Record the outcome of a transmission (consumer side).
+ *
+ * Does nothing unless `can_frame_id_field` is that of the message in flight.
+ *
+ * @param sporadic The queue.
+ * @param can_frame_id_field The ID field of the frame.
+ * @param sent Whether the frame was sent.
+ * @param timestamp The time of the outcome on the clock of GTTCAN_sporadic_push().
+ */
+void GTTCAN_sporadic_complete(gttcan_sporadic_t *sporadic, uint32_t can_frame_id_field, bool sent, uint32_t timestamp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GTTCAN_SPORADIC_H
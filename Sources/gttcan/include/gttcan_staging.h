@@ -0,0 +1,65 @@
+/**
+ * @file gttcan_staging.h
+ * @brief Double-buffered global schedule for switching at a round boundary.
+ *
+ * GTTCAN_load_schedule() deactivates a node until the next start of
+ * schedule, so changing the schedule that way takes the bus down for
+ * a round.  Instead, every node stages the next schedule in a
+ * gttcan_staging_t (attached with GTTCAN_set_staging()) with
+ * GTTCAN_stage_schedule(), which precomputes the local schedule and
+ * transmit tables off the interrupt path.  The time master then calls
+ * GTTCAN_request_schedule_switch(): its next start-of-schedule frame
+ * carries #GTTCAN_SCHEDULE_SWITCH_FLAG, and every node copies its
+ * staged tables into the instance while processing that frame (or
+ * references the shared node schedule staged with
+ * GTTCAN_stage_node_schedule()).  The activation, clock servo and FTA
+ * state are kept, so the first round of the new schedule is sent
+ * without a gap.
+ *
+ * The buffer is handed over through `state`: the application owns it
+ * while it is empty and fills it, the protocol context owns it once it
+ * is staged until the switch has been committed.
+ */
+#ifndef GTTCAN_STAGING_H
+#define GTTCAN_STAGING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gttcan.h"
+#include "gttcan_atomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Values of gttcan_staging_t::state.
+ */
+#define GTTCAN_STAGING_EMPTY 0U  // no schedule staged, owned by the application
+#define GTTCAN_STAGING_STAGED 1U // a schedule waits for its switch, owned by the protocol
+
+/**
+ * @brief A staged global schedule with its precomputed local schedule.
+ */
+typedef struct gttcan_staging_s {
+    const gttcan_node_schedule_t *node_schedule; // the staged schedule: built, or shared (GTTCAN_stage_node_schedule())
+#if GTTCAN_EMBEDDED_SCHEDULE
+    gttcan_node_schedule_t built; // built by GTTCAN_stage_schedule(), copied into the instance at the switch
+#endif
+    GTTCAN_ATOMIC(uint32_t) state;    // GTTCAN_STAGING_EMPTY or GTTCAN_STAGING_STAGED
+    GTTCAN_ATOMIC(uint32_t) announce; // non-zero: set the switch flag in the next start-of-schedule frame
+    uint32_t switches;                // schedules switched to, protocol context only
+} gttcan_staging_t;
+
+/**
+ * @brief Initialise an empty staging buffer.
+ *
+ * @param staging The buffer.
+ */
+void GTTCAN_staging_init(gttcan_staging_t *staging);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GTTCAN_STAGING_H
@@ -0,0 +1,283 @@
+/**
+ * @file gttcan_stats.h
+ * @brief Opt-in runtime statistics for timing and schedule health.
+ *
+ * When a statistics block is attached with GTTCAN_set_stats(), the
+ * receive and transmit paths count frames, out-of-sequence schedule
+ * indices and invalid frames, and record the distribution of the
+ * per-frame clock error, the FTA results and the timer re-arm
+ * corrections.  Each update costs a few loads and stores (the
+ * recording functions below are inlined into gttcan.c); without a
+ * block attached, the cost is one pointer test.
+ *
+ * The block has a single writer, the context that calls
+ * GTTCAN_process_frame() and GTTCAN_transmit_next_frame().  Every
+ * update is bracketed by a sequence counter, so GTTCAN_stats_snapshot()
+ * can take a consistent copy from another thread or core.
+ */
+#ifndef GTTCAN_STATS_H
+#define GTTCAN_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gttcan.h"
+#include "gttcan_atomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of bins of the error histogram.
+ *
+ * Bin 0 counts errors of 0 NTU, bin n errors with an absolute value
+ * from 2^(n-1) to 2^n - 1 NTU; the last bin also counts all larger errors.
+ */
+#ifndef GTTCAN_STATS_HISTOGRAM_BINS
+#define GTTCAN_STATS_HISTOGRAM_BINS 16U
+#endif
+
+/**
+ * @brief Number of attempts of GTTCAN_stats_snapshot() before it gives up.
+ */
+#ifndef GTTCAN_STATS_SNAPSHOT_RETRIES
+#define GTTCAN_STATS_SNAPSHOT_RETRIES 16U
+#endif
+
+/**
+ * @brief A statistics block, see GTTCAN_stats_init().
+ *
+ * Minimum and maximum fields are INT32_MAX and INT32_MIN until the
+ * first sample.
+ */
+typedef struct gttcan_stats_s {
+    GTTCAN_ATOMIC(uint32_t) sequence; // odd while an update is in progress
+    GTTCAN_ATOMIC(uint32_t) frames_received;    // valid received frames
+    GTTCAN_ATOMIC(uint32_t) frames_transmitted; // frames passed to transmit_callback
+    GTTCAN_ATOMIC(uint32_t) reference_frames;   // received reference frames
+    GTTCAN_ATOMIC(uint32_t) invalid_frames;     // received frames with an invalid index or data ID
+    GTTCAN_ATOMIC(uint32_t) out_of_sequence;    // frames whose index does not follow the previous frame's (free slots count too)
+    GTTCAN_ATOMIC(int32_t) error_min;           // smallest per-frame error in NTU (only after the first transmission)
+    GTTCAN_ATOMIC(int32_t) error_max;           // largest per-frame error in NTU
+    GTTCAN_ATOMIC(uint32_t) error_histogram[GTTCAN_STATS_HISTOGRAM_BINS]; // per-frame errors by magnitude
+    GTTCAN_ATOMIC(uint32_t) fta_results;        // number of FTA results over at least one sample
+    GTTCAN_ATOMIC(int32_t) fta_last;            // last FTA result in NTU
+    GTTCAN_ATOMIC(int32_t) fta_min;
+    GTTCAN_ATOMIC(int32_t) fta_max;
+    GTTCAN_ATOMIC(uint32_t) rearms;             // timer re-arms on received frames
+    GTTCAN_ATOMIC(int32_t) rearm_delta_last;    // last re-arm delay minus the nominal delay in NTU
+    GTTCAN_ATOMIC(int32_t) rearm_delta_min;
+    GTTCAN_ATOMIC(int32_t) rearm_delta_max;
+    uint16_t previous_index; // index of the previous frame, writer only
+    bool previous_valid;     // whether previous_index is set, writer only
+} gttcan_stats_t;
+
+/**
+ * @brief A consistent copy of a statistics block, see GTTCAN_stats_snapshot().
+ */
+typedef struct gttcan_stats_snapshot_s {
+    uint32_t frames_received;
+    uint32_t frames_transmitted;
+    uint32_t reference_frames;
+    uint32_t invalid_frames;
+    uint32_t out_of_sequence;
+    int32_t error_min;
+    int32_t error_max;
+    uint32_t error_histogram[GTTCAN_STATS_HISTOGRAM_BINS];
+    uint32_t fta_results;
+    int32_t fta_last;
+    int32_t fta_min;
+    int32_t fta_max;
+    uint32_t rearms;
+    int32_t rearm_delta_last;
+    int32_t rearm_delta_min;
+    int32_t rearm_delta_max;
+} gttcan_stats_snapshot_t;
+
+/**
+ * @brief Reset a statistics block.
+ *
+ * Must not be called while the block is attached to a running instance.
+ *
+ * @param stats The statistics block.
+ */
+void GTTCAN_stats_init(gttcan_stats_t *stats);
+
+/**
+ * @brief Take a consistent copy of a statistics block.
+ *
+ * May be called from any thread or core, concurrently with the writer.
+ * Fails only if an update was in progress in each of
+ * #GTTCAN_STATS_SNAPSHOT_RETRIES attempts, e.g. when called from an
+ * interrupt that preempted the writer.
+ *
+ * @param stats The statistics block.
+ * @param snapshot Receives the copy.
+ * @return false if no consistent copy could be taken.
+ */
+bool GTTCAN_stats_snapshot(const gttcan_stats_t *stats, gttcan_stats_snapshot_t *snapshot);
+
+/**
+ * @brief Return the histogram bin of a per-frame error.
+ *
+ * @param error The error in NTU.
+ * @return The bin, 0 to #GTTCAN_STATS_HISTOGRAM_BINS - 1.
+ */
+static inline uint32_t GTTCAN_stats_histogram_bin(int32_t error)
+{
+    const uint32_t magnitude = (error < 0) ? (0U - (uint32_t)error) : (uint32_t)error;
+    uint32_t bin = 0U;
+    if (magnitude != 0U)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        bin = 32U - (uint32_t)__builtin_clz(magnitude);
+#else
+        for (uint32_t bits = magnitude; bits != 0U; bits >>= 1U)
+        {
+            bin++;
+        }
+#endif
+    }
+    return (bin < (uint32_t)GTTCAN_STATS_HISTOGRAM_BINS) ? bin : ((uint32_t)GTTCAN_STATS_HISTOGRAM_BINS - 1U);
+}
+
+/**
+ * @brief Mark the start of an update (writer only).
+ */
+static inline void GTTCAN_stats_begin(gttcan_stats_t *stats)
+{
+    GTTCAN_ATOMIC_STORE(stats->sequence, GTTCAN_ATOMIC_LOAD(stats->sequence, relaxed) + 1U, relaxed);
+    // Order the odd sequence before the updated fields.
+    GTTCAN_ATOMIC_FENCE(release);
+}
+
+/**
+ * @brief Mark the end of an update (writer only).
+ */
+static inline void GTTCAN_stats_end(gttcan_stats_t *stats)
+{
+    GTTCAN_ATOMIC_STORE(stats->sequence, GTTCAN_ATOMIC_LOAD(stats->sequence, relaxed) + 1U, release);
+}
+
+/**
+ * @brief Increment a counter (writer only, between begin and end).
+ */
+#define GTTCAN_STATS_INCREMENT(counter) \
+    GTTCAN_ATOMIC_STORE((counter), GTTCAN_ATOMIC_LOAD((counter), relaxed) + 1U, relaxed)
+
+/**
+ * @brief Update a minimum and a maximum (writer only, between begin and end).
+ */
+#define GTTCAN_STATS_RANGE(minimum, maximum, value) \
+    do { \
+        if ((value) < (int32_t)GTTCAN_ATOMIC_LOAD((minimum), relaxed)) { GTTCAN_ATOMIC_STORE((minimum), (value), relaxed); } \
+        if ((value) > (int32_t)GTTCAN_ATOMIC_LOAD((maximum), relaxed)) { GTTCAN_ATOMIC_STORE((maximum), (value), relaxed); } \
+    } while (0)
+
+/**
+ * @brief Record the schedule index of a received or transmitted frame (writer only, between begin and end).
+ */
+static inline void GTTCAN_stats_sequence(gttcan_stats_t *stats, uint16_t index, uint16_t globalScheduleLength)
+{
+    if (stats->previous_valid)
+    {
+        uint32_t next = (uint32_t)stats->previous_index + 1U;
+        next = (next >= (uint32_t)globalScheduleLength) ? 0U : next;
+        if ((uint32_t)index != next)
+        {
+            GTTCAN_STATS_INCREMENT(stats->out_of_sequence);
+        }
+    }
+    stats->previous_index = index;
+    stats->previous_valid = true;
+}
+
+/**
+ * @brief Record a valid received frame and its clock error.
+ *
+ * @param stats The statistics block.
+ * @param index The global schedule index of the frame.
+ * @param globalScheduleLength The length of the global schedule.
+ * @param reference Whether the frame is a reference frame.
+ * @param measured Whether `error` is valid (the local node has transmitted).
+ * @param error The clock error of the frame in NTU.
+ */
+static inline void GTTCAN_stats_record_frame(gttcan_stats_t *stats, uint16_t index, uint16_t globalScheduleLength, bool reference, bool measured, int32_t error)
+{
+    GTTCAN_stats_begin(stats);
+    GTTCAN_STATS_INCREMENT(stats->frames_received);
+    if (reference)
+    {
+        GTTCAN_STATS_INCREMENT(stats->reference_frames);
+    }
+    GTTCAN_stats_sequence(stats, index, globalScheduleLength);
+    if (measured)
+    {
+        GTTCAN_STATS_RANGE(stats->error_min, stats->error_max, error);
+        GTTCAN_STATS_INCREMENT(stats->error_histogram[GTTCAN_stats_histogram_bin(error)]);
+    }
+    GTTCAN_stats_end(stats);
+}
+
+/**
+ * @brief Record a received frame that was rejected.
+ *
+ * @param stats The statistics block.
+ */
+static inline void GTTCAN_stats_record_invalid(gttcan_stats_t *stats)
+{
+    GTTCAN_stats_begin(stats);
+    GTTCAN_STATS_INCREMENT(stats->invalid_frames);
+    GTTCAN_stats_end(stats);
+}
+
+/**
+ * @brief Record a transmitted frame.
+ *
+ * @param stats The statistics block.
+ * @param index The global schedule index of the frame.
+ * @param globalScheduleLength The length of the global schedule.
+ */
+static inline void GTTCAN_stats_record_transmit(gttcan_stats_t *stats, uint16_t index, uint16_t globalScheduleLength)
+{
+    GTTCAN_stats_begin(stats);
+    GTTCAN_STATS_INCREMENT(stats->frames_transmitted);
+    GTTCAN_stats_sequence(stats, index, globalScheduleLength);
+    GTTCAN_stats_end(stats);
+}
+
+/**
+ * @brief Record an FTA result.
+ *
+ * @param stats The statistics block.
+ * @param result The FTA result in NTU.
+ */
+static inline void GTTCAN_stats_record_fta(gttcan_stats_t *stats, int32_t result)
+{
+    GTTCAN_stats_begin(stats);
+    GTTCAN_STATS_INCREMENT(stats->fta_results);
+    GTTCAN_ATOMIC_STORE(stats->fta_last, result, relaxed);
+    GTTCAN_STATS_RANGE(stats->fta_min, stats->fta_max, result);
+    GTTCAN_stats_end(stats);
+}
+
+/**
+ * @brief Record a timer re-arm.
+ *
+ * @param stats The statistics block.
+ * @param delta The re-arm delay minus the nominal delay for the same number of slots in NTU.
+ */
+static inline void GTTCAN_stats_record_rearm(gttcan_stats_t *stats, int32_t delta)
+{
+    GTTCAN_stats_begin(stats);
+    GTTCAN_STATS_INCREMENT(stats->rearms);
+    GTTCAN_ATOMIC_STORE(stats->rearm_delta_last, delta, relaxed);
+    GTTCAN_STATS_RANGE(stats->rearm_delta_min, stats->rearm_delta_max, delta);
+    GTTCAN_stats_end(stats);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GTTCAN_STATS_H
@@ -0,0 +1,151 @@
+/**
+ * @file gttcan_trace.h
+ * @brief Binary event trace ring.
+ *
+ * With #GTTCAN_TRACE enabled at compile time and a ring attached with
+ * GTTCAN_set_trace(), GTTCAN_process_frame(), GTTCAN_process_frames()
+ * and GTTCAN_transmit_next_frame() append one fixed-size record per
+ * event: what the node saw (`current_time`, index and data ID) and
+ * what it decided (clock error, FTA result and timer delay).  The ring
+ * is a flight recorder: once full, the oldest records are overwritten.
+ * Appending is a copy of 24 bytes and an index increment.
+ *
+ * The ring has a single writer, the context that processes frames.
+ * GTTCAN_trace_serialize() turns it into a portable blob (for example
+ * to dump it after a sync failure); it must be called from the same
+ * context or while the node is stopped.  The `gttcan-trace` tool
+ * decodes such a dump into a per-round timeline and a jitter report.
+ */
+#ifndef GTTCAN_TRACE_H
+#define GTTCAN_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gttcan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of records in a trace ring (a power of two).
+ */
+#ifndef GTTCAN_TRACE_SIZE
+#define GTTCAN_TRACE_SIZE 256U
+#endif
+
+#if (GTTCAN_TRACE_SIZE == 0) || ((GTTCAN_TRACE_SIZE & (GTTCAN_TRACE_SIZE - 1)) != 0)
+#error "GTTCAN_TRACE_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Event types of trace records.
+ */
+#define GTTCAN_TRACE_TRANSMIT 1U  // GTTCAN_transmit_next_frame() sent a frame
+#define GTTCAN_TRACE_RECEIVE 2U   // a data frame was received
+#define GTTCAN_TRACE_REFERENCE 3U // a reference frame was received
+#define GTTCAN_TRACE_INVALID 4U   // a received frame was rejected
+
+/**
+ * @brief Flags of trace records.
+ */
+#define GTTCAN_TRACE_FLAG_REARM 0x01U    // the timer was set to `timer`
+#define GTTCAN_TRACE_FLAG_MEASURED 0x02U // `error` is valid (the node has transmitted)
+#define GTTCAN_TRACE_FLAG_START 0x04U    // start-of-schedule reference frame
+#define GTTCAN_TRACE_FLAG_ACTIVE 0x08U   // the node was active after the event
+
+/**
+ * @brief Binary trace format, see GTTCAN_trace_serialize().
+ *
+ * All multi-byte fields are little-endian.
+ * ```
+ * offset  size  field
+ *      0     4  magic "GTTR"
+ *      4     1  version (1)
+ *      5     1  record size (24)
+ *      6     2  reserved (0)
+ *      8     4  number of records n
+ *     12     4  number of records ever written (n or more if records were overwritten)
+ *     16   24n  records, oldest first, fields in the order of gttcan_trace_record_t
+ * ```
+ */
+#define GTTCAN_TRACE_MAGIC_0 0x47U // 'G'
+#define GTTCAN_TRACE_MAGIC_1 0x54U // 'T'
+#define GTTCAN_TRACE_MAGIC_2 0x54U // 'T'
+#define GTTCAN_TRACE_MAGIC_3 0x52U // 'R'
+#define GTTCAN_TRACE_VERSION 1U
+#define GTTCAN_TRACE_HEADER_SIZE 16U
+#define GTTCAN_TRACE_RECORD_SIZE 24U
+#define GTTCAN_TRACE_BLOB_SIZE(records) (GTTCAN_TRACE_HEADER_SIZE + ((uint32_t)(records) * GTTCAN_TRACE_RECORD_SIZE))
+
+/**
+ * @brief A trace record.
+ */
+typedef struct gttcan_trace_record_s {
+    uint32_t current_time; // local time of a received frame, 0 for transmissions (the time base restarts)
+    int32_t error;         // clock error of a received frame in NTU (positive if early)
+    int32_t fta;           // error_offset after the event (the last FTA result)
+    uint32_t timer;        // timer delay in NTU if GTTCAN_TRACE_FLAG_REARM is set
+    uint16_t index;        // global schedule index
+    uint16_t slot_id;      // data ID
+    uint8_t type;          // GTTCAN_TRACE_TRANSMIT etc.
+    uint8_t flags;         // GTTCAN_TRACE_FLAG_REARM etc.
+    uint16_t reserved;
+} gttcan_trace_record_t;
+
+/**
+ * @brief A trace ring.
+ */
+typedef struct gttcan_trace_s {
+    uint32_t written; // number of records ever appended, writer only
+    gttcan_trace_record_t records[GTTCAN_TRACE_SIZE];
+} gttcan_trace_t;
+
+/**
+ * @brief Initialise an empty trace ring.
+ *
+ * @param trace The trace ring.
+ */
+void GTTCAN_trace_init(gttcan_trace_t *trace);
+
+/**
+ * @brief Append a record to a trace ring, overwriting the oldest one if it is full.
+ *
+ * @param trace The trace ring.
+ * @param record The record.
+ */
+static inline void GTTCAN_trace_append(gttcan_trace_t *trace, const gttcan_trace_record_t *record)
+{
+    trace->records[trace->written & ((uint32_t)GTTCAN_TRACE_SIZE - 1U)] = *record;
+    trace->written++;
+}
+
+/**
+ * @brief Write the records of a trace ring into a binary blob, oldest first.
+ *
+ * @param trace The trace ring.
+ * @param blob The buffer receiving the blob.
+ * @param size The size of `blob` in bytes (at most GTTCAN_TRACE_BLOB_SIZE(#GTTCAN_TRACE_SIZE) are needed).
+ * @return The number of bytes written, or 0 if `blob` is too small.
+ */
+uint32_t GTTCAN_trace_serialize(const gttcan_trace_t *trace, uint8_t *blob, uint32_t size);
+
+/**
+ * @brief Read the records of a binary trace blob.
+ *
+ * @param blob The blob (see #GTTCAN_TRACE_MAGIC_0 for the format).
+ * @param size The size of the blob in bytes.
+ * @param records Receives the records, oldest first.
+ * @param capacity The number of entries of `records`.
+ * @param count Receives the number of records.
+ * @param written Receives the number of records ever written to the ring.
+ * @return false if the blob is invalid or has more than `capacity` records.
+ */
+bool GTTCAN_trace_deserialize(const uint8_t *blob, uint32_t size, gttcan_trace_record_t *records, uint32_t capacity,
+                              uint32_t *count, uint32_t *written);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GTTCAN_TRACE_H
@@ -0,0 +1,169 @@
+/**
+ * @file gttcan_whiteboard.h
+ * @brief Built-in seqlock whiteboard, indexed by data ID.
+ *
+ * An alternative to the `read_value`/`write_value` callbacks.  When a
+ * whiteboard is attached with GTTCAN_set_whiteboard(), transmitted
+ * values are read from it and received values are written to it
+ * directly (the accessors below are inlined into gttcan.c), so the
+ * receive and transmit paths make no indirect calls for the data.
+ *
+ * Every entry holds two copies of its value and a sequence counter
+ * that is incremented after each update.  An update writes the copy
+ * that readers are not using and then publishes it by incrementing the
+ * counter; a reader takes the copy selected by the counter and retries
+ * only if the counter changed meanwhile.  This gives torn-free 64-bit
+ * values without locks, both for readers on other cores and for an
+ * interrupt that preempts a writer on the same core (which never has
+ * to retry, so it cannot spin on a suspended writer).
+ *
+ * Each entry must have a single writer: either the GTTCAN receive path
+ * (or GTTCAN_drain_rx_ring()) for received data IDs, or the application
+ * for the data IDs the local node transmits.
+ */
+#ifndef GTTCAN_WHITEBOARD_H
+#define GTTCAN_WHITEBOARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gttcan.h"
+#include "gttcan_atomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of whiteboard entries (data IDs 0 to size - 1).
+ *
+ * Values for larger data IDs are not stored and read as 0.
+ */
+#ifndef GTTCAN_WHITEBOARD_SIZE
+#define GTTCAN_WHITEBOARD_SIZE 64U
+#endif
+
+/**
+ * @brief One copy of a whiteboard value.
+ *
+ * Stored as 32-bit halves, so that targets without lock-free 64-bit
+ * atomics can still update it from an interrupt.
+ */
+typedef struct gttcan_whiteboard_copy_s {
+    GTTCAN_ATOMIC(uint32_t) value_high;
+    GTTCAN_ATOMIC(uint32_t) value_low;
+    GTTCAN_ATOMIC(uint32_t) timestamp;
+} gttcan_whiteboard_copy_t;
+
+/**
+ * @brief A whiteboard entry: the sequence counter and two copies.
+ */
+typedef struct gttcan_whiteboard_entry_s {
+    GTTCAN_ATOMIC(uint32_t) sequence; // number of updates, the current copy is sequence & 1
+    gttcan_whiteboard_copy_t copies[2];
+} gttcan_whiteboard_entry_t;
+
+/**
+ * @brief The whiteboard.
+ */
+typedef struct gttcan_whiteboard_s {
+    gttcan_whiteboard_entry_t entries[GTTCAN_WHITEBOARD_SIZE];
+} gttcan_whiteboard_t;
+
+/**
+ * @brief A consistent snapshot of a whiteboard entry.
+ */
+typedef struct gttcan_whiteboard_value_s {
+    uint64_t value;      // the value
+    uint32_t timestamp;  // local time of the update (current_time for received values)
+    uint32_t generation; // number of updates, 0 if the entry was never written
+} gttcan_whiteboard_value_t;
+
+/**
+ * @brief Initialise an empty whiteboard (all values 0, generation 0).
+ *
+ * @param whiteboard The whiteboard.
+ */
+void GTTCAN_whiteboard_init(gttcan_whiteboard_t *whiteboard);
+
+/**
+ * @brief Update a whiteboard entry.
+ *
+ * Only one context may write a given entry.
+ *
+ * @param whiteboard The whiteboard.
+ * @param dataID The data ID.
+ * @param value The new value.
+ * @param timestamp The local time of the update.
+ * @return false if the data ID is outside the whiteboard.
+ */
+static inline bool GTTCAN_whiteboard_write(gttcan_whiteboard_t *whiteboard, uint16_t dataID, uint64_t value, uint32_t timestamp)
+{
+    if ((uint32_t)dataID >= (uint32_t)GTTCAN_WHITEBOARD_SIZE)
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    gttcan_whiteboard_entry_t * const entry = &whiteboard->entries[dataID];
+    const uint32_t sequence = GTTCAN_ATOMIC_LOAD(entry->sequence, relaxed);
+    gttcan_whiteboard_copy_t * const copy = &entry->copies[(sequence + 1U) & 1U];
+    // Order the previous publication before overwriting the copy it retired.
+    GTTCAN_ATOMIC_FENCE(release);
+    GTTCAN_ATOMIC_STORE(copy->value_high, (uint32_t)(value >> 32U), relaxed);
+    GTTCAN_ATOMIC_STORE(copy->value_low, (uint32_t)value, relaxed);
+    GTTCAN_ATOMIC_STORE(copy->timestamp, timestamp, relaxed);
+    GTTCAN_ATOMIC_STORE(entry->sequence, sequence + 1U, release);
+    return true;
+}
+
+/**
+ * @brief Read a consistent snapshot of a whiteboard entry.
+ *
+ * May be called from any context, concurrently with the writer.
+ *
+ * @param whiteboard The whiteboard.
+ * @param dataID The data ID.
+ * @param result Receives the value, timestamp and generation.
+ * @return false if the data ID is outside the whiteboard.
+ */
+static inline bool GTTCAN_whiteboard_read(const gttcan_whiteboard_t *whiteboard, uint16_t dataID, gttcan_whiteboard_value_t *result)
+{
+    if ((uint32_t)dataID >= (uint32_t)GTTCAN_WHITEBOARD_SIZE)
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    const gttcan_whiteboard_entry_t * const entry = &whiteboard->entries[dataID];
+    uint32_t sequence = GTTCAN_ATOMIC_LOAD(entry->sequence, acquire);
+    uint32_t check;
+    do
+    {
+        const gttcan_whiteboard_copy_t * const copy = &entry->copies[sequence & 1U];
+        const uint32_t high = GTTCAN_ATOMIC_LOAD(copy->value_high, relaxed);
+        const uint32_t low = GTTCAN_ATOMIC_LOAD(copy->value_low, relaxed);
+        result->timestamp = GTTCAN_ATOMIC_LOAD(copy->timestamp, relaxed);
+        result->value = ((uint64_t)high << 32U) | (uint64_t)low;
+        GTTCAN_ATOMIC_FENCE(acquire);
+        check = sequence;
+        sequence = GTTCAN_ATOMIC_LOAD(entry->sequence, acquire);
+    } while (sequence != check);
+    result->generation = sequence;
+    return true;
+}
+
+/**
+ * @brief Read the value of a whiteboard entry.
+ *
+ * @param whiteboard The whiteboard.
+ * @param dataID The data ID.
+ * @return The value, or 0 if the data ID is outside the whiteboard.
+ */
+static inline uint64_t GTTCAN_whiteboard_value(const gttcan_whiteboard_t *whiteboard, uint16_t dataID)
+{
+    gttcan_whiteboard_value_t result = { 0U, 0U, 0U };
+    (void)GTTCAN_whiteboard_read(whiteboard, dataID, &result);
+    return result.value;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GTTCAN_WHITEBOARD_H
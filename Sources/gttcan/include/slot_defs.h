@@ -3,9 +3,5 @@
 
 #define NETWORK_TIME_SLOT 0
 #define INTERRUPT_TIMER_VALUE_SLOT 1    // cppcheck-suppress misra-c2012-2.5
-#define NODE1_NUM_RECEIVED_FRAMES 2     // FIXME: this (and the following lines) need to be removed
-#define NODE8_NUM_RECEIVED_FRAMES 3
-#define NODE9_NUM_RECEIVED_FRAMES 4
-#define NODE10_NUM_RECEIVED_FRAMES 5
 
 #endif // SLOT_DEFS_H
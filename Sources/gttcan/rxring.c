@@ -0,0 +1,107 @@
+/**
+ * @file rxring.c
+ * @brief Lock-free single-producer/single-consumer receive ring.
+ */
+#include "gttcan.h"
+#include "gttcan_rx_ring.h"
+#include "gttcan_whiteboard.h"
+
+#define GTTCAN_RX_RING_MASK ((uint32_t)GTTCAN_RX_RING_SIZE - 1U)
+
+/**
+ * @brief Initialise an empty receive ring.
+ *
+ * @param ring The ring.
+ */
+void GTTCAN_rx_ring_init(gttcan_rx_ring_t *ring)
+{
+    GTTCAN_ATOMIC_INIT(ring->head, 0U);
+    GTTCAN_ATOMIC_INIT(ring->tail, 0U);
+    ring->dropped = 0U;
+}
+
+/**
+ * @brief Append an entry to a receive ring (producer side).
+ *
+ * @param ring The ring.
+ * @param frame The entry to append.
+ * @return false if the ring was full and the entry was dropped.
+ */
+bool GTTCAN_rx_ring_push(gttcan_rx_ring_t *ring, const gttcan_rx_frame_t *frame)
+{
+    const uint32_t head = GTTCAN_ATOMIC_LOAD(ring->head, relaxed);
+    if ((head - GTTCAN_ATOMIC_LOAD(ring->tail, acquire)) >= (uint32_t)GTTCAN_RX_RING_SIZE)
+    {
+        ring->dropped++;
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    ring->frames[head & GTTCAN_RX_RING_MASK] = *frame;
+    GTTCAN_ATOMIC_STORE(ring->head, head + 1U, release);
+    return true;
+}
+
+/**
+ * @brief Remove the oldest entry from a receive ring (consumer side).
+ *
+ * @param ring The ring.
+ * @param frame Receives the entry.
+ * @return false if the ring was empty.
+ */
+bool GTTCAN_rx_ring_pop(gttcan_rx_ring_t *ring, gttcan_rx_frame_t *frame)
+{
+    const uint32_t tail = GTTCAN_ATOMIC_LOAD(ring->tail, relaxed);
+    if (GTTCAN_ATOMIC_LOAD(ring->head, acquire) == tail)
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    *frame = ring->frames[tail & GTTCAN_RX_RING_MASK];
+    GTTCAN_ATOMIC_STORE(ring->tail, tail + 1U, release);
+    return true;
+}
+
+/**
+ * @brief Attach a receive ring for deferred whiteboard delivery.
+ *
+ * With a ring attached, GTTCAN_process_frame() and GTTCAN_process_frames()
+ * only perform the clock synchronisation and push the whiteboard values
+ * onto the ring; GTTCAN_drain_rx_ring() passes them to `write_value`.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param ring The ring (initialised with GTTCAN_rx_ring_init()),
+ *             or NULL to call `write_value` directly again.
+ */
+void GTTCAN_set_rx_ring(gttcan_t *gttcan, gttcan_rx_ring_t *ring)
+{
+    gttcan->rx_ring = ring;
+}
+
+/**
+ * @brief Deliver the values queued on the receive ring to the whiteboard.
+ *
+ * The values are written to the built-in whiteboard (with their receive
+ * time as timestamp) if one is attached, otherwise passed to `write_value`.
+ * Must only be called from one context at a time (the ring consumer),
+ * e.g. the main loop or a whiteboard thread.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @return The number of values delivered.
+ */
+uint32_t GTTCAN_drain_rx_ring(gttcan_t *gttcan)
+{
+    uint32_t delivered = 0U;
+    gttcan_rx_frame_t frame;
+    while ((gttcan->rx_ring != (gttcan_rx_ring_t *)0) && GTTCAN_rx_ring_pop(gttcan->rx_ring, &frame))
+    {
+        const uint16_t dataID = (uint16_t)GTTCAN_CAN_ID_DATAID(frame.id);
+        if (gttcan->whiteboard != (struct gttcan_whiteboard_s *)0)
+        {
+            (void)GTTCAN_whiteboard_write(gttcan->whiteboard, dataID, frame.data, frame.timestamp);
+        }
+        else
+        {
+            gttcan->write_value(dataID, frame.data, gttcan->context_pointer);
+        }
+        delivered++;
+    }
+    return delivered;
+}
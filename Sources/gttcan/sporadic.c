@@ -0,0 +1,138 @@
+/**
+ * @file sporadic.c
+ * @brief Bounded priority queue for sporadic messages in arbitration slots.
+ */
+#include "gttcan.h"
+#include "gttcan_sporadic.h"
+
+#define GTTCAN_SPORADIC_MASK ((uint32_t)GTTCAN_SPORADIC_QUEUE_SIZE - 1U)
+
+/**
+ * @brief Initialise an empty sporadic message queue.
+ *
+ * @param sporadic The queue.
+ */
+void GTTCAN_sporadic_init(gttcan_sporadic_t *sporadic)
+{
+    for (uint32_t priority = 0U; priority < (uint32_t)GTTCAN_SPORADIC_PRIORITIES; priority++)
+    {
+        gttcan_sporadic_queue_t * const queue = &sporadic->queues[priority];
+        gttcan_sporadic_stats_t * const stats = &sporadic->stats[priority];
+        GTTCAN_ATOMIC_INIT(queue->head, 0U);
+        GTTCAN_ATOMIC_INIT(queue->tail, 0U);
+        queue->dropped = 0U;
+        stats->latency_sum = 0U;
+        stats->latency_max = 0U;
+        stats->sent = 0U;
+        stats->lost = 0U;
+    }
+    sporadic->pending_id = 0U;
+    sporadic->pending_priority = 0U;
+    sporadic->pending = false;
+}
+
+/**
+ * @brief Queue a sporadic message (producer side).
+ *
+ * Messages of the same priority are sent in the order they were queued.
+ *
+ * @param sporadic The queue.
+ * @param dataID The data ID (1 - GTTCAN_DATAID_MASK, not #GTTCAN_ARBITRATION_DATAID).
+ * @param data The value.
+ * @param priority The priority level, 0 (most urgent) to #GTTCAN_SPORADIC_PRIORITIES - 1.
+ * @param timestamp The current time on an application clock, which
+ *                  GTTCAN_transmit_result() has to be given as well.
+ * @return false if a parameter is invalid, or the ring of the priority
+ *         level was full and the message was dropped.
+ */
+bool GTTCAN_sporadic_push(gttcan_sporadic_t *sporadic, uint16_t dataID, uint64_t data, uint8_t priority, uint32_t timestamp)
+{
+    if ((dataID == (uint16_t)NETWORK_TIME_SLOT) || !GTTCAN_DATAID_FITS(dataID) ||
+        (dataID == (uint16_t)GTTCAN_ARBITRATION_DATAID) || ((uint32_t)priority >= (uint32_t)GTTCAN_SPORADIC_PRIORITIES))
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    gttcan_sporadic_queue_t * const queue = &sporadic->queues[priority];
+    const uint32_t head = GTTCAN_ATOMIC_LOAD(queue->head, relaxed);
+    if ((head - GTTCAN_ATOMIC_LOAD(queue->tail, acquire)) >= (uint32_t)GTTCAN_SPORADIC_QUEUE_SIZE)
+    {
+        queue->dropped++;
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    gttcan_sporadic_message_t * const message = &queue->messages[head & GTTCAN_SPORADIC_MASK];
+    message->data = data;
+    message->timestamp = timestamp;
+    message->dataID = dataID;
+    GTTCAN_ATOMIC_STORE(queue->head, head + 1U, release);
+    return true;
+}
+
+/**
+ * @brief Start sending the most urgent message in an arbitration slot (consumer side).
+ *
+ * The message stays queued until GTTCAN_sporadic_complete() reports
+ * that it was sent.  If the outcome of the previous attempt was never
+ * reported, it is counted as lost.
+ *
+ * @param sporadic The queue.
+ * @param index The global schedule index of the arbitration slot.
+ * @param can_frame_id_field Receives the ID field of the frame.
+ * @param data Receives the value.
+ * @return false if no message is queued.
+ */
+bool GTTCAN_sporadic_begin(gttcan_sporadic_t *sporadic, uint16_t index, uint32_t *can_frame_id_field, uint64_t *data)
+{
+    if (sporadic->pending)
+    {
+        sporadic->stats[sporadic->pending_priority].lost++;
+        sporadic->pending = false;
+    }
+    for (uint32_t priority = 0U; priority < (uint32_t)GTTCAN_SPORADIC_PRIORITIES; priority++)
+    {
+        gttcan_sporadic_queue_t * const queue = &sporadic->queues[priority];
+        const uint32_t tail = GTTCAN_ATOMIC_LOAD(queue->tail, relaxed);
+        if (GTTCAN_ATOMIC_LOAD(queue->head, acquire) != tail)
+        {
+            const gttcan_sporadic_message_t * const message = &queue->messages[tail & GTTCAN_SPORADIC_MASK];
+            *can_frame_id_field = GTTCAN_CAN_ID(index, message->dataID);
+            *data = message->data;
+            sporadic->pending_id = *can_frame_id_field;
+            sporadic->pending_priority = (uint8_t)priority;
+            sporadic->pending = true;
+            break;
+        }
+    }
+    return sporadic->pending;
+}
+
+/**
+ * @brief Record the outcome of a transmission (consumer side).
+ *
+ * Does nothing unless `can_frame_id_field` is that of the message in flight.
+ *
+ * @param sporadic The queue.
+ * @param can_frame_id_field The ID field of the frame.
+ * @param sent Whether the frame was sent.
+ * @param timestamp The time of the outcome on the clock of GTTCAN_sporadic_push().
+ */
+void GTTCAN_sporadic_complete(gttcan_sporadic_t *sporadic, uint32_t can_frame_id_field, bool sent, uint32_t timestamp)
+{
+    if (!sporadic->pending || (can_frame_id_field != sporadic->pending_id))
+    {
+        return; // cppcheck-suppress misra-c2012-15.5
+    }
+    sporadic->pending = false;
+    gttcan_sporadic_stats_t * const stats = &sporadic->stats[sporadic->pending_priority];
+    if (!sent)
+    {
+        stats->lost++;
+        return; // cppcheck-suppress misra-c2012-15.5
+    }
+    gttcan_sporadic_queue_t * const queue = &sporadic->queues[sporadic->pending_priority];
+    const uint32_t tail = GTTCAN_ATOMIC_LOAD(queue->tail, relaxed);
+    const uint32_t latency = timestamp - queue->messages[tail & GTTCAN_SPORADIC_MASK].timestamp;
+    GTTCAN_ATOMIC_STORE(queue->tail, tail + 1U, release);
+    stats->latency_sum += latency;
+    stats->latency_max = (latency > stats->latency_max) ? latency : stats->latency_max;
+    stats->sent++;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file stats.c
+ * @brief Opt-in runtime statistics for timing and schedule health.
+ */
+#include "gttcan.h"
+#include "gttcan_stats.h"
+
+/**
+ * @brief Reset a statistics block.
+ *
+ * Must not be called while the block is attached to a running instance.
+ *
+ * @param stats The statistics block.
+ */
+void GTTCAN_stats_init(gttcan_stats_t *stats)
+{
+    GTTCAN_ATOMIC_INIT(stats->sequence, 0U);
+    GTTCAN_ATOMIC_INIT(stats->frames_received, 0U);
+    GTTCAN_ATOMIC_INIT(stats->frames_transmitted, 0U);
+    GTTCAN_ATOMIC_INIT(stats->reference_frames, 0U);
+    GTTCAN_ATOMIC_INIT(stats->invalid_frames, 0U);
+    GTTCAN_ATOMIC_INIT(stats->out_of_sequence, 0U);
+    GTTCAN_ATOMIC_INIT(stats->error_min, INT32_MAX);
+    GTTCAN_ATOMIC_INIT(stats->error_max, INT32_MIN);
+    for (uint32_t i = 0U; i < (uint32_t)GTTCAN_STATS_HISTOGRAM_BINS; i++)
+    {
+        GTTCAN_ATOMIC_INIT(stats->error_histogram[i], 0U);
+    }
+    GTTCAN_ATOMIC_INIT(stats->fta_results, 0U);
+    GTTCAN_ATOMIC_INIT(stats->fta_last, 0);
+    GTTCAN_ATOMIC_INIT(stats->fta_min, INT32_MAX);
+    GTTCAN_ATOMIC_INIT(stats->fta_max, INT32_MIN);
+    GTTCAN_ATOMIC_INIT(stats->rearms, 0U);
+    GTTCAN_ATOMIC_INIT(stats->rearm_delta_last, 0);
+    GTTCAN_ATOMIC_INIT(stats->rearm_delta_min, INT32_MAX);
+    GTTCAN_ATOMIC_INIT(stats->rearm_delta_max, INT32_MIN);
+    stats->previous_index = 0U;
+    stats->previous_valid = false;
+}
+
+/**
+ * @brief Take a consistent copy of a statistics block.
+ *
+ * May be called from any thread or core, concurrently with the writer.
+ * Fails only if an update was in progress in each of
+ * #GTTCAN_STATS_SNAPSHOT_RETRIES attempts, e.g. when called from an
+ * interrupt that preempted the writer.
+ *
+ * @param stats The statistics block.
+ * @param snapshot Receives the copy.
+ * @return false if no consistent copy could be taken.
+ */
+bool GTTCAN_stats_snapshot(const gttcan_stats_t *stats, gttcan_stats_snapshot_t *snapshot)
+{
+    for (uint32_t attempt = 0U; attempt < (uint32_t)GTTCAN_STATS_SNAPSHOT_RETRIES; attempt++)
+    {
+        const uint32_t sequence = GTTCAN_ATOMIC_LOAD(stats->sequence, acquire);
+        if ((sequence & 1U) != 0U)
+        {
+            continue; // an update is in progress
+        }
+        snapshot->frames_received = GTTCAN_ATOMIC_LOAD(stats->frames_received, relaxed);
+        snapshot->frames_transmitted = GTTCAN_ATOMIC_LOAD(stats->frames_transmitted, relaxed);
+        snapshot->reference_frames = GTTCAN_ATOMIC_LOAD(stats->reference_frames, relaxed);
+        snapshot->invalid_frames = GTTCAN_ATOMIC_LOAD(stats->invalid_frames, relaxed);
+        snapshot->out_of_sequence = GTTCAN_ATOMIC_LOAD(stats->out_of_sequence, relaxed);
+        snapshot->error_min = (int32_t)GTTCAN_ATOMIC_LOAD(stats->error_min, relaxed);
+        snapshot->error_max = (int32_t)GTTCAN_ATOMIC_LOAD(stats->error_max, relaxed);
+        for (uint32_t i = 0U; i < (uint32_t)GTTCAN_STATS_HISTOGRAM_BINS; i++)
+        {
+            snapshot->error_histogram[i] = GTTCAN_ATOMIC_LOAD(stats->error_histogram[i], relaxed);
+        }
+        snapshot->fta_results = GTTCAN_ATOMIC_LOAD(stats->fta_results, relaxed);
+        snapshot->fta_last = (int32_t)GTTCAN_ATOMIC_LOAD(stats->fta_last, relaxed);
+        snapshot->fta_min = (int32_t)GTTCAN_ATOMIC_LOAD(stats->fta_min, relaxed);
+        snapshot->fta_max = (int32_t)GTTCAN_ATOMIC_LOAD(stats->fta_max, relaxed);
+        snapshot->rearms = GTTCAN_ATOMIC_LOAD(stats->rearms, relaxed);
+        snapshot->rearm_delta_last = (int32_t)GTTCAN_ATOMIC_LOAD(stats->rearm_delta_last, relaxed);
+        snapshot->rearm_delta_min = (int32_t)GTTCAN_ATOMIC_LOAD(stats->rearm_delta_min, relaxed);
+        snapshot->rearm_delta_max = (int32_t)GTTCAN_ATOMIC_LOAD(stats->rearm_delta_max, relaxed);
+        // Order the copies before checking that no update started meanwhile.
+        GTTCAN_ATOMIC_FENCE(acquire);
+        if (GTTCAN_ATOMIC_LOAD(stats->sequence, relaxed) == sequence)
+        {
+            return true; // cppcheck-suppress misra-c2012-15.5
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Attach a statistics block.
+ *
+ * With a block attached, GTTCAN_process_frame(), GTTCAN_process_frames(),
+ * GTTCAN_transmit_next_frame() and GTTCAN_fta() update it.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param stats The statistics block (initialised with GTTCAN_stats_init()),
+ *              or NULL to stop collecting statistics.
+ */
+void GTTCAN_set_stats(gttcan_t *gttcan, gttcan_stats_t *stats)
+{
+    gttcan->stats = stats;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file trace.c
+ * @brief Binary event trace ring.
+ */
+#include "gttcan.h"
+#include "gttcan_trace.h"
+
+/**
+ * @brief Write a little-endian 16-bit value to a trace blob.
+ */
+static inline void GTTCAN_trace_write_le16(uint8_t * const bytes, const uint16_t value)
+{
+    bytes[0] = (uint8_t)(value & 0xFFU);
+    bytes[1] = (uint8_t)(value >> 8U);
+}
+
+/**
+ * @brief Write a little-endian 32-bit value to a trace blob.
+ */
+static inline void GTTCAN_trace_write_le32(uint8_t * const bytes, const uint32_t value)
+{
+    for (uint32_t i = 0U; i < 4U; i++)
+    {
+        bytes[i] = (uint8_t)(value >> (8U * i));
+    }
+}
+
+/**
+ * @brief Read a little-endian 16-bit value from a trace blob.
+ */
+static inline uint16_t GTTCAN_trace_read_le16(const uint8_t * const bytes)
+{
+    return (uint16_t)((uint16_t)bytes[0] | (uint16_t)((uint16_t)bytes[1] << 8U));
+}
+
+/**
+ * @brief Read a little-endian 32-bit value from a trace blob.
+ */
+static inline uint32_t GTTCAN_trace_read_le32(const uint8_t * const bytes)
+{
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8U) | ((uint32_t)bytes[2] << 16U) | ((uint32_t)bytes[3] << 24U);
+}
+
+/**
+ * @brief Initialise an empty trace ring.
+ *
+ * @param trace The trace ring.
+ */
+void GTTCAN_trace_init(gttcan_trace_t *trace)
+{
+    trace->written = 0U;
+}
+
+/**
+ * @brief Write the records of a trace ring into a binary blob, oldest first.
+ *
+ * @param trace The trace ring.
+ * @param blob The buffer receiving the blob.
+ * @param size The size of `blob` in bytes (at most GTTCAN_TRACE_BLOB_SIZE(#GTTCAN_TRACE_SIZE) are needed).
+ * @return The number of bytes written, or 0 if `blob` is too small.
+ */
+uint32_t GTTCAN_trace_serialize(const gttcan_trace_t *trace, uint8_t *blob, uint32_t size)
+{
+    const uint32_t written = trace->written;
+    const uint32_t count = (written < (uint32_t)GTTCAN_TRACE_SIZE) ? written : (uint32_t)GTTCAN_TRACE_SIZE;
+    const uint32_t blobSize = GTTCAN_TRACE_BLOB_SIZE(count);
+    if (size < blobSize)
+    {
+        return 0U; // cppcheck-suppress misra-c2012-15.5
+    }
+    blob[0] = GTTCAN_TRACE_MAGIC_0;
+    blob[1] = GTTCAN_TRACE_MAGIC_1;
+    blob[2] = GTTCAN_TRACE_MAGIC_2;
+    blob[3] = GTTCAN_TRACE_MAGIC_3;
+    blob[4] = GTTCAN_TRACE_VERSION;
+    blob[5] = GTTCAN_TRACE_RECORD_SIZE;
+    GTTCAN_trace_write_le16(&blob[6], 0U); // reserved
+    GTTCAN_trace_write_le32(&blob[8], count);
+    GTTCAN_trace_write_le32(&blob[12], written);
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        const gttcan_trace_record_t * const record = &trace->records[(written - count + i) & ((uint32_t)GTTCAN_TRACE_SIZE - 1U)];
+        uint8_t * const bytes = &blob[GTTCAN_TRACE_HEADER_SIZE + (i * GTTCAN_TRACE_RECORD_SIZE)];
+        GTTCAN_trace_write_le32(&bytes[0], record->current_time);
+        GTTCAN_trace_write_le32(&bytes[4], (uint32_t)record->error);
+        GTTCAN_trace_write_le32(&bytes[8], (uint32_t)record->fta);
+        GTTCAN_trace_write_le32(&bytes[12], record->timer);
+        GTTCAN_trace_write_le16(&bytes[16], record->index);
+        GTTCAN_trace_write_le16(&bytes[18], record->slot_id);
+        bytes[20] = record->type;
+        bytes[21] = record->flags;
+        GTTCAN_trace_write_le16(&bytes[22], 0U); // reserved
+    }
+    return blobSize;
+}
+
+/**
+ * @brief Read the records of a binary trace blob.
+ *
+ * @param blob The blob (see #GTTCAN_TRACE_MAGIC_0 for the format).
+ * @param size The size of the blob in bytes.
+ * @param records Receives the records, oldest first.
+ * @param capacity The number of entries of `records`.
+ * @param count Receives the number of records.
+ * @param written Receives the number of records ever written to the ring.
+ * @return false if the blob is invalid or has more than `capacity` records.
+ */
+bool GTTCAN_trace_deserialize(const uint8_t *blob, uint32_t size, gttcan_trace_record_t *records, uint32_t capacity,
+                              uint32_t *count, uint32_t *written)
+{
+    if ((size < GTTCAN_TRACE_HEADER_SIZE) ||
+        (blob[0] != GTTCAN_TRACE_MAGIC_0) || (blob[1] != GTTCAN_TRACE_MAGIC_1) ||
+        (blob[2] != GTTCAN_TRACE_MAGIC_2) || (blob[3] != GTTCAN_TRACE_MAGIC_3) ||
+        (blob[4] != GTTCAN_TRACE_VERSION) || (blob[5] != GTTCAN_TRACE_RECORD_SIZE))
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    const uint32_t records_in_blob = GTTCAN_trace_read_le32(&blob[8]);
+    if ((records_in_blob > capacity) || (records_in_blob > ((size - GTTCAN_TRACE_HEADER_SIZE) / GTTCAN_TRACE_RECORD_SIZE)))
+    {
+        return false; // cppcheck-suppress misra-c2012-15.5
+    }
+    for (uint32_t i = 0U; i < records_in_blob; i++)
+    {
+        const uint8_t * const bytes = &blob[GTTCAN_TRACE_HEADER_SIZE + (i * GTTCAN_TRACE_RECORD_SIZE)];
+        gttcan_trace_record_t * const record = &records[i];
+        record->current_time = GTTCAN_trace_read_le32(&bytes[0]);
+        record->error = (int32_t)GTTCAN_trace_read_le32(&bytes[4]);
+        record->fta = (int32_t)GTTCAN_trace_read_le32(&bytes[8]);
+        record->timer = GTTCAN_trace_read_le32(&bytes[12]);
+        record->index = GTTCAN_trace_read_le16(&bytes[16]);
+        record->slot_id = GTTCAN_trace_read_le16(&bytes[18]);
+        record->type = bytes[20];
+        record->flags = bytes[21];
+        record->reserved = 0U;
+    }
+    *count = records_in_blob;
+    *written = GTTCAN_trace_read_le32(&blob[12]);
+    return true;
+}
+
+#if GTTCAN_TRACE
+/**
+ * @brief Attach a trace ring.
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param trace The trace ring (initialised with GTTCAN_trace_init()),
+ *              or NULL to stop tracing.
+ */
+void GTTCAN_set_trace(gttcan_t *gttcan, gttcan_trace_t *trace)
+{
+    gttcan->trace = trace;
+}
+#endif
@@ -0,0 +1,43 @@
+/**
+ * @file whiteboard.c
+ * @brief Built-in seqlock whiteboard, indexed by data ID.
+ */
+#include "gttcan.h"
+#include "gttcan_whiteboard.h"
+
+/**
+ * @brief Initialise an empty whiteboard (all values 0, generation 0).
+ *
+ * @param whiteboard The whiteboard.
+ */
+void GTTCAN_whiteboard_init(gttcan_whiteboard_t *whiteboard)
+{
+    for (uint32_t i = 0U; i < (uint32_t)GTTCAN_WHITEBOARD_SIZE; i++)
+    {
+        gttcan_whiteboard_entry_t * const entry = &whiteboard->entries[i];
+        GTTCAN_ATOMIC_INIT(entry->sequence, 0U);
+        for (uint32_t j = 0U; j < 2U; j++)
+        {
+            GTTCAN_ATOMIC_INIT(entry->copies[j].value_high, 0U);
+            GTTCAN_ATOMIC_INIT(entry->copies[j].value_low, 0U);
+            GTTCAN_ATOMIC_INIT(entry->copies[j].timestamp, 0U);
+        }
+    }
+}
+
+/**
+ * @brief Attach a built-in whiteboard.
+ *
+ * With a whiteboard attached, GTTCAN_transmit_next_frame() reads the
+ * transmitted values from it instead of calling `read_value`, and
+ * received values are written to it instead of calling `write_value`
+ * (by GTTCAN_drain_rx_ring() if a receive ring is attached).
+ *
+ * @param gttcan The GTTCAN instance.
+ * @param whiteboard The whiteboard (initialised with GTTCAN_whiteboard_init()),
+ *                   or NULL to use the callbacks again.
+ */
+void GTTCAN_set_whiteboard(gttcan_t *gttcan, gttcan_whiteboard_t *whiteboard)
+{
+    gttcan->whiteboard = whiteboard;
+}
@@ -0,0 +1,1788 @@
+/**
+ * @file gttcan_tests.c
+ * @brief Native C tests of the GTTCAN protocol library.
+ *
+ * Mirrors the Swift tests in Tests/gttcanTests so that the library can
+ * be tested on toolchains without Swift.  Run without arguments to run
+ * all tests, or with the names of the tests to run.
+ */
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gttcan.h"
+#include "gttcan_rx_ring.h"
+#include "gttcan_whiteboard.h"
+#include "gttcan_stats.h"
+#include "gttcan_trace.h"
+#include "gttcan_fd.h"
+#include "gttcan_sporadic.h"
+#include "gttcan_staging.h"
+#include "gttcan_clock.h"
+#include "gttcan_filter.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+#define HAVE_PTHREADS 1
+#endif
+
+#define LOCAL_NODE 1U
+#define REMOTE_NODE 2U
+#define SLOT_DURATION 10000U
+#define GLOBAL_SCHEDULE_LENGTH 4U
+#define CAN_SLOT_OFFSET 1480U
+#define DATA1 1U
+
+static int failures;
+
+#define EXPECT_EQ(actual, expected)                                                               \
+    do                                                                                            \
+    {                                                                                             \
+        const long long actual_ = (long long)(actual);                                            \
+        const long long expected_ = (long long)(expected);                                        \
+        if (actual_ != expected_)                                                                 \
+        {                                                                                         \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n",                                 \
+                    __FILE__, __LINE__, #actual, actual_, expected_);                             \
+            failures++;                                                                           \
+        }                                                                                         \
+    } while (0)
+
+#define EXPECT_TRUE(condition) EXPECT_EQ((condition) ? 1 : 0, 1)
+#define EXPECT_FALSE(condition) EXPECT_EQ((condition) ? 1 : 0, 0)
+
+typedef struct callback_data_s {
+    int call_count;
+    uint16_t id;
+    uint64_t data;
+} callback_data_t;
+
+static gttcan_t ttcan;
+static uint8_t schedule_blob[64];
+
+static void ignore_transmit(uint32_t id, uint64_t data, void *context) { (void)id; (void)data; (void)context; }
+static void ignore_timer(uint32_t delay, void *context) { (void)delay; (void)context; }
+static uint64_t read_zero(uint16_t id, void *context) { (void)id; (void)context; return 0U; }
+static void ignore_write(uint16_t id, uint64_t value, void *context) { (void)id; (void)value; (void)context; }
+
+static uint64_t read_twelve(uint16_t id, void *context)
+{
+    callback_data_t * const calls = context;
+    calls->call_count++;
+    calls->id = id;
+    return 12U;
+}
+
+static void record_transmit(uint32_t id, uint64_t data, void *context)
+{
+    (void)id;
+    callback_data_t * const calls = context;
+    calls->call_count++;
+    calls->data = data;
+}
+
+static void record_write(uint16_t id, uint64_t value, void *context)
+{
+    callback_data_t * const calls = context;
+    calls->call_count++;
+    calls->id = id;
+    calls->data = value;
+}
+
+static void record_timer(uint32_t delay, void *context)
+{
+    callback_data_t * const calls = context;
+    calls->call_count++;
+    calls->data = delay;
+}
+
+static void count_write(uint16_t id, uint64_t value, void *context)
+{
+    (void)id;
+    (void)value;
+    callback_data_t * const calls = context;
+    calls->id++;
+}
+
+static uint32_t schedule_index(uint32_t slot)
+{
+    return GTTCAN_CAN_ID(slot, 0U);
+}
+
+/**
+ * Load a schedule blob into ttcan.  Without #GTTCAN_EMBEDDED_SCHEDULE,
+ * the schedule is built into a node schedule of the tests that ttcan
+ * does not use, so that a failure leaves the current one untouched,
+ * like GTTCAN_load_schedule() does.
+ */
+static bool load_schedule(const uint8_t *blob, uint32_t size)
+{
+#if GTTCAN_EMBEDDED_SCHEDULE
+    return GTTCAN_load_schedule(&ttcan, blob, size);
+#else
+    static gttcan_node_schedule_t node_schedules[2];
+    gttcan_node_schedule_t * const node_schedule = &node_schedules[(ttcan.node_schedule == &node_schedules[0]) ? 1U : 0U];
+    return GTTCAN_build_node_schedule(node_schedule, blob, size, ttcan.localNodeId, ttcan.sporadic != NULL) &&
+           GTTCAN_set_node_schedule(&ttcan, node_schedule);
+#endif
+}
+
+/// Stage a schedule blob on ttcan, see load_schedule().
+static bool stage_schedule(const uint8_t *blob, uint32_t size)
+{
+#if GTTCAN_EMBEDDED_SCHEDULE
+    return GTTCAN_stage_schedule(&ttcan, blob, size);
+#else
+    // Neither the current nor a staged schedule is overwritten.
+    static gttcan_node_schedule_t node_schedules[3];
+    uint32_t i = 0U;
+    while ((ttcan.node_schedule == &node_schedules[i]) ||
+           ((ttcan.staging != NULL) && (ttcan.staging->node_schedule == &node_schedules[i])))
+    {
+        i++;
+    }
+    return GTTCAN_build_node_schedule(&node_schedules[i], blob, size, ttcan.localNodeId, ttcan.sporadic != NULL) &&
+           GTTCAN_stage_node_schedule(&ttcan, &node_schedules[i]);
+#endif
+}
+
+/// Without an embedded schedule, load the free slots that GTTCAN_init() puts into it.
+static void load_free_schedule(void)
+{
+#if !GTTCAN_EMBEDDED_SCHEDULE
+    static const uint32_t free_entries[GLOBAL_SCHEDULE_LENGTH] = { 0U };
+    static uint8_t free_blob[GTTCAN_SCHEDULE_SIZE(GLOBAL_SCHEDULE_LENGTH)];
+    const uint32_t size = GTTCAN_pack_schedule(free_blob, sizeof(free_blob), free_entries, GLOBAL_SCHEDULE_LENGTH, 0U);
+    EXPECT_TRUE(load_schedule(free_blob, size));
+#endif
+}
+
+static void set_up(void)
+{
+    memset(&ttcan, 0xA5, sizeof(ttcan));
+    GTTCAN_init(&ttcan, LOCAL_NODE, SLOT_DURATION, GLOBAL_SCHEDULE_LENGTH,
+                ignore_transmit, ignore_timer, read_zero, ignore_write, &ttcan);
+    load_free_schedule();
+}
+
+/// Load a 4-slot global schedule in which the local node owns slot 0.
+static bool load_test_schedule(void)
+{
+    const uint32_t entries[] = { (LOCAL_NODE << 16U) | 0U, (10U << 16U) | 5U, (8U << 16U) | 3U, (9U << 16U) | 4U };
+    const uint32_t size = GTTCAN_pack_schedule(schedule_blob, sizeof(schedule_blob), entries, 4U, 0U);
+    return load_schedule(schedule_blob, size);
+}
+
+static void test_init(void)
+{
+    EXPECT_EQ(ttcan.localNodeId, LOCAL_NODE);
+    EXPECT_EQ(ttcan.slotduration, SLOT_DURATION);
+    EXPECT_EQ(ttcan.node_schedule->globalScheduleLength, GLOBAL_SCHEDULE_LENGTH);
+    EXPECT_TRUE(ttcan.transmit_callback != NULL);
+    EXPECT_TRUE(ttcan.set_timer_int_callback != NULL);
+    EXPECT_TRUE(ttcan.read_value != NULL);
+    EXPECT_TRUE(ttcan.write_value != NULL);
+    EXPECT_TRUE(ttcan.context_pointer == &ttcan);
+#if !GTTCAN_EMBEDDED_SCHEDULE
+    // Without a node schedule attached, the schedule is empty.
+    static gttcan_t detached;
+    GTTCAN_init(&detached, LOCAL_NODE, SLOT_DURATION, GLOBAL_SCHEDULE_LENGTH,
+                ignore_transmit, ignore_timer, read_zero, ignore_write, NULL);
+    EXPECT_EQ(detached.node_schedule->globalScheduleLength, 0U);
+#endif
+}
+
+static void test_fta(void)
+{
+    EXPECT_EQ(ttcan.error_accumulator, 0);
+    EXPECT_EQ(ttcan.slots_accumulated, 0);
+    EXPECT_EQ(ttcan.lower_outliers[0], INT32_MAX);
+    EXPECT_EQ(ttcan.upper_outliers[0], INT32_MIN);
+    ttcan.transmitted = true;
+    EXPECT_EQ(GTTCAN_fta(&ttcan), 0);
+    ttcan.error_accumulator = 1;
+    ttcan.slots_accumulated = 1;
+    EXPECT_EQ(GTTCAN_fta(&ttcan), 1);
+    ttcan.error_accumulator = -3;
+    ttcan.slots_accumulated = 2;
+    EXPECT_EQ(GTTCAN_fta(&ttcan), -1);
+    ttcan.error_accumulator = 3;
+    ttcan.slots_accumulated = 4;
+    EXPECT_EQ(GTTCAN_fta(&ttcan), 2);
+    GTTCAN_accumulate_error(&ttcan, -1);
+    EXPECT_EQ(ttcan.lower_outliers[0], -1);
+    EXPECT_EQ(ttcan.upper_outliers[0], -1);
+    GTTCAN_accumulate_error(&ttcan, 1);
+    EXPECT_EQ(ttcan.lower_outliers[0], -1);
+    EXPECT_EQ(ttcan.upper_outliers[0], 1);
+    GTTCAN_accumulate_error(&ttcan, -2);
+    GTTCAN_accumulate_error(&ttcan, 2);
+    EXPECT_EQ(ttcan.lower_outliers[0], -2);
+    EXPECT_EQ(ttcan.upper_outliers[0], 2);
+    GTTCAN_accumulate_error(&ttcan, -3);
+    GTTCAN_accumulate_error(&ttcan, 3);
+    EXPECT_EQ(ttcan.lower_outliers[0], -3);
+    EXPECT_EQ(ttcan.upper_outliers[0], 3);
+    EXPECT_EQ(GTTCAN_fta(&ttcan), 0);
+    EXPECT_EQ(ttcan.lower_outliers[0], INT32_MAX);
+    EXPECT_EQ(ttcan.upper_outliers[0], INT32_MIN);
+    EXPECT_EQ(ttcan.error_accumulator, 0);
+    EXPECT_EQ(ttcan.slots_accumulated, 0);
+}
+
+static void accumulate_errors(const int32_t *errors, size_t count)
+{
+    for (size_t i = 0U; i < count; i++)
+    {
+        GTTCAN_accumulate_error(&ttcan, errors[i]);
+    }
+}
+
+static void test_fta_outliers(void)
+{
+    ttcan.transmitted = true;
+    EXPECT_EQ(ttcan.fta.outliers, 1);
+    EXPECT_EQ(ttcan.fta.window, 1);
+    EXPECT_FALSE(GTTCAN_set_fta(&ttcan, 0U, 1U));
+    EXPECT_FALSE(GTTCAN_set_fta(&ttcan, (uint8_t)(GTTCAN_FTA_MAX_OUTLIERS + 1U), 1U));
+    EXPECT_FALSE(GTTCAN_set_fta(&ttcan, 1U, 0U));
+    EXPECT_FALSE(GTTCAN_set_fta(&ttcan, 1U, (uint8_t)(GTTCAN_FTA_MAX_WINDOW + 1U)));
+    EXPECT_EQ(ttcan.fta.outliers, 1);
+
+    // Two faulty nodes: a single discarded outlier is not enough...
+    const int32_t two_faulty[] = { 1, 1000, 1, 1, 900, 1, 1 };
+    accumulate_errors(two_faulty, sizeof(two_faulty) / sizeof(two_faulty[0]));
+    EXPECT_EQ(GTTCAN_fta(&ttcan), 180);
+    // ...but two are.
+    EXPECT_TRUE(GTTCAN_set_fta(&ttcan, 2U, 1U));
+    accumulate_errors(two_faulty, sizeof(two_faulty) / sizeof(two_faulty[0]));
+    EXPECT_EQ(ttcan.lower_outliers[0], 1);
+    EXPECT_EQ(ttcan.lower_outliers[1], 1);
+    EXPECT_EQ(ttcan.upper_outliers[0], 1000);
+    EXPECT_EQ(ttcan.upper_outliers[1], 900);
+    EXPECT_EQ(GTTCAN_fta(&ttcan), 1);
+    EXPECT_EQ(ttcan.state_correction, 7);
+    EXPECT_EQ(ttcan.lower_outliers[1], INT32_MAX);
+    EXPECT_EQ(ttcan.upper_outliers[1], INT32_MIN);
+    // Not more than 2k samples: arithmetic average.
+    const int32_t four[] = { 2, 4, 6, 12 };
+    accumulate_errors(four, sizeof(four) / sizeof(four[0]));
+    EXPECT_EQ(GTTCAN_fta(&ttcan), 6);
+    EXPECT_EQ(ttcan.state_correction, 24);
+
+    // Average the trimmed samples over two rounds.
+    EXPECT_TRUE(GTTCAN_set_fta(&ttcan, 1U, 2U));
+    const int32_t round1[] = { 0, 4, 4, 4, 100 };
+    const int32_t round2[] = { 0, 0, 0 };
+    const int32_t round3[] = { 8, 8, 8 };
+    accumulate_errors(round1, sizeof(round1) / sizeof(round1[0]));
+    EXPECT_EQ(GTTCAN_fta(&ttcan), 4);
+    accumulate_errors(round2, sizeof(round2) / sizeof(round2[0]));
+    EXPECT_EQ(GTTCAN_fta(&ttcan), 3);
+    accumulate_errors(round3, sizeof(round3) / sizeof(round3[0]));
+    EXPECT_EQ(GTTCAN_fta(&ttcan), 4);
+    EXPECT_EQ(GTTCAN_fta(&ttcan), 0); // a round without samples
+    EXPECT_EQ(ttcan.fta.window_filled, 2);
+    EXPECT_TRUE(GTTCAN_set_fta(&ttcan, 1U, 2U));
+    EXPECT_EQ(ttcan.fta.window_filled, 0);
+
+    // Trimmed sums beyond the range of int32_t are kept in full.
+    const int32_t large[] = { -2100000000, 1100000000, 1100000000, 1100000000 };
+    accumulate_errors(large, sizeof(large) / sizeof(large[0]));
+    EXPECT_EQ(GTTCAN_fta(&ttcan), 1100000000);
+    EXPECT_EQ(ttcan.state_correction, INT32_MAX);
+    accumulate_errors(large, sizeof(large) / sizeof(large[0]));
+    EXPECT_EQ(GTTCAN_fta(&ttcan), 1100000000);
+    EXPECT_EQ(ttcan.fta.window_total, 4400000000LL);
+}
+
+static void test_state_correction(void)
+{
+    ttcan.transmitted = true;
+    // Simulate receiving from a slow node that is off by 1
+    const uint32_t current_time = SLOT_DURATION + 1U;
+    GTTCAN_process_frame(&ttcan, current_time, schedule_index(1U) | DATA1, 0U);
+    // We expect the accumulated error to be -1 (from our perspective)
+    EXPECT_EQ(ttcan.error_accumulator, -1);
+    EXPECT_EQ(ttcan.slots_accumulated, 1);
+    EXPECT_EQ(ttcan.lower_outliers[0], -1);
+    EXPECT_EQ(ttcan.upper_outliers[0], -1);
+    for (int i = 2; i <= 3; i++)
+    {
+        GTTCAN_process_frame(&ttcan, current_time, schedule_index(1U) | DATA1, 0U);
+    }
+    EXPECT_EQ(ttcan.error_accumulator, -3);
+    EXPECT_EQ(ttcan.slots_accumulated, 3);
+    EXPECT_EQ(ttcan.lower_outliers[0], -1);
+    EXPECT_EQ(ttcan.upper_outliers[0], -1);
+}
+
+static void test_transmit_not_active(void)
+{
+    EXPECT_FALSE(ttcan.isActive);
+    EXPECT_FALSE(ttcan.transmitted);
+    GTTCAN_transmit_next_frame(&ttcan);
+    EXPECT_FALSE(ttcan.isActive);
+    EXPECT_FALSE(ttcan.transmitted);
+}
+
+static void test_transmit_calls_read_value(void)
+{
+    callback_data_t calls = { 0 };
+    ttcan.isActive = true;
+    ttcan.context_pointer = &calls;
+    ttcan.localScheduleIndex = 1U;
+    static gttcan_node_schedule_t node_schedule;
+    node_schedule = *ttcan.node_schedule;
+    node_schedule.localScheduleSlotID[1] = 10U;
+    node_schedule.localScheduleDataID[1] = 10U;
+    ttcan.node_schedule = &node_schedule;
+    ttcan.read_value = read_twelve;
+    ttcan.transmit_callback = record_transmit;
+    GTTCAN_transmit_next_frame(&ttcan);
+    EXPECT_EQ(calls.call_count, 2);
+    EXPECT_EQ(calls.id, 10U);
+    EXPECT_EQ(calls.data, 12U);
+}
+
+static void test_load_schedule(void)
+{
+#if !GTTCAN_EMBEDDED_SCHEDULE
+    // There is no storage to load into; load_schedule() builds a node schedule instead.
+    const uint32_t reference[] = { (LOCAL_NODE << 16U) | 0U };
+    EXPECT_FALSE(GTTCAN_load_schedule(&ttcan, schedule_blob, GTTCAN_pack_schedule(schedule_blob, sizeof(schedule_blob), reference, 1U, 0U)));
+#endif
+    EXPECT_EQ(GTTCAN_get_schedule_entry(&ttcan, 0U), 0U);
+    EXPECT_TRUE(load_test_schedule());
+    EXPECT_EQ(ttcan.node_schedule->globalScheduleLength, 4U);
+    EXPECT_EQ(ttcan.slotduration, SLOT_DURATION);
+    EXPECT_EQ(ttcan.node_schedule->localScheduleLength, 1U);
+    EXPECT_EQ(GTTCAN_get_schedule_entry(&ttcan, 2U), (8U << 16U) | 3U);
+    EXPECT_EQ(GTTCAN_get_schedule_entry(&ttcan, 4U), 0U);
+    // Truncated blobs and a corrupted magic are rejected.
+    EXPECT_FALSE(load_schedule(schedule_blob, GTTCAN_SCHEDULE_HEADER_SIZE));
+    schedule_blob[0] = 0U;
+    EXPECT_FALSE(load_schedule(schedule_blob, sizeof(schedule_blob)));
+    // Packing into a buffer that is too small fails.
+    const uint32_t entries[] = { (1U << 16U) | 1U };
+    EXPECT_EQ(GTTCAN_pack_schedule(schedule_blob, 8U, entries, 1U, 0U), 0U);
+
+    // A node with more slots than its local schedule holds is rejected,
+    // also when a sporadic queue would add the arbitration slots.
+    static uint32_t long_entries[GTTCAN_MAX_SLOTS + 1U];
+    static uint8_t long_blob[GTTCAN_SCHEDULE_SIZE(GTTCAN_MAX_SLOTS + 1U)];
+    static gttcan_sporadic_t sporadic;
+    EXPECT_TRUE(load_test_schedule());
+    for (uint32_t g = 0U; g <= (uint32_t)GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH; g++)
+    {
+        long_entries[g] = (LOCAL_NODE << 16U) | (g + 1U);
+    }
+    uint32_t size = GTTCAN_pack_schedule(long_blob, sizeof(long_blob), long_entries, GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH + 1U, 0U);
+    EXPECT_FALSE(load_schedule(long_blob, size));
+    EXPECT_EQ(ttcan.node_schedule->globalScheduleLength, 4U);
+    EXPECT_EQ(ttcan.node_schedule->localScheduleLength, 1U);
+    long_entries[GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH] = (uint32_t)GTTCAN_ARBITRATION_NODE << 16U;
+    size = GTTCAN_pack_schedule(long_blob, sizeof(long_blob), long_entries, GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH + 1U, 0U);
+    EXPECT_TRUE(load_schedule(long_blob, size));
+#if GTTCAN_EMBEDDED_SCHEDULE
+    GTTCAN_sporadic_init(&sporadic);
+    EXPECT_FALSE(GTTCAN_set_sporadic(&ttcan, &sporadic));
+    EXPECT_TRUE(ttcan.sporadic == NULL);
+#else
+    static gttcan_node_schedule_t node_schedule;
+    (void)sporadic;
+    EXPECT_FALSE(GTTCAN_build_node_schedule(&node_schedule, long_blob, size, LOCAL_NODE, true));
+#endif
+    EXPECT_EQ(ttcan.node_schedule->localScheduleLength, GTTCAN_MAX_LOCAL_SCHEDULE_LENGTH);
+
+    // Transmit tables bound the schedule length by GTTCAN_MAX_SLOTS, without them only the index bits do.
+    for (uint32_t g = 0U; g <= (uint32_t)GTTCAN_MAX_SLOTS; g++)
+    {
+        long_entries[g] = (g == 0U) ? (LOCAL_NODE << 16U) : ((REMOTE_NODE << 16U) | g);
+    }
+    size = GTTCAN_pack_schedule(long_blob, sizeof(long_blob), long_entries, GTTCAN_MAX_SLOTS + 1U, 0U);
+    EXPECT_EQ(load_schedule(long_blob, size), !GTTCAN_TRANSMIT_TABLES);
+}
+
+static void test_transmit_tables(void)
+{
+    // The local node owns slot 0 of the 4-slot global schedule.
+    EXPECT_TRUE(load_test_schedule());
+    EXPECT_EQ(GTTCAN_get_slots_to_next_transmit(&ttcan, 0U), 4U);
+    EXPECT_EQ(GTTCAN_get_slots_to_next_transmit(&ttcan, 1U), 3U);
+    EXPECT_EQ(GTTCAN_get_slots_to_next_transmit(&ttcan, 3U), 1U);
+    EXPECT_EQ(GTTCAN_get_slots_to_next_transmit(&ttcan, 100U), 0U);
+    EXPECT_EQ(GTTCAN_get_slots_since_last_transmit(&ttcan, 2U), 2U);
+    ttcan.transmitted = true;
+    EXPECT_EQ(GTTCAN_get_slots_since_last_transmit(&ttcan, 0U), 4U);
+    EXPECT_EQ(GTTCAN_get_slots_since_last_transmit(&ttcan, 1U), 1U);
+    EXPECT_EQ(GTTCAN_get_slots_since_last_transmit(&ttcan, 3U), 3U);
+    EXPECT_EQ(GTTCAN_get_slots_since_last_transmit(&ttcan, 100U), 0U);
+    // A frame from any slot puts the local schedule back in step.
+    ttcan.localScheduleIndex = 7U;
+    GTTCAN_process_frame(&ttcan, SLOT_DURATION * 2U, schedule_index(2U) | DATA1, 0U);
+    EXPECT_EQ(ttcan.localScheduleIndex, 0U);
+    // Frames outside the global schedule are ignored.
+    const uint16_t accumulated = ttcan.slots_accumulated;
+    GTTCAN_process_frame(&ttcan, 0U, schedule_index(100U) | DATA1, 0U);
+    EXPECT_EQ(ttcan.slots_accumulated, accumulated);
+}
+
+static void test_process_frames(void)
+{
+    const gttcan_rx_frame_t frames[] = {
+        { 10003U, schedule_index(1U) | 5U, 1U },
+        { 19998U, schedule_index(2U) | 3U, 2U },
+        { 30001U, schedule_index(3U) | 4U, 3U },
+        { 40002U, schedule_index(0U), 0x8000000000000000ULL | 1000000U },
+        { 50001U, schedule_index(1U) | 5U, 4U },
+    };
+    const uint32_t count = sizeof(frames) / sizeof(frames[0]);
+    callback_data_t single = { 0 };
+    callback_data_t batch = { 0 };
+    EXPECT_TRUE(load_test_schedule());
+    ttcan.transmitted = true;
+    ttcan.set_timer_int_callback = record_timer;
+    ttcan.write_value = count_write;
+    ttcan.context_pointer = &single;
+    gttcan_t batched = ttcan;
+    batched.context_pointer = &batch;
+
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        GTTCAN_process_frame(&ttcan, frames[i].timestamp, frames[i].id, frames[i].data);
+    }
+    GTTCAN_process_frames(&batched, frames, count);
+    // The same state and whiteboard writes, but a single timer re-arm
+    // relative to the last frame of the batch.
+    EXPECT_EQ(batch.id, single.id);
+    EXPECT_EQ(batched.error_accumulator, ttcan.error_accumulator);
+    EXPECT_EQ(batched.slots_accumulated, ttcan.slots_accumulated);
+    EXPECT_EQ(batched.error_offset, ttcan.error_offset);
+    EXPECT_EQ(batched.localScheduleIndex, ttcan.localScheduleIndex);
+    EXPECT_EQ(batched.isActive, ttcan.isActive);
+    EXPECT_EQ(single.data, 4U * SLOT_DURATION);
+    EXPECT_EQ(batch.call_count, 1);
+    EXPECT_EQ(batch.data, (4U * SLOT_DURATION) - (50001U - 40002U));
+    // A batch without a re-arm leaves the timer alone.
+    GTTCAN_process_frames(&batched, frames, 1U);
+    EXPECT_EQ(batch.call_count, 1);
+}
+
+/// Receive one schedule round in which every frame arrives `early` NTU early.
+static void receive_early_round(int32_t early)
+{
+    for (uint32_t slot = 1U; slot <= GLOBAL_SCHEDULE_LENGTH; slot++)
+    {
+        const uint32_t index = slot % GLOBAL_SCHEDULE_LENGTH;
+        const uint64_t data = (index == 0U) ? 0x8000000000000000ULL : DATA1;
+        GTTCAN_process_frame(&ttcan, (slot * SLOT_DURATION) - (uint32_t)early, schedule_index(index) | ((index == 0U) ? 0U : 3U), data);
+    }
+}
+
+static void test_clock_servo(void)
+{
+    callback_data_t calls = { 0 };
+    EXPECT_TRUE(load_test_schedule());
+    EXPECT_FALSE(ttcan.servo.enabled);
+    EXPECT_EQ(GTTCAN_get_corrected_slot_duration(&ttcan), (uint64_t)SLOT_DURATION << GTTCAN_SERVO_FRACTION_BITS);
+    ttcan.transmitted = true;
+    ttcan.set_timer_int_callback = record_timer;
+    ttcan.context_pointer = &calls;
+
+    // The reference frame closes the round: the FTA error of 8 NTU
+    // shortens the slots by 8 / 4 slots and the next timer by 8 / 2.
+    GTTCAN_set_clock_servo(&ttcan, true, 1U, 0U, 0U);
+    receive_early_round(8);
+    EXPECT_EQ(ttcan.servo.updates, 1U);
+    EXPECT_EQ(ttcan.servo.last_error, 8);
+    EXPECT_EQ(ttcan.servo.rate_correction, 2 << GTTCAN_SERVO_FRACTION_BITS);
+    EXPECT_EQ(ttcan.servo.phase_correction, 4);
+    EXPECT_EQ(GTTCAN_get_corrected_slot_duration(&ttcan), (uint64_t)(SLOT_DURATION - 2U) << GTTCAN_SERVO_FRACTION_BITS);
+    EXPECT_EQ(calls.call_count, 1);
+    EXPECT_EQ(calls.data, (4U * (SLOT_DURATION - 2U)) - 4U);
+
+    // Corrections below one NTU accumulate across timer delays.
+    GTTCAN_set_clock_servo(&ttcan, true, 30U, 3U, 0U);
+    receive_early_round(1);
+    EXPECT_EQ(ttcan.servo.rate_correction, 2048); // 1/32 NTU per slot
+    EXPECT_EQ(ttcan.servo.phase_correction, 0);
+    EXPECT_EQ(calls.data, 39999U);
+    ttcan.isActive = true;
+    GTTCAN_transmit_next_frame(&ttcan);
+    EXPECT_EQ(calls.data, 40000U); // 39999.875 + 0.875
+    GTTCAN_transmit_next_frame(&ttcan);
+    EXPECT_EQ(calls.data, 40000U); // 39999.875 + 0.75
+
+    // The rate correction is limited to GTTCAN_SERVO_MAX_PPM.
+    GTTCAN_set_clock_servo(&ttcan, true, 1U, 0U, 0U);
+    receive_early_round(4000);
+    EXPECT_EQ(ttcan.servo.rate_correction, (int32_t)((((uint64_t)SLOT_DURATION << GTTCAN_SERVO_FRACTION_BITS) * GTTCAN_SERVO_MAX_PPM) / 1000000U));
+    EXPECT_EQ(ttcan.servo.phase_correction, 2000);
+
+    // The timestamp latency is subtracted before the error is computed.
+    GTTCAN_set_clock_servo(&ttcan, true, 1U, 0U, 5U);
+    receive_early_round(-5);
+    EXPECT_EQ(ttcan.servo.last_error, 0);
+    EXPECT_EQ(ttcan.servo.rate_correction, 0);
+}
+
+static void test_fast_join(void)
+{
+    callback_data_t calls = { 0 };
+    EXPECT_TRUE(load_test_schedule());
+    EXPECT_EQ(ttcan.join.observations, 0U);
+    ttcan.set_timer_int_callback = record_timer;
+    ttcan.context_pointer = &calls;
+
+    // Without the fast join, only a start-of-schedule frame activates the node.
+    GTTCAN_process_frame(&ttcan, 100000U, schedule_index(2U) | 3U, DATA1);
+    GTTCAN_process_frame(&ttcan, 110000U, schedule_index(3U) | 4U, DATA1);
+    EXPECT_FALSE(ttcan.isActive);
+    EXPECT_EQ(calls.call_count, 0);
+
+    // Two frames one slot apart: join and arm the timer for slot 0.
+    GTTCAN_set_fast_join(&ttcan, 2U);
+    GTTCAN_process_frame(&ttcan, 100000U, schedule_index(2U) | 3U, DATA1);
+    EXPECT_FALSE(ttcan.isActive);
+    GTTCAN_process_frame(&ttcan, 110000U + (SLOT_DURATION / 8U), schedule_index(3U) | 4U, DATA1);
+    EXPECT_TRUE(ttcan.isActive);
+    EXPECT_FALSE(ttcan.transmitted);
+    EXPECT_EQ(ttcan.localScheduleIndex, 0U);
+    EXPECT_EQ(calls.call_count, 1);
+    EXPECT_EQ(calls.data, SLOT_DURATION);
+    EXPECT_EQ(ttcan.slots_accumulated, 0U);
+
+    // Reloading the schedule deactivates the node and restarts the count;
+    // a frame that does not fit the schedule timing restarts it as well.
+    EXPECT_TRUE(load_test_schedule());
+    EXPECT_EQ(ttcan.join.observations, 2U);
+    GTTCAN_process_frame(&ttcan, 200000U, schedule_index(1U) | 5U, DATA1);
+    GTTCAN_process_frame(&ttcan, 225000U, schedule_index(2U) | 3U, DATA1);
+    EXPECT_FALSE(ttcan.isActive);
+    EXPECT_EQ(ttcan.join.consistent, 1U);
+
+    // Missed frames, even a whole round, are fine.
+    GTTCAN_process_frame(&ttcan, 225000U + (5U * SLOT_DURATION), schedule_index(3U) | 4U, DATA1);
+    EXPECT_TRUE(ttcan.isActive);
+    EXPECT_EQ(calls.call_count, 2);
+
+    // With one observation, the first frame is enough.
+    EXPECT_TRUE(load_test_schedule());
+    GTTCAN_set_fast_join(&ttcan, 1U);
+    GTTCAN_process_frame(&ttcan, 300000U, schedule_index(1U) | 5U, DATA1);
+    EXPECT_TRUE(ttcan.isActive);
+    EXPECT_EQ(calls.call_count, 3);
+    EXPECT_EQ(calls.data, 3U * SLOT_DURATION);
+    GTTCAN_set_fast_join(&ttcan, 0U);
+}
+
+static void test_sporadic_queue(void)
+{
+    static gttcan_sporadic_t sporadic;
+    uint32_t id = 0U;
+    uint64_t data = 0U;
+    GTTCAN_sporadic_init(&sporadic);
+    EXPECT_FALSE(GTTCAN_sporadic_begin(&sporadic, 1U, &id, &data));
+
+    // Reserved data IDs and unknown priorities are rejected.
+    EXPECT_FALSE(GTTCAN_sporadic_push(&sporadic, (uint16_t)NETWORK_TIME_SLOT, 1U, 0U, 0U));
+    EXPECT_FALSE(GTTCAN_sporadic_push(&sporadic, (uint16_t)GTTCAN_ARBITRATION_DATAID, 1U, 0U, 0U));
+    EXPECT_FALSE(GTTCAN_sporadic_push(&sporadic, 7U, 1U, (uint8_t)GTTCAN_SPORADIC_PRIORITIES, 0U));
+
+    // The most urgent message is sent first, messages of the same priority in order.
+    EXPECT_TRUE(GTTCAN_sporadic_push(&sporadic, 20U, 200U, 2U, 100U));
+    EXPECT_TRUE(GTTCAN_sporadic_push(&sporadic, 10U, 100U, 1U, 110U));
+    EXPECT_TRUE(GTTCAN_sporadic_push(&sporadic, 11U, 101U, 1U, 120U));
+    EXPECT_TRUE(GTTCAN_sporadic_begin(&sporadic, 3U, &id, &data));
+    EXPECT_EQ(id, GTTCAN_CAN_ID(3U, 10U));
+    EXPECT_EQ(data, 100U);
+
+    // A lost message stays queued, the outcome of another frame is ignored.
+    GTTCAN_sporadic_complete(&sporadic, id, false, 150U);
+    EXPECT_EQ(sporadic.stats[1].lost, 1U);
+    EXPECT_TRUE(GTTCAN_sporadic_begin(&sporadic, 5U, &id, &data));
+    EXPECT_EQ(id, GTTCAN_CAN_ID(5U, 10U));
+    GTTCAN_sporadic_complete(&sporadic, GTTCAN_CAN_ID(5U, 11U), true, 160U);
+    EXPECT_EQ(sporadic.stats[1].sent, 0U);
+    GTTCAN_sporadic_complete(&sporadic, id, true, 170U);
+    EXPECT_EQ(sporadic.stats[1].sent, 1U);
+    EXPECT_EQ(sporadic.stats[1].latency_sum, 60U);
+    EXPECT_EQ(sporadic.stats[1].latency_max, 60U);
+
+    // An attempt whose outcome was never reported counts as lost.
+    EXPECT_TRUE(GTTCAN_sporadic_begin(&sporadic, 1U, &id, &data));
+    EXPECT_EQ(id, GTTCAN_CAN_ID(1U, 11U));
+    EXPECT_TRUE(GTTCAN_sporadic_begin(&sporadic, 3U, &id, &data));
+    EXPECT_EQ(sporadic.stats[1].lost, 2U);
+    GTTCAN_sporadic_complete(&sporadic, id, true, 220U);
+    EXPECT_TRUE(GTTCAN_sporadic_begin(&sporadic, 1U, &id, &data));
+    EXPECT_EQ(id, GTTCAN_CAN_ID(1U, 20U));
+    EXPECT_EQ(data, 200U);
+    GTTCAN_sporadic_complete(&sporadic, id, true, 300U);
+    EXPECT_EQ(sporadic.stats[2].latency_max, 200U);
+    EXPECT_FALSE(GTTCAN_sporadic_begin(&sporadic, 1U, &id, &data));
+
+    // A full ring drops new messages.
+    for (uint32_t i = 0U; i < (uint32_t)GTTCAN_SPORADIC_QUEUE_SIZE; i++)
+    {
+        EXPECT_TRUE(GTTCAN_sporadic_push(&sporadic, 30U, i, 0U, 0U));
+    }
+    EXPECT_FALSE(GTTCAN_sporadic_push(&sporadic, 30U, 0U, 0U, 0U));
+    EXPECT_EQ(sporadic.queues[0].dropped, 1U);
+}
+
+static uint32_t transmitted_id;
+
+static void record_transmit_id(uint32_t id, uint64_t data, void *context)
+{
+    transmitted_id = id;
+    record_transmit(id, data, context);
+}
+
+static void test_arbitration_slots(void)
+{
+    static gttcan_sporadic_t sporadic;
+    callback_data_t calls = { 0 };
+    // The local node sends the reference frame, slots 1 and 3 are arbitration slots.
+    const uint32_t entries[] = {
+        (LOCAL_NODE << 16U) | 0U, (GTTCAN_ARBITRATION_NODE << 16U), (8U << 16U) | 3U, (GTTCAN_ARBITRATION_NODE << 16U)
+    };
+    const uint32_t size = GTTCAN_pack_schedule(schedule_blob, sizeof(schedule_blob), entries, 4U, 0U);
+    EXPECT_TRUE(load_schedule(schedule_blob, size));
+    EXPECT_EQ(ttcan.node_schedule->localScheduleLength, 1U);
+    GTTCAN_sporadic_init(&sporadic);
+    EXPECT_TRUE(GTTCAN_set_sporadic(&ttcan, &sporadic));
+#if !GTTCAN_EMBEDDED_SCHEDULE
+    // A shared schedule without the arbitration slots no longer matches.
+    EXPECT_EQ(ttcan.node_schedule->localScheduleLength, 0U);
+    EXPECT_TRUE(load_schedule(schedule_blob, size));
+#endif
+    EXPECT_EQ(ttcan.node_schedule->localScheduleLength, 3U);
+    ttcan.transmit_callback = record_transmit_id;
+    ttcan.set_timer_int_callback = record_timer;
+    ttcan.context_pointer = &calls;
+
+    // The reference frame is followed by an arbitration slot.
+    GTTCAN_start(&ttcan);
+    EXPECT_EQ(calls.call_count, 2);
+    EXPECT_EQ(transmitted_id, schedule_index(0U));
+
+    // An empty queue skips the slot without sending.
+    GTTCAN_transmit_next_frame(&ttcan);
+    EXPECT_EQ(calls.call_count, 3);
+    EXPECT_EQ(calls.data, 2U * SLOT_DURATION);
+    EXPECT_EQ(ttcan.lastTransmitIndex, 0U);
+    EXPECT_EQ(GTTCAN_get_slots_since_last_transmit(&ttcan, 2U), 2U);
+
+    // A queued message is sent in the next arbitration slot.
+    EXPECT_TRUE(GTTCAN_sporadic_push(&sporadic, 42U, 4200U, 0U, 0U));
+    GTTCAN_transmit_next_frame(&ttcan);
+    EXPECT_EQ(calls.call_count, 5);
+    EXPECT_EQ(transmitted_id, GTTCAN_CAN_ID(3U, 42U));
+    EXPECT_EQ(calls.data, 4200U);
+    EXPECT_EQ(ttcan.lastTransmitIndex, 3U);
+
+    // After losing arbitration, the winning frame is in the same slot
+    // and the message is retried in the next arbitration slot.
+    GTTCAN_transmit_result(&ttcan, transmitted_id, false, 10U);
+    EXPECT_EQ(GTTCAN_get_slots_since_last_transmit(&ttcan, 3U), 0U);
+    EXPECT_EQ(GTTCAN_get_slots_since_last_transmit(&ttcan, 0U), 1U);
+    GTTCAN_transmit_next_frame(&ttcan); // reference frame
+    GTTCAN_transmit_next_frame(&ttcan);
+    EXPECT_EQ(transmitted_id, GTTCAN_CAN_ID(1U, 42U));
+    GTTCAN_transmit_result(&ttcan, transmitted_id, true, 30U);
+    EXPECT_EQ(sporadic.stats[0].sent, 1U);
+    EXPECT_EQ(sporadic.stats[0].lost, 1U);
+    EXPECT_EQ(sporadic.stats[0].latency_sum, 30U);
+    EXPECT_FALSE(GTTCAN_sporadic_begin(&sporadic, 3U, &transmitted_id, &calls.data));
+    EXPECT_TRUE(GTTCAN_set_sporadic(&ttcan, NULL));
+#if !GTTCAN_EMBEDDED_SCHEDULE
+    EXPECT_EQ(ttcan.node_schedule->localScheduleLength, 0U);
+    EXPECT_TRUE(load_schedule(schedule_blob, size));
+#endif
+    EXPECT_EQ(ttcan.node_schedule->localScheduleLength, 1U);
+}
+
+static uint32_t armed_delay;
+
+static void record_delay(uint32_t delay, void *context)
+{
+    (void)context;
+    armed_delay = delay;
+}
+
+static void test_schedule_switch(void)
+{
+    static gttcan_staging_t staging;
+    static uint8_t next_blob[64];
+    callback_data_t calls = { 0 };
+    ttcan.transmit_callback = record_transmit;
+    ttcan.set_timer_int_callback = record_delay;
+    ttcan.context_pointer = &calls;
+
+    // The time master stages a schedule in which it also owns slots 1 and 3.
+    EXPECT_TRUE(load_test_schedule());
+    const uint32_t next_entries[] = { (LOCAL_NODE << 16U) | 0U, (LOCAL_NODE << 16U) | 7U, (8U << 16U) | 3U, (LOCAL_NODE << 16U) | 9U };
+    const uint32_t size = GTTCAN_pack_schedule(next_blob, sizeof(next_blob), next_entries, 4U, 0U);
+    EXPECT_FALSE(stage_schedule(next_blob, size));
+    GTTCAN_staging_init(&staging);
+    GTTCAN_set_staging(&ttcan, &staging);
+    EXPECT_FALSE(GTTCAN_request_schedule_switch(&ttcan));
+    EXPECT_FALSE(stage_schedule(next_blob, GTTCAN_SCHEDULE_HEADER_SIZE));
+    EXPECT_TRUE(stage_schedule(next_blob, size));
+    EXPECT_FALSE(stage_schedule(next_blob, size)); // already staged
+    EXPECT_EQ(ttcan.node_schedule->localScheduleLength, 1U);
+
+    // Without a request, the start of schedule keeps the current schedule.
+    GTTCAN_start(&ttcan);
+    EXPECT_EQ(calls.data & GTTCAN_SCHEDULE_SWITCH_FLAG, 0U);
+    EXPECT_EQ(armed_delay, 4U * SLOT_DURATION);
+    EXPECT_TRUE(GTTCAN_request_schedule_switch(&ttcan));
+    GTTCAN_transmit_next_frame(&ttcan);
+    EXPECT_TRUE((calls.data & GTTCAN_SCHEDULE_SWITCH_FLAG) != 0U);
+    EXPECT_EQ(ttcan.node_schedule->localScheduleLength, 3U);
+    EXPECT_EQ(armed_delay, SLOT_DURATION);
+    EXPECT_EQ(staging.switches, 1U);
+    EXPECT_EQ(GTTCAN_get_schedule_entry(&ttcan, 3U), (LOCAL_NODE << 16U) | 9U);
+    GTTCAN_transmit_next_frame(&ttcan);
+    EXPECT_EQ(calls.call_count, 3);
+    EXPECT_EQ(armed_delay, 2U * SLOT_DURATION);
+
+    // A receiver switches with the flagged start of schedule and stays active.
+    EXPECT_TRUE(load_test_schedule());
+    const uint32_t remote_entries[] = { (REMOTE_NODE << 16U) | 0U, (8U << 16U) | 3U, (LOCAL_NODE << 16U) | 5U, (9U << 16U) | 4U };
+    const uint32_t remote_size = GTTCAN_pack_schedule(next_blob, sizeof(next_blob), remote_entries, 4U, 0U);
+    EXPECT_TRUE(stage_schedule(next_blob, remote_size));
+    GTTCAN_process_frame(&ttcan, 0U, schedule_index(0U), 0x8000000000000000ULL);
+    EXPECT_TRUE(ttcan.isActive);
+    EXPECT_EQ(ttcan.node_schedule->localScheduleLength, 1U);
+    EXPECT_EQ(ttcan.node_schedule->localScheduleSlotID[0], 0U);
+    GTTCAN_process_frame(&ttcan, 0U, schedule_index(0U), 0x8000000000000000ULL | GTTCAN_SCHEDULE_SWITCH_FLAG | 1000U);
+    EXPECT_TRUE(ttcan.isActive);
+    EXPECT_FALSE(ttcan.transmitted);
+    EXPECT_EQ(ttcan.node_schedule->localScheduleSlotID[0], 2U);
+    EXPECT_EQ(ttcan.localScheduleIndex, 0U);
+    EXPECT_EQ(armed_delay, 2U * SLOT_DURATION);
+    EXPECT_EQ(staging.switches, 2U);
+    EXPECT_EQ(GTTCAN_ATOMIC_LOAD(staging.state, acquire), GTTCAN_STAGING_EMPTY);
+
+    // Without a staged schedule, the flag deactivates the node until a schedule is loaded.
+    GTTCAN_process_frame(&ttcan, 0U, schedule_index(0U), 0x8000000000000000ULL | GTTCAN_SCHEDULE_SWITCH_FLAG);
+    EXPECT_FALSE(ttcan.isActive);
+    EXPECT_TRUE(ttcan.scheduleStale);
+    GTTCAN_process_frame(&ttcan, 0U, schedule_index(0U), 0x8000000000000000ULL);
+    EXPECT_FALSE(ttcan.isActive);
+    EXPECT_TRUE(load_test_schedule());
+    GTTCAN_process_frame(&ttcan, 0U, schedule_index(0U), 0x8000000000000000ULL);
+    EXPECT_TRUE(ttcan.isActive);
+    GTTCAN_set_staging(&ttcan, NULL);
+}
+
+/// A running hash of the callback calls of an instance.
+typedef struct call_log_s {
+    uint64_t hash;
+    int count;
+} call_log_t;
+
+static void log_call(call_log_t *log, uint64_t value)
+{
+    log->hash = (log->hash * 31U) + value;
+    log->count++;
+}
+
+static void log_transmit(uint32_t id, uint64_t data, void *context) { log_call(context, id ^ data); }
+static void log_timer(uint32_t delay, void *context) { log_call(context, delay); }
+static void log_write(uint16_t id, uint64_t value, void *context) { log_call(context, id ^ value); }
+
+static void test_shared_node_schedule(void)
+{
+    static gttcan_node_schedule_t node_schedule;
+    static gttcan_node_schedule_t next_schedule;
+    static gttcan_t instances[8];
+    static gttcan_t other;
+    static gttcan_sporadic_t sporadic;
+    static gttcan_staging_t staging;
+    static uint8_t next_blob[64];
+    call_log_t logs[8] = { { 0U, 0 } };
+    call_log_t embedded_log = { 0U, 0 };
+    const uint32_t entries[] = { (LOCAL_NODE << 16U) | 0U, (10U << 16U) | 5U, (8U << 16U) | 3U, (LOCAL_NODE << 16U) | 4U };
+    const uint32_t size = GTTCAN_pack_schedule(schedule_blob, sizeof(schedule_blob), entries, 4U, 0U);
+    EXPECT_FALSE(GTTCAN_build_node_schedule(&node_schedule, schedule_blob, GTTCAN_SCHEDULE_HEADER_SIZE, LOCAL_NODE, false));
+    EXPECT_TRUE(GTTCAN_build_node_schedule(&node_schedule, schedule_blob, size, LOCAL_NODE, false));
+    EXPECT_EQ(node_schedule.localScheduleLength, 2U);
+    EXPECT_EQ(node_schedule.localScheduleSlotID[1], 3U);
+
+    // All instances reference the same node schedule.
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        GTTCAN_init(&instances[i], LOCAL_NODE, SLOT_DURATION, 1U, log_transmit, log_timer, read_zero, log_write, &logs[i]);
+        EXPECT_TRUE(GTTCAN_set_node_schedule(&instances[i], &node_schedule));
+        EXPECT_TRUE(instances[i].node_schedule == &node_schedule);
+        EXPECT_EQ(GTTCAN_get_schedule_entry(&instances[i], 3U), (LOCAL_NODE << 16U) | 4U);
+    }
+    // Other node IDs, and nodes with arbitration slots, need their own.
+    GTTCAN_init(&other, REMOTE_NODE, SLOT_DURATION, 1U, ignore_transmit, ignore_timer, read_zero, ignore_write, NULL);
+    EXPECT_FALSE(GTTCAN_set_node_schedule(&other, &node_schedule));
+    GTTCAN_init(&other, LOCAL_NODE, SLOT_DURATION, 1U, ignore_transmit, ignore_timer, read_zero, ignore_write, NULL);
+    GTTCAN_sporadic_init(&sporadic);
+    EXPECT_TRUE(GTTCAN_set_sporadic(&other, &sporadic));
+    EXPECT_FALSE(GTTCAN_set_node_schedule(&other, &node_schedule));
+
+    // They behave like an instance with the schedule embedded.
+    ttcan.transmit_callback = log_transmit;
+    ttcan.set_timer_int_callback = log_timer;
+    ttcan.write_value = log_write;
+    ttcan.context_pointer = &embedded_log;
+    EXPECT_TRUE(load_schedule(schedule_blob, size));
+    GTTCAN_start(&ttcan);
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        GTTCAN_start(&instances[i]);
+    }
+    for (uint32_t round = 0U; round < 3U; round++)
+    {
+        GTTCAN_process_frame(&ttcan, SLOT_DURATION + round, GTTCAN_CAN_ID(1U, 5U), round);
+        GTTCAN_process_frame(&ttcan, (2U * SLOT_DURATION) - round, GTTCAN_CAN_ID(2U, 3U), round);
+        GTTCAN_transmit_next_frame(&ttcan);
+        GTTCAN_transmit_next_frame(&ttcan);
+        for (uint32_t i = 0U; i < 8U; i++)
+        {
+            GTTCAN_process_frame(&instances[i], SLOT_DURATION + round, GTTCAN_CAN_ID(1U, 5U), round);
+            GTTCAN_process_frame(&instances[i], (2U * SLOT_DURATION) - round, GTTCAN_CAN_ID(2U, 3U), round);
+            GTTCAN_transmit_next_frame(&instances[i]);
+            GTTCAN_transmit_next_frame(&instances[i]);
+        }
+    }
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        EXPECT_EQ(logs[i].count, embedded_log.count);
+        EXPECT_TRUE(logs[i].hash == embedded_log.hash);
+    }
+
+    // A staged node schedule is referenced from the switch on.
+    const uint32_t next_entries[] = { (LOCAL_NODE << 16U) | 0U, (LOCAL_NODE << 16U) | 7U, (8U << 16U) | 3U, (LOCAL_NODE << 16U) | 9U };
+    const uint32_t next_size = GTTCAN_pack_schedule(next_blob, sizeof(next_blob), next_entries, 4U, 0U);
+    EXPECT_TRUE(GTTCAN_build_node_schedule(&next_schedule, next_blob, next_size, LOCAL_NODE, false));
+    EXPECT_FALSE(GTTCAN_stage_node_schedule(&instances[0], &next_schedule));
+    GTTCAN_staging_init(&staging);
+    GTTCAN_set_staging(&instances[0], &staging);
+    EXPECT_TRUE(GTTCAN_stage_node_schedule(&instances[0], &next_schedule));
+    EXPECT_TRUE(GTTCAN_request_schedule_switch(&instances[0]));
+    GTTCAN_transmit_next_frame(&instances[0]); // slot 3
+    EXPECT_TRUE(instances[0].node_schedule == &node_schedule);
+    GTTCAN_transmit_next_frame(&instances[0]); // slot 0
+    EXPECT_TRUE(instances[0].node_schedule == &next_schedule);
+    EXPECT_EQ(staging.switches, 1U);
+    EXPECT_TRUE(instances[1].node_schedule == &node_schedule);
+}
+
+static void record_values(uint16_t id, uint64_t value, void *context)
+{
+    callback_data_t * const calls = context;
+    EXPECT_EQ(id, (uint16_t)(calls->call_count + 3));
+    EXPECT_EQ(value, (uint64_t)(calls->call_count + 1));
+    calls->call_count++;
+}
+
+/// Moves the local reference to a fixed time, like a driver in its transmit callback.
+/// The scheduled frames of a round that the filters accept, as a bitmap of slots.
+static uint32_t accepted_slots(const uint32_t *entries, uint16_t length, const gttcan_filter_t *filters, uint32_t count)
+{
+    uint32_t slots = 0U;
+    for (uint16_t g = 0U; g < length; g++)
+    {
+        const uint32_t node = entries[g] >> 16U;
+        if ((node != 0U) && (node != GTTCAN_ARBITRATION_NODE) &&
+            GTTCAN_filters_accept(filters, count, GTTCAN_CAN_ID(g, entries[g] & 0xFFFFU)))
+        {
+            slots |= 1UL << g;
+        }
+    }
+    return slots;
+}
+
+static void test_acceptance_filters(void)
+{
+    gttcan_filter_t filters[8];
+    static gttcan_filter_workspace_t filter_workspace;
+    // Node 3 owns slots 2 and 10 and consumes data IDs 13 and 18, and 42 in the arbitration slots 6 and 14.
+    const uint32_t entries[] = {
+        (1U << 16U) | 0U, (2U << 16U) | 10U, (3U << 16U) | 11U, (4U << 16U) | 12U,
+        (2U << 16U) | 13U, (4U << 16U) | 14U, (GTTCAN_ARBITRATION_NODE << 16U), (5U << 16U) | 15U,
+        (1U << 16U) | 0U, (2U << 16U) | 16U, (3U << 16U) | 17U, (4U << 16U) | 18U,
+        0U, (5U << 16U) | 19U, (GTTCAN_ARBITRATION_NODE << 16U), (2U << 16U) | 20U
+    };
+    const uint16_t consumed[] = { 18U, 13U, 42U, 13U };
+    GTTCAN_init(&ttcan, 3U, SLOT_DURATION, 16U, ignore_transmit, ignore_timer, read_zero, ignore_write, &ttcan);
+    EXPECT_EQ(GTTCAN_build_filters(&ttcan, consumed, 4U, 0U, filters, 8U, &filter_workspace), 0U);
+    const uint32_t size = GTTCAN_pack_schedule(schedule_blob, sizeof(schedule_blob), entries, 16U, 0U);
+    EXPECT_TRUE(load_schedule(schedule_blob, size));
+    EXPECT_EQ(GTTCAN_build_filters(&ttcan, consumed, 4U, 0U, filters, 0U, &filter_workspace), 0U);
+
+    // One filter per frame: the reference frames and the consumed data
+    // IDs are enough samples to discard one outlier at each end.
+    EXPECT_EQ(GTTCAN_build_filters(&ttcan, consumed, 4U, 0U, filters, 8U, &filter_workspace), 5U);
+    EXPECT_EQ(accepted_slots(entries, 16U, filters, 5U), (1UL << 0U) | (1UL << 4U) | (1UL << 8U) | (1UL << 11U));
+    EXPECT_TRUE(GTTCAN_filters_accept(filters, 5U, GTTCAN_CAN_ID(6U, 42U)));
+    EXPECT_TRUE(GTTCAN_filters_accept(filters, 5U, GTTCAN_CAN_ID(14U, 42U)));
+    EXPECT_FALSE(GTTCAN_filters_accept(filters, 5U, GTTCAN_CAN_ID(14U, 43U)));
+    EXPECT_FALSE(GTTCAN_filters_accept(filters, 5U, 0x10000000U | GTTCAN_CAN_ID(0U, 0U)));
+
+    // Further samples come from node 5, which was not heard yet, then in slot order.
+    EXPECT_EQ(GTTCAN_build_filters(&ttcan, consumed, 4U, 5U, filters, 8U, &filter_workspace), 6U);
+    EXPECT_EQ(accepted_slots(entries, 16U, filters, 6U), (1UL << 0U) | (1UL << 4U) | (1UL << 7U) | (1UL << 8U) | (1UL << 11U));
+    EXPECT_TRUE(GTTCAN_set_fta(&ttcan, 3U, 1U));
+    EXPECT_EQ(GTTCAN_build_filters(&ttcan, consumed, 4U, 0U, filters, 8U, &filter_workspace), 8U);
+    EXPECT_EQ(accepted_slots(entries, 16U, filters, 8U),
+              (1UL << 0U) | (1UL << 1U) | (1UL << 3U) | (1UL << 4U) | (1UL << 7U) | (1UL << 8U) | (1UL << 11U));
+    EXPECT_TRUE(GTTCAN_set_fta(&ttcan, 1U, 1U));
+
+    // With fewer filter banks, the needed frames are still accepted, at the cost of a few more.
+    const uint32_t needed = (1UL << 0U) | (1UL << 4U) | (1UL << 8U) | (1UL << 11U);
+    const uint32_t expected[] = { 0U, 0xAFBFU, 0x09BFU, 0x0913U, 0x0911U };
+    for (uint32_t banks = 1U; banks <= 4U; banks++)
+    {
+        EXPECT_EQ(GTTCAN_build_filters(&ttcan, consumed, 4U, 0U, filters, banks, &filter_workspace), banks);
+        const uint32_t slots = accepted_slots(entries, 16U, filters, banks);
+        EXPECT_EQ(slots & needed, needed);
+        EXPECT_EQ(slots, expected[banks]);
+        EXPECT_TRUE(GTTCAN_filters_accept(filters, banks, GTTCAN_CAN_ID(6U, 42U)));
+        EXPECT_TRUE(GTTCAN_filters_accept(filters, banks, GTTCAN_CAN_ID(14U, 42U)));
+    }
+}
+
+static void transmit_at_reference(uint32_t id, uint64_t data, void *context)
+{
+    (void)id;
+    (void)data;
+    GTTCAN_set_local_reference(context, 0x7000U);
+}
+
+static uint64_t read_network_time(uint16_t id, void *context) { (void)id; (void)context; return 12U; }
+
+static void test_global_clock(void)
+{
+    gttcan_clock_t global_clock;
+    GTTCAN_clock_init(&global_clock);
+    EXPECT_TRUE(load_test_schedule());
+    EXPECT_EQ(GTTCAN_get_global_time(&ttcan, 0U), 0U);
+    GTTCAN_set_global_clock(&ttcan, &global_clock);
+    EXPECT_EQ(GTTCAN_get_global_time(&ttcan, 0U), 0U); // no reference frame yet
+
+    // The anchor is the start of the received frame on the local clock,
+    // which may wrap before or after it.
+    GTTCAN_set_local_reference(&ttcan, 0xFFFFFF00U);
+    GTTCAN_process_frame(&ttcan, 0x80U, schedule_index(0U), 0x8000000000000000ULL | 1000000U);
+    gttcan_clock_anchor_t anchor;
+    GTTCAN_clock_read(&global_clock, &anchor);
+    EXPECT_EQ(anchor.time, 1000000U);
+    EXPECT_EQ(anchor.local, 0xFFFFFF80U);
+    EXPECT_EQ(anchor.drift, 0);
+    EXPECT_EQ(anchor.generation, 1U);
+    EXPECT_EQ(GTTCAN_get_global_time(&ttcan, 0x100U), 1000384U);
+    EXPECT_EQ(GTTCAN_get_global_time(&ttcan, 0xFFFFFF70U), 999984U); // read just before the anchor
+
+    // With the servo, the time since the anchor is scaled by the drift
+    // estimate: slots shortened by 0.1 % make the local clock 1/999 slow.
+    GTTCAN_set_clock_servo(&ttcan, true, 1U, 0U, 0U);
+    ttcan.servo.rate_correction = (int32_t)(((uint64_t)SLOT_DURATION << GTTCAN_SERVO_FRACTION_BITS) / 1000U);
+    GTTCAN_process_frame(&ttcan, 0x80U, schedule_index(0U), 0x8000000000000000ULL | 2000000U);
+    const uint64_t global = GTTCAN_get_global_time(&ttcan, 0xFFFFFF80U + 999000U);
+    EXPECT_TRUE((global >= 2999999U) && (global <= 3000000U));
+
+    // The network time wraps at 62 bits.
+    anchor.time = 0x3FFFFFFFFFFFFFFFULL;
+    anchor.drift = 0;
+    EXPECT_EQ(GTTCAN_clock_extrapolate(&anchor, anchor.local + 2U), 1U);
+
+    // The time master anchors its own reference frames, without drift.
+    ttcan.transmit_callback = transmit_at_reference;
+    ttcan.read_value = read_network_time;
+    ttcan.context_pointer = &ttcan;
+    GTTCAN_start(&ttcan);
+    EXPECT_EQ(GTTCAN_get_global_time(&ttcan, 0x7000U + 100U), 112U);
+    GTTCAN_clock_read(&global_clock, &anchor);
+    EXPECT_EQ(anchor.drift, 0);
+    EXPECT_EQ(anchor.generation, 3U);
+}
+
+static void test_rx_ring(void)
+{
+    static gttcan_rx_ring_t ring;
+    GTTCAN_rx_ring_init(&ring);
+    gttcan_rx_frame_t frame = { 0U, 0U, 0U };
+    EXPECT_FALSE(GTTCAN_rx_ring_pop(&ring, &frame));
+    // Fill, overflow and empty the ring twice to wrap around.
+    for (uint32_t round = 0U; round < 2U; round++)
+    {
+        for (uint32_t i = 0U; i < GTTCAN_RX_RING_SIZE; i++)
+        {
+            const gttcan_rx_frame_t entry = { i, i + 1U, (uint64_t)i << 32U };
+            EXPECT_TRUE(GTTCAN_rx_ring_push(&ring, &entry));
+        }
+        EXPECT_FALSE(GTTCAN_rx_ring_push(&ring, &frame));
+        EXPECT_EQ(ring.dropped, round + 1U);
+        for (uint32_t i = 0U; i < GTTCAN_RX_RING_SIZE; i++)
+        {
+            EXPECT_TRUE(GTTCAN_rx_ring_pop(&ring, &frame));
+            EXPECT_EQ(frame.timestamp, i);
+            EXPECT_EQ(frame.id, i + 1U);
+            EXPECT_EQ(frame.data, (uint64_t)i << 32U);
+        }
+        EXPECT_FALSE(GTTCAN_rx_ring_pop(&ring, &frame));
+    }
+}
+
+static void test_deferred_delivery(void)
+{
+    static gttcan_rx_ring_t ring;
+    callback_data_t calls = { 0 };
+    GTTCAN_rx_ring_init(&ring);
+    EXPECT_TRUE(load_test_schedule());
+    ttcan.transmitted = true;
+    ttcan.write_value = record_values;
+    ttcan.context_pointer = &calls;
+    GTTCAN_set_rx_ring(&ttcan, &ring);
+    GTTCAN_process_frame(&ttcan, SLOT_DURATION + 1U, schedule_index(1U) | 3U, 1U);
+    GTTCAN_process_frame(&ttcan, (2U * SLOT_DURATION) + 1U, schedule_index(2U) | 4U, 2U);
+    // The clock synchronisation happens immediately, the whiteboard write later.
+    EXPECT_EQ(ttcan.slots_accumulated, 2U);
+    EXPECT_EQ(ttcan.error_accumulator, -2);
+    EXPECT_EQ(calls.call_count, 0);
+    EXPECT_EQ(GTTCAN_drain_rx_ring(&ttcan), 2U);
+    EXPECT_EQ(calls.call_count, 2);
+    EXPECT_EQ(GTTCAN_drain_rx_ring(&ttcan), 0U);
+    // Without a ring, values are written directly again.
+    GTTCAN_set_rx_ring(&ttcan, NULL);
+    GTTCAN_process_frame(&ttcan, 3U * SLOT_DURATION, schedule_index(3U) | 5U, 3U);
+    EXPECT_EQ(calls.call_count, 3);
+}
+
+static void test_whiteboard(void)
+{
+    static gttcan_whiteboard_t whiteboard;
+    gttcan_whiteboard_value_t value = { 1U, 1U, 1U };
+    GTTCAN_whiteboard_init(&whiteboard);
+    EXPECT_TRUE(GTTCAN_whiteboard_read(&whiteboard, 5U, &value));
+    EXPECT_EQ(value.value, 0U);
+    EXPECT_EQ(value.generation, 0U);
+    EXPECT_TRUE(GTTCAN_whiteboard_write(&whiteboard, 5U, 0x0123456789ABCDEFULL, 100U));
+    EXPECT_TRUE(GTTCAN_whiteboard_write(&whiteboard, 5U, 0xFEDCBA9876543210ULL, 200U));
+    EXPECT_TRUE(GTTCAN_whiteboard_read(&whiteboard, 5U, &value));
+    EXPECT_EQ(value.value, 0xFEDCBA9876543210ULL);
+    EXPECT_EQ(value.timestamp, 200U);
+    EXPECT_EQ(value.generation, 2U);
+    EXPECT_EQ(GTTCAN_whiteboard_value(&whiteboard, 4U), 0U);
+    // Data IDs outside the whiteboard are ignored.
+    EXPECT_FALSE(GTTCAN_whiteboard_write(&whiteboard, (uint16_t)GTTCAN_WHITEBOARD_SIZE, 1U, 0U));
+    EXPECT_FALSE(GTTCAN_whiteboard_read(&whiteboard, (uint16_t)GTTCAN_WHITEBOARD_SIZE, &value));
+    EXPECT_EQ(GTTCAN_whiteboard_value(&whiteboard, (uint16_t)GTTCAN_WHITEBOARD_SIZE), 0U);
+}
+
+static void test_whiteboard_transmit_receive(void)
+{
+    static gttcan_whiteboard_t whiteboard;
+    callback_data_t calls = { 0 };
+    gttcan_whiteboard_value_t value;
+    GTTCAN_whiteboard_init(&whiteboard);
+    EXPECT_TRUE(load_test_schedule());
+    ttcan.transmit_callback = record_transmit;
+    ttcan.write_value = record_write;
+    ttcan.context_pointer = &calls;
+    GTTCAN_set_whiteboard(&ttcan, &whiteboard);
+    // The local node transmits data ID 0 (the network time) from the whiteboard.
+    EXPECT_TRUE(GTTCAN_whiteboard_write(&whiteboard, 0U, 42U, 0U));
+    ttcan.isActive = true;
+    GTTCAN_transmit_next_frame(&ttcan);
+    EXPECT_EQ(calls.call_count, 1);
+    EXPECT_EQ(calls.data, 0x8000000000000000ULL | 42U);
+    // Received values are written to the whiteboard, not to write_value.
+    GTTCAN_process_frame(&ttcan, SLOT_DURATION + 1U, schedule_index(1U) | 5U, 7U);
+    EXPECT_EQ(calls.call_count, 1);
+    EXPECT_TRUE(GTTCAN_whiteboard_read(&whiteboard, 5U, &value));
+    EXPECT_EQ(value.value, 7U);
+    EXPECT_EQ(value.timestamp, SLOT_DURATION + 1U);
+    EXPECT_EQ(value.generation, 1U);
+    // With a receive ring, the value reaches the whiteboard when it is drained.
+    static gttcan_rx_ring_t ring;
+    GTTCAN_rx_ring_init(&ring);
+    GTTCAN_set_rx_ring(&ttcan, &ring);
+    GTTCAN_process_frame(&ttcan, (3U * SLOT_DURATION) + 2U, schedule_index(3U) | 4U, 9U);
+    EXPECT_EQ(GTTCAN_whiteboard_value(&whiteboard, 4U), 0U);
+    EXPECT_EQ(GTTCAN_drain_rx_ring(&ttcan), 1U);
+    EXPECT_TRUE(GTTCAN_whiteboard_read(&whiteboard, 4U, &value));
+    EXPECT_EQ(value.value, 9U);
+    EXPECT_EQ(value.timestamp, (3U * SLOT_DURATION) + 2U);
+    EXPECT_EQ(calls.call_count, 1);
+}
+
+/// The frames and payloads seen by the CAN FD callbacks.
+typedef struct fd_calls_s {
+    int transmits;
+    int writes;
+    uint32_t id;
+    uint16_t dataID;
+    uint8_t length;
+    uint8_t data[GTTCAN_FD_MAX_PAYLOAD];
+} fd_calls_t;
+
+static fd_calls_t fd_calls;
+
+static void record_fd_transmit(uint32_t id, const uint8_t *data, uint8_t length, void *context)
+{
+    (void)context;
+    fd_calls.transmits++;
+    fd_calls.id = id;
+    fd_calls.length = length;
+    memcpy(fd_calls.data, data, length);
+}
+
+static uint8_t read_ramp(uint16_t dataID, uint8_t *data, void *context)
+{
+    (void)context;
+    for (uint8_t i = 0U; i < 20U; i++)
+    {
+        data[i] = (uint8_t)(dataID + i);
+    }
+    return 20U;
+}
+
+static void record_fd_write(uint16_t dataID, const uint8_t *data, uint8_t length, void *context)
+{
+    (void)context;
+    fd_calls.writes++;
+    fd_calls.dataID = dataID;
+    fd_calls.length = length;
+    memcpy(fd_calls.data, data, length);
+}
+
+static void test_fd_transmit_receive(void)
+{
+    static gttcan_fd_t fd;
+    callback_data_t calls = { 0 };
+    memset(&fd_calls, 0, sizeof(fd_calls));
+    const uint32_t entries[] = { (LOCAL_NODE << 16U) | 0U, (LOCAL_NODE << 16U) | 5U, (REMOTE_NODE << 16U) | 6U, (REMOTE_NODE << 16U) | 7U };
+    const uint32_t size = GTTCAN_pack_schedule(schedule_blob, sizeof(schedule_blob), entries, 4U, 0U);
+    EXPECT_TRUE(load_schedule(schedule_blob, size));
+    ttcan.transmit_callback = record_transmit;
+    ttcan.read_value = read_twelve;
+    ttcan.write_value = record_write;
+    ttcan.context_pointer = &calls;
+    GTTCAN_fd_init(&fd, record_fd_transmit, read_ramp, record_fd_write, 2U);
+    GTTCAN_set_fd(&ttcan, &fd);
+    // The reference frame carries the network time in 8 bytes, MSB first.
+    GTTCAN_start(&ttcan);
+    EXPECT_EQ(fd_calls.transmits, 1);
+    EXPECT_EQ(fd_calls.id, GTTCAN_CAN_ID(0U, 0U));
+    EXPECT_EQ(fd_calls.length, 8U);
+    EXPECT_EQ(GTTCAN_fd_read_u64(fd_calls.data, fd_calls.length), 0x8000000000000000ULL | 12U);
+    EXPECT_EQ(calls.call_count, 1); // read_value, not transmit_callback
+    // Data frames are read with read_buffer.
+    GTTCAN_transmit_next_frame(&ttcan);
+    EXPECT_EQ(fd_calls.transmits, 2);
+    EXPECT_EQ(fd_calls.id, GTTCAN_CAN_ID(1U, 5U));
+    EXPECT_EQ(fd_calls.length, 20U);
+    EXPECT_EQ(fd_calls.data[0], 5U);
+    EXPECT_EQ(fd_calls.data[19], 24U);
+    EXPECT_EQ(calls.call_count, 1);
+    // Received data frames are passed to write_buffer.
+    uint8_t payload[GTTCAN_FD_MAX_PAYLOAD];
+    for (uint32_t i = 0U; i < GTTCAN_FD_MAX_PAYLOAD; i++)
+    {
+        payload[i] = (uint8_t)(0xFFU - i);
+    }
+    GTTCAN_process_fd_frame(&ttcan, SLOT_DURATION, GTTCAN_CAN_ID(2U, 6U), payload, 64U);
+    EXPECT_EQ(fd_calls.writes, 1);
+    EXPECT_EQ(fd_calls.dataID, 6U);
+    EXPECT_EQ(fd_calls.length, 64U);
+    EXPECT_EQ(fd_calls.data[63], 0xC0U);
+    EXPECT_EQ(calls.call_count, 1);
+    // Reference frames update the network time, with the CAN FD frame duration as exact offset.
+    const uint32_t bit_time = 10U;
+    GTTCAN_set_exact_slot_offset(&ttcan, bit_time, 0U);
+    GTTCAN_fd_write_u64(payload, 0x8000000000000000ULL | 1000000U);
+    gttcan_fd_frame_bits_t bits;
+    (void)GTTCAN_calculate_fd_frame_bits(GTTCAN_CAN_ID(0U, 0U), payload, 8U, true, &bits);
+    GTTCAN_process_fd_frame(&ttcan, 4U * SLOT_DURATION, GTTCAN_CAN_ID(0U, 0U), payload, 8U);
+    EXPECT_EQ(calls.call_count, 2);
+    EXPECT_EQ(calls.id, NETWORK_TIME_SLOT);
+    EXPECT_EQ(calls.data, 1000000U + GTTCAN_fd_frame_duration(&bits, bit_time, 2U));
+    EXPECT_TRUE(GTTCAN_fd_frame_duration(&bits, bit_time, 2U) < (GTTCAN_calculate_fd_frame_bits(GTTCAN_CAN_ID(0U, 0U), payload, 8U, false, &bits) * bit_time));
+    // The cached identifier and control field serve other payloads, and
+    // are rebuilt when the bit rate switch is turned off.
+    EXPECT_EQ(ttcan.reference_fd_frame_prefixes[0].id, GTTCAN_CAN_ID(0U, 0U));
+    const uint64_t stuffed = 0x8000000000000000ULL | 0x0F0F0F0FU;
+    GTTCAN_fd_write_u64(payload, stuffed);
+    (void)GTTCAN_calculate_fd_frame_bits(GTTCAN_CAN_ID(0U, 0U), payload, 8U, true, &bits);
+    EXPECT_EQ(GTTCAN_reference_frame_offset(&ttcan, GTTCAN_CAN_ID(0U, 0U), stuffed), GTTCAN_fd_frame_duration(&bits, bit_time, 2U));
+    fd.data_bit_time = 0U;
+    (void)GTTCAN_calculate_fd_frame_bits(GTTCAN_CAN_ID(0U, 0U), payload, 8U, false, &bits);
+    EXPECT_EQ(GTTCAN_reference_frame_offset(&ttcan, GTTCAN_CAN_ID(0U, 0U), stuffed), GTTCAN_fd_frame_duration(&bits, bit_time, 0U));
+    EXPECT_EQ(ttcan.reference_fd_frame_prefixes[0].brs, 0U);
+    fd.data_bit_time = 2U;
+    // Without the interface, classic frames are sent again.
+    GTTCAN_set_fd(&ttcan, (gttcan_fd_t *)0);
+    GTTCAN_start(&ttcan);
+    EXPECT_EQ(calls.call_count, 4);
+    EXPECT_EQ(fd_calls.transmits, 2);
+}
+
+static void test_stats(void)
+{
+    static gttcan_stats_t stats;
+    gttcan_stats_snapshot_t snapshot;
+    GTTCAN_stats_init(&stats);
+    GTTCAN_set_stats(&ttcan, &stats);
+    EXPECT_TRUE(load_test_schedule());
+    ttcan.isActive = true;
+    GTTCAN_transmit_next_frame(&ttcan);
+    GTTCAN_process_frame(&ttcan, SLOT_DURATION + 1U, schedule_index(1U) | 5U, 0U);
+    GTTCAN_process_frame(&ttcan, (3U * SLOT_DURATION) + 8U, schedule_index(3U) | 4U, 0U); // slot 2 missed
+    GTTCAN_process_frame(&ttcan, 9U * SLOT_DURATION, schedule_index(9U) | 4U, 0U);        // invalid index
+    GTTCAN_process_frame(&ttcan, 4U * SLOT_DURATION, schedule_index(0U), 0x8000000000000000ULL);
+    EXPECT_TRUE(GTTCAN_stats_snapshot(&stats, &snapshot));
+    EXPECT_EQ(snapshot.frames_transmitted, 1U);
+    EXPECT_EQ(snapshot.frames_received, 3U);
+    EXPECT_EQ(snapshot.reference_frames, 1U);
+    EXPECT_EQ(snapshot.invalid_frames, 1U);
+    EXPECT_EQ(snapshot.out_of_sequence, 1U);
+    EXPECT_EQ(snapshot.error_min, -8);
+    EXPECT_EQ(snapshot.error_max, 0);
+    EXPECT_EQ(snapshot.error_histogram[0], 1U);
+    EXPECT_EQ(snapshot.error_histogram[1], 1U);
+    EXPECT_EQ(snapshot.error_histogram[4], 1U);
+    // The errors -1, -8 and 0 without the outliers -8 and 0.
+    EXPECT_EQ(snapshot.fta_results, 1U);
+    EXPECT_EQ(snapshot.fta_last, -1);
+    EXPECT_EQ(snapshot.rearms, 1U);
+    EXPECT_EQ(snapshot.rearm_delta_last, 0);
+    EXPECT_EQ(GTTCAN_stats_histogram_bin(3), 2U);
+    EXPECT_EQ(GTTCAN_stats_histogram_bin(-4), 3U);
+    EXPECT_EQ(GTTCAN_stats_histogram_bin(INT32_MIN), GTTCAN_STATS_HISTOGRAM_BINS - 1U);
+    // Detached: no further updates.
+    GTTCAN_set_stats(&ttcan, NULL);
+    GTTCAN_process_frame(&ttcan, SLOT_DURATION, schedule_index(1U) | 5U, 0U);
+    EXPECT_TRUE(GTTCAN_stats_snapshot(&stats, &snapshot));
+    EXPECT_EQ(snapshot.frames_received, 3U);
+}
+
+#if GTTCAN_TRACE
+static void test_trace(void)
+{
+    static gttcan_trace_t trace;
+    static gttcan_trace_record_t records[GTTCAN_TRACE_SIZE];
+    static uint8_t blob[GTTCAN_TRACE_BLOB_SIZE(GTTCAN_TRACE_SIZE)];
+    uint32_t count = 0U;
+    uint32_t written = 0U;
+    GTTCAN_trace_init(&trace);
+    GTTCAN_set_trace(&ttcan, &trace);
+    EXPECT_TRUE(load_test_schedule());
+    ttcan.isActive = true;
+    GTTCAN_transmit_next_frame(&ttcan);
+    GTTCAN_process_frame(&ttcan, SLOT_DURATION + 1U, schedule_index(1U) | 5U, 0U);
+    GTTCAN_process_frame(&ttcan, 9U * SLOT_DURATION, schedule_index(9U) | 4U, 0U);
+    GTTCAN_process_frame(&ttcan, 4U * SLOT_DURATION, schedule_index(0U), 0x8000000000000000ULL);
+    EXPECT_EQ(trace.written, 4U);
+
+    const uint32_t size = GTTCAN_trace_serialize(&trace, blob, sizeof(blob));
+    EXPECT_EQ(size, GTTCAN_TRACE_BLOB_SIZE(4U));
+    EXPECT_EQ(GTTCAN_trace_serialize(&trace, blob, size - 1U), 0U);
+    EXPECT_TRUE(GTTCAN_trace_deserialize(blob, size, records, GTTCAN_TRACE_SIZE, &count, &written));
+    EXPECT_EQ(count, 4U);
+    EXPECT_EQ(written, 4U);
+    EXPECT_EQ(records[0].type, GTTCAN_TRACE_TRANSMIT);
+    EXPECT_EQ(records[0].flags, GTTCAN_TRACE_FLAG_REARM | GTTCAN_TRACE_FLAG_START | GTTCAN_TRACE_FLAG_ACTIVE);
+    EXPECT_EQ(records[0].timer, GLOBAL_SCHEDULE_LENGTH * SLOT_DURATION);
+    EXPECT_EQ(records[1].type, GTTCAN_TRACE_RECEIVE);
+    EXPECT_EQ(records[1].flags, GTTCAN_TRACE_FLAG_MEASURED | GTTCAN_TRACE_FLAG_ACTIVE);
+    EXPECT_EQ(records[1].current_time, SLOT_DURATION + 1U);
+    EXPECT_EQ(records[1].index, 1U);
+    EXPECT_EQ(records[1].slot_id, 5U);
+    EXPECT_EQ(records[1].error, -1);
+    EXPECT_EQ(records[2].type, GTTCAN_TRACE_INVALID);
+    EXPECT_EQ(records[2].index, 9U);
+    EXPECT_EQ(records[3].type, GTTCAN_TRACE_REFERENCE);
+    EXPECT_EQ(records[3].flags, GTTCAN_TRACE_FLAG_REARM | GTTCAN_TRACE_FLAG_MEASURED | GTTCAN_TRACE_FLAG_START | GTTCAN_TRACE_FLAG_ACTIVE);
+    EXPECT_EQ(records[3].fta, 0); // the mean of the errors -1 and 0, truncated
+    EXPECT_EQ(records[3].timer, GLOBAL_SCHEDULE_LENGTH * SLOT_DURATION);
+    // Too few records, a truncated blob or a wrong magic are rejected.
+    EXPECT_FALSE(GTTCAN_trace_deserialize(blob, size, records, 3U, &count, &written));
+    EXPECT_FALSE(GTTCAN_trace_deserialize(blob, size - 1U, records, GTTCAN_TRACE_SIZE, &count, &written));
+    blob[3] = 0U;
+    EXPECT_FALSE(GTTCAN_trace_deserialize(blob, size, records, GTTCAN_TRACE_SIZE, &count, &written));
+
+    // Once full, the oldest records are overwritten.
+    for (uint32_t i = 0U; i < GTTCAN_TRACE_SIZE; i++)
+    {
+        GTTCAN_process_frame(&ttcan, SLOT_DURATION, schedule_index(1U) | 5U, 0U);
+    }
+    EXPECT_EQ(GTTCAN_trace_serialize(&trace, blob, sizeof(blob)), sizeof(blob));
+    EXPECT_TRUE(GTTCAN_trace_deserialize(blob, sizeof(blob), records, GTTCAN_TRACE_SIZE, &count, &written));
+    EXPECT_EQ(count, GTTCAN_TRACE_SIZE);
+    EXPECT_EQ(written, GTTCAN_TRACE_SIZE + 4U);
+    EXPECT_EQ(records[0].type, GTTCAN_TRACE_RECEIVE);
+    EXPECT_EQ(records[GTTCAN_TRACE_SIZE - 1U].current_time, SLOT_DURATION);
+}
+#endif
+
+#ifdef HAVE_PTHREADS
+#define THREADED_ENTRIES 100000U
+
+static void *produce(void *context)
+{
+    gttcan_rx_ring_t * const ring = context;
+    for (uint32_t i = 0U; i < THREADED_ENTRIES; i++)
+    {
+        const gttcan_rx_frame_t entry = { i, ~i, ((uint64_t)i << 32U) | i };
+        while (!GTTCAN_rx_ring_push(ring, &entry))
+        {
+            (void)sched_yield(); // full, let the consumer catch up
+        }
+    }
+    return NULL;
+}
+
+static void test_rx_ring_threads(void)
+{
+    static gttcan_rx_ring_t ring;
+    GTTCAN_rx_ring_init(&ring);
+    pthread_t producer;
+    EXPECT_EQ(pthread_create(&producer, NULL, produce, &ring), 0);
+    uint32_t expected = 0U;
+    while (expected < THREADED_ENTRIES)
+    {
+        gttcan_rx_frame_t frame;
+        if (GTTCAN_rx_ring_pop(&ring, &frame))
+        {
+            // Resynchronise after a torn or reordered entry so the producer never blocks.
+            if ((frame.timestamp != expected) || (frame.id != ~expected) || (frame.data != (((uint64_t)expected << 32U) | expected)))
+            {
+                EXPECT_EQ(frame.timestamp, expected);
+                EXPECT_EQ(frame.id, ~expected);
+                EXPECT_EQ(frame.data, ((uint64_t)expected << 32U) | expected);
+                expected = frame.timestamp;
+            }
+            expected++;
+        }
+        else
+        {
+            (void)sched_yield();
+        }
+    }
+    EXPECT_EQ(pthread_join(producer, NULL), 0);
+    EXPECT_EQ(expected, THREADED_ENTRIES);
+}
+
+static gttcan_whiteboard_t shared_whiteboard;
+
+/// Writes values whose halves must always match.
+static void *update_whiteboard(void *context)
+{
+    (void)context;
+    for (uint32_t i = 1U; i <= THREADED_ENTRIES; i++)
+    {
+        (void)GTTCAN_whiteboard_write(&shared_whiteboard, 1U, ((uint64_t)i << 32U) | i, i);
+    }
+    return NULL;
+}
+
+static void test_whiteboard_threads(void)
+{
+    GTTCAN_whiteboard_init(&shared_whiteboard);
+    pthread_t writer;
+    EXPECT_EQ(pthread_create(&writer, NULL, update_whiteboard, NULL), 0);
+    uint32_t torn = 0U;
+    uint32_t last_generation = 0U;
+    gttcan_whiteboard_value_t value = { 0U, 0U, 0U };
+    while (value.generation < THREADED_ENTRIES)
+    {
+        (void)GTTCAN_whiteboard_read(&shared_whiteboard, 1U, &value);
+        if (((value.value >> 32U) != (value.value & 0xFFFFFFFFU)) || (value.timestamp != (uint32_t)value.value)
+            || (value.generation < last_generation))
+        {
+            torn++;
+        }
+        last_generation = value.generation;
+    }
+    EXPECT_EQ(pthread_join(writer, NULL), 0);
+    EXPECT_EQ(torn, 0U);
+    EXPECT_EQ(value.value, ((uint64_t)THREADED_ENTRIES << 32U) | THREADED_ENTRIES);
+}
+
+static gttcan_clock_t shared_clock;
+
+/// Anchors network time (i << 32) | i at local time i, so every anchor extrapolates to the same line.
+static void *update_clock(void *context)
+{
+    (void)context;
+    for (uint32_t i = 1U; i <= THREADED_ENTRIES; i++)
+    {
+        GTTCAN_clock_write(&shared_clock, ((uint64_t)i << 32U) | i, i, 0);
+    }
+    return NULL;
+}
+
+static void test_clock_threads(void)
+{
+    GTTCAN_clock_init(&shared_clock);
+    pthread_t writer;
+    EXPECT_EQ(pthread_create(&writer, NULL, update_clock, NULL), 0);
+    uint32_t torn = 0U;
+    uint32_t last_generation = 0U;
+    gttcan_clock_anchor_t anchor = { 0U, 0U, 0, 0U };
+    while (anchor.generation < THREADED_ENTRIES)
+    {
+        GTTCAN_clock_read(&shared_clock, &anchor);
+        if (((anchor.time >> 32U) != (anchor.time & 0xFFFFFFFFU)) || (anchor.local != (uint32_t)anchor.time)
+            || (anchor.generation < last_generation) || (GTTCAN_clock_extrapolate(&anchor, anchor.local + 1U) != (anchor.time + 1U)))
+        {
+            torn++;
+        }
+        last_generation = anchor.generation;
+    }
+    EXPECT_EQ(pthread_join(writer, NULL), 0);
+    EXPECT_EQ(torn, 0U);
+}
+
+static gttcan_stats_t shared_stats;
+
+/// Records frames in schedule order, each with a measured error.
+static void *update_stats(void *context)
+{
+    (void)context;
+    for (uint32_t i = 0U; i < THREADED_ENTRIES; i++)
+    {
+        GTTCAN_stats_record_frame(&shared_stats, (uint16_t)(i % GLOBAL_SCHEDULE_LENGTH), GLOBAL_SCHEDULE_LENGTH,
+                                  false, true, (int32_t)(i & 255U) - 128);
+    }
+    return NULL;
+}
+
+static void test_stats_threads(void)
+{
+    GTTCAN_stats_init(&shared_stats);
+    pthread_t writer;
+    EXPECT_EQ(pthread_create(&writer, NULL, update_stats, NULL), 0);
+    uint32_t inconsistent = 0U;
+    gttcan_stats_snapshot_t snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    while (snapshot.frames_received < THREADED_ENTRIES)
+    {
+        if (!GTTCAN_stats_snapshot(&shared_stats, &snapshot))
+        {
+            (void)sched_yield();
+            continue;
+        }
+        uint32_t histogram = 0U;
+        for (uint32_t i = 0U; i < GTTCAN_STATS_HISTOGRAM_BINS; i++)
+        {
+            histogram += snapshot.error_histogram[i];
+        }
+        if ((histogram != snapshot.frames_received) || (snapshot.out_of_sequence != 0U))
+        {
+            inconsistent++;
+        }
+    }
+    EXPECT_EQ(pthread_join(writer, NULL), 0);
+    EXPECT_EQ(inconsistent, 0U);
+    EXPECT_EQ(snapshot.error_min, -128);
+    EXPECT_EQ(snapshot.error_max, 127);
+}
+#endif
+
+static void test_can_id(void)
+{
+    const uint32_t id = GTTCAN_CAN_ID(GTTCAN_INDEX_MASK, GTTCAN_DATAID_MASK);
+    EXPECT_TRUE(id <= 0x1FFFFFFFU);
+    EXPECT_EQ(GTTCAN_CAN_ID_INDEX(id), GTTCAN_INDEX_MASK);
+    EXPECT_EQ(GTTCAN_CAN_ID_DATAID(id), GTTCAN_DATAID_MASK);
+    EXPECT_EQ(GTTCAN_CAN_ID_INDEX(GTTCAN_CAN_ID(3U, 7U)), 3U);
+    EXPECT_EQ(GTTCAN_CAN_ID_DATAID(GTTCAN_CAN_ID(3U, 7U)), 7U);
+}
+
+static void test_bit_stuffing(void)
+{
+    const uint8_t unstuffed[8] = { 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55 };
+    const uint8_t zeroes[8] = { 0 };
+    const uint8_t ones[8] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    const uint8_t partially_stuffed[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    EXPECT_EQ(GTTCAN_calculate_stuffing_bits(unstuffed, 8U), 0U);
+    EXPECT_EQ(GTTCAN_calculate_stuffing_bits(zeroes, 8U), 64U / 5U);
+    EXPECT_EQ(GTTCAN_calculate_stuffing_bits(ones, 8U), 64U / 5U);
+    EXPECT_EQ(GTTCAN_calculate_stuffing_bits(partially_stuffed, 8U), 8U);
+}
+
+static void test_extended_frame_bits(void)
+{
+    const uint8_t zeroes[8] = { 0 };
+    gttcan_bitstream_t stream;
+    EXPECT_EQ(GTTCAN_serialise_extended_frame(0U, zeroes, 8U, &stream), 118U);
+    EXPECT_EQ(stream.length, 118U);
+    EXPECT_EQ(stream.bits[0] >> 60U, 0U); // SOF and leading identifier bits
+    EXPECT_EQ(GTTCAN_count_bitstream_stuffing_bits(&stream), 19U);
+    EXPECT_EQ(GTTCAN_calculate_extended_frame_bits(0U, zeroes, 8U), 147U);
+    EXPECT_EQ(GTTCAN_calculate_extended_frame_bits(0x1FFFFFFFU, zeroes, 0U), 71U);
+    const uint32_t frame_bits = GTTCAN_calculate_extended_frame_bits(schedule_index(1U) | DATA1, zeroes, 8U);
+    EXPECT_TRUE(frame_bits >= 128U);
+    EXPECT_TRUE(frame_bits <= (128U + (117U / 4U)));
+}
+
+static void test_extended_frame_max_bits(void)
+{
+    static const uint32_t ids[] = { 0U, 0x1FFFFFFFU, 0x0AAAAAAAU, 0x00040001U };
+    uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+    for (uint32_t i = 0U; i < (sizeof(ids) / sizeof(ids[0])); i++)
+    {
+        for (uint8_t length = 0U; length <= 8U; length++)
+        {
+            const uint32_t max_bits = GTTCAN_calculate_extended_frame_max_bits(ids[i], length);
+            EXPECT_TRUE(max_bits <= (64U + (8U * length) + ((53U + (8U * length)) / 4U))); // Davis et al. without interframe space
+            for (uint32_t sample = 0U; sample < 1000U; sample++)
+            {
+                random_state = (random_state * 6364136223846793005ULL) + 1442695040888963407ULL;
+                uint8_t payload[8];
+                for (uint32_t byte = 0U; byte < 8U; byte++)
+                {
+                    // Mostly runs of equal bits, which stuff the most.
+                    payload[byte] = ((random_state >> (60U - byte)) & 1U) ? (uint8_t)(random_state >> (8U * byte)) : (uint8_t)(0U - ((random_state >> byte) & 1U));
+                }
+                EXPECT_TRUE(GTTCAN_calculate_extended_frame_bits(ids[i], payload, length) <= max_bits);
+            }
+        }
+    }
+}
+
+static void test_fd_dlc(void)
+{
+    static const uint8_t lengths[16] = { 0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 12U, 16U, 20U, 24U, 32U, 48U, 64U };
+    for (uint8_t dlc = 0U; dlc < 16U; dlc++)
+    {
+        EXPECT_EQ(GTTCAN_fd_dlc_to_length(dlc), lengths[dlc]);
+        EXPECT_EQ(GTTCAN_fd_length_to_dlc(lengths[dlc]), dlc);
+    }
+    EXPECT_EQ(GTTCAN_fd_length_to_dlc(9U), 9U);
+    EXPECT_EQ(GTTCAN_fd_length_to_dlc(33U), 14U);
+    EXPECT_EQ(GTTCAN_fd_length_to_dlc(49U), 15U);
+    EXPECT_EQ(GTTCAN_fd_length_to_dlc(200U), 15U);
+}
+
+static void test_fd_crc(void)
+{
+    // The CRC-17/CAN-FD and CRC-21/CAN-FD check values (0x04F03 and
+    // 0x0ED841) are for an initial value of 0; these are for the
+    // initial values of ISO 11898-1:2015.
+    const uint8_t check[9] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    EXPECT_EQ(GTTCAN_crc17(check, 72U), 0x09D9BU);
+    EXPECT_EQ(GTTCAN_crc21(check, 72U), 0x1323D8U);
+    // Appending the CRC gives a zero remainder.
+    const uint32_t crc17 = GTTCAN_crc17(check, 72U);
+    const uint8_t with_crc17[12] = { '1', '2', '3', '4', '5', '6', '7', '8', '9',
+                                     (uint8_t)(crc17 >> 9U), (uint8_t)(crc17 >> 1U), (uint8_t)(crc17 << 7U) };
+    EXPECT_EQ(GTTCAN_crc17(with_crc17, 89U), 0U);
+    const uint32_t crc21 = GTTCAN_crc21(check, 72U);
+    const uint8_t with_crc21[12] = { '1', '2', '3', '4', '5', '6', '7', '8', '9',
+                                     (uint8_t)(crc21 >> 13U), (uint8_t)(crc21 >> 5U), (uint8_t)(crc21 << 3U) };
+    EXPECT_EQ(GTTCAN_crc21(with_crc21, 93U), 0U);
+}
+
+static void test_fd_frame_bits(void)
+{
+    gttcan_fd_frame_bits_t bits;
+    // 41 header bits + 2 stuffing bits + 28 CRC field bits + 9 (ACK, EOF)
+    EXPECT_EQ(GTTCAN_calculate_fd_frame_bits(0x1234567U, (const uint8_t *)0, 0U, true, &bits), 80U);
+    EXPECT_EQ(bits.nominal_bits, 46U);
+    EXPECT_EQ(bits.data_bits, 34U);
+    EXPECT_EQ(bits.stuffing_bits, 2U);
+    EXPECT_EQ(GTTCAN_fd_frame_duration(&bits, 10U, 2U), (46U * 10U) + (34U * 2U));
+    EXPECT_EQ(GTTCAN_calculate_fd_frame_bits(0x1234567U, (const uint8_t *)0, 0U, false, &bits), 80U);
+    EXPECT_EQ(bits.nominal_bits, 80U);
+    EXPECT_EQ(bits.data_bits, 0U);
+
+    static const uint32_t ids[] = { 0U, 0x1FFFFFFFU, 0x0AAAAAAAU, 0x00040001U };
+    uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+    for (uint32_t i = 0U; i < (sizeof(ids) / sizeof(ids[0])); i++)
+    {
+        for (uint8_t length = 0U; length <= GTTCAN_FD_MAX_PAYLOAD; length++)
+        {
+            gttcan_fd_frame_bits_t max;
+            const uint32_t max_bits = GTTCAN_calculate_fd_frame_max_bits(ids[i], length, true, &max);
+            EXPECT_EQ(max.nominal_bits + max.data_bits, max_bits);
+            gttcan_fd_frame_prefix_t prefix; // reused for every payload
+            GTTCAN_prepare_fd_frame_prefix(ids[i], length, true, &prefix);
+            for (uint32_t sample = 0U; sample < 100U; sample++)
+            {
+                uint8_t payload[GTTCAN_FD_MAX_PAYLOAD];
+                for (uint32_t byte = 0U; byte < GTTCAN_FD_MAX_PAYLOAD; byte++)
+                {
+                    random_state = (random_state * 6364136223846793005ULL) + 1442695040888963407ULL;
+                    // Mostly runs of equal bits, which stuff the most.
+                    payload[byte] = ((random_state >> 60U) & 1U) ? (uint8_t)(random_state >> 32U) : (uint8_t)(0U - ((random_state >> 40U) & 1U));
+                }
+                const uint32_t frame_bits = GTTCAN_calculate_fd_frame_bits(ids[i], payload, length, true, &bits);
+                gttcan_fd_frame_bits_t from_prefix;
+                EXPECT_EQ(GTTCAN_calculate_fd_frame_bits_from_prefix(&prefix, payload, &from_prefix), frame_bits);
+                EXPECT_EQ(from_prefix.data_bits, bits.data_bits);
+                EXPECT_EQ(from_prefix.crc, bits.crc);
+                EXPECT_TRUE(frame_bits <= max_bits);
+                EXPECT_EQ(bits.nominal_bits + bits.data_bits, frame_bits);
+                EXPECT_EQ(bits.nominal_bits, max.nominal_bits); // the header is stuffed exactly
+                EXPECT_EQ(bits.crc >> ((GTTCAN_fd_dlc_to_length(GTTCAN_fd_length_to_dlc(length)) > 16U) ? 21U : 17U), 0U);
+                // Gray-coded stuff count with even parity
+                const uint32_t gray = (uint32_t)bits.stuff_count >> 1U;
+                EXPECT_EQ(((bits.stuff_count >> 3U) ^ (bits.stuff_count >> 2U) ^ (bits.stuff_count >> 1U) ^ bits.stuff_count) & 1U, 0U);
+                const uint32_t count = gray ^ (gray >> 1U) ^ (gray >> 2U);
+                EXPECT_EQ(count & 7U, bits.stuffing_bits & 7U);
+            }
+        }
+    }
+}
+
+static void test_exact_slot_offset(void)
+{
+    callback_data_t calls = { 0 };
+    GTTCAN_init(&ttcan, REMOTE_NODE, SLOT_DURATION, GLOBAL_SCHEDULE_LENGTH,
+                ignore_transmit, ignore_timer, read_zero, record_write, &calls);
+    load_free_schedule();
+    const uint64_t network_time = 1000000U;
+    const uint64_t reference_data = 0x8000000000000000ULL | network_time;
+    GTTCAN_process_frame(&ttcan, 0U, schedule_index(0U), reference_data);
+    EXPECT_EQ(calls.call_count, 1);
+    EXPECT_EQ(calls.id, NETWORK_TIME_SLOT);
+    EXPECT_EQ(calls.data, network_time + CAN_SLOT_OFFSET);
+
+    const uint32_t bit_time = 10U;
+    GTTCAN_set_exact_slot_offset(&ttcan, bit_time, 0U);
+    uint8_t payload[8];
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        payload[i] = (uint8_t)(reference_data >> (56U - (8U * i)));
+    }
+    const uint32_t frame_bits = GTTCAN_calculate_extended_frame_bits(schedule_index(0U), payload, 8U);
+    EXPECT_EQ(GTTCAN_reference_frame_offset(&ttcan, schedule_index(0U), reference_data), frame_bits * bit_time);
+    EXPECT_EQ(ttcan.reference_frame_prefixes[0].id, schedule_index(0U));
+    GTTCAN_process_frame(&ttcan, 0U, schedule_index(0U), reference_data);
+    EXPECT_EQ(calls.call_count, 2);
+    EXPECT_EQ(calls.data, network_time + (frame_bits * bit_time));
+}
+
+static void test_crc15_matches_bitwise(void)
+{
+    const uint8_t frame[8] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+    EXPECT_EQ(GTTCAN_crc15(frame, 8U), 0x4BFFU);
+    EXPECT_EQ(GTTCAN_crc15_bitwise(frame, 8U), 0x4BFFU);
+    uint8_t buffer[64];
+    srand(1U);
+    for (uint32_t length = 0U; length <= sizeof(buffer); length++)
+    {
+        for (uint32_t i = 0U; i < length; i++)
+        {
+            buffer[i] = (uint8_t)rand();
+        }
+        EXPECT_EQ(GTTCAN_crc15(buffer, length), GTTCAN_crc15_bitwise(buffer, length));
+    }
+}
+
+static void test_crc15_batch(void)
+{
+    const uint32_t stride = 16U;
+    const uint32_t lengths[] = { 0U, 1U, 8U, 13U, 16U };
+    const uint32_t count = sizeof(lengths) / sizeof(lengths[0]);
+    uint8_t frames[sizeof(lengths) / sizeof(lengths[0]) * 16U];
+    uint16_t crcs[sizeof(lengths) / sizeof(lengths[0])];
+    for (uint32_t i = 0U; i < sizeof(frames); i++)
+    {
+        frames[i] = (uint8_t)(i * 37U);
+    }
+    GTTCAN_crc15_batch(frames, stride, lengths, crcs, count);
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        EXPECT_EQ(crcs[i], GTTCAN_crc15_bitwise(&frames[i * stride], lengths[i]));
+    }
+}
+
+typedef struct test_case_s {
+    const char *name;
+    void (*run)(void);
+} test_case_t;
+
+static const test_case_t tests[] = {
+    { "init", test_init },
+    { "fta", test_fta },
+    { "fta_outliers", test_fta_outliers },
+    { "state_correction", test_state_correction },
+    { "transmit_not_active", test_transmit_not_active },
+    { "transmit_calls_read_value", test_transmit_calls_read_value },
+    { "load_schedule", test_load_schedule },
+    { "transmit_tables", test_transmit_tables },
+    { "process_frames", test_process_frames },
+    { "clock_servo", test_clock_servo },
+    { "fast_join", test_fast_join },
+    { "sporadic_queue", test_sporadic_queue },
+    { "arbitration_slots", test_arbitration_slots },
+    { "schedule_switch", test_schedule_switch },
+    { "shared_node_schedule", test_shared_node_schedule },
+    { "acceptance_filters", test_acceptance_filters },
+    { "global_clock", test_global_clock },
+    { "rx_ring", test_rx_ring },
+    { "deferred_delivery", test_deferred_delivery },
+    { "whiteboard", test_whiteboard },
+    { "whiteboard_transmit_receive", test_whiteboard_transmit_receive },
+    { "fd_transmit_receive", test_fd_transmit_receive },
+    { "stats", test_stats },
+#if GTTCAN_TRACE
+    { "trace", test_trace },
+#endif
+#ifdef HAVE_PTHREADS
+    { "rx_ring_threads", test_rx_ring_threads },
+    { "whiteboard_threads", test_whiteboard_threads },
+    { "clock_threads", test_clock_threads },
+    { "stats_threads", test_stats_threads },
+#endif
+    { "can_id", test_can_id },
+    { "bit_stuffing", test_bit_stuffing },
+    { "extended_frame_bits", test_extended_frame_bits },
+    { "extended_frame_max_bits", test_extended_frame_max_bits },
+    { "exact_slot_offset", test_exact_slot_offset },
+    { "fd_dlc", test_fd_dlc },
+    { "fd_crc", test_fd_crc },
+    { "fd_frame_bits", test_fd_frame_bits },
+    { "crc15_matches_bitwise", test_crc15_matches_bitwise },
+    { "crc15_batch", test_crc15_batch },
+};
+
+static int run_test(const test_case_t *test)
+{
+    const int before = failures;
+    set_up();
+    test->run();
+    printf("%s %s\n", (failures == before) ? "PASS" : "FAIL", test->name);
+    return failures - before;
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t count = sizeof(tests) / sizeof(tests[0]);
+    if (argc < 2)
+    {
+        for (size_t i = 0U; i < count; i++)
+        {
+            (void)run_test(&tests[i]);
+        }
+    }
+    for (int arg = 1; arg < argc; arg++)
+    {
+        size_t i = 0U;
+        while ((i < count) && (strcmp(tests[i].name, argv[arg]) != 0))
+        {
+            i++;
+        }
+        if (i == count)
+        {
+            fprintf(stderr, "%s: unknown test %s\n", argv[0], argv[arg]);
+            return 2;
+        }
+        (void)run_test(&tests[i]);
+    }
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,298 @@
+/**
+ * @file gttcan_cpp_tests.cpp
+ * @brief Tests of the header-only C++ front end (gttcan.hpp).
+ *
+ * The tables and the behaviour of gttcan::Node are compared with a
+ * gttcan_t instance loaded with the same schedule.  Run without
+ * arguments to run all tests, or with the names of the tests to run.
+ */
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "gttcan.hpp"
+
+namespace {
+
+int failures;
+
+#define EXPECT_EQ(actual, expected)                                                               \
+    do                                                                                            \
+    {                                                                                             \
+        const long long actual_ = (long long)(actual);                                            \
+        const long long expected_ = (long long)(expected);                                        \
+        if (actual_ != expected_)                                                                 \
+        {                                                                                         \
+            std::fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n",                            \
+                         __FILE__, __LINE__, #actual, actual_, expected_);                        \
+            failures++;                                                                           \
+        }                                                                                         \
+    } while (0)
+
+#define EXPECT_TRUE(condition) EXPECT_EQ((condition) ? 1 : 0, 1)
+
+/// 12 slots: the reference frame of node 1 at 0 and 6, node 2 in 2, 3 and 9, node 3 elsewhere.
+struct TestSchedule {
+    static constexpr uint8_t node = 2U;
+    static constexpr uint32_t slotduration = 2000U;
+    static constexpr std::array<uint32_t, 12> entries = {
+        (1U << 16U) | 0U, (3U << 16U) | 5U, (2U << 16U) | 1U, (2U << 16U) | 2U,
+        (3U << 16U) | 6U, (3U << 16U) | 7U, (1U << 16U) | 0U, (3U << 16U) | 8U,
+        (3U << 16U) | 9U, (2U << 16U) | 3U, (3U << 16U) | 10U, (3U << 16U) | 11U,
+    };
+};
+
+/// The same schedule on the time master.
+struct MasterSchedule {
+    static constexpr uint8_t node = 1U;
+    static constexpr uint32_t slotduration = TestSchedule::slotduration;
+    static constexpr std::array<uint32_t, 12> entries = TestSchedule::entries;
+};
+
+/// A node without slots.
+struct ListenerSchedule {
+    static constexpr uint8_t node = 7U;
+    static constexpr uint32_t slotduration = TestSchedule::slotduration;
+    static constexpr std::array<uint32_t, 12> entries = TestSchedule::entries;
+};
+
+/// One call of a driver or store.
+struct Call {
+    char kind; // 't'ransmit, 's'et timer, 'r'ead, 'w'rite
+    uint32_t id;
+    uint64_t value;
+
+    bool operator==(const Call &other) const { return (kind == other.kind) && (id == other.id) && (value == other.value); }
+};
+
+/// Driver and store of gttcan::Node, recording every call.
+struct Recorder {
+    std::vector<Call> calls;
+
+    void transmit(uint32_t id, uint64_t data) { calls.push_back(Call { 't', id, data }); }
+    void set_timer(uint32_t delay) { calls.push_back(Call { 's', 0U, delay }); }
+    uint64_t read(uint16_t dataID) { calls.push_back(Call { 'r', dataID, 0U }); return 0x0123456789ABCDEFULL ^ dataID; }
+    void write(uint16_t dataID, uint64_t value, uint32_t timestamp) { (void)timestamp; calls.push_back(Call { 'w', dataID, value }); }
+};
+
+void c_transmit(uint32_t id, uint64_t data, void *context) { static_cast<Recorder *>(context)->transmit(id, data); }
+void c_set_timer(uint32_t delay, void *context) { static_cast<Recorder *>(context)->set_timer(delay); }
+uint64_t c_read(uint16_t dataID, void *context) { return static_cast<Recorder *>(context)->read(dataID); }
+void c_write(uint16_t dataID, uint64_t value, void *context) { static_cast<Recorder *>(context)->write(dataID, value, 0U); }
+
+uint8_t blob[GTTCAN_SCHEDULE_SIZE(12)];
+
+/// Initialise a gttcan_t node with the schedule of `Schedule`, shared
+/// by all nodes of that schedule (also without GTTCAN_EMBEDDED_SCHEDULE).
+template <typename Schedule>
+bool load(gttcan_t &ttcan, Recorder &recorder)
+{
+    static gttcan_node_schedule_t node_schedule;
+    GTTCAN_init(&ttcan, Schedule::node, Schedule::slotduration, (uint16_t)Schedule::entries.size(),
+                c_transmit, c_set_timer, c_read, c_write, &recorder);
+    const uint32_t size = GTTCAN_pack_schedule(blob, sizeof(blob), Schedule::entries.data(),
+                                               (uint16_t)Schedule::entries.size(), 0U);
+    return GTTCAN_build_node_schedule(&node_schedule, blob, size, Schedule::node, false) &&
+           GTTCAN_set_node_schedule(&ttcan, &node_schedule);
+}
+
+template <typename Schedule>
+void check_tables()
+{
+    using tables = gttcan::Tables<Schedule>;
+    static gttcan_t ttcan;
+    Recorder recorder;
+    EXPECT_TRUE(load<Schedule>(ttcan, recorder));
+    EXPECT_EQ(tables::local_length, ttcan.node_schedule->localScheduleLength);
+    for (std::size_t i = 0U; i < tables::local_length; i++)
+    {
+        EXPECT_EQ(tables::local[i].index, ttcan.node_schedule->localScheduleSlotID[i]);
+        EXPECT_EQ(tables::local[i].dataID, ttcan.node_schedule->localScheduleDataID[i]);
+        EXPECT_EQ(tables::local[i].id, GTTCAN_CAN_ID(ttcan.node_schedule->localScheduleSlotID[i], ttcan.node_schedule->localScheduleDataID[i]));
+    }
+    for (uint16_t index = 0U; index < tables::length; index++)
+    {
+        EXPECT_EQ(tables::next[index].delay, GTTCAN_get_slots_to_next_transmit(&ttcan, index) * Schedule::slotduration);
+#if GTTCAN_TRANSMIT_TABLES
+        EXPECT_EQ(tables::next[index].local, ttcan.node_schedule->nextLocalScheduleIndex[index]);
+#endif
+    }
+}
+
+void test_tables()
+{
+    check_tables<TestSchedule>();
+    check_tables<MasterSchedule>();
+    check_tables<ListenerSchedule>();
+    static_assert(gttcan::Tables<TestSchedule>::local_length == 3U, "node 2 owns three slots");
+    static_assert(gttcan::Tables<TestSchedule>::next[3].delay == 6U * 2000U, "slot 3 to slot 9");
+}
+
+/// Return the next value of a xorshift generator.
+uint32_t next_random(uint32_t &state)
+{
+    state ^= state << 13U;
+    state ^= state >> 17U;
+    state ^= state << 5U;
+    return state;
+}
+
+/**
+ * Feed the same random frames and timer interrupts to a gttcan_t and a
+ * gttcan::Node and compare all driver and store calls.
+ */
+template <typename Schedule>
+void check_lockstep(bool start)
+{
+    static gttcan_t ttcan;
+    Recorder c_calls;
+    Recorder cpp_calls;
+    EXPECT_TRUE(load<Schedule>(ttcan, c_calls));
+    gttcan::Node<Schedule, Recorder, Recorder> node(cpp_calls, cpp_calls);
+    if (start)
+    {
+        GTTCAN_start(&ttcan);
+        node.start();
+    }
+    uint32_t state = 12345U;
+    const uint32_t length = (uint32_t)Schedule::entries.size();
+    for (uint32_t step = 0U; step < 20000U; step++)
+    {
+        const uint32_t choice = next_random(state) % 16U;
+        if ((choice < 3U) && (gttcan::Tables<Schedule>::local_length > 0U)) // gttcan_t does not check for an empty local schedule
+        {
+            GTTCAN_transmit_next_frame(&ttcan);
+            node.transmit_next_frame();
+        }
+        else
+        {
+            const uint16_t index = (uint16_t)(next_random(state) % (length + 1U)); // sometimes outside the schedule
+            const uint16_t dataID = (index < length) ? (uint16_t)(Schedule::entries[index] & 0xFFFFU) : 1U;
+            uint64_t data = ((uint64_t)next_random(state) << 32U) | next_random(state);
+            if (dataID == (uint16_t)NETWORK_TIME_SLOT)
+            {
+                data &= gttcan::network_time_mask;
+                data |= (index == 0U) ? gttcan::start_of_schedule_flag : 0U;
+            }
+            const uint32_t current_time = next_random(state) % 100000U;
+            GTTCAN_process_frame(&ttcan, current_time, GTTCAN_CAN_ID(index, dataID), data);
+            node.process_frame(current_time, GTTCAN_CAN_ID(index, dataID), data);
+        }
+        EXPECT_EQ(node.active(), ttcan.isActive);
+        EXPECT_EQ(node.transmitted(), ttcan.transmitted);
+        if (!(c_calls.calls == cpp_calls.calls))
+        {
+            std::fprintf(stderr, "calls differ at step %u (node %u)\n", step, (unsigned)Schedule::node);
+            failures++;
+            break;
+        }
+    }
+    EXPECT_TRUE(!c_calls.calls.empty());
+}
+
+void test_lockstep()
+{
+    check_lockstep<TestSchedule>(false);
+    check_lockstep<MasterSchedule>(true);
+    check_lockstep<ListenerSchedule>(false);
+}
+
+void test_schedule_switch()
+{
+    static gttcan_t ttcan;
+    Recorder c_calls;
+    Recorder cpp_calls;
+    EXPECT_TRUE(load<TestSchedule>(ttcan, c_calls));
+    gttcan::Node<TestSchedule, Recorder, Recorder> node(cpp_calls, cpp_calls);
+    const uint64_t switching = gttcan::start_of_schedule_flag | GTTCAN_SCHEDULE_SWITCH_FLAG | 1000U;
+    GTTCAN_process_frame(&ttcan, 0U, GTTCAN_CAN_ID(0U, 0U), switching);
+    node.process_frame(0U, GTTCAN_CAN_ID(0U, 0U), switching);
+    EXPECT_TRUE(!node.active()); // the new schedule is not known
+    EXPECT_EQ(node.active(), ttcan.isActive);
+    node.process_frame(0U, GTTCAN_CAN_ID(0U, 0U), gttcan::start_of_schedule_flag);
+    EXPECT_TRUE(!node.active());
+    node.reset();
+    node.process_frame(0U, GTTCAN_CAN_ID(0U, 0U), gttcan::start_of_schedule_flag);
+    EXPECT_TRUE(node.active());
+}
+
+/// A driver that only counts its calls.
+struct CountingDriver {
+    uint32_t frames = 0U;
+    uint32_t last_delay = 0U;
+
+    void transmit(uint32_t id, uint64_t data) { (void)id; (void)data; frames++; }
+    void set_timer(uint32_t delay) { last_delay = delay; }
+};
+
+void test_whiteboard_store()
+{
+    static gttcan_whiteboard_t whiteboard;
+    GTTCAN_whiteboard_init(&whiteboard);
+    (void)GTTCAN_whiteboard_write(&whiteboard, 1U, 42U, 0U);
+    CountingDriver driver;
+    gttcan::WhiteboardStore store(whiteboard);
+    gttcan::Node<TestSchedule, CountingDriver, gttcan::WhiteboardStore> node(driver, store);
+    node.process_frame(10U, GTTCAN_CAN_ID(0U, 0U), gttcan::start_of_schedule_flag | 5000U);
+    EXPECT_TRUE(node.active());
+    EXPECT_EQ(driver.last_delay, 2U * TestSchedule::slotduration);
+    EXPECT_EQ(GTTCAN_whiteboard_value(&whiteboard, NETWORK_TIME_SLOT), 5000U + GTTCAN_DEFAULT_SLOT_OFFSET);
+    node.process_frame(4000U, GTTCAN_CAN_ID(1U, 5U), 77U);
+    gttcan_whiteboard_value_t value = { 0U, 0U, 0U };
+    EXPECT_TRUE(GTTCAN_whiteboard_read(&whiteboard, 5U, &value));
+    EXPECT_EQ(value.value, 77U);
+    EXPECT_EQ(value.timestamp, 4000U);
+    node.transmit_next_frame(); // slot 2 sends data ID 1 from the whiteboard
+    EXPECT_EQ(driver.frames, 1U);
+    EXPECT_EQ(driver.last_delay, TestSchedule::slotduration);
+}
+
+struct TestCase {
+    const char *name;
+    void (*run)();
+};
+
+const TestCase tests[] = {
+    { "tables", test_tables },
+    { "lockstep", test_lockstep },
+    { "schedule_switch", test_schedule_switch },
+    { "whiteboard_store", test_whiteboard_store },
+};
+
+int run_test(const TestCase &test)
+{
+    const int before = failures;
+    test.run();
+    std::printf("%s %s\n", (failures == before) ? "PASS" : "FAIL", test.name);
+    return failures - before;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        for (const TestCase &test : tests)
+        {
+            (void)run_test(test);
+        }
+    }
+    for (int arg = 1; arg < argc; arg++)
+    {
+        const TestCase *found = nullptr;
+        for (const TestCase &test : tests)
+        {
+            if (std::strcmp(test.name, argv[arg]) == 0)
+            {
+                found = &test;
+            }
+        }
+        if (found == nullptr)
+        {
+            std::fprintf(stderr, "%s: unknown test %s\n", argv[0], argv[arg]);
+            return 2;
+        }
+        (void)run_test(*found);
+    }
+    return (failures == 0) ? 0 : 1;
+}
@@ -17,6 +17,8 @@ final class gttcanTests: XCTestCase {
     }
 
     var ttcanptr = UnsafeMutablePointer<gttcan_t>.allocate(capacity: 1)
+    var scheduleBlob = UnsafeMutablePointer<UInt8>.allocate(capacity: 64)
+    var nodeSchedule = UnsafeMutablePointer<gttcan_node_schedule_t>.allocate(capacity: 1)
 
     static let localNode = UInt8(1)
     static let remoteNode = UInt8(2)
@@ -27,6 +29,8 @@ final class gttcanTests: XCTestCase {
 
     deinit {
         ttcanptr.deallocate()
+        scheduleBlob.deallocate()
+        nodeSchedule.deallocate()
     }
 
     override func setUp() {
@@ -45,7 +49,7 @@ final class gttcanTests: XCTestCase {
     func testInit() {
         XCTAssertEqual(ttcanptr.pointee.localNodeId, gttcanTests.localNode)
         XCTAssertEqual(ttcanptr.pointee.slotduration, gttcanTests.slotDuration)
-        XCTAssertEqual(ttcanptr.pointee.globalScheduleLength, gttcanTests.globalScheduleLength)
+        XCTAssertEqual(ttcanptr.pointee.node_schedule.pointee.globalScheduleLength, gttcanTests.globalScheduleLength)
         XCTAssertNotNil(ttcanptr.pointee.transmit_callback)
         XCTAssertNotNil(ttcanptr.pointee.set_timer_int_callback)
         XCTAssertNotNil(ttcanptr.pointee.read_value)
@@ -56,8 +60,8 @@ final class gttcanTests: XCTestCase {
     func testFTA() {
         XCTAssertEqual(ttcanptr.pointee.error_accumulator, 0)
         XCTAssertEqual(ttcanptr.pointee.slots_accumulated, 0)
-        XCTAssertEqual(ttcanptr.pointee.lower_outlier, Int32.max)
-        XCTAssertEqual(ttcanptr.pointee.upper_outlier, Int32.min)
+        XCTAssertEqual(ttcanptr.pointee.lower_outliers.0, Int32.max)
+        XCTAssertEqual(ttcanptr.pointee.upper_outliers.0, Int32.min)
         ttcanptr.pointee.transmitted = true
         XCTAssertEqual(GTTCAN_fta(ttcanptr), 0)
         ttcanptr.pointee.error_accumulator = 1
@@ -70,22 +74,22 @@ final class gttcanTests: XCTestCase {
         ttcanptr.pointee.slots_accumulated = 4
         XCTAssertEqual(GTTCAN_fta(ttcanptr), 2)
         GTTCAN_accumulate_error(ttcanptr, -1)
-        XCTAssertEqual(ttcanptr.pointee.lower_outlier, -1)
-        XCTAssertEqual(ttcanptr.pointee.upper_outlier, -1)
+        XCTAssertEqual(ttcanptr.pointee.lower_outliers.0, -1)
+        XCTAssertEqual(ttcanptr.pointee.upper_outliers.0, -1)
         GTTCAN_accumulate_error(ttcanptr, 1)
-        XCTAssertEqual(ttcanptr.pointee.lower_outlier, -1)
-        XCTAssertEqual(ttcanptr.pointee.upper_outlier, 1)
+        XCTAssertEqual(ttcanptr.pointee.lower_outliers.0, -1)
+        XCTAssertEqual(ttcanptr.pointee.upper_outliers.0, 1)
         GTTCAN_accumulate_error(ttcanptr, -2)
         GTTCAN_accumulate_error(ttcanptr, 2)
-        XCTAssertEqual(ttcanptr.pointee.lower_outlier, -2)
-        XCTAssertEqual(ttcanptr.pointee.upper_outlier, 2)
+        XCTAssertEqual(ttcanptr.pointee.lower_outliers.0, -2)
+        XCTAssertEqual(ttcanptr.pointee.upper_outliers.0, 2)
         GTTCAN_accumulate_error(ttcanptr, -3)
         GTTCAN_accumulate_error(ttcanptr, 3)
-        XCTAssertEqual(ttcanptr.pointee.lower_outlier, -3)
-        XCTAssertEqual(ttcanptr.pointee.upper_outlier, 3)
+        XCTAssertEqual(ttcanptr.pointee.lower_outliers.0, -3)
+        XCTAssertEqual(ttcanptr.pointee.upper_outliers.0, 3)
         XCTAssertEqual(GTTCAN_fta(ttcanptr), 0)
-        XCTAssertEqual(ttcanptr.pointee.lower_outlier, Int32.max)
-        XCTAssertEqual(ttcanptr.pointee.upper_outlier, Int32.min)
+        XCTAssertEqual(ttcanptr.pointee.lower_outliers.0, Int32.max)
+        XCTAssertEqual(ttcanptr.pointee.upper_outliers.0, Int32.min)
         XCTAssertEqual(ttcanptr.pointee.error_accumulator, 0)
         XCTAssertEqual(ttcanptr.pointee.slots_accumulated, 0)
     }
@@ -108,20 +112,21 @@ final class gttcanTests: XCTestCase {
         let timer = Int(expectedTimer) + gttcanTests.canSlotOffset + slowNodeOffset
         ttcan.action_time = UInt32(timer - gttcanTests.canSlotOffset)
         XCTAssertEqual(ttcan.action_time, expectedTimer + UInt32(slowNodeOffset))
-        GTTCAN_process_frame(&ttcan, scheduleIndex(1) | gttcanTests.data1, 0)
+        var currentTime = ttcan.action_time
+        GTTCAN_process_frame(&ttcan, currentTime, scheduleIndex(1) | gttcanTests.data1, 0)
         // We expect the accumulated error to be -1 (from our perspective)
         XCTAssertEqual(ttcan.error_accumulator, -1)
         XCTAssertEqual(ttcan.slots_accumulated, 1)
-        XCTAssertEqual(ttcan.lower_outlier, -1)
-        XCTAssertEqual(ttcan.upper_outlier, -1)
+        XCTAssertEqual(ttcan.lower_outliers.0, -1)
+        XCTAssertEqual(ttcan.upper_outliers.0, -1)
         for _ in 2...3 {
-            ttcan.action_time = UInt32(timer - gttcanTests.canSlotOffset)
-            GTTCAN_process_frame(&ttcan, scheduleIndex(1) | gttcanTests.data1, 0)
+            currentTime = UInt32(timer - gttcanTests.canSlotOffset)
+            GTTCAN_process_frame(&ttcan, currentTime, scheduleIndex(1) | gttcanTests.data1, 0)
         }
         XCTAssertEqual(ttcan.error_accumulator, -3)
         XCTAssertEqual(ttcan.slots_accumulated, 3)
-        XCTAssertEqual(ttcan.lower_outlier, -1)
-        XCTAssertEqual(ttcan.upper_outlier, -1)
+        XCTAssertEqual(ttcan.lower_outliers.0, -1)
+        XCTAssertEqual(ttcan.upper_outliers.0, -1)
     }
 
     func testTransmitNotActive() {
@@ -137,8 +142,10 @@ final class gttcanTests: XCTestCase {
         ttcanptr.pointee.isActive = true
         ttcanptr.pointee.context_pointer = Unmanaged.passUnretained(callData).toOpaque()
         ttcanptr.pointee.localScheduleIndex = 1
-        ttcanptr.pointee.localScheduleSlotID.1 = 10
-        ttcanptr.pointee.localScheduleDataID.1 = 10
+        nodeSchedule.initialize(to: ttcanptr.pointee.node_schedule.pointee)
+        nodeSchedule.pointee.localScheduleSlotID.1 = 10
+        nodeSchedule.pointee.localScheduleDataID.1 = 10
+        ttcanptr.pointee.node_schedule = UnsafePointer(nodeSchedule)
         ttcanptr.pointee.read_value = { id, context in
             guard
                 let callData = context.map({ Unmanaged<CallbackData<UInt64>>.fromOpaque($0).takeUnretainedValue() })
@@ -167,6 +174,137 @@ final class gttcanTests: XCTestCase {
         XCTAssertEqual(callData.data, 12)
     }
 
+    /// Load a 4-slot global schedule in which the local node owns slot 0.
+    @discardableResult
+    func loadTestSchedule() -> Bool {
+        let entries: [UInt32] = [
+            UInt32(gttcanTests.localNode) << 16 | 0,
+            10 << 16 | 5,
+            8 << 16 | 3,
+            9 << 16 | 4
+        ]
+        let size = GTTCAN_pack_schedule(scheduleBlob, 64, entries, UInt16(entries.count), 0)
+        return GTTCAN_build_node_schedule(nodeSchedule, scheduleBlob, size, gttcanTests.localNode,
+                                          ttcanptr.pointee.sporadic != nil) &&
+            GTTCAN_set_node_schedule(ttcanptr, nodeSchedule)
+    }
+
+    func testLoadSchedule() {
+        XCTAssertEqual(GTTCAN_get_schedule_entry(ttcanptr, 0), 0)
+        XCTAssertTrue(loadTestSchedule())
+        XCTAssertEqual(ttcanptr.pointee.node_schedule.pointee.globalScheduleLength, 4)
+        XCTAssertEqual(ttcanptr.pointee.slotduration, gttcanTests.slotDuration)
+        XCTAssertEqual(ttcanptr.pointee.node_schedule.pointee.localScheduleLength, 1)
+        XCTAssertEqual(GTTCAN_get_schedule_entry(ttcanptr, 2), 8 << 16 | 3)
+        XCTAssertEqual(GTTCAN_get_schedule_entry(ttcanptr, 4), 0)
+        // Truncated blobs and a corrupted magic are rejected.
+        XCTAssertFalse(GTTCAN_load_schedule(ttcanptr, scheduleBlob, UInt32(GTTCAN_SCHEDULE_HEADER_SIZE)))
+        scheduleBlob[0] = 0
+        XCTAssertFalse(GTTCAN_load_schedule(ttcanptr, scheduleBlob, 64))
+        // Packing into a buffer that is too small fails.
+        let entries: [UInt32] = [ 1 << 16 | 1 ]
+        XCTAssertEqual(GTTCAN_pack_schedule(scheduleBlob, 8, entries, 1, 0), 0)
+    }
+
+    func testTransmitTables() {
+        // The local node owns slot 0 of the 4-slot global schedule.
+        XCTAssertTrue(loadTestSchedule())
+        XCTAssertEqual(GTTCAN_get_slots_to_next_transmit(ttcanptr, 0), 4)
+        XCTAssertEqual(GTTCAN_get_slots_to_next_transmit(ttcanptr, 1), 3)
+        XCTAssertEqual(GTTCAN_get_slots_to_next_transmit(ttcanptr, 3), 1)
+        XCTAssertEqual(GTTCAN_get_slots_to_next_transmit(ttcanptr, 100), 0)
+        XCTAssertEqual(GTTCAN_get_slots_since_last_transmit(ttcanptr, 2), 2)
+        ttcanptr.pointee.transmitted = true
+        XCTAssertEqual(GTTCAN_get_slots_since_last_transmit(ttcanptr, 0), 4)
+        XCTAssertEqual(GTTCAN_get_slots_since_last_transmit(ttcanptr, 1), 1)
+        XCTAssertEqual(GTTCAN_get_slots_since_last_transmit(ttcanptr, 3), 3)
+        XCTAssertEqual(GTTCAN_get_slots_since_last_transmit(ttcanptr, 100), 0)
+        // A frame from any slot puts the local schedule back in step.
+        ttcanptr.pointee.localScheduleIndex = 7
+        GTTCAN_process_frame(ttcanptr, gttcanTests.slotDuration * 2, scheduleIndex(2) | gttcanTests.data1, 0)
+        XCTAssertEqual(ttcanptr.pointee.localScheduleIndex, 0)
+        // Frames outside the global schedule are ignored.
+        let accumulated = ttcanptr.pointee.slots_accumulated
+        GTTCAN_process_frame(ttcanptr, 0, scheduleIndex(100) | gttcanTests.data1, 0)
+        XCTAssertEqual(ttcanptr.pointee.slots_accumulated, accumulated)
+    }
+
+    func testProcessFrames() {
+        XCTAssertTrue(loadTestSchedule())
+        let callData = CallbackData<UInt32>()
+        ttcanptr.pointee.transmitted = true
+        ttcanptr.pointee.context_pointer = Unmanaged.passUnretained(callData).toOpaque()
+        ttcanptr.pointee.set_timer_int_callback = { delay, context in
+            guard
+                let callData = context.map({ Unmanaged<CallbackData<UInt32>>.fromOpaque($0).takeUnretainedValue() })
+            else {
+                XCTFail("Context is nil")
+                return
+            }
+            callData.callCount += 1
+            callData.data = delay
+        }
+        let frames = [
+            gttcan_rx_frame_t(timestamp: 10_003, id: scheduleIndex(1) | 5, data: 1),
+            gttcan_rx_frame_t(timestamp: 19_998, id: scheduleIndex(2) | 3, data: 2),
+            gttcan_rx_frame_t(timestamp: 30_001, id: scheduleIndex(3) | 4, data: 3),
+            gttcan_rx_frame_t(timestamp: 40_002, id: scheduleIndex(0), data: 0x8000_0000_0000_0000 | 1_000_000),
+            gttcan_rx_frame_t(timestamp: 50_001, id: scheduleIndex(1) | 5, data: 4)
+        ]
+        GTTCAN_process_frames(ttcanptr, frames, UInt32(frames.count))
+        // The timer is re-armed once, relative to the last frame.
+        XCTAssertEqual(callData.callCount, 1)
+        XCTAssertEqual(callData.data, 4 * gttcanTests.slotDuration - (50_001 - 40_002))
+        XCTAssertTrue(ttcanptr.pointee.isActive)
+        XCTAssertEqual(ttcanptr.pointee.slots_accumulated, 1)
+    }
+
+    func testClockServo() {
+        XCTAssertTrue(loadTestSchedule())
+        XCTAssertFalse(ttcanptr.pointee.servo.enabled)
+        ttcanptr.pointee.transmitted = true
+        GTTCAN_set_clock_servo(ttcanptr, true, 1, 0, 0)
+        // A round in which every frame arrives 8 NTU early.
+        for slot in UInt32(1)...4 {
+            let index = slot % 4
+            let id = scheduleIndex(Int(index)) | (index == 0 ? 0 : 3)
+            GTTCAN_process_frame(ttcanptr, slot * gttcanTests.slotDuration - 8, id, index == 0 ? 0x8000_0000_0000_0000 : 1)
+        }
+        XCTAssertEqual(ttcanptr.pointee.servo.updates, 1)
+        XCTAssertEqual(ttcanptr.pointee.servo.last_error, 8)
+        XCTAssertEqual(ttcanptr.pointee.servo.phase_correction, 4)
+        XCTAssertEqual(GTTCAN_get_corrected_slot_duration(ttcanptr), UInt64(gttcanTests.slotDuration - 2) << 16)
+    }
+
+    func testFastJoin() {
+        XCTAssertTrue(loadTestSchedule())
+        // Without the fast join, data frames do not activate the node.
+        GTTCAN_process_frame(ttcanptr, 100_000, scheduleIndex(2) | 3, 1)
+        GTTCAN_process_frame(ttcanptr, 110_000, scheduleIndex(3) | 4, 1)
+        XCTAssertFalse(ttcanptr.pointee.isActive)
+        // Two frames one slot apart are consistent.
+        GTTCAN_set_fast_join(ttcanptr, 2)
+        GTTCAN_process_frame(ttcanptr, 100_000, scheduleIndex(2) | 3, 1)
+        XCTAssertFalse(ttcanptr.pointee.isActive)
+        GTTCAN_process_frame(ttcanptr, 110_000, scheduleIndex(3) | 4, 1)
+        XCTAssertTrue(ttcanptr.pointee.isActive)
+        XCTAssertFalse(ttcanptr.pointee.transmitted)
+        XCTAssertEqual(ttcanptr.pointee.localScheduleIndex, 0)
+    }
+
+    func testFTAOutliers() {
+        ttcanptr.pointee.transmitted = true
+        XCTAssertEqual(ttcanptr.pointee.fta.outliers, 1)
+        XCTAssertFalse(GTTCAN_set_fta(ttcanptr, 0, 1))
+        XCTAssertTrue(GTTCAN_set_fta(ttcanptr, 2, 1))
+        for error: Int32 in [1, 1000, 1, 1, 900, 1, 1] {
+            GTTCAN_accumulate_error(ttcanptr, error)
+        }
+        XCTAssertEqual(ttcanptr.pointee.upper_outliers.0, 1000)
+        XCTAssertEqual(ttcanptr.pointee.upper_outliers.1, 900)
+        XCTAssertEqual(GTTCAN_fta(ttcanptr), 1)
+    }
+
     func testBitStuffing() {
         let unstuffedData: [UInt8] = [ 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55 ]
         let fullyStuffedZeroes: [UInt8] = [ 0, 0, 0, 0, 0, 0, 0, 0 ]
@@ -183,8 +321,133 @@ final class gttcanTests: XCTestCase {
         let partiallyStuffedBits = GTTCAN_calculate_stuffing_bits(partiallyStuffed, UInt32(partiallyStuffed.count))
         XCTAssertEqual(partiallyStuffedBits, 8)
     }
+
+    func testExtendedFrameBits() {
+        let zeroes: [UInt8] = [ 0, 0, 0, 0, 0, 0, 0, 0 ]
+        var stream = gttcan_bitstream_t()
+        XCTAssertEqual(GTTCAN_serialise_extended_frame(0, zeroes, UInt8(zeroes.count), &stream), 118)
+        XCTAssertEqual(stream.length, 118)
+        XCTAssertEqual(stream.bits.0 >> 60, 0x0) // SOF and leading identifier bits
+        XCTAssertEqual(GTTCAN_count_bitstream_stuffing_bits(&stream), 19)
+        XCTAssertEqual(GTTCAN_calculate_extended_frame_bits(0, zeroes, UInt8(zeroes.count)), 147)
+        XCTAssertEqual(GTTCAN_calculate_extended_frame_bits(0x1FFF_FFFF, zeroes, 0), 71)
+        let frameBits = GTTCAN_calculate_extended_frame_bits(scheduleIndex(1) | gttcanTests.data1, zeroes, UInt8(zeroes.count))
+        XCTAssertGreaterThanOrEqual(frameBits, 128)
+        XCTAssertLessThanOrEqual(frameBits, 128 + 117 / 4)
+    }
+
+    func testStuffingPerformance() {
+        let frame: [UInt8] = [ 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0 ]
+        measure {
+            var bits = UInt32(0)
+            for id in 0..<UInt32(100_000) {
+                bits &+= GTTCAN_calculate_extended_frame_bits(id, frame, UInt8(frame.count))
+            }
+            XCTAssertGreaterThan(bits, 0)
+        }
+    }
+
+    func testExactSlotOffset() {
+        let callData = CallbackData<UInt64>()
+        var ttcan = gttcan_t()
+        GTTCAN_init(&ttcan,
+                    gttcanTests.remoteNode,
+                    gttcanTests.slotDuration,
+                    gttcanTests.globalScheduleLength,
+                    { _, _, _ in },
+                    { _, _ in },
+                    { _, _ in 0 },
+                    { slot, value, context in
+                        guard
+                            let callData = context.map({ Unmanaged<CallbackData<UInt64>>.fromOpaque($0).takeUnretainedValue() })
+                        else {
+                            XCTFail("Context is nil")
+                            return
+                        }
+                        XCTAssertEqual(slot, UInt16(NETWORK_TIME_SLOT))
+                        callData.callCount += 1
+                        callData.data = value
+                    },
+                    Unmanaged.passUnretained(callData).toOpaque())
+        let networkTime = UInt64(1_000_000)
+        let referenceData = 0x8000_0000_0000_0000 | networkTime
+        GTTCAN_process_frame(&ttcan, 0, scheduleIndex(0), referenceData)
+        XCTAssertEqual(callData.callCount, 1)
+        XCTAssertEqual(callData.data, networkTime + UInt64(gttcanTests.canSlotOffset))
+
+        let bitTime = UInt32(10)
+        GTTCAN_set_exact_slot_offset(&ttcan, bitTime, 0)
+        let payload = withUnsafeBytes(of: referenceData.bigEndian) { Array($0) }
+        let frameBits = GTTCAN_calculate_extended_frame_bits(scheduleIndex(0), payload, UInt8(payload.count))
+        XCTAssertEqual(GTTCAN_reference_frame_offset(&ttcan, scheduleIndex(0), referenceData), frameBits * bitTime)
+        XCTAssertEqual(ttcan.reference_frame_prefixes.0.id, scheduleIndex(0))
+        GTTCAN_process_frame(&ttcan, 0, scheduleIndex(0), referenceData)
+        XCTAssertEqual(callData.callCount, 2)
+        XCTAssertEqual(callData.data, networkTime + UInt64(frameBits * bitTime))
+    }
+
+    func testFDFrameBits() {
+        let check = Array("123456789".utf8)
+        XCTAssertEqual(GTTCAN_crc17(check, UInt32(8 * check.count)), 0x09D9B)
+        XCTAssertEqual(GTTCAN_crc21(check, UInt32(8 * check.count)), 0x1323D8)
+        XCTAssertEqual(GTTCAN_fd_length_to_dlc(20), 11)
+        XCTAssertEqual(GTTCAN_fd_dlc_to_length(15), 64)
+        var bits = gttcan_fd_frame_bits_t()
+        XCTAssertEqual(GTTCAN_calculate_fd_frame_bits(0x123_4567, nil, 0, true, &bits), 80)
+        XCTAssertEqual(bits.nominal_bits, 46)
+        XCTAssertEqual(bits.data_bits, 34)
+        let payload = [UInt8](repeating: 0x55, count: 64)
+        let frameBits = GTTCAN_calculate_fd_frame_bits(scheduleIndex(1) | gttcanTests.data1, payload, UInt8(payload.count), true, &bits)
+        XCTAssertEqual(bits.nominal_bits + bits.data_bits, frameBits)
+        XCTAssertLessThanOrEqual(frameBits, GTTCAN_calculate_fd_frame_max_bits(scheduleIndex(1) | gttcanTests.data1, 64, true, &bits))
+    }
+
+    func testCRC15MatchesBitwise() {
+        let frame: [UInt8] = [ 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 ]
+        XCTAssertEqual(GTTCAN_crc15(frame, UInt32(frame.count)), 0x4BFF)
+        XCTAssertEqual(GTTCAN_crc15_bitwise(frame, UInt32(frame.count)), 0x4BFF)
+        var generator = SystemRandomNumberGenerator()
+        for length in 0...64 {
+            let buffer = (0..<length).map { _ in UInt8.random(in: 0...255, using: &generator) }
+            XCTAssertEqual(GTTCAN_crc15(buffer, UInt32(length)), GTTCAN_crc15_bitwise(buffer, UInt32(length)))
+        }
+    }
+
+    func testCRC15Batch() {
+        let stride = 16
+        let lengths: [UInt32] = [ 0, 1, 8, 13, 16 ]
+        let frames = (0..<(stride * lengths.count)).map { UInt8(truncatingIfNeeded: $0 &* 37) }
+        var crcs = [UInt16](repeating: 0, count: lengths.count)
+        GTTCAN_crc15_batch(frames, UInt32(stride), lengths, &crcs, UInt32(lengths.count))
+        for (i, length) in lengths.enumerated() {
+            let frame = Array(frames[(i * stride)..<(i * stride + Int(length))])
+            XCTAssertEqual(crcs[i], GTTCAN_crc15_bitwise(frame, length))
+        }
+    }
+
+    func testCRC15Performance() {
+        let frame: [UInt8] = [ 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0 ]
+        measure {
+            var crc = UInt16(0)
+            for _ in 0..<100_000 {
+                crc ^= GTTCAN_crc15(frame, UInt32(frame.count))
+            }
+            XCTAssertLessThan(crc, 0x8000)
+        }
+    }
+
+    func testCRC15BitwisePerformance() {
+        let frame: [UInt8] = [ 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0 ]
+        measure {
+            var crc = UInt16(0)
+            for _ in 0..<100_000 {
+                crc ^= GTTCAN_crc15_bitwise(frame, UInt32(frame.count))
+            }
+            XCTAssertLessThan(crc, 0x8000)
+        }
+    }
 }
 
 private func scheduleIndex(_ slot: Int) -> UInt32 {
-    UInt32(slot) << 14
+    UInt32(slot) << GTTCAN_NUM_DATAID_BITS
 }
@@ -1,2 +1,100 @@
 # Sources for gttcan.
-set(gttcan_SOURCES Sources/gttcan/gttcan.c)
+set(gttcan_SOURCES
+	Sources/gttcan/gttcan.c
+	Sources/gttcan/cansupport.c
+	Sources/gttcan/rxring.c
+	Sources/gttcan/whiteboard.c
+	Sources/gttcan/stats.c
+	Sources/gttcan/trace.c
+	Sources/gttcan/fd.c
+	Sources/gttcan/sporadic.c
+	Sources/gttcan/clock.c
+	Sources/gttcan/filter.c
+)
+
+# Sources for the gttcan-sim bus simulator.
+set(gttcan_sim_SOURCES
+	Sources/gttcan-sim/gttcan_sim.c
+	Sources/gttcan-sim/main.c
+)
+
+# Sources for the Linux SocketCAN backend.
+set(gttcan_socketcan_SOURCES
+	Sources/gttcan-socketcan/gttcan_socketcan.c
+)
+
+# Sources for the gttcan-trace decoder.
+set(gttcan_trace_SOURCES
+	Sources/gttcan-trace/main.c
+)
+
+# Sources for the gttcan-schedule compiler.
+set(gttcan_schedule_SOURCES
+	Sources/gttcan-schedule/gttcan_schedule.c
+	Sources/gttcan-schedule/main.c
+)
+
+# Sources for the gttcan-bench micro-benchmarks.
+set(gttcan_bench_SOURCES
+	Sources/gttcan-bench/main.c
+)
+
+# C++ sources of the gttcan-bench micro-benchmarks (gttcan.hpp).
+set(gttcan_bench_cpp_SOURCES
+	Sources/gttcan-bench/node.cpp
+)
+
+# Sources for the native C tests.
+set(gttcan_tests_SOURCES
+	Tests/gttcanCTests/gttcan_tests.c
+)
+
+# Sources for the C++ front end tests.
+set(gttcan_cpp_tests_SOURCES
+	Tests/gttcanCppTests/gttcan_cpp_tests.cpp
+)
+
+# Native C tests, one CTest test each.
+set(gttcan_TESTS
+	init
+	fta
+	fta_outliers
+	state_correction
+	transmit_not_active
+	transmit_calls_read_value
+	load_schedule
+	transmit_tables
+	process_frames
+	clock_servo
+	fast_join
+	sporadic_queue
+	arbitration_slots
+	schedule_switch
+	shared_node_schedule
+	acceptance_filters
+	global_clock
+	rx_ring
+	deferred_delivery
+	whiteboard
+	whiteboard_transmit_receive
+	fd_transmit_receive
+	stats
+	can_id
+	bit_stuffing
+	extended_frame_bits
+	extended_frame_max_bits
+	exact_slot_offset
+	fd_dlc
+	fd_crc
+	fd_frame_bits
+	crc15_matches_bitwise
+	crc15_batch
+)
+
+# C++ front end tests, one CTest test each.
+set(gttcan_CPP_TESTS
+	tables
+	lockstep
+	schedule_switch
+	whiteboard_store
+)